@@ -18,6 +18,7 @@
 #ifndef _UNIT_TEST_H_INCLUDED_
 #define _UNIT_TEST_H_INCLUDED_
 
+#include <stddef.h>
 
 // ----------------------------------------------------------------------------
 
@@ -75,6 +76,249 @@
         }
 #endif
 
+/* The death test macros run the statement in a child process, and pass if the
+ child ends as expected and its standard error matches the pattern.  The
+ pattern is a POSIX extended regular expression, and an empty or NULL pattern
+ matches anything.  Each death test waits for its child, so death tests which
+ should run at the same time belong in separate UnitTest's run by
+ UnitTestSet::RunUnitTests with isolated workers.
+ */
+#ifndef UNIT_TEST_DEATH
+    #define UNIT_TEST_DEATH( u, statement, pattern ) \
+        if ( u->StartDeathTest() ) { \
+            try { statement; } catch (...) { u->EndDeathTest( true ); } \
+            u->EndDeathTest( false ); \
+        } else { \
+            u->CheckDeathTest( __FILE__, __LINE__, u->Checked, #statement, \
+                u->AnyDeath, 0, pattern ); \
+        }
+#endif
+
+#ifndef UNIT_TEST_EXIT
+    #define UNIT_TEST_EXIT( u, statement, code, pattern ) \
+        if ( u->StartDeathTest() ) { \
+            try { statement; } catch (...) { u->EndDeathTest( true ); } \
+            u->EndDeathTest( false ); \
+        } else { \
+            u->CheckDeathTest( __FILE__, __LINE__, u->Checked, #statement, \
+                u->ExitCode, code, pattern ); \
+        }
+#endif
+
+#ifndef UNIT_TEST_SIGNAL
+    #define UNIT_TEST_SIGNAL( u, statement, signal, pattern ) \
+        if ( u->StartDeathTest() ) { \
+            try { statement; } catch (...) { u->EndDeathTest( true ); } \
+            u->EndDeathTest( false ); \
+        } else { \
+            u->CheckDeathTest( __FILE__, __LINE__, u->Checked, #statement, \
+                u->Signal, signal, pattern ); \
+        }
+#endif
+
+/* The memory budget macro fails if resident memory of the process grew by
+ more than the given number of kilobytes while the UnitTest was current.
+ Growth is counted only where resident memory may be read, which is Linux.
+ Memory use is sampled whenever a UnitTest becomes current, whether or not
+ the Memory option is on, so growth counts from the start of the UnitTest.
+ */
+#ifndef UNIT_TEST_MEMORY_BUDGET
+    #define UNIT_TEST_MEMORY_BUDGET( u, kilobytes ) \
+        try { \
+            u->CheckMemoryBudget( __FILE__, __LINE__, u->Checked, \
+                kilobytes, #kilobytes ); \
+        } catch (...) { \
+            u->OnException( __FILE__, __LINE__, u->Checked, #kilobytes, 0 ); \
+        }
+#endif
+
+/* The latency macros time each call of an operation, record the times in a
+ ut::LatencyHistogram, and check that a percentile of those times is within a
+ bound in seconds.  UNIT_TEST_LATENCY runs the operation and checks one bound.
+ To check several bounds against the same runs, fill a histogram with
+ UNIT_TEST_LATENCY_RUN, and then check each bound with UNIT_TEST_PERCENTILE.
+ For example, these check that p50 is within 2 microseconds, and p99.9 is
+ within 50 microseconds.
+
+    ut::LatencyHistogram histogram;
+    UNIT_TEST_LATENCY_RUN( histogram, 100000, cache.Find( key ) );
+    UNIT_TEST_PERCENTILE( u, histogram, 50.0, 2.0e-6 );
+    UNIT_TEST_PERCENTILE( u, histogram, 99.9, 50.0e-6 );
+ */
+#ifndef UNIT_TEST_LATENCY_RUN
+    #define UNIT_TEST_LATENCY_RUN( histogram, iterations, operation ) \
+        for ( unsigned long utLatencyRun = 0; utLatencyRun < (iterations); \
+            ++utLatencyRun ) { \
+            const double utLatencyStart = ::ut::LatencyHistogram::GetTime(); \
+            operation; \
+            histogram.Record( ::ut::LatencyHistogram::GetTime() \
+                - utLatencyStart ); \
+        }
+#endif
+
+#ifndef UNIT_TEST_PERCENTILE
+    #define UNIT_TEST_PERCENTILE( u, histogram, percentile, seconds ) \
+        try { \
+            u->CheckLatency( __FILE__, __LINE__, u->Checked, histogram, \
+                percentile, seconds, #histogram ); \
+        } catch (...) { \
+            u->OnException( __FILE__, __LINE__, u->Checked, #histogram, 0 ); \
+        }
+#endif
+
+#ifndef UNIT_TEST_LATENCY
+    #define UNIT_TEST_LATENCY( u, operation, iterations, percentile, seconds ) \
+        try { \
+            ::ut::LatencyHistogram utLatencies; \
+            UNIT_TEST_LATENCY_RUN( utLatencies, iterations, operation ); \
+            u->CheckLatency( __FILE__, __LINE__, u->Checked, utLatencies, \
+                percentile, seconds, #operation ); \
+        } catch (...) { \
+            u->OnException( __FILE__, __LINE__, u->Checked, #operation, 0 ); \
+        }
+#endif
+
+/* The property macro checks a predicate against many inputs made by a
+ generator, such as ut::IntegerGenerator or ut::StringGenerator.  Cases are
+ spread across threads, so the predicate must be safe to call from several
+ threads at once, and must not use other test macros.  If any case fails, the
+ failing input is shrunk to a minimal one, and the message shows it with the
+ seed which makes it again.  For example, this checks that reversing a string
+ twice gives the same string for thousands of strings.
+
+    UNIT_TEST_PROPERTY( u, ut::StringGenerator< std::string >( 40 ),
+        IsReversedTwiceSame );
+ */
+#ifndef UNIT_TEST_PROPERTY
+    #define UNIT_TEST_PROPERTY( u, generator, predicate ) \
+        try { \
+            u->CheckProperty( __FILE__, __LINE__, u->Checked, \
+                ::ut::MakeProperty( generator, predicate ), #predicate ); \
+        } catch (...) { \
+            u->OnException( __FILE__, __LINE__, u->Checked, #predicate, 0 ); \
+        }
+#endif
+
+/* The snapshot macros compare bytes made by a test against a golden file
+ kept from an earlier run.  UNIT_TEST_SNAPSHOT takes any object with data and
+ size functions, such as std::string or std::vector< char >.  If they differ,
+ the message tells the first offset which differs, with the bytes around it.
+ Setting the UNIT_TEST_UPDATE_SNAPSHOTS environment variable to anything but
+ 0, or calling UnitTestSet::SetSnapshotUpdate, writes the golden files
+ instead.  For example, this compares serialized output against the golden
+ file named "order.json" within the snapshot directory.
+
+    UNIT_TEST_SNAPSHOT( u, "order.json", Serialize( order ) );
+ */
+#ifndef UNIT_TEST_SNAPSHOT_DATA
+    #define UNIT_TEST_SNAPSHOT_DATA( u, name, data, size ) \
+        try { \
+            u->CheckSnapshot( __FILE__, __LINE__, u->Checked, name, \
+                data, size, #data ); \
+        } catch (...) { \
+            u->OnException( __FILE__, __LINE__, u->Checked, #data, 0 ); \
+        }
+#endif
+
+#ifndef UNIT_TEST_SNAPSHOT
+    #define UNIT_TEST_SNAPSHOT( u, name, bytes ) \
+        try { \
+            u->CheckSnapshot( __FILE__, __LINE__, u->Checked, name, \
+                ( bytes ).data(), ( bytes ).size(), #bytes ); \
+        } catch (...) { \
+            u->OnException( __FILE__, __LINE__, u->Checked, #bytes, 0 ); \
+        }
+#endif
+
+/* UNIT_TEST_CASE defines the body of a UnitTest, and registers it without
+ any code running at startup.  Each registration is a constant record which
+ the compiler places in a linker section, so programs with many thousands of
+ UnitTest's start just as quickly as programs with none.  The UnitTest itself
+ is made only when UnitTestSet::RunStaticUnitTests selects it.  Compilers
+ which can't place records in a section link each one into a list instead,
+ which costs a pointer assignment at startup.  The body receives the UnitTest
+ as its first parameter.  For example, this defines a UnitTest named
+ ThingySizeTest which other code never needs to call.
+
+    UNIT_TEST_CASE( u, ThingySizeTest )
+    {
+        UNIT_TEST( u, Thingy( 3 ).GetSize() == 3 );
+    }
+ */
+#if !defined( UNIT_TEST_CASE_SECTION ) && !defined( UNIT_TEST_CASE_LIST )
+    #if defined( __GNUC__ ) && defined( __ELF__ )
+        #define UNIT_TEST_CASE_SECTION \
+            __attribute__(( used, section( "ut_cases" ), \
+                aligned( sizeof( void * ) ) ))
+    #else
+        #define UNIT_TEST_CASE_LIST
+    #endif
+#endif
+
+#ifndef UNIT_TEST_CASE
+    #ifdef UNIT_TEST_CASE_LIST
+        #define UNIT_TEST_CASE( u, name ) \
+            static void UnitTestCase_##name( ::ut::UnitTest * u ); \
+            static const ::ut::StaticUnitTest UnitTestRecord_##name = \
+                { #name, &UnitTestCase_##name, __FILE__, __LINE__ }; \
+            static const ::ut::StaticUnitTestLink UnitTestLink_##name( \
+                UnitTestRecord_##name ); \
+            static void UnitTestCase_##name( ::ut::UnitTest * u )
+    #else
+        #define UNIT_TEST_CASE( u, name ) \
+            static void UnitTestCase_##name( ::ut::UnitTest * u ); \
+            static const ::ut::StaticUnitTest UnitTestRecord_##name \
+                UNIT_TEST_CASE_SECTION = \
+                { #name, &UnitTestCase_##name, __FILE__, __LINE__ }; \
+            static void UnitTestCase_##name( ::ut::UnitTest * u )
+    #endif
+#endif
+
+#ifndef UNIT_TEST_THREAD_LOCAL
+    #if defined( _MSC_VER )
+        #define UNIT_TEST_THREAD_LOCAL __declspec( thread )
+    #else
+        #define UNIT_TEST_THREAD_LOCAL __thread
+    #endif
+#endif
+
+/** Checks a test item at only some calls, so a host program may keep these
+ within production code as a canary.  On average, one call of every oneIn
+ calls made by each thread checks the item, and the others skip the item with
+ just one test and decrement of a thread-local countdown for this call site.
+ Neither test nor oneIn is evaluated when the item is skipped.  The gaps
+ between checks are random, so items within loops do not fall into step with
+ the loops.  The first call within each thread always checks the item.
+ Checked items go through UnitTest::DoSampledTest, which records them like
+ any other, so receivers see them.  Host threads may check items at once, so
+ each checked item takes a lock, but skipped calls never do.  Since oneIn may
+ be any expression, host programs may change how often a call site is checked
+ while running.
+ @par Example
+    UNIT_TEST_SAMPLED( u, cache.GetSize() <= cache.GetCapacity(), 1000 );
+ */
+#ifndef UNIT_TEST_SAMPLED
+    #define UNIT_TEST_SAMPLED( u, test, oneIn ) \
+        { \
+            static UNIT_TEST_THREAD_LOCAL unsigned int utSampleCountdown = 0; \
+            if ( 0 != utSampleCountdown ) \
+                --utSampleCountdown; \
+            else \
+            { \
+                utSampleCountdown = ::ut::UnitTest::GetSampleGap( oneIn ); \
+                bool utSamplePassed = false; \
+                bool utSampleThrew = false; \
+                try { \
+                    utSamplePassed = ( test ) ? true : false; \
+                } catch (...) { \
+                    utSampleThrew = true; \
+                } \
+                u->DoSampledTest( __FILE__, __LINE__, utSamplePassed, \
+                    utSampleThrew, #test ); \
+            } \
+        }
+#endif
+
 #ifndef UNIT_TEST_JUST_MSG
     #define UNIT_TEST_JUST_MSG( unit, msg ) \
         u->OutputMessage( __FILE__, __LINE__, msg );
@@ -88,6 +332,20 @@ namespace ut
 
 class UnitTestSet;
 class UnitTestSetImpl;
+class LatencyHistogram;
+class PropertyRunner;
+
+/** Type which counts items.  It has 64 bits, so runs lasting days with
+ billions of items do not overflow.  C++03 has no 64-bit type, so this uses
+ unsigned long where that has 64 bits, and the compiler's own type elsewhere.
+ */
+#if defined( _MSC_VER )
+    typedef unsigned __int64 ItemCount;
+#elif defined( __LP64__ ) || defined( _LP64 )
+    typedef unsigned long ItemCount;
+#else
+    typedef unsigned long long ItemCount;
+#endif
 
 /** @class UnitTest
  @brief Maintains counts of test results for a specific unit test.
@@ -104,23 +362,80 @@ public:
      If a Warning level test fails, a message is placed into output only if
      that option is turned on via UnitTestSet::OutputOptions::Warnings.  If a
      required test fails, the program generates a special message, exits
-     immediately, and completes output for UnitTestSet.
+     immediately, and completes output for UnitTestSet.  If the FatalEndsTest
+     option is on, and the UnitTest is running inside UnitTestSet::RunUnitTest,
+     then only that UnitTest ends, and the program continues.
      */
     enum TestLevel
     {
         Warning = 0, ///< Does not cause entire UnitTest to fail.
         Checked = 1, ///< Causes UnitTest to fail, and further tests are done.
-        Require = 2  ///< Causes UnitTest to fail, but no more tests are done.
+        Require = 2  ///< Causes UnitTest to fail, and no more tests are done.
+    };
+
+    /// How a death test expects its child process to end.
+    enum DeathKind
+    {
+        AnyDeath = 0, ///< Ends by any signal, or by exit with nonzero code.
+        ExitCode = 1, ///< Ends by calling exit with a particular code.
+        Signal   = 2  ///< Ends by a particular signal.
     };
 
     inline const char * GetName( void ) const { return m_name; }
     inline unsigned int GetIndex( void ) const { return m_index; }
 
-    inline unsigned int GetItemCount( void ) const { return m_itemCount; }
-    inline unsigned int GetFailCount( void ) const { return m_failCount; }
-    inline unsigned int GetPassCount( void ) const { return m_passCount; }
-    inline unsigned int GetWarnCount( void ) const { return m_warnCount; }
-    inline unsigned int GetExceptionCount( void ) const { return m_exceptions; }
+    inline ItemCount GetItemCount( void ) const { return m_itemCount; }
+    inline ItemCount GetFailCount( void ) const { return m_failCount; }
+    inline ItemCount GetPassCount( void ) const { return m_passCount; }
+    inline ItemCount GetWarnCount( void ) const { return m_warnCount; }
+    inline ItemCount GetExceptionCount( void ) const { return m_exceptions; }
+    inline ItemCount GetSkipCount( void ) const { return m_skipCount; }
+
+    /// Most performance counters kept for each UnitTest.
+    enum { CounterCount = 4 };
+
+    /** Returns count of one performance counter while this UnitTest was
+     current, or zero if the counter is not in use.  Events of threads which
+     the library starts for stress tests, properties, and case files are
+     added in once each thread is done.  See UnitTestSet::GetCounterName for
+     what each counter counts.
+     */
+    inline double GetCounter( unsigned int which ) const
+    { return ( which < CounterCount ) ? m_counters[ which ] : 0.0; }
+
+    /** Returns kilobytes by which resident memory of the process grew while
+     this UnitTest was current.  This is negative if memory shrank, and stays
+     zero where resident memory may not be read.
+     */
+    inline long GetRssGrowth( void ) const { return m_rssGrowth; }
+
+    /** Returns most kilobytes of resident memory seen while this UnitTest was
+     current.  Memory is sampled when UnitTest's become current or stop being
+     current, and a new peak for the process is credited to the UnitTest
+     which was current when it happened.
+     */
+    inline unsigned long GetPeakRss( void ) const { return m_peakRss; }
+
+    /// Returns # of page faults which read from disk while this was current.
+    inline unsigned long GetMajorFaults( void ) const { return m_majorFaults; }
+
+    /// Returns # of page faults which did not read from disk.
+    inline unsigned long GetMinorFaults( void ) const { return m_minorFaults; }
+
+    /// Returns true if this UnitTest skipped any items.
+    inline bool WasSkipped( void ) const { return ( 0 < m_skipCount ); }
+
+    /** Returns approximate seconds spent in this UnitTest.  Time is counted
+     from when this UnitTest records an item until a different UnitTest
+     records one, or until the summary table is made.
+     */
+    inline double GetElapsedTime( void ) const { return m_elapsedTime; }
+
+    /** Returns seconds which passed on the virtual clock while this UnitTest
+     was current, or while its async body waited.  This stays zero unless the
+     virtual clock is used.  See UnitTestSet::SetVirtualClock.
+     */
+    inline double GetVirtualTime( void ) const { return m_virtualTime; }
 
     inline bool DidPass( void ) const
     { return ( 0 == m_failCount ) && ( 0 == m_exceptions ); }
@@ -154,6 +469,131 @@ public:
     void OnException( const char * file, unsigned int line, TestLevel level,
         const char * expression, const char * message );
 
+    /** Records that the rest of this UnitTest was skipped, usually since a
+     prerequisite UnitTest did not pass.  Skipped items are counted separately,
+     and do not cause a UnitTest to fail.
+     @param file Name of source code file.
+     @param line Source code line.
+     @param expression Reason for skipping, such as name of prerequisite.
+     @param message Optional message placed into output.
+     */
+    void Skip( const char * file, unsigned int line, const char * expression,
+        const char * message );
+
+    /** Returns how many calls of a sampled test item to skip before checking
+     it again.  UNIT_TEST_SAMPLED calls this.  Gaps are random, and spread
+     evenly around oneIn - 1, so on average one call in oneIn is checked.
+     @param oneIn Average # of calls for each check.  One or zero means
+      every call is checked.
+     */
+    static unsigned int GetSampleGap( unsigned int oneIn );
+
+    /** Records a test item checked by UNIT_TEST_SAMPLED.  Sampled items may
+     come from any thread of the host program, so this serializes with other
+     threads even when no stress test or case file runs.
+     @param file Name of source code file.
+     @param line Source code line.
+     @param pass True if test item passed.
+     @param threw True if checking the item threw an exception.
+     @param expression Text of test item.
+     @return True if test item passed.
+     */
+    bool DoSampledTest( const char * file, unsigned int line, bool pass,
+        bool threw, const char * expression );
+
+    /** Starts a death test by making a child process.  The death test macros
+     call this, and run the statement only within the child.  Within the child,
+     test items and messages go nowhere, and nothing happens at exit time.
+     @return True within the child process.  False within this process, or if
+     the child could not be made.
+     */
+    bool StartDeathTest( void );
+
+    /** Ends the child process of a death test after its statement returned or
+     threw instead of ending the process.  This never returns.
+     @param threw True if the statement threw an exception.
+     */
+    void EndDeathTest( bool threw );
+
+    /** Waits for the child process made by StartDeathTest, and then records an
+     item which passes if the child ended as expected, and if its standard
+     error matched the pattern.  If no child could be made, this records a
+     skipped item instead.
+     @param file Name of source code file.
+     @param line Source code line.
+     @param level Severity level of test item.
+     @param expression Statement run by child process.
+     @param kind How the child should end.
+     @param expected Exit code or signal number, unused for AnyDeath.
+     @param pattern Extended regular expression for standard error of child,
+      or NULL or empty string to accept any output.
+     @return True if test item passed.
+     */
+    bool CheckDeathTest( const char * file, unsigned int line,
+        TestLevel level, const char * expression, DeathKind kind, int expected,
+        const char * pattern );
+
+    /** Records an item which passes if resident memory did not grow by more
+     than the budget while this UnitTest was current.  Growth counts only time
+     this was current, so other UnitTest's between its items do not matter.
+     @param file Name of source code file.
+     @param line Source code line.
+     @param level Severity level of test item.
+     @param kilobytes Most growth allowed.
+     @param expression Text of budget expression.
+     @return True if test item passed.
+     */
+    bool CheckMemoryBudget( const char * file, unsigned int line,
+        TestLevel level, unsigned long kilobytes, const char * expression );
+
+    /** Records an item which passes if a percentile of the latencies in the
+     histogram is within the bound.  If the item fails, its message has the
+     percentiles and buckets of the histogram.  A histogram with no latencies
+     always fails.
+     @param file Name of source code file.
+     @param line Source code line.
+     @param level Severity level of test item.
+     @param histogram Latencies recorded by UNIT_TEST_LATENCY_RUN.
+     @param percentile Percent of latencies, such as 99.9, from 0 to 100.
+     @param seconds Most seconds allowed for that percentile.
+     @param expression Text of operation or histogram.
+     @return True if test item passed.
+     */
+    bool CheckLatency( const char * file, unsigned int line, TestLevel level,
+        const LatencyHistogram & histogram, double percentile, double seconds,
+        const char * expression );
+
+    /** Records an item which passes if a property holds for every generated
+     case.  See UNIT_TEST_PROPERTY and UnitTestSet::SetPropertyOptions.  If
+     the item fails, its message has the shrunk counterexample, the seed,
+     and which case failed first.
+     @param file Name of source code file.
+     @param line Source code line.
+     @param level Severity level of test item.
+     @param property Generator and predicate made by MakeProperty.
+     @param expression Text of predicate.
+     @return True if test item passed.
+     */
+    bool CheckProperty( const char * file, unsigned int line, TestLevel level,
+        const PropertyRunner & property, const char * expression );
+
+    /** Records an item which passes if bytes match the golden file of the
+     given name within the snapshot directory.  In update mode, the golden
+     file is written if missing or different, and the item passes.  See
+     UNIT_TEST_SNAPSHOT and UnitTestSet::SetSnapshotDirectory.
+     @param file Name of source code file.
+     @param line Source code line.
+     @param level Severity level of test item.
+     @param name Name of golden file within snapshot directory.
+     @param data Bytes made by test.
+     @param size # of bytes.
+     @param expression Text of bytes expression.
+     @return True if test item passed.
+     */
+    bool CheckSnapshot( const char * file, unsigned int line, TestLevel level,
+        const char * name, const void * data, size_t size,
+        const char * expression );
+
     /** Places message directly into test result output if UnitTestSet::Create
      function was called with UnitTestSet::OutputOptions::Messages option.
      @param file Name of source code file.
@@ -168,11 +608,6 @@ public:
 
 private:
 
-    enum Constants
-    {
-        MaxNameSize = 23
-    };
-
     friend class UnitTestSet;
     friend class UnitTestSetImpl;
 
@@ -185,7 +620,8 @@ private:
 
     /** Constructs a UnitTest object with given name.  This constructor should
       not throw any exceptions.
-      @param unitTestName Name of test may not be NULL or empty string.
+      @param unitTestName Name of test may not be NULL or empty string.  The
+       UnitTest does not copy the name, so the caller must keep it alive.
       */
     explicit UnitTest( const char * unitTestName );
 
@@ -196,13 +632,21 @@ private:
     ~UnitTest( void );
 
     bool m_madeHeader;            ///< True if unit-test header was outputted.
-    char m_name[ MaxNameSize+1 ]; ///< Unique name of unit test.
+    const char * m_name;          ///< Unique name of unit test.
     unsigned int m_index;         ///< Index # of test within UnitTestSet.
-    unsigned int m_itemCount;     ///< Total # of items tested.
-    unsigned int m_failCount;     ///< # of failed items.
-    unsigned int m_warnCount;     ///< # of failed warning items.
-    unsigned int m_passCount;     ///< # of passed items.
-    unsigned int m_exceptions;    ///< # of items that threw exceptions.
+    ItemCount m_itemCount;        ///< Total # of items tested.
+    ItemCount m_failCount;        ///< # of failed items.
+    ItemCount m_warnCount;        ///< # of failed warning items.
+    ItemCount m_passCount;        ///< # of passed items.
+    ItemCount m_exceptions;       ///< # of items that threw exceptions.
+    ItemCount m_skipCount;        ///< # of items skipped.
+    double m_elapsedTime;         ///< Seconds spent in this UnitTest.
+    double m_virtualTime;         ///< Virtual seconds spent in this UnitTest.
+    double m_counters[ CounterCount ]; ///< Performance counts for UnitTest.
+    long m_rssGrowth;             ///< Kilobytes resident memory grew.
+    unsigned long m_peakRss;      ///< Most kilobytes of resident memory.
+    unsigned long m_majorFaults;  ///< # of page faults which read disk.
+    unsigned long m_minorFaults;  ///< # of page faults which did not.
 };
 
 // ----------------------------------------------------------------------------
@@ -220,7 +664,8 @@ public:
         Warning = 0x02, ///< Warning failed.
         Failed  = 0x04, ///< A normal test failed.
         Fatal   = 0x08, ///< A required test failed, program must end.
-        Thrown  = 0x10  ///< The test threw an exception.
+        Thrown  = 0x10, ///< The test threw an exception.
+        Skipped = 0x20  ///< A prerequisite did not pass, so test was skipped.
     };
 
     /// Returns a simple string name of the test result.
@@ -261,8 +706,11 @@ public:
   -# ShowTableLine is called once per UnitTest so the observer can prepare one
     line per UnitTest in the summary table.  If no UnitTests exist, then this
     never gets called.
-  -# ShowTotalLine is called to provide totals for items in all UnitTest's.
-  -# ShowSummaryLine is called to provide counts for the number of UnitTest's.
+  -# ShowLongTotalLine is called to provide totals for items in all
+    UnitTest's.  Unless overridden, it calls ShowTotalLineWithSkips, which
+    calls ShowTotalLine.
+  -# ShowSummaryLineWithSkips is called to provide counts for the number of
+    UnitTest's.  Unless overridden, it calls ShowSummaryLine.
   -# EndSummaryTable is called after UnitTestSet has completed the summary
     table so the observers can clean up any resources.
   -# FinalEnd is called from the UnitTestSet's destructor to inform any
@@ -359,6 +807,38 @@ public:
         unsigned int warnCount, unsigned int failCount,
         unsigned int exceptCount, unsigned int itemCount );
 
+    /** Shows item counts in line in summary table, including skipped items.
+     Unless overridden, this calls ShowTotalLine without the skipped items, so
+     observers written before items could be skipped still get called.
+     @param passCount Total # of items that passed in all UnitTest's.
+     @param warnCount Total # of items that made warnings in all UnitTest's.
+     @param failCount Total # of items that failed in all UnitTest's.
+     @param exceptCount Total # of items throwing exceptions in all UnitTest's.
+     @param skipCount Total # of items skipped in all UnitTest's.
+     @param itemCount Total # of all items in all UnitTest's.
+     @return True if the observer wants to receive more event notices.
+     */
+    virtual bool ShowTotalLineWithSkips( unsigned int passCount,
+        unsigned int warnCount, unsigned int failCount,
+        unsigned int exceptCount, unsigned int skipCount,
+        unsigned int itemCount );
+
+    /** Shows item counts in line in summary table, with counts of 64 bits so
+     runs with billions of items show them exactly.  Unless overridden, this
+     calls ShowTotalLineWithSkips with each count limited to the largest
+     unsigned int.
+     @param passCount Total # of items that passed in all UnitTest's.
+     @param warnCount Total # of items that made warnings in all UnitTest's.
+     @param failCount Total # of items that failed in all UnitTest's.
+     @param exceptCount Total # of items throwing exceptions in all UnitTest's.
+     @param skipCount Total # of items skipped in all UnitTest's.
+     @param itemCount Total # of all items in all UnitTest's.
+     @return True if the observer wants to receive more event notices.
+     */
+    virtual bool ShowLongTotalLine( ItemCount passCount, ItemCount warnCount,
+        ItemCount failCount, ItemCount exceptCount, ItemCount skipCount,
+        ItemCount itemCount );
+
     /** Shows item counts in line in summary table.
      @param passCount Total # of UnitTest's that passed.
      @param warnCount Total # of UnitTest's with warnings.
@@ -372,6 +852,52 @@ public:
         unsigned int warnCount, unsigned int failCount,
         unsigned int exceptCount, unsigned int testCount );
 
+    /** Shows UnitTest counts in line in summary table, including skipped
+     UnitTest's.  Unless overridden, this calls ShowSummaryLine without the
+     skipped UnitTest's.
+     @param passCount Total # of UnitTest's that passed.
+     @param warnCount Total # of UnitTest's with warnings.
+     @param failCount Total # of UnitTest's that failed.
+     @param exceptCount Total # of UnitTest's which tossed exceptions.
+     @param skipCount Total # of UnitTest's which were skipped and did not
+      fail.
+     @param testCount Total # of UnitTest's, should be same as number of calls
+      to UnitTestSet::AddUnitTest.
+     @return True if the observer wants to receive more event notices.
+     */
+    virtual bool ShowSummaryLineWithSkips( unsigned int passCount,
+        unsigned int warnCount, unsigned int failCount,
+        unsigned int exceptCount, unsigned int skipCount,
+        unsigned int testCount );
+
+    /** Shows what a fixture cost within the summary table.  This is called
+     after the summary line, once for each fixture built since the last
+     summary table.
+     @param fixtureName Name of fixture.  See UnitTestSet::AddFixture.
+     @param isWorker True if each worker thread has its own fixture, or false
+      if all UnitTest's share one.
+     @param setUpCount # of times fixture was built.
+     @param setUpSeconds Total seconds spent building fixture.
+     @param tearDownSeconds Total seconds spent tearing down fixture.
+     @return True if the observer wants to receive more event notices.
+     */
+    virtual bool ShowFixtureLine( const char * fixtureName, bool isWorker,
+        unsigned int setUpCount, double setUpSeconds,
+        double tearDownSeconds );
+
+    /** Shows what checking invariants cost within the summary table.  This is
+     called after the fixture lines, and only within DEBUG builds, since other
+     builds do not check invariants.  See UnitTestSet::SetInvariantPolicy.
+     @param checks # of calls of CheckInvariants which did checks since the
+      last summary table.
+     @param seconds Total seconds spent doing checks.
+     @param period One call of this many did checks, or zero if checks were
+      done only at summary time.
+     @return True if the observer wants to receive more event notices.
+     */
+    virtual bool ShowInvariantLine( ItemCount checks, double seconds,
+        unsigned int period );
+
     /** Called after the UnitTestSet has calculated all the summary data,
      and so observer can know no more calls will be made and it can do any
      cleanup necessary.
@@ -406,98 +932,1217 @@ private:
 
 // ----------------------------------------------------------------------------
 
-/** @class UnitTestSet
- @brief Maintains collection of unit tests, and sends test results to output
-  observers.
+/** Type of function which contains the body of a unit test.  The function
+ receives the UnitTest which records its results.  See UnitTestSet::RunUnitTest.
+ */
+typedef void ( * UnitTestFunction )( UnitTest * test );
 
- @par Interaction With Host Program
- This singleton should be created soon after the host program begins execution.
- The host program does not need to call anything to destroy the singleton since
- it will destroy itself at exit time.  The singleton also sends test results to
- various forms of output (e.g. - text file, HTML files, and standard output) so
- the host program will not need to handle that separately.  The minimum a host
- program needs to do is call UnitTestSet::Create, call UnitTestSet::AddUnitTest
- occasionally and then exercise the UnitTest's.
+// ----------------------------------------------------------------------------
 
- All implementation details are hidden from the host program using the Cheshire
- Cat technique (a.k.a. Pimpl Idiom).
+/** @struct StaticUnitTest
+ @brief Registration record made by UNIT_TEST_CASE.  This is a plain aggregate
+  so the compiler fills it in at build time, without running any code.
+ */
+struct StaticUnitTest
+{
+    const char * m_name;      ///< Name of UnitTest.
+    UnitTestFunction m_body;  ///< Function with body of UnitTest.
+    const char * m_file;      ///< Source file where UnitTest is defined.
+    unsigned int m_line;      ///< Line where UnitTest is defined.
+};
 
- @par Exit Time
- The singleton typically registers its Destroy function with ::atexit so it can
- output a summary table and perform final cleanup at exit time.  By then, most
- programs complete their unit tests.  You can make a summary table before exit
- time by calling UnitTestSet::OutputSummary directly.  You can perform unit
- tests at exit time without worrying about whether the singleton remains alive
- by passing in false for deleteAtExitTime in the UnitTestSet::Create function.
- Once the host has completed all unit tests, call UnitTestSet::OutputSummary.
- If a required unit test fails, the unit-tester will create the summary table
- and end the program.
+// ----------------------------------------------------------------------------
 
- @par Container of UnitTest's
- The singleton owns each UnitTest, and only it may create or destroy a UnitTest
- instance.  Each UnitTest has a unique name, and is identified by that name.
+/** @class StaticUnitTestLink
+ @brief Links a StaticUnitTest into a list for compilers where UNIT_TEST_CASE
+  can't place records within a linker section.
+ */
+class StaticUnitTestLink
+{
+public:
 
- @par Test Result Observers
- UnitTestSet maintains a container of pointers to test result observers.  At
- appropriate moments, it iterates through the container to call each observer.
- If an observer returns the function call with false, it will not be called by
- UnitTestSet again.  The host program may call AddReceiver and RemoveReceiver
- to specify if it will receive event notices.  UnitTestSet also maintains two
- internal observers, one which sends output to an HTML file, and another which
- sends output to both standard out and a text file.  UnitTestSet will never
- attempt to delete an external observer - even when UnitTestSet's destructor is
- called.
+    /// Adds the record to the front of the list.
+    explicit StaticUnitTestLink( const StaticUnitTest & record );
 
- @par Text Output
- This produces identical content for the text result file, the standard-output
- stream, and the standard-error stream.  The host program may choose to send
- output to any combination of those three (file, cout, cerr).  The cout option
- allows a person to exercise unit tests on the command line and see the results
- directly.  The cerr option exists in case programs want to reserve cout for
- other purposes.  The text file option exists in case programs use both cout
- and cerr.
+    /// Returns first link in list, or NULL if the list is empty.
+    inline static const StaticUnitTestLink * GetFirst( void )
+    {
+        return s_first;
+    }
 
- @par Output File Names
- The strings passed into the Create function should not contain complete file
- names.  The strings should contain just partial file names - a prefix onto
- which the rest of the name shall be added.  The strings may contain relative
- or absolute paths.  This singleton will embed a timestamp into the file name
- and add the appropriate extension.  That timestamp represents when the unit
- tests were executed.  For example, if the string contains "./MyCo_UnitTests"
- and if the unit tests began on 2007-March-14 at 1:59:26 AM, then the text file
- name is "./MyCo_UnitTests_2007_03_14_01_59_26.txt".
+    /// Returns next link in list, or NULL if this is the last.
+    inline const StaticUnitTestLink * GetNext( void ) const { return m_next; }
 
- @par HTML File Names
- The UnitTestSet produces two html files - a main page which contains a table
- of showing multiple unit test iterations, and a current page showing details
- of the current iteration.  The HTML file name parameter specifies a location
- and partial name for both the main and current html pages.  Each execution of
- unit tests produces a new HTML file for the current test results.  Each test
- result page has a link back to the main page, and contain detailed stats for
- all unit tests executed.  The main page has a table showing the history of
- prior tests so readers can quickly see long-term patterns of test results.
- Each row in that table has a link to the corresponding html file.
+    /// Returns registration record of this link.
+    inline const StaticUnitTest & GetRecord( void ) const { return m_record; }
 
- @par Legal examples of partial file names for text or HTML files are:
- - "./MyCo_UnitTests"
- - "c:/test/results/current"
- - "//mars/olympus/zp/rev_5_2"
- - "../../elysium/mainline"
- */
-class UnitTestSet
-{
-public:
+private:
 
-    /// Type of error that occurred when calling Create function.
-    enum ErrorState
-    {
-        Success = 0,   ///< No error occurred.
-        AlreadyExists, ///< Singleton already created.
-        CantCreate     ///< Could not create singleton.
-    };
+    /// Default constructor is not implemented.
+    StaticUnitTestLink( void );
+    /// Copy constructor is not implemented.
+    StaticUnitTestLink( const StaticUnitTestLink & );
+    /// Copy-assignment operator is not implemented.
+    StaticUnitTestLink & operator = ( const StaticUnitTestLink & );
 
-    /** This enum family defines output options which programs can use to
-     specify what gets added to the test result output.  A bitfield can contain
+    /// First link in list.  Zero before any constructor runs.
+    static const StaticUnitTestLink * s_first;
+
+    const StaticUnitTest & m_record;     ///< Registration record.
+    const StaticUnitTestLink * m_next;   ///< Next link in list.
+};
+
+// ----------------------------------------------------------------------------
+
+/** Type of function which builds a fixture, such as a loaded dictionary,
+ which many UnitTest's share.  See UnitTestSet::AddFixture.
+ @param state Pointer given to UnitTestSet::AddFixture.
+ @return Pointer to fixture, or NULL if it could not be built.  May throw.
+ */
+typedef void * ( * FixtureSetUpFunction )( void * state );
+
+/** Type of function which tears down a fixture made by a set-up function.
+ @param fixture Pointer returned by set-up function.
+ @param state Pointer given to UnitTestSet::AddFixture.
+ */
+typedef void ( * FixtureTearDownFunction )( void * fixture, void * state );
+
+// ----------------------------------------------------------------------------
+
+/** @class AsyncWait
+ @brief Tells the event loop within UnitTestSet::RunAsyncUnitTests what an
+  async unit test body waits for before the loop calls it again.
+
+ @par Purpose
+  An async body does one step each time it is called, and then returns what
+  it waits for instead of blocking.  The event loop waits for all bodies at
+  once, so unit tests which mostly wait on sockets, pipes, or timers finish in
+  about the time of the slowest one instead of the sum of all of them.
+ */
+class AsyncWait
+{
+public:
+
+    /// What the body waits for.
+    enum Kind
+    {
+        Finished = 0, ///< Body is done, and will not be called again.
+        Ready    = 1, ///< Body should be called again soon.
+        Timer    = 2, ///< Body waits for some milliseconds.
+        Readable = 3, ///< Body waits until it can read a descriptor.
+        Writable = 4  ///< Body waits until it can write to a descriptor.
+    };
+
+    /// Body is done.
+    static inline AsyncWait Done( void )
+    { return AsyncWait( Finished, -1, 0 ); }
+
+    /// Body should be called again after other bodies get a turn.
+    static inline AsyncWait Again( void )
+    { return AsyncWait( Ready, -1, 0 ); }
+
+    /// Body should be called again after some milliseconds.
+    static inline AsyncWait After( unsigned int milliseconds )
+    { return AsyncWait( Timer, -1, milliseconds ); }
+
+    /** Body should be called again once the descriptor is readable, or once
+     timeout milliseconds passed.  Zero means no timeout.
+     */
+    static inline AsyncWait ForRead( int descriptor, unsigned int timeout )
+    { return AsyncWait( Readable, descriptor, timeout ); }
+
+    /** Body should be called again once the descriptor is writable, or once
+     timeout milliseconds passed.  Zero means no timeout.
+     */
+    static inline AsyncWait ForWrite( int descriptor, unsigned int timeout )
+    { return AsyncWait( Writable, descriptor, timeout ); }
+
+    inline Kind GetKind( void ) const { return m_kind; }
+    inline int GetDescriptor( void ) const { return m_descriptor; }
+    inline unsigned int GetMilliseconds( void ) const { return m_milliseconds; }
+
+private:
+
+    inline AsyncWait( Kind kind, int descriptor, unsigned int milliseconds ) :
+        m_kind( kind ), m_descriptor( descriptor ),
+        m_milliseconds( milliseconds ) {}
+
+    Kind m_kind;                  ///< What the body waits for.
+    int m_descriptor;             ///< Descriptor for Readable or Writable.
+    unsigned int m_milliseconds;  ///< Time to wait, or timeout.
+};
+
+/** Type of function which does one step of an async unit test.  See
+ UnitTestSet::RunAsyncUnitTests.
+ @param test UnitTest which records the results of this body.
+ @param state Pointer given to UnitTestSet::RegisterAsyncUnitTest, so the body
+  knows where it left off.
+ @param timedOut True if the body waited for a descriptor, and the timeout
+  passed first.
+ @return What body waits for before its next step.
+ */
+typedef AsyncWait ( * AsyncUnitTestFunction )( UnitTest * test, void * state,
+    bool timedOut );
+
+// ----------------------------------------------------------------------------
+
+/** @class StressThread
+ @brief Tells a stress test body which thread calls it, and gives the body
+  random numbers which repeat for the same seed.  See
+  UnitTestSet::RunStressTest.
+ */
+class StressThread
+{
+public:
+
+    /// Returns which thread this is, from zero up to one less than the count.
+    inline unsigned int GetIndex( void ) const { return m_index; }
+
+    /// Returns # of times this thread called the body so far.
+    inline unsigned long GetCallCount( void ) const { return m_calls; }
+
+    /// Returns next pseudo-random number from this thread's sequence.
+    unsigned int GetRandom( void );
+
+    /** Gives up the processor now and then, as often as the yield percent of
+     UnitTestSet::SetStressInjection says.  Calling this between steps of an
+     operation makes races between threads more likely to show.
+     */
+    void MaybeYield( void );
+
+private:
+
+    friend class UnitTestSetImpl;
+
+    StressThread( unsigned int index, unsigned int seed,
+        unsigned int yieldPercent );
+
+    unsigned int m_index;         ///< Which thread this is.
+    unsigned long m_calls;        ///< # of calls to body.
+    unsigned int m_random;        ///< State of xorshift random numbers.
+    unsigned int m_yieldPercent;  ///< Chance that MaybeYield yields.
+};
+
+/** Type of function called over and over by each thread of a stress test.
+ See UnitTestSet::RunStressTest.
+ @param test UnitTest which records the results of every thread.
+ @param state Pointer given to UnitTestSet::RunStressTest.
+ @param thread Which thread calls the body, and its random numbers.
+ */
+typedef void ( * StressUnitTestFunction )( UnitTest * test, void * state,
+    StressThread & thread );
+
+// ----------------------------------------------------------------------------
+
+/** @class CaseRow
+ @brief One row of a case file, split into fields where it sits within the
+  memory-mapped file, so nothing is copied or allocated.  Fields are not nul
+  terminated.  Fields are split at every separator, so quotes are not
+  special, and a field may not contain the separator.  See
+  UnitTestSet::RunCaseFile.
+ */
+class CaseRow
+{
+public:
+
+    enum { MaxFields = 64 };      ///< Later separators stay in the last field.
+
+    CaseRow( void );
+    inline ~CaseRow( void ) {}
+
+    /** Splits text of a row into fields.  Called by RunCaseFile, and by
+     host programs which test their own rows.
+     */
+    void Split( const char * text, unsigned int length, char separator );
+
+    /// Returns text of whole row, without line ending.  Not nul terminated.
+    inline const char * GetText( void ) const { return m_text; }
+    inline unsigned int GetLength( void ) const { return m_length; }
+    inline unsigned int GetFieldCount( void ) const { return m_fieldCount; }
+
+    /** Returns start of a field, and gets its length.
+     @return NULL if which is not less than the # of fields.
+     */
+    const char * GetField( unsigned int which, unsigned int & length ) const;
+
+    /// True if field holds exactly the given text.
+    bool IsField( unsigned int which, const char * text ) const;
+
+    /** Reads field as a whole number in base 10.
+     @return False if field is missing, empty, or not all digits.
+     */
+    bool GetLong( unsigned int which, long & value ) const;
+
+    /** Reads field as a real number.
+     @return False if field is missing, empty, or not all one number.
+     */
+    bool GetDouble( unsigned int which, double & value ) const;
+
+private:
+
+    const char * m_text;          ///< Start of row within file.
+    unsigned int m_length;        ///< # of characters in row.
+    unsigned int m_fieldCount;    ///< # of fields in row.
+    unsigned int m_ends[ MaxFields ]; ///< Place where each field ends.
+};
+
+/** Type of function called for each row of a case file.  See
+ UnitTestSet::RunCaseFile.
+ @param test UnitTest which records the results of every row.
+ @param state Pointer given to UnitTestSet::RunCaseFile.
+ @param row Fields of the row.
+ */
+typedef void ( * CaseFileFunction )( UnitTest * test, void * state,
+    const CaseRow & row );
+
+// ----------------------------------------------------------------------------
+
+/** @class Clock
+ @brief Interface through which test bodies and code under test read the time
+  and wait.  Code which takes a Clock can be tested with a VirtualClock, so
+  retries, backoffs, and timeouts run at CPU speed instead of real time.
+ */
+class Clock
+{
+public:
+
+    /// Returns time in seconds.  Only differences between two calls matter.
+    virtual double GetSeconds( void ) const = 0;
+
+    /// Waits until some seconds pass on this clock.
+    virtual void Sleep( double seconds ) = 0;
+
+    inline virtual ~Clock( void ) {}
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class SystemClock
+ @brief Clock which reads the real wall-clock time, and really waits.
+ */
+class SystemClock : public Clock
+{
+public:
+
+    inline SystemClock( void ) : Clock() {}
+    inline virtual ~SystemClock( void ) {}
+
+    virtual double GetSeconds( void ) const;
+    virtual void Sleep( double seconds );
+
+private:
+    /// Copy-constructor is not implemented.
+    SystemClock( const SystemClock & );
+    /// Copy-assignment operator is not implemented.
+    SystemClock & operator = ( const SystemClock & );
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class VirtualClock
+ @brief Clock whose time starts at zero and moves only when told to.  Sleep
+  returns at once after moving the time forward.
+ */
+class VirtualClock : public Clock
+{
+public:
+
+    inline VirtualClock( void ) : Clock(), m_seconds( 0.0 ) {}
+    inline virtual ~VirtualClock( void ) {}
+
+    virtual double GetSeconds( void ) const;
+    virtual void Sleep( double seconds );
+
+    /// Moves time forward.  Negative amounts are ignored.
+    void Advance( double seconds );
+
+private:
+    /// Copy-constructor is not implemented.
+    VirtualClock( const VirtualClock & );
+    /// Copy-assignment operator is not implemented.
+    VirtualClock & operator = ( const VirtualClock & );
+
+    double m_seconds;             ///< Current virtual time.
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class SampleComparison
+ @brief Compares benchmark samples from a baseline with samples from a
+  candidate without assuming they follow any distribution.  Samples are costs,
+  such as seconds per operation, so larger values are worse.
+
+ @par Statistics
+  The Mann-Whitney U test gives the chance that the two sets of samples differ
+  this much by luck alone.  The U distribution is counted exactly when neither
+  set has more than 20 samples and no samples tie.  Otherwise this uses the
+  normal approximation with a correction for ties.  The shift is the
+  Hodges-Lehmann estimate, which is the median of every difference between a
+  candidate sample and a baseline sample.  The bounds of the confidence
+  interval for the shift are picked from those differences using the same U
+  distribution.
+ */
+class SampleComparison
+{
+public:
+
+    /// What the comparison found.
+    enum Verdict
+    {
+        TooFewSamples = 0, ///< Either set had fewer than 2 samples.
+        Unchanged     = 1, ///< Difference is not significant.
+        Improved      = 2, ///< Candidate costs significantly less.
+        Regressed     = 3  ///< Candidate costs significantly more.
+    };
+
+    /** Compares two sets of samples.  Neither array needs to be sorted.
+     @param baseline Samples from baseline.
+     @param baselineCount # of baseline samples.
+     @param candidate Samples from candidate.
+     @param candidateCount # of candidate samples.
+     @param confidence Confidence level, such as 0.95.  The difference is
+      significant if the chance of it happening by luck is less than one minus
+      this.
+     */
+    SampleComparison( const double * baseline, unsigned int baselineCount,
+        const double * candidate, unsigned int candidateCount,
+        double confidence );
+
+    inline ~SampleComparison( void ) {}
+
+    inline Verdict GetVerdict( void ) const { return m_verdict; }
+    inline double GetBaselineMedian( void ) const { return m_baselineMedian; }
+    inline double GetCandidateMedian( void ) const { return m_candidateMedian; }
+
+    /// Returns estimated amount candidate costs more than baseline.
+    inline double GetShift( void ) const { return m_shift; }
+
+    /** Returns lower bound of confidence interval for the shift.  If there are
+     too few samples to reach the confidence level, the interval spans every
+     difference between samples.
+     */
+    inline double GetLowerBound( void ) const { return m_lowerBound; }
+
+    /// Returns upper bound of confidence interval for the shift.
+    inline double GetUpperBound( void ) const { return m_upperBound; }
+
+    /// Returns two-sided chance of a difference this large by luck alone.
+    inline double GetProbability( void ) const { return m_probability; }
+
+    /// Returns Mann-Whitney U statistic for the baseline samples.
+    inline double GetU( void ) const { return m_u; }
+
+    /// Returns name of verdict, such as "Regressed".
+    static const char * GetVerdictName( Verdict verdict );
+
+private:
+    /// Default-constructor is not implemented.
+    SampleComparison( void );
+
+    Verdict m_verdict;            ///< What the comparison found.
+    double m_baselineMedian;      ///< Median of baseline samples.
+    double m_candidateMedian;     ///< Median of candidate samples.
+    double m_shift;               ///< Hodges-Lehmann estimate of shift.
+    double m_lowerBound;          ///< Lower bound of shift.
+    double m_upperBound;          ///< Upper bound of shift.
+    double m_probability;         ///< Two-sided p-value.
+    double m_u;                   ///< Mann-Whitney U statistic.
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class LatencyHistogram
+ @brief Counts latencies in log-bucketed form, as HDR histograms do, so
+  percentiles may be found without storing every latency.
+
+ @par Buckets
+  Latencies below 32 nanoseconds have a bucket for each nanosecond.  Above
+  that, each power of two is split into 32 buckets of equal width, so every
+  bucket is within about 3% of the latencies it holds.  The last bucket holds
+  anything above about 40 hours.  A percentile is reported as the upper edge
+  of its bucket, so a bound never passes because of rounding, but never as
+  more than the largest latency.
+ */
+class LatencyHistogram
+{
+public:
+
+    enum
+    {
+        SubBucketCount = 32,  ///< Buckets for each power of two.
+        OctaveCount = 46,     ///< Powers of two above the linear buckets.
+        BucketCount = SubBucketCount * ( OctaveCount + 1 )
+    };
+
+    LatencyHistogram( void );
+    inline ~LatencyHistogram( void ) {}
+
+    /// Returns seconds from a monotonic clock with the finest resolution.
+    static double GetTime( void );
+
+    /// Adds one latency in seconds.  Negative latencies count as zero.
+    void Record( double seconds );
+
+    /// Removes every latency.
+    void Clear( void );
+
+    inline unsigned long GetCount( void ) const { return m_count; }
+    inline double GetMin( void ) const { return m_min; }
+    inline double GetMax( void ) const { return m_max; }
+    inline double GetMean( void ) const
+    { return ( 0 == m_count ) ? 0.0 : m_sum / m_count; }
+
+    /** Returns latency in seconds which the given percent of latencies are at
+     or below, or zero if there are no latencies.
+     @param percentile Percent from 0 to 100, such as 99.9.
+     */
+    double GetPercentile( double percentile ) const;
+
+    /** Makes a summary with the count, min, mean, max, common percentiles,
+     and # of latencies within each power of two.
+     @param buffer Gets summary, cut short if needed, ending with a nul.
+     @param size Size of buffer.
+     @return Length of the whole summary, not counting the nul.
+     */
+    unsigned int GetSummary( char * buffer, unsigned int size ) const;
+
+private:
+
+    /// Returns which bucket holds latency of some nanoseconds.
+    static unsigned int GetBucket( double nanoseconds );
+
+    /// Returns nanoseconds at upper edge of bucket.
+    static double GetUpperEdge( unsigned int bucket );
+
+    unsigned long m_counts[ BucketCount ]; ///< # of latencies in each bucket.
+    unsigned long m_count;        ///< # of latencies.
+    double m_min;                 ///< Least latency in seconds.
+    double m_max;                 ///< Largest latency in seconds.
+    double m_sum;                 ///< Sum of latencies in seconds.
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class PropertyRandom
+ @brief Random numbers for property generators.  The same seed always gives
+  the same numbers, so a failing case can be made again from its seed.
+ */
+class PropertyRandom
+{
+public:
+
+    explicit PropertyRandom( unsigned int seed );
+    inline ~PropertyRandom( void ) {}
+
+    /// Returns next number of xorshift sequence.
+    unsigned int GetNext( void );
+
+    /// Returns number from zero up to one less than limit, or zero if none.
+    unsigned int GetBelow( unsigned int limit );
+
+    /// Returns number from 0.0 up to, but not including, 1.0.
+    double GetFraction( void );
+
+private:
+
+    unsigned int m_state;         ///< State of xorshift sequence.
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class PropertyText
+ @brief Text of a counterexample, made by the Print function of generators.
+  Text longer than MaxLength ends with "...".
+ */
+class PropertyText
+{
+public:
+
+    enum { MaxLength = 1023 };    ///< Most characters kept.
+
+    PropertyText( void );
+    inline ~PropertyText( void ) {}
+
+    void Append( char c );
+    void Append( const char * text );
+    void AppendSigned( long value );
+    void AppendUnsigned( unsigned long value );
+    void AppendReal( double value );
+
+    /** Adds character as it would be written within quotes in C, so quote,
+     backslash, and unprintable characters are escaped.
+     */
+    void AppendEscaped( char c, char quote );
+
+    inline const char * GetText( void ) const { return m_text; }
+    inline unsigned int GetLength( void ) const { return m_length; }
+
+private:
+
+    char m_text[ MaxLength + 1 ]; ///< Text ending with a nul.
+    unsigned int m_length;        ///< # of characters in text.
+};
+
+// ----------------------------------------------------------------------------
+
+/* Generators make inputs for UNIT_TEST_PROPERTY.  A generator is any class
+ with these, so host programs may add their own.
+ - typedef ValueType: Type of input.
+ - ValueType Generate( PropertyRandom & random, unsigned int size ) const;
+   Makes an input.  Size goes from 1 up to 100 over the cases, so early cases
+   are small and later ones are larger.
+ - bool Shrink( const ValueType & value, unsigned int step,
+   ValueType & smaller ) const;  Makes the step-th input simpler than value,
+   simplest first.  Returns false when there are no more steps.
+ - void Print( const ValueType & value, PropertyText & text ) const;
+ Generate, Shrink, and Print are called from several threads at once.
+ */
+
+/** @class PropertySign
+ @brief Tells if an integer is negative without comparing unsigned types to
+  zero, which compilers warn is always false.  Used by IntegerGenerator.
+ */
+template < bool IsSigned >
+struct PropertySign
+{
+    template < typename T >
+    static inline bool IsNegative( const T & value ) { return ( value < T() ); }
+};
+
+template <>
+struct PropertySign< false >
+{
+    template < typename T >
+    static inline bool IsNegative( const T & ) { return false; }
+};
+
+/** @class IntegerGenerator
+ @brief Makes integers within a range.  Early cases stay close to the origin,
+  and later ones spread further.  One case in eight is an end of the range.
+  Shrinks toward the origin, which is the value within range closest to zero
+  unless given.
+ */
+template < typename T >
+class IntegerGenerator
+{
+public:
+
+    typedef T ValueType;
+
+    inline IntegerGenerator( T low, T high ) :
+        m_low( low ), m_high( high ),
+        m_origin( ( T() < low ) ? low : ( ( high < T() ) ? high : T() ) ) {}
+
+    inline IntegerGenerator( T low, T high, T origin ) :
+        m_low( low ), m_high( high ), m_origin( origin ) {}
+
+    ValueType Generate( PropertyRandom & random, unsigned int size ) const
+    {
+        const unsigned int pick = random.GetBelow( 16 );
+        if ( 0 == pick )
+            return m_low;
+        if ( 1 == pick )
+            return m_high;
+        // Spread grows with the cube of size, up to a million each way.
+        const double spread = static_cast< double >( size ) * size * size;
+        const double below = static_cast< double >( m_origin )
+            - static_cast< double >( m_low );
+        const double above = static_cast< double >( m_high )
+            - static_cast< double >( m_origin );
+        const long down = static_cast< long >(
+            ( below < spread ) ? below : spread );
+        const long up = static_cast< long >(
+            ( above < spread ) ? above : spread );
+        const long offset = static_cast< long >(
+            ( down + up + 1.0 ) * random.GetFraction() ) - down;
+        return static_cast< T >( static_cast< unsigned long >( m_origin )
+            + static_cast< unsigned long >( offset ) );
+    }
+
+    bool Shrink( const ValueType & value, unsigned int step,
+        ValueType & smaller ) const
+    {
+        // Steps try the origin first, then half way to it, a quarter of the
+        // way, and so on, down to one closer than value.
+        const bool isAbove = ( m_origin < value );
+        const unsigned long from = static_cast< unsigned long >( value );
+        const unsigned long to = static_cast< unsigned long >( m_origin );
+        const unsigned long distance = isAbove ? ( from - to ) : ( to - from );
+        if ( ( 0 == distance ) || ( sizeof( unsigned long ) * 8 <= step ) )
+            return false;
+        const unsigned long part = distance >> step;
+        if ( 0 == part )
+            return false;
+        smaller = static_cast< T >(
+            isAbove ? ( from - part ) : ( from + part ) );
+        return true;
+    }
+
+    void Print( const ValueType & value, PropertyText & text ) const
+    {
+        if ( PropertySign< ( static_cast< T >( -1 ) < T() ) >::IsNegative(
+            value ) )
+            text.AppendSigned( static_cast< long >( value ) );
+        else
+            text.AppendUnsigned( static_cast< unsigned long >( value ) );
+    }
+
+private:
+
+    T m_low;                      ///< Least value made.
+    T m_high;                     ///< Largest value made.
+    T m_origin;                   ///< Value which shrinking goes toward.
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class CharGenerator
+ @brief Makes characters spread evenly over a range, which is printable ASCII
+  unless given.  Shrinks toward 'a' if within range, or else toward low.
+ */
+class CharGenerator : public IntegerGenerator< char >
+{
+public:
+
+    inline explicit CharGenerator( char low = ' ', char high = '~' ) :
+        IntegerGenerator< char >( low, high,
+            ( ( low <= 'a' ) && ( 'a' <= high ) ) ? 'a' : low ),
+        m_low( low ), m_count( static_cast< unsigned int >(
+            static_cast< unsigned char >( high )
+            - static_cast< unsigned char >( low ) ) + 1 ) {}
+
+    inline ValueType Generate( PropertyRandom & random, unsigned int ) const
+    {
+        return static_cast< char >( m_low + random.GetBelow( m_count ) );
+    }
+
+    inline void Print( const ValueType & value, PropertyText & text ) const
+    {
+        text.Append( '\'' );
+        text.AppendEscaped( value, '\'' );
+        text.Append( '\'' );
+    }
+
+private:
+
+    char m_low;                   ///< Least character made.
+    unsigned int m_count;         ///< # of characters within range.
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class BoolGenerator
+ @brief Makes true or false equally often.  Shrinks true to false.
+ */
+class BoolGenerator
+{
+public:
+
+    typedef bool ValueType;
+
+    inline ValueType Generate( PropertyRandom & random, unsigned int ) const
+    {
+        return ( 0 != random.GetBelow( 2 ) );
+    }
+
+    inline bool Shrink( const ValueType & value, unsigned int step,
+        ValueType & smaller ) const
+    {
+        smaller = false;
+        return ( value && ( 0 == step ) );
+    }
+
+    inline void Print( const ValueType & value, PropertyText & text ) const
+    {
+        text.Append( value ? "true" : "false" );
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class RealGenerator
+ @brief Makes doubles within a range.  Early cases stay close to the origin,
+  and later ones spread further.  One case in eight is an end of the range.
+  Shrinks toward the origin, which is the value within range closest to zero,
+  and then toward whole numbers.
+ */
+class RealGenerator
+{
+public:
+
+    typedef double ValueType;
+
+    inline RealGenerator( double low, double high ) :
+        m_low( low ), m_high( high ),
+        m_origin( ( 0.0 < low ) ? low : ( ( high < 0.0 ) ? high : 0.0 ) ) {}
+
+    ValueType Generate( PropertyRandom & random, unsigned int size ) const
+    {
+        const unsigned int pick = random.GetBelow( 16 );
+        if ( 0 == pick )
+            return m_low;
+        if ( 1 == pick )
+            return m_high;
+        const double spread = static_cast< double >( size ) * size;
+        const double below = m_origin - m_low;
+        const double above = m_high - m_origin;
+        const double down = ( below < spread ) ? below : spread;
+        const double up = ( above < spread ) ? above : spread;
+        return m_origin - down + ( down + up ) * random.GetFraction();
+    }
+
+    bool Shrink( const ValueType & value, unsigned int step,
+        ValueType & smaller ) const
+    {
+        if ( value == m_origin )
+            return false;
+        if ( 0 == step )
+        {
+            smaller = m_origin;
+            return true;
+        }
+        if ( 1 == step )
+        {
+            // Whole number toward zero, if that is within range.
+            const double limit = 1.0e15;
+            smaller = ( ( -limit < value ) && ( value < limit ) )
+                ? static_cast< double >( static_cast< long >( value ) ) : value;
+            if ( ( smaller != value ) && ( m_low <= smaller )
+              && ( smaller <= m_high ) )
+                return true;
+        }
+        // Then half way to the origin, a quarter of the way, and so on, until
+        // the part is too small to change value.
+        double part = ( value - m_origin ) / 2.0;
+        for ( unsigned int ii = 2; ii < step; ++ii )
+            part /= 2.0;
+        smaller = value - part;
+        return ( smaller != value );
+    }
+
+    inline void Print( const ValueType & value, PropertyText & text ) const
+    {
+        text.AppendReal( value );
+    }
+
+private:
+
+    double m_low;                 ///< Least value made.
+    double m_high;                ///< Largest value made.
+    double m_origin;              ///< Value which shrinking goes toward.
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class ContainerGenerator
+ @brief Makes containers such as vectors, lists, deques, or strings, whose
+  elements come from another generator.  The Container type needs push_back
+  and const_iterator.  Length grows with size, up to a most length.  Shrinks
+  by emptying the container, then by removing each element, and then by
+  shrinking each element.
+ */
+template < typename Container, typename ElementGenerator >
+class ContainerGenerator
+{
+public:
+
+    typedef Container ValueType;
+    typedef typename ElementGenerator::ValueType ElementType;
+    typedef typename Container::const_iterator ConstIterator;
+
+    inline ContainerGenerator( const ElementGenerator & element,
+        unsigned int maxLength ) :
+        m_element( element ), m_maxLength( maxLength ) {}
+
+    ValueType Generate( PropertyRandom & random, unsigned int size ) const
+    {
+        const unsigned int longest =
+            ( size < m_maxLength ) ? size : m_maxLength;
+        const unsigned int length = random.GetBelow( longest + 1 );
+        Container value;
+        for ( unsigned int ii = 0; ii < length; ++ii )
+            value.push_back( m_element.Generate( random, size ) );
+        return value;
+    }
+
+    bool Shrink( const ValueType & value, unsigned int step,
+        ValueType & smaller ) const
+    {
+        ConstIterator last( value.end() );
+        if ( value.begin() == last )
+            return false;
+        if ( 0 == step )
+        {
+            smaller = Container();
+            return true;
+        }
+        unsigned int count = 0;
+        for ( ConstIterator it( value.begin() ); it != last; ++it )
+            ++count;
+        if ( step <= count )
+        {
+            smaller = Container();
+            unsigned int index = 1;
+            for ( ConstIterator it( value.begin() ); it != last; ++it, ++index )
+            {
+                if ( index != step )
+                    smaller.push_back( *it );
+            }
+            return true;
+        }
+
+        // Steps past removals go through the shrink steps of each element.
+        unsigned int remaining = step - count - 1;
+        unsigned int place = 0;
+        for ( ConstIterator it( value.begin() ); it != last; ++it, ++place )
+        {
+            ElementType element( *it );
+            for ( unsigned int ii = 0; m_element.Shrink( *it, ii, element );
+                ++ii )
+            {
+                if ( 0 < remaining )
+                {
+                    --remaining;
+                    continue;
+                }
+                smaller = Container();
+                unsigned int index = 0;
+                for ( ConstIterator jt( value.begin() ); jt != last;
+                    ++jt, ++index )
+                {
+                    if ( index == place )
+                        smaller.push_back( element );
+                    else
+                        smaller.push_back( *jt );
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Print( const ValueType & value, PropertyText & text ) const
+    {
+        text.Append( '[' );
+        ConstIterator last( value.end() );
+        for ( ConstIterator it( value.begin() ); it != last; ++it )
+        {
+            if ( it != value.begin() )
+                text.Append( ", " );
+            m_element.Print( *it, text );
+        }
+        text.Append( ']' );
+    }
+
+private:
+
+    ElementGenerator m_element;   ///< Makes each element.
+    unsigned int m_maxLength;     ///< Most elements made.
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class StringGenerator
+ @brief Makes strings of type such as std::string from a CharGenerator, and
+  prints them within double quotes.
+ */
+template < typename StringType >
+class StringGenerator : public ContainerGenerator< StringType, CharGenerator >
+{
+public:
+
+    typedef ContainerGenerator< StringType, CharGenerator > BaseType;
+
+    inline explicit StringGenerator( unsigned int maxLength,
+        char low = ' ', char high = '~' ) :
+        BaseType( CharGenerator( low, high ), maxLength ) {}
+
+    void Print( const StringType & value, PropertyText & text ) const
+    {
+        text.Append( '"' );
+        typename StringType::const_iterator last( value.end() );
+        for ( typename StringType::const_iterator it( value.begin() );
+            it != last; ++it )
+            text.AppendEscaped( *it, '"' );
+        text.Append( '"' );
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+/// Pair of inputs made by PairGenerator.
+template < typename First, typename Second >
+struct PropertyPair
+{
+    First first;
+    Second second;
+
+    inline PropertyPair( const First & f, const Second & s ) :
+        first( f ), second( s ) {}
+};
+
+/** @class PairGenerator
+ @brief Makes two inputs from two generators, so a predicate may take more
+  than one input.  Shrinks the first input, and then the second.
+ */
+template < typename FirstGenerator, typename SecondGenerator >
+class PairGenerator
+{
+public:
+
+    typedef typename FirstGenerator::ValueType FirstType;
+    typedef typename SecondGenerator::ValueType SecondType;
+    typedef PropertyPair< FirstType, SecondType > ValueType;
+
+    inline PairGenerator( const FirstGenerator & first,
+        const SecondGenerator & second ) :
+        m_first( first ), m_second( second ) {}
+
+    ValueType Generate( PropertyRandom & random, unsigned int size ) const
+    {
+        const FirstType first( m_first.Generate( random, size ) );
+        return ValueType( first, m_second.Generate( random, size ) );
+    }
+
+    bool Shrink( const ValueType & value, unsigned int step,
+        ValueType & smaller ) const
+    {
+        smaller = value;
+        unsigned int steps = 0;
+        for ( ; m_first.Shrink( value.first, steps, smaller.first ); ++steps )
+        {
+            if ( steps == step )
+                return true;
+        }
+        smaller.first = value.first;
+        return m_second.Shrink( value.second, step - steps, smaller.second );
+    }
+
+    void Print( const ValueType & value, PropertyText & text ) const
+    {
+        text.Append( '(' );
+        m_first.Print( value.first, text );
+        text.Append( ", " );
+        m_second.Print( value.second, text );
+        text.Append( ')' );
+    }
+
+private:
+
+    FirstGenerator m_first;       ///< Makes first input.
+    SecondGenerator m_second;     ///< Makes second input.
+};
+
+/** Makes a PairGenerator without naming its types.  Since macro arguments
+ can't hold a bare comma, UNIT_TEST_PROPERTY needs this for pairs.
+ */
+template < typename FirstGenerator, typename SecondGenerator >
+inline PairGenerator< FirstGenerator, SecondGenerator > MakePairGenerator(
+    const FirstGenerator & first, const SecondGenerator & second )
+{
+    return PairGenerator< FirstGenerator, SecondGenerator >( first, second );
+}
+
+// ----------------------------------------------------------------------------
+
+/** @class PropertyRunner
+ @brief Runs the cases of one property for UnitTest::CheckProperty, without
+  needing to know the type of input.  Made by MakeProperty.
+ */
+class PropertyRunner
+{
+public:
+
+    /** Makes the input for one case, and checks the predicate.  Called from
+     several threads at once.
+     @return True if predicate held.  False if it failed or threw.
+     */
+    virtual bool RunCase( unsigned int seed, unsigned int size ) const = 0;
+
+    /** Makes the input for a failed case again, and shrinks it while the
+     predicate still fails.
+     @param text Gets shrunk input.
+     @return # of times input was shrunk.
+     */
+    virtual unsigned int ShrinkCase( unsigned int seed, unsigned int size,
+        unsigned int maxTries, PropertyText & text ) const = 0;
+
+    inline virtual ~PropertyRunner( void ) {}
+};
+
+// ----------------------------------------------------------------------------
+
+/** @class PropertyCheck
+ @brief Runs cases of a predicate over inputs made by a generator.  The
+  predicate may be a function or a function object taking a const reference
+  to the input, and returning bool.
+ */
+template < typename Generator, typename Predicate >
+class PropertyCheck : public PropertyRunner
+{
+public:
+
+    typedef typename Generator::ValueType ValueType;
+
+    inline PropertyCheck( const Generator & generator,
+        const Predicate & predicate ) :
+        PropertyRunner(), m_generator( generator ), m_predicate( predicate ) {}
+
+    inline virtual ~PropertyCheck( void ) {}
+
+    virtual bool RunCase( unsigned int seed, unsigned int size ) const
+    {
+        PropertyRandom random( seed );
+        const ValueType value( m_generator.Generate( random, size ) );
+        return Holds( value );
+    }
+
+    virtual unsigned int ShrinkCase( unsigned int seed, unsigned int size,
+        unsigned int maxTries, PropertyText & text ) const
+    {
+        PropertyRandom random( seed );
+        ValueType value( m_generator.Generate( random, size ) );
+        unsigned int shrinks = 0;
+        unsigned int step = 0;
+        for ( unsigned int tries = 0; tries < maxTries; ++tries )
+        {
+            ValueType smaller( value );
+            if ( !m_generator.Shrink( value, step, smaller ) )
+                break;
+            if ( Holds( smaller ) )
+            {
+                ++step;
+                continue;
+            }
+            // Simpler input still fails, so start over from it.
+            value = smaller;
+            ++shrinks;
+            step = 0;
+        }
+        m_generator.Print( value, text );
+        return shrinks;
+    }
+
+private:
+
+    bool Holds( const ValueType & value ) const
+    {
+        try
+        {
+            return ( m_predicate( value ) ) ? true : false;
+        }
+        catch ( ... )
+        {
+            return false;
+        }
+    }
+
+    Generator m_generator;        ///< Makes inputs.
+    Predicate m_predicate;        ///< Checks each input.
+};
+
+/// Makes a PropertyCheck without naming its types.  Used by UNIT_TEST_PROPERTY.
+template < typename Generator, typename Predicate >
+inline PropertyCheck< Generator, Predicate > MakeProperty(
+    const Generator & generator, Predicate predicate )
+{
+    return PropertyCheck< Generator, Predicate >( generator, predicate );
+}
+
+// ----------------------------------------------------------------------------
+
+/** @class UnitTestSet
+ @brief Maintains collection of unit tests, and sends test results to output
+  observers.
+
+ @par Interaction With Host Program
+ This singleton should be created soon after the host program begins execution.
+ The host program does not need to call anything to destroy the singleton since
+ it will destroy itself at exit time.  The singleton also sends test results to
+ various forms of output (e.g. - text file, HTML files, and standard output) so
+ the host program will not need to handle that separately.  The minimum a host
+ program needs to do is call UnitTestSet::Create, call UnitTestSet::AddUnitTest
+ occasionally and then exercise the UnitTest's.
+
+ All implementation details are hidden from the host program using the Cheshire
+ Cat technique (a.k.a. Pimpl Idiom).
+
+ @par Exit Time
+ The singleton typically registers its Destroy function with ::atexit so it can
+ output a summary table and perform final cleanup at exit time.  By then, most
+ programs complete their unit tests.  You can make a summary table before exit
+ time by calling UnitTestSet::OutputSummary directly.  You can perform unit
+ tests at exit time without worrying about whether the singleton remains alive
+ by passing in false for deleteAtExitTime in the UnitTestSet::Create function.
+ Once the host has completed all unit tests, call UnitTestSet::OutputSummary.
+ If a required unit test fails, the unit-tester will create the summary table
+ and end the program.
+
+ @par Container of UnitTest's
+ The singleton owns each UnitTest, and only it may create or destroy a UnitTest
+ instance.  Each UnitTest has a unique name, and is identified by that name.
+
+ @par Test Result Observers
+ UnitTestSet maintains a container of pointers to test result observers.  At
+ appropriate moments, it iterates through the container to call each observer.
+ If an observer returns the function call with false, it will not be called by
+ UnitTestSet again.  The host program may call AddReceiver and RemoveReceiver
+ to specify if it will receive event notices.  UnitTestSet also maintains two
+ internal observers, one which sends output to an HTML file, and another which
+ sends output to both standard out and a text file.  UnitTestSet will never
+ attempt to delete an external observer - even when UnitTestSet's destructor is
+ called.
+
+ @par Text Output
+ This produces identical content for the text result file, the standard-output
+ stream, and the standard-error stream.  The host program may choose to send
+ output to any combination of those three (file, cout, cerr).  The cout option
+ allows a person to exercise unit tests on the command line and see the results
+ directly.  The cerr option exists in case programs want to reserve cout for
+ other purposes.  The text file option exists in case programs use both cout
+ and cerr.
+
+ @par Output File Names
+ The strings passed into the Create function should not contain complete file
+ names.  The strings should contain just partial file names - a prefix onto
+ which the rest of the name shall be added.  The strings may contain relative
+ or absolute paths.  This singleton will embed a timestamp into the file name
+ and add the appropriate extension.  That timestamp represents when the unit
+ tests were executed.  For example, if the string contains "./MyCo_UnitTests"
+ and if the unit tests began on 2007-March-14 at 1:59:26 AM, then the text file
+ name is "./MyCo_UnitTests_2007_03_14_01_59_26.txt".
+
+ @par HTML File Names
+ The UnitTestSet produces two html files - a main page which contains a table
+ of showing multiple unit test iterations, and a current page showing details
+ of the current iteration.  The HTML file name parameter specifies a location
+ and partial name for both the main and current html pages.  Each execution of
+ unit tests produces a new HTML file for the current test results.  Each test
+ result page has a link back to the main page, and contain detailed stats for
+ all unit tests executed.  The main page has a table showing the history of
+ prior tests so readers can quickly see long-term patterns of test results.
+ Each row in that table has a link to the corresponding html file.
+
+ @par Legal examples of partial file names for text or HTML files are:
+ - "./MyCo_UnitTests"
+ - "c:/test/results/current"
+ - "//mars/olympus/zp/rev_5_2"
+ - "../../elysium/mainline"
+ */
+class UnitTestSet
+{
+public:
+
+    /// Type of error that occurred when calling Create function.
+    enum ErrorState
+    {
+        Success = 0,   ///< No error occurred.
+        AlreadyExists, ///< Singleton already created.
+        CantCreate     ///< Could not create singleton.
+    };
+
+    /** This enum family defines output options which programs can use to
+     specify what gets added to the test result output.  A bitfield can contain
      all the options so options can be bitwise ORed together.
      */
     enum OutputOptions
@@ -512,11 +2157,43 @@ public:
         Dividers     = 0x0040, ///< Show divider lines in tables and sections.
         AddTestIndex = 0x0080, ///< Add unit test index to item lines.
         SummaryTable = 0x0100, ///< Send summary table to output.
+        FatalEndsTest = 0x0200, ///< Required failure ends only its UnitTest.
+        Times        = 0x0400, ///< Show real & virtual seconds in text table.
+        Counters     = 0x0800, ///< Count CPU events per UnitTest, Linux only.
+        Memory       = 0x1000, ///< Show memory use in text and HTML tables.
         SendToCout   = 0x4000, ///< Send output to standard output.
         SendToCerr   = 0x8000, ///< Send output to standard error.
         Default      = 0x015E  ///< Bitflags for default output options.
     };
 
+    /** Decides when text output for the text file, standard output, and
+     standard error gets flushed.  Output is always flushed when a required
+     test fails, when the summary table ends, and when the singleton is
+     destroyed.  It is also flushed when 64 KB of output is waiting.
+     */
+    enum FlushPolicy
+    {
+        FlushEveryLine = 0, ///< Flush after every line.  This is the default.
+        FlushInterval,      ///< Flush once enough milliseconds passed.
+        FlushOnFailure,     ///< Flush after failed or thrown items.
+        FlushAtExit         ///< Flush only at end of tests.
+    };
+
+    /// Which threads share a fixture.  See AddFixture.
+    enum FixtureScope
+    {
+        SuiteFixture = 0, ///< One fixture shared by every UnitTest and thread.
+        WorkerFixture     ///< One fixture for each thread which uses it.
+    };
+
+    /// Which calls of CheckInvariants do checks.  See SetInvariantPolicy.
+    enum InvariantPolicy
+    {
+        CheckAlways = 0,  ///< Every call checks invariants.
+        CheckEveryNth,    ///< One call of every N within each thread checks.
+        CheckAtSummary    ///< Only summaries check invariants.
+    };
+
     /** Creates a singleton for executing sets of unit tests.
      @param testName Name of overall set of unit tests.
      @param textFileName Path and part of filename used to store test results
@@ -555,21 +2232,23 @@ public:
     }
 
     /** This function either adds a new UnitTest to the set, or returns an
-      existing one with the same name.  The function performs O(N) operations
-      in the worst case scenario where N is the number of existing UnitTest's.
-      If this can't allocate a new UnitTest or add the new UnitTest to a
-      container, this may throw an exception.  This function provides strong
-      exception safety in that internal data does not change if an exception
-      occurs.
-     @param unitTestName Name of new UnitTest.  Any name longer than the max
-      allowed is truncated.  If the string is NULL or empty, this returns NULL.
+      existing one with the same name.  Names are found through a hash table,
+      so this performs O(1) operations on average, and O(L) where L is the
+      length of the name.  UnitTest's are stored in blocks, so pointers to them
+      stay valid until the summary is output.  If this can't allocate a new
+      UnitTest or add the new UnitTest to a container, this may throw an
+      exception.  This function provides strong exception safety in that
+      internal data does not change if an exception occurs.
+     @param unitTestName Name of new UnitTest.  Names may have any length, and
+      the library keeps its own copy.  If the string is NULL or empty, this
+      returns NULL.
      @return Pointer to new UnitTest, or pointer to existing one if it matches
       the name.
      */
     UnitTest * AddUnitTest( const char * unitTestName );
 
     /** Returns pointer to UnitTest that matches given name.  This function
-     takes O(N) operations where N is the number of unit tests.  A NULL or
+     takes O(1) operations on average, since it uses a hash table.  A NULL or
      empty name causes this to return NULL.  If no name matches the parameter,
      this returns NULL.
      */
@@ -592,6 +2271,357 @@ public:
             const_cast< const UnitTestSet * >( this )->GetUnitTest( index ) );
     }
 
+    /** Adds a UnitTest with the given name, and then calls a function which
+     contains the body of that unit test.  If the FatalEndsTest output option
+     is on, a required item which fails or throws inside the function ends only
+     that function instead of the whole program, so every other UnitTest still
+     runs.  Any exception which escapes the function is caught and recorded as
+     a thrown item, whether or not the FatalEndsTest option is on.  The host
+     program may call this from within another test function.
+     @param unitTestName Name of UnitTest.  See AddUnitTest.
+     @param body Function which does the test items for the UnitTest.
+     @return True if the UnitTest has no failures or exceptions.  False if the
+      name or function is NULL, or if called while receivers are in use.
+     */
+    bool RunUnitTest( const char * unitTestName, UnitTestFunction body );
+
+    /** Returns true if a required item which fails in the given UnitTest will
+     end the program, or false if it ends only the UnitTest.  Receivers may
+     call this to decide what to show after a fatal result.
+     */
+    bool WillFatalEndProgram( const UnitTest * test ) const;
+
+    /** Adds a UnitTest and remembers the function with its body so the
+     UnitTest can run later via RunUnitTests.
+     @param unitTestName Name of UnitTest.  See AddUnitTest.
+     @param body Function which does the test items for the UnitTest.
+     @return True if registered.  False if the name or function is NULL, if
+      the UnitTest is already registered, or if receivers are in use.
+     */
+    bool RegisterUnitTest( const char * unitTestName, UnitTestFunction body );
+
+    /** Declares that one UnitTest should not run unless another one passed.
+     Names are matched when RunUnitTests is called, so UnitTest's may be
+     registered in any order.  A prerequisite which is not registered must
+     already have run by then, or its dependents are skipped.
+     @param unitTestName Name of dependent UnitTest.
+     @param prerequisiteName Name of UnitTest which must pass first.
+     @return True if added.  False if either name is NULL or empty, or if
+      receivers are in use.
+     */
+    bool AddDependency( const char * unitTestName,
+        const char * prerequisiteName );
+
+    /** Runs all registered UnitTest's via RunUnitTest, so each one runs after
+     all its prerequisites.  Among UnitTest's whose prerequisites are done,
+     the one registered first runs first.  If any prerequisite failed or was
+     skipped, the dependent is skipped instead of run, and so are its own
+     dependents.  UnitTest's within a cycle of dependencies are skipped.  The
+     registrations and dependencies are removed once they are run.
+     Complexity is O( ( T + D ) * log T ) where T is the number of registered
+     UnitTest's and D is the number of dependencies.
+     @return True if every registered UnitTest ran and passed.
+     */
+    bool RunUnitTests( void );
+
+    /** Runs the UnitTest's defined by UNIT_TEST_CASE whose names contain the
+     filter.  Only UnitTest's which match are made, so a filtered run never
+     pays for the others.  Those which match are registered and then run via
+     RunUnitTests, so they may have dependencies and isolated workers.  They
+     run in order of source file name, and then in order within each file.
+     UNIT_TEST_CASE records within a static library are only found if the
+     linker keeps their object files, so put them in the program itself.
+     @param filter Part of each name to run.  NULL or empty runs them all.
+     @return True if every UnitTest which ran passed.  False if receivers are
+      in use.
+     */
+    bool RunStaticUnitTests( const char * filter );
+
+    /** Declares a fixture which UnitTest's get via GetFixture, so something
+     costly to build is built once and reused instead of within each
+     UnitTest.  A suite fixture is built once and shared by every thread, so
+     UnitTest's must not change it unless only one thread uses it.  A worker
+     fixture is built once for each thread which uses it.  Threads started
+     for stress tests, property tests, and case files keep the same worker
+     fixtures from one run to the next.  If isolated workers are set, a child
+     process which builds a fixture tells this process what it cost.  This
+     process then builds that fixture before starting later children, so they
+     reuse its copy instead of building their own.  Fixtures are torn down
+     when the summary is made, or by TearDownFixtures, and are built again if
+     used after that.  The summary shows time spent building and tearing down
+     each fixture, including time spent by children.
+     @param fixtureName Name of fixture.  The library keeps its own copy.
+     @param scope Whether every thread shares the fixture, or each has one.
+     @param setUp Function which builds fixture.
+     @param tearDown Function which tears down fixture.  May be NULL.
+     @param state Pointer passed to setUp and tearDown.  May be NULL.
+     @return True if declared.  False if the name is NULL or empty, if setUp
+      is NULL, if a fixture already has that name, or if receivers are in use.
+     */
+    bool AddFixture( const char * fixtureName, FixtureScope scope,
+        FixtureSetUpFunction setUp, FixtureTearDownFunction tearDown,
+        void * state );
+
+    /** Returns fixture with given name, and builds it first if this is its
+     first use within its scope.  May be called from any thread.  Exceptions
+     thrown by the set-up function pass through this, so they are recorded
+     like any other exception within a UnitTest.
+     @return Pointer to fixture, or NULL if no fixture has that name or if it
+      could not be built.
+     */
+    void * GetFixture( const char * fixtureName );
+
+    /** Tears down each fixture which was built, and adds the time spent to
+     the summary.  Call only while no other thread uses fixtures.
+     */
+    void TearDownFixtures( void );
+
+    /** Turns soak mode on or off, for runs lasting hours or days.  In soak
+     mode, a snapshot goes to the text output every so many minutes.  Each
+     snapshot shows item totals among all UnitTest's, how much each total
+     grew since the last snapshot, items per second, the worst burst of
+     failures within one second, and which UnitTest's had new failures.
+     A snapshot changes no counts, and while soak mode is on, OutputSummary
+     changes none either, so the summary at the end covers the whole run.
+     Item counts have 64 bits, so they do not overflow within billions of
+     items.  The first snapshot counts growth from when soak mode began.  The
+     time is checked after every 256 items and after each RunUnitTest, so a
+     snapshot may come a little after it is due.
+     @param minutes Minutes between snapshots, which may be a fraction.
+      Zero turns soak mode off.
+     @return True if set.  False if minutes is negative, or if receivers
+      are in use.
+     */
+    bool SetSoakMode( double minutes );
+
+    /** Makes a soak snapshot now, even if soak mode is off, and starts the
+     time until the next one over.  Growth is counted from the last snapshot,
+     or from when soak mode began.
+     */
+    void OutputSoakSnapshot( void );
+
+    /// Returns # of soak snapshots made since the program began.
+    unsigned int GetSoakSnapshotCount( void ) const;
+
+    /** Sets which calls of CheckInvariants do checks within DEBUG builds,
+     since checking at every call makes large suites run much slower.  Each
+     summary checks invariants of every UnitTest regardless of policy, and
+     the text output shows how many checks were done and how long they took
+     since the last summary.  Other builds never check invariants, so this
+     does nothing there.  Call this before tests run within other threads.
+     @param policy Which calls do checks.  Default is CheckAlways.
+     @param n One call of every n within each thread does checks if policy is
+      CheckEveryNth.  Ignored for other policies.
+     @return True if set.  False if policy is unknown, or if n is zero for
+      CheckEveryNth.
+     */
+    bool SetInvariantPolicy( InvariantPolicy policy, unsigned int n );
+
+    /** Returns # of calls of CheckInvariants which did checks since the last
+     summary, added up over every thread.  This is always zero for builds
+     which do not check invariants.
+     */
+    ItemCount GetInvariantCheckCount( void ) const;
+
+    /** Makes RunUnitTest and RunUnitTests run each UnitTest body in a child
+     process which sends its results back through a pipe.  The results are
+     then sent to the receivers as if the body ran in this process.  If the
+     child crashes or calls exit, the UnitTest gets a thrown item instead of
+     the whole program ending.  A failed required item ends only the child,
+     as if the FatalEndsTest option were on.  RunUnitTests runs up to
+     workerCount children at once, so UnitTest's without dependencies between
+     them run in parallel.  Each UnitTest's results are shown once its child
+     ends, so output from different children is never mixed.  This works only
+     where fork is available, so not on Windows.
+     @param workerCount Maximum # of child processes at once, up to 64.  Zero
+      means each UnitTest runs within this process, which is the default.
+     @return True if set.  False if this platform can't make child processes,
+      or if receivers are in use.
+     */
+    bool SetIsolatedWorkers( unsigned int workerCount );
+
+    /** Sets how long a child process made for SetIsolatedWorkers may run.  A
+     child still running at that time is killed, and its UnitTest gets a
+     thrown item saying so.  The default is 300 seconds.
+     @param seconds Time limit for each child process.  Zero means no limit.
+     @return True if set.  False if seconds is negative, or if receivers are
+      in use.
+     */
+    bool SetIsolatedTimeout( double seconds );
+
+    /** Adds a UnitTest and remembers the function with its async body so the
+     UnitTest can run later via RunAsyncUnitTests.  A body may register more
+     async UnitTest's while running, and they join the same event loop.
+     @param unitTestName Name of UnitTest.  See AddUnitTest.
+     @param body Function which does one step of the UnitTest each call.
+     @param state Pointer passed to each call of body.  May be NULL.
+     @return True if registered.  False if the name or function is NULL, or
+      if receivers are in use.
+     */
+    bool RegisterAsyncUnitTest( const char * unitTestName,
+        AsyncUnitTestFunction body, void * state );
+
+    /** Runs all registered async UnitTest's together within a single-threaded
+     event loop.  Each body is called once, and then again whenever what it
+     waits for happens.  Items go to whichever UnitTest is passed to the body,
+     so results belong to the right UnitTest even though bodies take turns.
+     Required failures and escaping exceptions are handled just as within
+     RunUnitTest, and end only the one body.  Time spent within each call is
+     added to the elapsed time of its UnitTest, and time spent waiting is not.
+     Async bodies always run in this process, even if isolated workers are
+     set.  On Windows, waits for a descriptor end at the next turn of the
+     loop, so the body must check the descriptor itself.
+     @return True if every registered async UnitTest passed.
+     */
+    bool RunAsyncUnitTests( void );
+
+    /** Adds a UnitTest and calls its body on many threads at once, over and
+     over, until some seconds pass.  Before each round, every thread waits at
+     a barrier so all of them start the body together.  Each thread then
+     waits a random time up to the jitter, and may yield, before calling the
+     body.  Items from every thread go into the one UnitTest, and recording
+     them is serialized, so test macros are safe to use within the body.  A
+     required failure or an escaping exception ends the whole run.  At the
+     end, one more item tells the seed and the calls per second of each
+     thread, and fails if any item failed or any exception escaped.  Running
+     again with the same seed gives each thread the same random numbers,
+     though the operating system may still order the threads differently.
+     Stress tests always run in this process, even if isolated workers are
+     set.
+     @param unitTestName Name of UnitTest.  See AddUnitTest.
+     @param body Function called by each thread for each round.
+     @param state Pointer passed to each call of body.  May be NULL.
+     @param threadCount # of threads, from 1 to 64.
+     @param seconds How long to keep starting new rounds.
+     @param seed Seed for random numbers of each thread, or zero to pick one
+      from the time.
+     @return True if the UnitTest passed.  False if it failed, if the name or
+      function is NULL, if the thread count is out of range, if threads could
+      not be made, or if receivers are in use.
+     */
+    bool RunStressTest( const char * unitTestName, StressUnitTestFunction body,
+        void * state, unsigned int threadCount, double seconds,
+        unsigned int seed );
+
+    /** Sets how RunStressTest disturbs the timing of its threads.
+     @param jitterMicroseconds Most time each thread waits after the barrier
+      before calling the body.  Default is 50 microseconds.
+     @param yieldPercent Chance out of 100 that StressThread::MaybeYield gives
+      up the processor.  The threads also call it once before each call of
+      the body.  Default is 10 percent.
+     */
+    void SetStressInjection( unsigned int jitterMicroseconds,
+        unsigned int yieldPercent );
+
+    /** Adds a UnitTest, and calls its body once for each row of a case file,
+     such as a CSV or TSV file of inputs and expected outputs.  The file is
+     memory-mapped and split into chunks, and threads take chunks in turn,
+     so rows are not read in order.  Rows are split where they sit, so no
+     memory is allocated for each row, and files larger than memory stream
+     through.  Items from every thread go into the one UnitTest, and
+     recording them is serialized.  The message of each failed or thrown item
+     starts with the line number and text of its row.  Blank lines are
+     skipped, but counted as lines.  A required failure or an escaping
+     exception ends the run.  At the end, one more item tells how many rows
+     were read and how fast, and fails if any item failed or any exception
+     escaped.  Case files always run in this process, even if isolated
+     workers are set.  A 32-bit program can map only files which fit within
+     its address space.
+     @param unitTestName Name of UnitTest.  See AddUnitTest.
+     @param fileName Name of case file.
+     @param body Function called for each row.
+     @param state Pointer passed to each call of body.  May be NULL.
+     @param separator Character between fields, such as ',' or '\t'.
+     @param headerRows # of lines at the start which are not cases.
+     @param threadCount # of threads, up to 64, or zero for each processor.
+     @return True if the UnitTest passed.  False if it failed, if the name,
+      file name, or function is NULL, if the file could not be mapped, or if
+      receivers are in use.
+     */
+    bool RunCaseFile( const char * unitTestName, const char * fileName,
+        CaseFileFunction body, void * state, char separator,
+        unsigned int headerRows, unsigned int threadCount );
+
+    /** Sets how UNIT_TEST_PROPERTY runs cases.  Which case fails first, and
+     its counterexample, depend only on the case count and seed, so running
+     again with the seed from a failure message finds the same failure.
+     @param caseCount # of cases for each property.  Default is 2000.
+     @param threadCount # of threads which run cases, up to 64.  Zero, which
+      is the default, means one for each processor.
+     @param seed Seed for the cases, or zero to pick one from the time for
+      each property.  Default is zero.
+     */
+    void SetPropertyOptions( unsigned int caseCount, unsigned int threadCount,
+        unsigned int seed );
+
+    /** Sets directory which holds golden files for UNIT_TEST_SNAPSHOT.  The
+     default is "snapshots" within the current directory.
+     @return False if directory name is NULL or empty.
+     */
+    bool SetSnapshotDirectory( const char * directory );
+
+    /// Returns directory which holds golden files for UNIT_TEST_SNAPSHOT.
+    const char * GetSnapshotDirectory( void ) const;
+
+    /** Decides whether UNIT_TEST_SNAPSHOT compares against golden files, or
+     writes them.  Update mode starts on if the UNIT_TEST_UPDATE_SNAPSHOTS
+     environment variable is set to anything but 0.
+     */
+    void SetSnapshotUpdate( bool update );
+
+    /// True if UNIT_TEST_SNAPSHOT writes golden files instead of comparing.
+    bool IsSnapshotUpdate( void ) const;
+
+    /// Returns maximum # of child processes, or zero if not isolating tests.
+    unsigned int GetIsolatedWorkers( void ) const;
+
+    /// Returns time limit in seconds for each child process, or zero if none.
+    double GetIsolatedTimeout( void ) const;
+
+    /** Decides whether GetClock returns the system clock or the virtual clock.
+     While the virtual clock is in use, RunAsyncUnitTests moves it straight to
+     the soonest timer whenever every async body waits only on timers, so no
+     real time passes.  If any body waits on a descriptor, the loop really
+     waits, and the virtual clock moves forward as much as the real one.
+     @param useVirtual True for virtual clock, false for system clock.
+     @return False if receivers are in use.
+     */
+    bool SetVirtualClock( bool useVirtual );
+
+    /** Returns the clock which test bodies and code under test should use.
+     This is the system clock unless SetVirtualClock chose the virtual one.
+     */
+    Clock & GetClock( void );
+
+    /// Returns the virtual clock, even if GetClock does not return it.
+    VirtualClock & GetVirtualClock( void );
+
+    /** Returns name of a performance counter, or NULL if it is not in use.
+     Counters are used only if the Counters output option is on, and only on
+     Linux.  They count cycles, instructions, cache misses, and branch misses
+     where the hardware counters may be read.  Where those are restricted, as
+     within many containers, they count task-clock nanoseconds, context
+     switches, and page faults instead.  The summary tables add one column
+     for each counter in use.
+     @param which Counter number, less than UnitTest::CounterCount.
+     */
+    const char * GetCounterName( unsigned int which ) const;
+
+    /** Returns name used for a performance counter in XML output, or NULL if
+     it is not in use.
+     */
+    const char * GetCounterKey( unsigned int which ) const;
+
+    /** Reads the running totals of the performance counters, so a host
+     program can measure code outside of any UnitTest.  These count only the
+     thread which made the UnitTestSet, or the main thread of an isolated
+     child process.
+     @param values Array of UnitTest::CounterCount values.  Counters not in
+      use are set to zero.
+     @return True if any counter is in use.
+     */
+    bool ReadCounters( double * values ) const;
+
     /** Tells the singleton to notify a receiver of test result and output
       events.  This function may throw exceptions, but will not leak resources
       if it throws.  Complexity is O(N) where N is the number of observers
@@ -632,6 +2662,45 @@ public:
      */
     bool DoesSendToXmlFile( void ) const;
 
+    /** Returns true if this sends test results to a JSON Lines file, or false
+     if host program did not specify name for JSON file, or could not open it.
+     */
+    bool DoesSendToJsonFile( void ) const;
+
+    /** Tells the singleton to also send test results to a JSON Lines file.
+     Each event (test header, test item, message, timestamp, table line, and
+     totals) becomes one JSON object on a separate line.  Like the other file
+     names, this is a partial name onto which a timestamp and a ".jsonl"
+     extension are added.  This must be called before any test results are
+     output.
+     @param jsonFileName Path and part of filename used to store test results
+      in JSON Lines form.  A NULL or empty string turns off JSON output.
+     @return True if name was set, or false if output already started.
+     */
+    bool SetJsonFileName( const char * jsonFileName );
+
+    /** Returns true if this sends test results to a JUnit XML file, or false
+     if host program did not specify name for JUnit file, or could not open it.
+     */
+    bool DoesSendToJUnitFile( void ) const;
+
+    /** Tells the singleton to also send test results to an XML file in the
+     format used by JUnit, which most continuous integration servers can read.
+     Each UnitTest becomes a testcase element with its elapsed time, and each
+     failed or thrown item becomes a failure or error element inside it.
+     Each testcase is written along with the summary table, or when its
+     UnitTest is destroyed if no table is made, so a UnitTest has one testcase
+     even if other UnitTests record results between its items.  Only failure,
+     error, and skipped elements are kept until then, so memory use does not
+     grow with the number of passing items.  This adds a timestamp and a
+     ".junit.xml" extension onto the partial file name.  This must be called
+     before any test results are output.
+     @param junitFileName Path and part of filename used to store test results
+      in JUnit form.  A NULL or empty string turns off JUnit output.
+     @return True if name was set, or false if output already started.
+     */
+    bool SetJUnitFileName( const char * junitFileName );
+
     /// Returns true if this sends test results to standard output.
     bool DoesSendToCout( void ) const;
 
@@ -658,14 +2727,40 @@ public:
      */
     const char * GetXmlFileName( void ) const;
 
+    /** This provides name of output JSON Lines file, but returns NULL if this
+     does not send output to a JSON file, or could not open file.
+     */
+    const char * GetJsonFileName( void ) const;
+
+    /** This provides name of output JUnit XML file, but returns NULL if this
+     does not send output to a JUnit file, or could not open file.
+     */
+    const char * GetJUnitFileName( void ) const;
+
     /// Returns true if this has the output option(s) specified.
     bool DoesOutputOption( UnitTestSet::OutputOptions options ) const;
 
+    /** Sets when text output gets flushed.  Flushing after every line keeps
+     output accurate even if the host program crashes, but is slow when many
+     items are shown.  The other policies collect lines in a buffer so each
+     flush writes many lines at once.  Any output already buffered is flushed
+     before the policy changes.  This does nothing if called while receivers
+     are in use.
+     @param policy When to flush text output.
+     @param milliseconds Minimum time between flushes when policy is
+      FlushInterval.  Ignored for other policies.
+     */
+    void SetTextFlushPolicy( UnitTestSet::FlushPolicy policy,
+        unsigned int milliseconds );
+
     /** Creates a summary table of unit test results and sends table info to
      the receivers.  Once this makes the final summary table, it clears the
      contents of all unit tests so that the host program can either start over
-     or exit.  If the main function exits and the host program has not called
-     this function, then UnitTestSet will do the output at exit time.
+     or exit.  While soak mode is on, this clears nothing, so a long run may
+     make summaries along the way and still get one covering the whole run at
+     exit.  See SetSoakMode.  If the main function exits and the host program
+     has not called this function, then UnitTestSet will do the output at exit
+     time.
      If this throws, no resources are lost.  Complexity is O(R * U) where R is
      the number of receivers and U is the number of unit tests.
      */
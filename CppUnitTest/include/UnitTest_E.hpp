@@ -80,6 +80,56 @@
         u->OutputMessage( __FILE__, __LINE__, msg );
 #endif
 
+/* The UNIT_TEST_ISR macros record a test item into an InterruptContext instead
+ of sending it to the receiver.  They are safe to use within interrupt handlers
+ and real-time callbacks because they never block, never allocate memory, and
+ never call the receiver.  Since an interrupt handler should not throw, these
+ macros do not catch exceptions.  The message must be a string literal or some
+ other string which remains alive until the item is pumped to the receiver.
+ */
+
+#ifndef UNIT_TEST_ISR_WARN
+    #define UNIT_TEST_ISR_WARN( context, u, test ) \
+        context->Record( u, __FILE__, __LINE__, u->Warning, test, #test, 0 );
+#endif
+
+#ifndef UNIT_TEST_ISR
+    #define UNIT_TEST_ISR( context, u, test ) \
+        context->Record( u, __FILE__, __LINE__, u->Checked, test, #test, 0 );
+#endif
+
+#ifndef UNIT_TEST_ISR_MSG
+    #define UNIT_TEST_ISR_MSG( context, u, test, msg ) \
+        context->Record( u, __FILE__, __LINE__, u->Checked, test, #test, msg );
+#endif
+
+#ifndef UNIT_TEST_ISR_REQUIRE
+    #define UNIT_TEST_ISR_REQUIRE( context, u, test ) \
+        context->Record( u, __FILE__, __LINE__, u->Require, test, #test, 0 );
+#endif
+
+/* The InterruptContext ring buffer needs a memory barrier between writing an
+ event and publishing the new ring position.  Host programs for compilers other
+ than GCC and MSVC must define this macro before including this header.  A
+ compiler-only barrier is enough on single-core targets, and on x86 where
+ stores are not reordered with other stores.
+ */
+#ifndef UNIT_TEST_MEMORY_BARRIER
+    #if defined( __GNUC__ )
+        #define UNIT_TEST_MEMORY_BARRIER() __sync_synchronize()
+    #elif defined( _MSC_VER )
+        #include <intrin.h>
+        #pragma intrinsic( _ReadWriteBarrier )
+        #if defined( _M_IX86 ) || defined( _M_X64 )
+            #define UNIT_TEST_MEMORY_BARRIER() _ReadWriteBarrier()
+        #else
+            #define UNIT_TEST_MEMORY_BARRIER() __dmb( _ARM_BARRIER_ISH )
+        #endif
+    #else
+        #error Define UNIT_TEST_MEMORY_BARRIER for this compiler.
+    #endif
+#endif
+
 
 namespace ut
 {
@@ -406,6 +456,102 @@ private:
 
 // ----------------------------------------------------------------------------
 
+/** @class InterruptContext
+ @brief Records unit test items from an interrupt handler or real-time callback
+  so they can be sent to the receiver later from a normal-priority context.
+
+ @par Wait-Free Recording
+  Each InterruptContext owns a fixed-size ring of pending events which it
+  allocates when UnitTestSet::AddInterruptContext creates it.  Record only
+  copies a few pointers into the ring and updates counters, so it never blocks,
+  never allocates, and never re-enters the receiver.  If the ring is full, the
+  item is dropped and counted instead of waiting for space.
+
+ @par Single Producer
+  Only one interrupt handler or callback may record into a given context, and
+  only UnitTestSet::PumpInterruptEvents may remove events from it.  Give each
+  interrupt source its own context.  The counters are written only by the
+  producer, so the host may read them from any context.
+ */
+class InterruptContext
+{
+public:
+
+    /** Records result of test item into ring of pending events.  This may be
+     called from an interrupt handler.  It does not update the UnitTest; that
+     happens when the event is pumped.
+     @param test Pointer to UnitTest which gets the item.
+     @param file Name of source code file.
+     @param line Source code line.
+     @param level Severity level of test item.
+     @param pass True if test item passed.
+     @param expression Conditional expression that was evaluated.
+     @param message Optional message placed into output.  This must remain
+      alive until the event is pumped.
+     @return True if test item passed.
+     */
+    bool Record( UnitTest * test, const char * file, unsigned int line,
+        UnitTest::TestLevel level, bool pass, const char * expression,
+        const char * message );
+
+    /// Returns # of items recorded into ring, including ones already pumped.
+    inline unsigned int GetRecordCount( void ) const { return m_recordCount; }
+    /// Returns # of recorded items which did not pass.
+    inline unsigned int GetFailCount( void ) const { return m_failCount; }
+    /// Returns # of items dropped because ring was full.
+    inline unsigned int GetDropCount( void ) const { return m_dropCount; }
+    /// Returns max # of events ring can hold before pumping.
+    inline unsigned int GetCapacity( void ) const { return m_size - 1; }
+
+private:
+
+    friend class UnitTestSet;
+    friend class UnitTestSetImpl;
+
+    /// Pending test item stored in the ring.
+    struct Event
+    {
+        UnitTest * m_test;
+        const char * m_file;
+        const char * m_expression;
+        const char * m_message;
+        unsigned int m_line;
+        UnitTest::TestLevel m_level;
+        bool m_pass;
+    };
+
+    /// Not implemented.
+    InterruptContext( void );
+    /// Not implemented.
+    InterruptContext( const InterruptContext & that );
+    /// Not implemented.
+    InterruptContext & operator = ( const InterruptContext & that );
+
+    /** Allocates ring for given number of pending events.  This may throw if
+     it can't allocate the ring.
+     */
+    explicit InterruptContext( unsigned int capacity );
+
+    /// Releases ring.  Any events still in ring are lost.
+    ~InterruptContext( void );
+
+    /** Sends all pending events to UnitTest::DoTest.  Called only from a
+     normal-priority context.
+     @return Number of events sent.
+     */
+    unsigned int Pump( void );
+
+    Event * m_events;                     ///< Ring of pending events.
+    unsigned int m_size;                  ///< # of slots in ring.
+    volatile unsigned int m_head;         ///< Next slot producer writes.
+    volatile unsigned int m_tail;         ///< Next slot consumer reads.
+    volatile unsigned int m_recordCount;  ///< # of items recorded.
+    volatile unsigned int m_failCount;    ///< # of recorded items which failed.
+    volatile unsigned int m_dropCount;    ///< # of items dropped when full.
+};
+
+// ----------------------------------------------------------------------------
+
 /** @class UnitTestSet
  @brief Maintains collection of unit tests, and sends test results to a single
   receiver.  This version of UnitTestSet does not send output to cout, cerr, a
@@ -445,6 +591,13 @@ private:
  receiver to provide information about a UnitTest, or summary information once
  all tests are done. If the receiver returns false, it will not be called by
  UnitTestSet again.
+
+ @par Interrupt Contexts
+ Interrupt handlers and real-time callbacks must not call the receiver, so they
+ record test items into an InterruptContext via the UNIT_TEST_ISR macros.  The
+ host program calls UnitTestSet::PumpInterruptEvents from a normal-priority
+ context to send those items to the receiver.  OutputSummary also pumps any
+ pending events before it makes the summary table.
  */
 
 class UnitTestSet
@@ -550,6 +703,24 @@ public:
      */
     bool SetReceiver( UnitTestResultReceiver * receiver );
 
+    /** Creates a context which an interrupt handler or real-time callback uses
+     to record test items without blocking.  Call this from a normal-priority
+     context before the interrupt handler needs it.  The UnitTestSet owns the
+     context, and deletes it when the singleton is destroyed.  This provides
+     strong exception safety.
+     @param capacity Max # of events which may wait in the context between
+      calls to PumpInterruptEvents.
+     @return Pointer to new context, or NULL if capacity is zero.
+     */
+    InterruptContext * AddInterruptContext( unsigned int capacity );
+
+    /** Sends events waiting in all interrupt contexts to the receiver.  Call
+     this only from a normal-priority context.  Complexity is O(E) where E is
+     the number of pending events.
+     @return Number of events sent.
+     */
+    unsigned int PumpInterruptEvents( void );
+
     /// Returns true if this has the output option(s) specified.
     bool DoesOutputOption( UnitTestSet::OutputOptions options ) const;
 
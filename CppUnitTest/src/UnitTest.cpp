@@ -17,21 +17,54 @@
 
 #include "../include/UnitTest.hpp"
 
+#include <math.h>
 #include <time.h>
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 
+#include <new>
+#include <queue>
 #include <string>
 #include <vector>
-#include <iomanip>
+#include <utility>
 #include <ostream>
 #include <fstream>
 #include <iterator>
 #include <iostream>
-#include <strstream>
 #include <algorithm>
 #include <functional>
 
+#if defined( _WIN32 )
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+    #include <direct.h>
+    #include <process.h>
+    #include <sys/timeb.h>
+#else
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <regex.h>
+    #include <sched.h>
+    #include <signal.h>
+    #include <unistd.h>
+    #include <pthread.h>
+    #include <sys/time.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/wait.h>
+    #include <sys/types.h>
+    #include <sys/select.h>
+    #include <sys/resource.h>
+#endif
+
+#if defined( __linux__ )
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <linux/perf_event.h>
+#endif
+
 
 // ----------------------------------------------------------------------------
 
@@ -41,10 +74,22 @@
     #define DEBUG_CODE( code ) ;
 #endif
 
+// Thread-local storage, since C++03 has no keyword for it.
+#define THREAD_LOCAL UNIT_TEST_THREAD_LOCAL
+
 // define nullptr even though new compilers will have this keyword just so we
 // have a consistent and easy way of identifying which uses of 0 mean null.
 #define nullptr 0
 
+#if defined( __GNUC__ ) && defined( __ELF__ )
+// The linker defines these around the section which holds records made by
+// UNIT_TEST_CASE.  They are weak so programs without any records still link.
+extern "C" const ut::StaticUnitTest __start_ut_cases[]
+    __attribute__(( weak, visibility( "hidden" ) ));
+extern "C" const ut::StaticUnitTest __stop_ut_cases[]
+    __attribute__(( weak, visibility( "hidden" ) ));
+#endif
+
 using namespace ::std;
 
 namespace
@@ -68,6 +113,25 @@ inline bool IsEmptyString( const char * s )
 
 // ----------------------------------------------------------------------------
 
+/** Returns wall-clock time in seconds.  Only differences between two calls
+ are meaningful.  Resolution is microseconds on POSIX systems, and
+ milliseconds on Windows.
+ */
+double GetWallClockTime( void )
+{
+#if defined( _WIN32 )
+    struct _timeb now;
+    ::_ftime( &now );
+    return static_cast< double >( now.time ) + now.millitm / 1000.0;
+#else
+    struct timeval now;
+    ::gettimeofday( &now, nullptr );
+    return static_cast< double >( now.tv_sec ) + now.tv_usec / 1000000.0;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
 /// Actual container of UnitTest pointers.
 typedef std::vector< ut::UnitTest * > TUnitTestChildren;
 
@@ -86,6 +150,18 @@ typedef TUnitTestReceiverSet::iterator TUnitTestReceiverSetIter;
 /// Iterator across container of UnitTest pointers.
 typedef TUnitTestReceiverSet::const_iterator TUnitTestReceiverSetCIter;
 
+/// A UnitTest and its body which RunUnitTests will call.
+typedef std::pair< ut::UnitTest *, ut::UnitTestFunction > TUnitTestRegistration;
+
+/// Container of UnitTest's waiting for RunUnitTests, in order registered.
+typedef std::vector< TUnitTestRegistration > TUnitTestRegistrations;
+
+/// Names of a dependent UnitTest and its prerequisite.
+typedef std::pair< std::string, std::string > TUnitTestDependency;
+
+/// Container of dependencies among registered UnitTest's.
+typedef std::vector< TUnitTestDependency > TUnitTestDependencies;
+
 // ----------------------------------------------------------------------------
 
 /// Returns the color associated with the test result.
@@ -98,6 +174,7 @@ const char * GetColor( ut::TestResult::EnumType result )
         case ut::TestResult::Failed:  return "red";
         case ut::TestResult::Fatal:   return "red";
         case ut::TestResult::Thrown:  return "red";
+        case ut::TestResult::Skipped: return "gray";
         default: break;
     }
     return "white";
@@ -131,14 +208,15 @@ ut::TestResult::EnumType Convert( ut::UnitTest::TestLevel level, bool pass )
  */
 struct HtmlResultColors
 {
-    HtmlResultColors( unsigned int itemCount, unsigned int passCount,
-        unsigned int warnCount, unsigned int failCount,
-        unsigned int tossCount );
+    HtmlResultColors( ut::ItemCount itemCount, ut::ItemCount passCount,
+        ut::ItemCount warnCount, ut::ItemCount failCount,
+        ut::ItemCount tossCount, ut::ItemCount skipCount = 0 );
 
     const char * failColor;
     const char * warnColor;
     const char * passColor;
     const char * tossColor;
+    const char * skipColor;
     const char * testColor;
     const char * textColor;  ///< Default text color.
     const char * testResult;
@@ -146,13 +224,14 @@ struct HtmlResultColors
 
 //  HtmlResultColors::HtmlResultColors ----------------------------------------
 
-HtmlResultColors::HtmlResultColors( unsigned int itemCount,
-    unsigned int passCount, unsigned int warnCount, unsigned int failCount,
-    unsigned int tossCount ) :
+HtmlResultColors::HtmlResultColors( ut::ItemCount itemCount,
+    ut::ItemCount passCount, ut::ItemCount warnCount, ut::ItemCount failCount,
+    ut::ItemCount tossCount, ut::ItemCount skipCount ) :
     failColor( ( 0 == failCount ) ? "green" : "red" ),
     warnColor( ( 0 == warnCount ) ? "green" : "yellow" ),
     passColor( ( 0 <  passCount ) ? "green" : "red" ),
     tossColor( ( 0 == tossCount ) ? "green" : "red" ),
+    skipColor( ( 0 == skipCount ) ? "green" : "gray" ),
     testColor( "green" ),
     textColor( "white" ),
     testResult( "Passed" )
@@ -162,6 +241,11 @@ HtmlResultColors::HtmlResultColors( unsigned int itemCount,
         testColor = "red";
         testResult = "FAILED";
     }
+    else if ( 0 < skipCount )
+    {
+        testColor = "gray";
+        testResult = "Skipped";
+    }
     else if ( 0 < warnCount )
     {
         testColor = "yellow";
@@ -264,6 +348,23 @@ void PrepFileName( const char * partialName, const char * timestamp,
 
 // --------------------------------------------------------------------------------------------
 
+/** Makes name of an output file which contains the timestamp.
+ @param[in] startTime Pointer to timestamp information.
+ @param[in] partialName Path and partial name of file.
+ @param[in] extension Extension added after timestamp, including the dot.
+ @param[out] fileName Name of file in format "name_YYYY_MM_DD_hh_mm_ss.ext".
+ */
+void MakeTimeStampedFileName( const time_t * startTime, const char * partialName,
+    const char * extension, string & fileName )
+{
+    const struct tm * timeStamp = ::localtime( startTime );
+    char buffer[ 128 ];
+    ::strftime( buffer, sizeof(buffer)-1, "_%Y_%m_%d_%H_%M_%S", timeStamp );
+    PrepFileName( partialName, buffer, extension, fileName );
+}
+
+// --------------------------------------------------------------------------------------------
+
 /** Makes filenames for text file, current HTML file, and for main HTML page.
  @param[in] timestamp Pointer to timestamp information.
  @param[in] textFilePartialName Path and partial name of text file.
@@ -389,20 +490,377 @@ void MakeColorTable( ofstream & output )
 
 // ----------------------------------------------------------------------------
 
-/** struct FChildNameFinder
- @brief Comparator decides if a UnitTest has a specific name.
+/// Calculates FNV-1a hash of a name, and provides length of name.
+unsigned int HashName( const char * name, size_t & length )
+{
+    assert( nullptr != name );
+    unsigned int hash = 2166136261u;
+    const char * here = name;
+    for ( ; '\0' != *here; ++here )
+    {
+        hash ^= static_cast< unsigned char >( *here );
+        hash *= 16777619u;
+    }
+    length = static_cast< size_t >( here - name );
+    return hash;
+}
+
+// ----------------------------------------------------------------------------
+
+/** Makes sure v can hold count elements without allocating again.  The vector
+ reserves exactly what is asked for, so asking for one more element at a time
+ would copy the whole vector on every add.  This at least doubles capacity.
+ */
+template < typename T >
+void ReserveGrowth( vector< T > & v, size_t count )
+{
+    if ( count <= v.capacity() )
+        return;
+    const size_t doubled = v.capacity() * 2;
+    v.reserve( ( count < doubled ) ? doubled : count );
+}
+
+// ----------------------------------------------------------------------------
+
+/** @class NamePool
+ @brief Stores copies of unit test names in large chunks so each name does not
+  need a separate allocation.  Names stay at the same address until Clear.
+ */
+class NamePool
+{
+public:
+
+    NamePool( void );
+    ~NamePool( void );
+
+    /** Makes sure the pool can copy a name of the given length without
+     allocating more memory.  This may throw, but does not change any name.
+     */
+    void Reserve( size_t length );
+
+    /** Copies name into pool.  Call Reserve first so this never throws.
+     @return Pointer to copy of name.
+     */
+    const char * Intern( const char * name, size_t length );
+
+    /// Releases all names.
+    void Clear( void );
+
+private:
+    /// Copy-constructor is not implemented.
+    NamePool( const NamePool & );
+    /// Copy-assignment operator is not implemented.
+    NamePool & operator = ( const NamePool & );
+
+    /// Default size of each chunk of characters.
+    static const size_t s_ChunkSize = 16384;
+
+    vector< char * > m_chunks; ///< Chunks of name characters.
+    char * m_next;             ///< Next unused character in last chunk.
+    size_t m_available;        ///< # of unused characters in last chunk.
+};
+
+// ----------------------------------------------------------------------------
+
+NamePool::NamePool( void ) :
+    m_chunks(),
+    m_next( nullptr ),
+    m_available( 0 )
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+NamePool::~NamePool( void )
+{
+    assert( nullptr != this );
+    Clear();
+}
+
+// ----------------------------------------------------------------------------
+
+void NamePool::Reserve( size_t length )
+{
+    assert( nullptr != this );
+    if ( length < m_available )
+        return;
+    const size_t size = ( s_ChunkSize <= length ) ? length + 1 : s_ChunkSize;
+    ReserveGrowth( m_chunks, m_chunks.size() + 1 );
+    char * chunk = new char[ size ];
+    m_chunks.push_back( chunk );
+    m_next = chunk;
+    m_available = size;
+}
+
+// ----------------------------------------------------------------------------
+
+const char * NamePool::Intern( const char * name, size_t length )
+{
+    assert( nullptr != this );
+    assert( length < m_available );
+    char * copy = m_next;
+    ::memcpy( copy, name, length );
+    copy[ length ] = '\0';
+    m_next += length + 1;
+    m_available -= length + 1;
+    return copy;
+}
+
+// ----------------------------------------------------------------------------
+
+void NamePool::Clear( void )
+{
+    assert( nullptr != this );
+    vector< char * >::iterator last( m_chunks.end() );
+    for ( vector< char * >::iterator it( m_chunks.begin() ); it != last; ++it )
+        delete [] *it;
+    m_chunks.clear();
+    m_next = nullptr;
+    m_available = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+/** @class UnitTestArena
+ @brief Provides raw storage for UnitTest's in blocks so each UnitTest does
+  not need a separate allocation.  Storage never moves, so pointers given to
+  the host program stay valid until Clear.  The arena does not construct or
+  destroy UnitTest's; UnitTestSetImpl does that since it is a friend.
+ */
+class UnitTestArena
+{
+public:
+
+    UnitTestArena( void );
+    ~UnitTestArena( void );
+
+    /** Makes sure the next call to Allocate will not need more memory.  This
+     may throw, but does not change any existing storage.
+     */
+    void Reserve( void );
+
+    /// Returns storage for one UnitTest.  Call Reserve first so it never throws.
+    void * Allocate( void );
+
+    /// Releases all storage.  Caller must destroy UnitTest's first.
+    void Clear( void );
+
+private:
+    /// Copy-constructor is not implemented.
+    UnitTestArena( const UnitTestArena & );
+    /// Copy-assignment operator is not implemented.
+    UnitTestArena & operator = ( const UnitTestArena & );
+
+    /// # of UnitTest's in each block.
+    static const unsigned int s_BlockSize = 256;
+
+    vector< void * > m_blocks; ///< Blocks of storage.
+    unsigned int m_used;       ///< # of slots used in last block.
+};
+
+// ----------------------------------------------------------------------------
+
+UnitTestArena::UnitTestArena( void ) :
+    m_blocks(),
+    m_used( s_BlockSize )
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+UnitTestArena::~UnitTestArena( void )
+{
+    assert( nullptr != this );
+    Clear();
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestArena::Reserve( void )
+{
+    assert( nullptr != this );
+    if ( m_used < s_BlockSize )
+        return;
+    ReserveGrowth( m_blocks, m_blocks.size() + 1 );
+    void * block = ::operator new( sizeof(ut::UnitTest) * s_BlockSize );
+    m_blocks.push_back( block );
+    m_used = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+void * UnitTestArena::Allocate( void )
+{
+    assert( nullptr != this );
+    assert( m_used < s_BlockSize );
+    char * block = static_cast< char * >( m_blocks.back() );
+    void * place = block + ( sizeof(ut::UnitTest) * m_used );
+    ++m_used;
+    return place;
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestArena::Clear( void )
+{
+    assert( nullptr != this );
+    vector< void * >::iterator last( m_blocks.end() );
+    for ( vector< void * >::iterator it( m_blocks.begin() ); it != last; ++it )
+        ::operator delete( *it );
+    m_blocks.clear();
+    m_used = s_BlockSize;
+}
+
+// ----------------------------------------------------------------------------
+
+/** @class UnitTestIndex
+ @brief Open-addressing hash table which finds UnitTest's by name.  It uses
+  linear probing, and grows when half full, so lookups and insertions take
+  O(1) operations on average.
  */
-struct FChildNameFinder : public unary_function< const ut::UnitTest *, bool >
+class UnitTestIndex
 {
-    inline explicit FChildNameFinder( const char * name )
-        : m_name( name ) {}
-    inline bool operator () ( const ut::UnitTest * pTest ) const
-    { return ( 0 == ::strcmp( pTest->GetName(), m_name ) ); }
-    const char * m_name;
+public:
+
+    UnitTestIndex( void );
+    ~UnitTestIndex( void );
+
+    /** Returns pointer to UnitTest with same name, or NULL if none match.
+     @param name Name of UnitTest.
+     @param hash Hash of name, as calculated by HashName.
+     */
+    ut::UnitTest * Find( const char * name, unsigned int hash ) const;
+
+    /** Makes sure table has room for count UnitTest's.  This may throw, but
+     the table remains unchanged if it does.
+     */
+    void Reserve( size_t count );
+
+    /// Adds UnitTest to table.  Call Reserve first so this never throws.
+    void Insert( ut::UnitTest * test, unsigned int hash );
+
+    /// Removes all entries.
+    void Clear( void );
+
+private:
+    /// Copy-constructor is not implemented.
+    UnitTestIndex( const UnitTestIndex & );
+    /// Copy-assignment operator is not implemented.
+    UnitTestIndex & operator = ( const UnitTestIndex & );
+
+    /// One slot within the table.  An empty slot has a NULL test pointer.
+    struct Slot
+    {
+        unsigned int m_hash;   ///< Hash of name, checked before comparing names.
+        ut::UnitTest * m_test; ///< Pointer to UnitTest, or NULL if slot is empty.
+    };
+
+    typedef vector< Slot > TSlots;
+
+    /// Minimum # of slots.  Must be a power of 2.
+    static const size_t s_MinSlotCount = 64;
+
+    /// Places entry into first empty slot at or after hash position.
+    static void Place( TSlots & slots, ut::UnitTest * test, unsigned int hash );
+
+    TSlots m_slots; ///< Table of slots.  Size is always zero or a power of 2.
+    size_t m_count; ///< # of slots in use.
 };
 
 // ----------------------------------------------------------------------------
 
+UnitTestIndex::UnitTestIndex( void ) :
+    m_slots(),
+    m_count( 0 )
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+UnitTestIndex::~UnitTestIndex( void )
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+ut::UnitTest * UnitTestIndex::Find( const char * name, unsigned int hash ) const
+{
+    assert( nullptr != this );
+    if ( m_slots.empty() )
+        return nullptr;
+    const size_t mask = m_slots.size() - 1;
+    for ( size_t place = ( hash & mask ); ; place = ( place + 1 ) & mask )
+    {
+        const Slot & slot = m_slots[ place ];
+        if ( nullptr == slot.m_test )
+            return nullptr;
+        if ( ( slot.m_hash == hash )
+          && ( 0 == ::strcmp( slot.m_test->GetName(), name ) ) )
+            return slot.m_test;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestIndex::Reserve( size_t count )
+{
+    assert( nullptr != this );
+    if ( count * 2 <= m_slots.size() )
+        return;
+    size_t size = ( m_slots.empty() ) ? s_MinSlotCount : m_slots.size();
+    while ( size < count * 2 )
+        size *= 2;
+
+    const Slot empty = { 0, nullptr };
+    TSlots slots( size, empty );
+    TSlots::const_iterator last( m_slots.end() );
+    for ( TSlots::const_iterator it( m_slots.begin() ); it != last; ++it )
+    {
+        if ( nullptr != it->m_test )
+            Place( slots, it->m_test, it->m_hash );
+    }
+    m_slots.swap( slots );
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestIndex::Insert( ut::UnitTest * test, unsigned int hash )
+{
+    assert( nullptr != this );
+    assert( ( m_count + 1 ) * 2 <= m_slots.size() );
+    Place( m_slots, test, hash );
+    ++m_count;
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestIndex::Place( TSlots & slots, ut::UnitTest * test,
+    unsigned int hash )
+{
+    const size_t mask = slots.size() - 1;
+    size_t place = ( hash & mask );
+    while ( nullptr != slots[ place ].m_test )
+        place = ( place + 1 ) & mask;
+    slots[ place ].m_hash = hash;
+    slots[ place ].m_test = test;
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestIndex::Clear( void )
+{
+    assert( nullptr != this );
+    TSlots empty;
+    m_slots.swap( empty );
+    m_count = 0;
+}
+
+// ----------------------------------------------------------------------------
+
 template < typename T >
 class InvariantChecker
 {
@@ -456,6 +914,56 @@ private:
 
 // ----------------------------------------------------------------------------
 
+/** @struct SoakTotals
+ @brief Item counts among all UnitTest's at one moment of a soak run.
+ */
+struct SoakTotals
+{
+    ut::ItemCount m_passCount;    ///< # of passed items.
+    ut::ItemCount m_warnCount;    ///< # of failed warning items.
+    ut::ItemCount m_failCount;    ///< # of failed items.
+    ut::ItemCount m_exceptCount;  ///< # of items which threw exceptions.
+    ut::ItemCount m_skipCount;    ///< # of skipped items.
+    ut::ItemCount m_itemCount;    ///< # of all items.
+};
+
+/** @struct SoakSnapshot
+ @brief What one soak snapshot shows.  See UnitTestSet::SetSoakMode.
+ */
+struct SoakSnapshot
+{
+    unsigned int m_number;        ///< Place of snapshot within run, from 1.
+    double m_runSeconds;          ///< Seconds since soak mode began.
+    double m_intervalSeconds;     ///< Seconds since last snapshot.
+    SoakTotals m_totals;          ///< Counts now.
+    SoakTotals m_deltas;          ///< Growth of counts since last snapshot.
+    unsigned int m_burstCount;    ///< Most failures within one burst.
+    double m_burstSeconds;        ///< Seconds into run when that burst began.
+    string m_failedTests;         ///< UnitTest's with new failures.
+};
+
+/// Adds item counts of a UnitTest to totals.
+void AddSoakTotals( SoakTotals & totals, const ut::UnitTest & test )
+{
+    totals.m_passCount += test.GetPassCount();
+    totals.m_warnCount += test.GetWarnCount();
+    totals.m_failCount += test.GetFailCount();
+    totals.m_exceptCount += test.GetExceptionCount();
+    totals.m_skipCount += test.GetSkipCount();
+    totals.m_itemCount += test.GetItemCount();
+}
+
+/// # of items recorded between checks of whether a soak snapshot is due.
+static const unsigned int s_SoakCheckItems = 256;
+
+/// Failures within this many seconds of the first one form one burst.
+static const double s_SoakBurstSeconds = 1.0;
+
+/// Most UnitTest's with new failures named within one soak snapshot.
+static const unsigned int s_MaxSoakNames = 10;
+
+// ----------------------------------------------------------------------------
+
 /** @class TextOutputter
  @brief A strategy class for sending unit test results to either a text file or
  to standard output.  Since the text file has identical content as standard
@@ -481,16 +989,47 @@ public:
     virtual bool ShowTimeStamp( bool isStartTime, const char * timestamp );
     virtual bool StartSummaryTable( void );
     virtual bool ShowTableLine( const ut::UnitTest * test );
-    virtual bool ShowTotalLine( unsigned int passCount, unsigned int warnCount,
-        unsigned int failCount, unsigned int exceptCount,
-        unsigned int itemCount );
-    virtual bool ShowSummaryLine( unsigned int passCount,
+    virtual bool ShowLongTotalLine( ut::ItemCount passCount,
+        ut::ItemCount warnCount, ut::ItemCount failCount,
+        ut::ItemCount exceptCount, ut::ItemCount skipCount,
+        ut::ItemCount itemCount );
+    virtual bool ShowSummaryLineWithSkips( unsigned int passCount,
         unsigned int warnCount, unsigned int failCount,
-        unsigned int exceptCount, unsigned int testCount );
+        unsigned int exceptCount, unsigned int skipCount,
+        unsigned int testCount );
+    virtual bool ShowFixtureLine( const char * fixtureName, bool isWorker,
+        unsigned int setUpCount, double setUpSeconds,
+        double tearDownSeconds );
+    virtual bool ShowInvariantLine( ut::ItemCount checks, double seconds,
+        unsigned int period );
     virtual bool EndSummaryTable( void );
+    virtual void FinalEnd( void );
 
     inline void SetFileName( const char * name ) { m_filename = name; }
 
+    /** Decides when buffered output gets sent to the streams.  Any output
+     already buffered is sent before the policy changes.
+     @param policy When to send output.
+     @param milliseconds Time between flushes for FlushInterval policy.
+     */
+    void SetFlushPolicy( ut::UnitTestSet::FlushPolicy policy,
+        unsigned int milliseconds );
+
+    /// Sends buffered output to each stream and flushes them.
+    void Flush( void );
+
+    /** Flushes buffered output if the FlushInterval policy is in use and
+     enough time passed since the last flush.  This lets output go out on
+     time even while no lines are added, such as during runs of passing tests.
+     @param now Wall-clock time in seconds, which callers often already have.
+     */
+    void FlushIfDue( double now );
+
+    /** Shows a soak snapshot, and flushes it at once so anyone watching a
+     long run sees it.  See UnitTestSet::SetSoakMode.
+     */
+    void ShowSoakSnapshot( const SoakSnapshot & snapshot );
+
     inline const char * GetFileName( void ) const
     { return ( m_isOpen ) ? m_filename.c_str() : nullptr; }
 
@@ -503,6 +1042,8 @@ public:
 
     inline bool ShowDividers( void ) const { return m_showDividers; }
     inline bool DoesShowIndexes( void ) const { return m_showIndexes; }
+    inline bool DoesShowTimes( void ) const { return m_showTimes; }
+    inline bool DoesShowMemory( void ) const { return m_showMemory; }
 
 private:
     /// Default-constructor is not implemented.
@@ -512,6 +1053,46 @@ private:
     /// Copy-assignment operator is not implemented.
     TextOutputter & operator = ( const TextOutputter & );
 
+    /// Adds string to buffered output.
+    void Append( const char * s );
+
+    /// Adds string padded with spaces to width characters.
+    void Append( const char * s, unsigned int width, bool alignLeft );
+
+    /** Adds name into name column of summary table.  Names which do not fit
+     are cut short, so columns after the name stay on the same tab stops.
+     */
+    void AppendTableName( const char * name );
+
+    /// Adds number right-aligned and padded with spaces to width characters.
+    void Append( ut::ItemCount value, unsigned int width );
+
+    /// Adds seconds with 3 decimal places, right-aligned to width characters.
+    void AppendSeconds( double seconds, unsigned int width );
+
+    /// Adds kilobytes with a minus sign if negative, right-aligned to width.
+    void AppendKilobytes( long kilobytes, unsigned int width );
+
+    /** Adds a column for each performance counter in use.
+     @param test UnitTest whose counts are added, or NULL to add the names.
+     */
+    void AppendCounters( const ut::UnitTest * test );
+
+    /// Adds a line of totals at end of summary table.
+    void AppendTotals( const char * title, ut::ItemCount passCount,
+        ut::ItemCount warnCount, ut::ItemCount failCount,
+        ut::ItemCount exceptCount, ut::ItemCount skipCount,
+        ut::ItemCount totalCount );
+
+    /** Called after each complete line is buffered, and flushes if the policy
+     says it should.
+     @param isFailure True if line shows a failed or thrown item.
+     */
+    void Send( bool isFailure );
+
+    /// Buffer is flushed once it gets this big no matter what the policy is.
+    static const size_t s_MaxBufferSize = 65536;
+
     /// True if content is sent to standard output.
     bool m_sendToCout;
 
@@ -524,11 +1105,30 @@ private:
     /// True if this adds UnitTest index to each output line.
     bool m_showIndexes;
 
+    /// True if summary table shows real and virtual seconds.
+    bool m_showTimes;
+
+    /// True if summary table shows memory growth, peak, and page faults.
+    bool m_showMemory;
+
     /// Path and name of text output file.
     string m_filename;
-};
 
-// ----------------------------------------------------------------------------
+    /// Output not yet sent to streams.  It grows as needed, and keeps its
+    /// capacity after each flush.
+    string m_buffer;
+
+    /// When buffered output gets sent to streams.
+    ut::UnitTestSet::FlushPolicy m_flushPolicy;
+
+    /// Milliseconds between flushes for FlushInterval policy.
+    unsigned int m_flushInterval;
+
+    /// Time of most recent flush in seconds.
+    double m_lastFlush;
+};
+
+// ----------------------------------------------------------------------------
 
 /** @class HtmlOutputter
  @brief A strategy class for sending unit test results to an html file.
@@ -550,12 +1150,14 @@ public:
     virtual bool ShowTimeStamp( bool isStartTime, const char * timestamp );
     virtual bool StartSummaryTable( void );
     virtual bool ShowTableLine( const ut::UnitTest * test );
-    virtual bool ShowTotalLine( unsigned int passCount, unsigned int warnCount,
-        unsigned int failCount, unsigned int exceptCount,
-        unsigned int itemCount );
-    virtual bool ShowSummaryLine( unsigned int passCount,
+    virtual bool ShowLongTotalLine( ut::ItemCount passCount,
+        ut::ItemCount warnCount, ut::ItemCount failCount,
+        ut::ItemCount exceptCount, ut::ItemCount skipCount,
+        ut::ItemCount itemCount );
+    virtual bool ShowSummaryLineWithSkips( unsigned int passCount,
         unsigned int warnCount, unsigned int failCount,
-        unsigned int exceptCount, unsigned int testCount );
+        unsigned int exceptCount, unsigned int skipCount,
+        unsigned int testCount );
     virtual bool EndSummaryTable( void );
 
     inline bool DoesOutput( void ) const { return m_isOpen; }
@@ -630,12 +1232,14 @@ public:
     virtual bool ShowTimeStamp( bool isStartTime, const char * timestamp );
     virtual bool StartSummaryTable( void );
     virtual bool ShowTableLine( const ut::UnitTest * test );
-    virtual bool ShowTotalLine( unsigned int passCount, unsigned int warnCount,
-        unsigned int failCount, unsigned int exceptCount,
-        unsigned int itemCount );
-    virtual bool ShowSummaryLine( unsigned int passCount,
+    virtual bool ShowLongTotalLine( ut::ItemCount passCount,
+        ut::ItemCount warnCount, ut::ItemCount failCount,
+        ut::ItemCount exceptCount, ut::ItemCount skipCount,
+        ut::ItemCount itemCount );
+    virtual bool ShowSummaryLineWithSkips( unsigned int passCount,
         unsigned int warnCount, unsigned int failCount,
-        unsigned int exceptCount, unsigned int testCount );
+        unsigned int exceptCount, unsigned int skipCount,
+        unsigned int testCount );
     virtual bool EndSummaryTable( void );
 
     inline void SetFileName( const char * name ) { m_filename = name; }
@@ -664,2509 +1268,9615 @@ private:
 
 // ----------------------------------------------------------------------------
 
-}; // end anonymous namespace
-
-namespace ut
+/** @class JsonOutputter
+ @brief A strategy class for sending unit test results to a JSON Lines file.
+  Each event becomes one JSON object on one line.  Each line is built in a
+  buffer which keeps its capacity, so events do not allocate memory once the
+  buffer is big enough.
+ */
+class JsonOutputter : public FileOutputter, public ut::UnitTestResultReceiver
 {
+public:
 
-UnitTestSet * UnitTestSet::s_instance = nullptr;
+    JsonOutputter( void );
+    virtual ~JsonOutputter( void );
 
+    virtual bool Start( const char * name );
+    virtual bool ShowMessage( const ut::UnitTest * test,
+        const char * fileName, unsigned int line, const char * message );
+    virtual bool ShowTestHeader( const ut::UnitTest * test );
+    virtual bool ShowTestLine( const ut::UnitTest * test,
+        ut::TestResult::EnumType result, const char * fileName,
+        unsigned int line, const char * expression, const char * message );
+    virtual bool ShowTimeStamp( bool isStartTime, const char * timestamp );
+    virtual bool StartSummaryTable( void );
+    virtual bool ShowTableLine( const ut::UnitTest * test );
+    virtual bool ShowLongTotalLine( ut::ItemCount passCount,
+        ut::ItemCount warnCount, ut::ItemCount failCount,
+        ut::ItemCount exceptCount, ut::ItemCount skipCount,
+        ut::ItemCount itemCount );
+    virtual bool ShowSummaryLineWithSkips( unsigned int passCount,
+        unsigned int warnCount, unsigned int failCount,
+        unsigned int exceptCount, unsigned int skipCount,
+        unsigned int testCount );
+    virtual bool ShowFixtureLine( const char * fixtureName, bool isWorker,
+        unsigned int setUpCount, double setUpSeconds,
+        double tearDownSeconds );
+    virtual bool EndSummaryTable( void );
 
-// ----------------------------------------------------------------------------
+    inline void SetFileName( const char * name ) { m_filename = name; }
 
-const char * ut::TestResult::GetName( ut::TestResult::EnumType result )
-{
-    switch ( result )
-    {
-        case ut::TestResult::Passed:  return "Passed";
-        case ut::TestResult::Warning: return "Warning";
-        case ut::TestResult::Failed:  return "FAILED";
-        case ut::TestResult::Fatal:   return "FATAL";
-        case ut::TestResult::Thrown:  return "THROWN";
-        default: break;
-    }
-    return "UNKNOWN";
-}
+    inline const char * GetFileName( void ) const
+    { return ( m_isOpen ) ? m_filename.c_str() : nullptr; }
 
-// ----------------------------------------------------------------------------
+    inline bool DoesOutput( void ) const { return ( m_isOpen ); }
 
-/** @class UnitTestSetImpl
- @brief Contains implementation details for UnitTestSet singleton so those
- details are not exposed to host program.
- */
-class UnitTestSetImpl
-{
-public:
+private:
+    /// Copy-constructor is not implemented.
+    JsonOutputter( const JsonOutputter & );
+    /// Copy-assignment operator is not implemented.
+    JsonOutputter & operator = ( const JsonOutputter & );
 
-    /** Constructs storage for unit tests, and how to present test results.
-     @param testName Name of overall set of unit tests.
-     @param textFileName Path and part of filename used to store test results
-      in text form.  If neither NULL nor empty string, then test results are
-      sent to a text file.  This adds a timestamp into the filename and then
-      appends ".txt" extension onto the filename.
-     @param htmlFileName Path and part of filename used to store test results
-      in HTML form.  This is the filename of a "main page" of test results -
-      which contains links to one or more HTML files showing results of unit
-      test executions.  If neither NULL nor empty string, then test results are
-      sent to an html file.  This adds a timestamp into the filename and then
-      appends ".html" extension onto the filename.
-     @param xmlFileName Path and part of filename used to store test results
-      in XML form.  If neither NULL nor empty string, then test results are
-      sent to an XML file.  This adds a timestamp into the filename and then
-      appends ".xml" extension onto the filename.
-     @param options A bitfield of all possible output options - each bit is a
-      different option.
-     */
-    UnitTestSetImpl( const char * testName, const char * textFileName,
-        const char * htmlFileName, const char * xmlFileName,
-        ut::UnitTestSet::OutputOptions info );
+    /// Starts a new line with the given event name.
+    void StartEvent( const char * event );
 
-    /// Destructor goes through all the UnitTest's and deletes them.
-    ~UnitTestSetImpl( void );
+    /// Adds a string member with escaped value to current line.
+    void AddString( const char * name, const char * value );
 
-    /// Returns pointer to UnitTest that matches given name.
-    const ut::UnitTest * GetUnitTest( const char * unitTestName ) const;
+    /// Adds a numeric member to current line.
+    void AddNumber( const char * name, ut::ItemCount value );
 
-    /// Creates initial page header that precedes all test result output.
-    void StartOutput( void );
+    /// Adds a member with seconds to 6 decimal places to current line.
+    void AddSeconds( const char * name, double seconds );
 
-    /// Creates the header for a specific unit test.
-    void OutputTestHeader( const ut::UnitTest * test );
+    /// Adds pass, warning, fail, exception, skip, and total counts to line.
+    void AddCounts( ut::ItemCount passCount, ut::ItemCount warnCount,
+        ut::ItemCount failCount, ut::ItemCount exceptCount,
+        ut::ItemCount skipCount, ut::ItemCount totalCount );
 
-    /** Called to output test results for an individual unit test item.
-     @param test Pointer to UnitTest used to tabulate results.
-     @param result Severity level of test item.
-     @param fileName Name of source code file.
-     @param line Source code line.
-     @param expression Conditional expression that was evaluated.
-     @param message Optional message placed into output.
-     */
-    void OutputTestLine( ut::UnitTest * test, ut::TestResult::EnumType result,
-        const char * fileName, unsigned int line, const char * expression,
-        const char * message );
+    /// Ends current line and writes it to file.
+    void EndEvent( bool flushNow );
 
-    /** Called to output a text message, but not as part of test.
-     @param test Pointer to UnitTest used to tabulate results.
-     @param fileName Name of source code file.
-     @param line Source code line.
-     @param message Text message placed into output.
-     */
-    void OutputMessage( UnitTest * test, const char * fileName,
-        unsigned int line, const char * message );
+    /// Path and name of JSON output file.
+    string m_filename;
 
-    /// Sends summary information (timestamps & table) to output.
-    void OutputSummaryInfo( void );
+    /// Line being built.  It keeps its capacity between events.
+    string m_line;
+};
 
-    inline bool ShowPasses( void ) const { return m_showPasses; }
-    inline bool ShowWarnings( void ) const { return m_showWarnings; }
+// ----------------------------------------------------------------------------
 
-    inline unsigned int GetTestCount( void ) const { return m_testCount; }
-    inline unsigned int GetTestPassCount( void ) const { return m_testPassCount; }
-    inline unsigned int GetTestWarnCount( void ) const { return m_testWarnCount; }
-    inline unsigned int GetTestFailCount( void ) const { return m_testFailCount; }
-    inline unsigned int GetTestExceptCount( void ) const { return m_testExceptCount; }
+/** @class JUnitOutputter
+ @brief A strategy class for sending unit test results to an XML file in the
+  format used by JUnit, so continuous integration servers can read it.  Each
+  UnitTest gets exactly one testcase element, written when its summary table
+  line is shown, so items of UnitTests which take turns recording results
+  still land in one testcase.  Until then, only the failure, error, and
+  skipped elements of a UnitTest are kept, so passing UnitTests cost one bit
+  and one index each.  Testsuite totals are written as a fixed-width
+  placeholder and patched in place.
+ */
+class JUnitOutputter : public FileOutputter, public ut::UnitTestResultReceiver
+{
+public:
 
-    inline unsigned int GetItemCount( void ) const { return m_itemCount; }
-    inline unsigned int GetItemPassCount( void ) const { return m_itemPassCount; }
-    inline unsigned int GetItemWarnCount( void ) const { return m_itemWarnCount; }
-    inline unsigned int GetItemFailCount( void ) const { return m_itemFailCount; }
-    inline unsigned int GetItemExceptCount( void ) const { return m_itemExceptCount; }
+    JUnitOutputter( void );
+    virtual ~JUnitOutputter( void );
 
-    const char * GetTestName( void ) const { return m_testName.c_str(); }
+    virtual bool Start( const char * name );
+    virtual bool ShowTestLine( const ut::UnitTest * test,
+        ut::TestResult::EnumType result, const char * fileName,
+        unsigned int line, const char * expression, const char * message );
+    virtual bool StartSummaryTable( void );
+    virtual bool ShowTableLine( const ut::UnitTest * test );
+    virtual bool EndSummaryTable( void );
+    virtual void FinalEnd( void );
 
-    /** True if currently calling test result receivers or modifying container
-     of pointers to receivers.
+    /** Writes testcase of each UnitTest not written yet.  The UnitTestSet
+     calls this before UnitTest's are destroyed, since ShowTableLine is not
+     called for them if no summary table was made.
      */
-    inline bool IsUsingReceivers( void ) const { return m_usingReceivers; }
+    void ShowTestCases( const TUnitTestChildren & tests );
 
-    /// Checks if any class invariants were broken.
-    void CheckInvariants( void ) const;
+    inline void SetFileName( const char * name ) { m_filename = name; }
 
-private:
+    inline const char * GetFileName( void ) const
+    { return ( m_isOpen ) ? m_filename.c_str() : nullptr; }
 
-    friend class ut::UnitTestSet;
+    inline bool DoesOutput( void ) const { return ( m_isOpen ); }
 
-    /// Default-constructor is not implemented.
-    UnitTestSetImpl( void );
+private:
     /// Copy-constructor is not implemented.
-    UnitTestSetImpl( const UnitTestSetImpl & );
+    JUnitOutputter( const JUnitOutputter & );
     /// Copy-assignment operator is not implemented.
-    UnitTestSetImpl & operator = ( const UnitTestSetImpl & );
+    JUnitOutputter & operator = ( const JUnitOutputter & );
 
-    /// Clears contents associated with unit test results.
-    void Clear( void );
+    /// Returns elements kept for UnitTest until its testcase is written.
+    string & GetBody( const ut::UnitTest * test );
 
-    /// Sets up text file, standard-output, and html file receivers.
-    void SetupInternalReceivers( void );
+    /// Writes testcase element of UnitTest with any elements kept for it.
+    void WriteTestCase( const ut::UnitTest * test );
 
-    /// Adds start and stop timestamps to output.
-    void ShowTimeStamp( void );
+    /// Writes testsuite totals into placeholder and closes file.
+    void Finish( void );
 
-    /// Creates detail rows in the summary table - one row for each unit test.
-    void MakeTableRows( void );
+    /// Writes contents of m_line to file, and clears m_line.
+    void WriteLine( void );
 
-    /// Creates summary table for output.
-    void OutputSummaryTable( void );
+    /// Path and name of JUnit output file.
+    string m_filename;
 
-    /// Overall name of test.
-    string m_testName;
+    /// Name of set of unit tests, used as testsuite name and classname.
+    string m_suiteName;
 
-    /// First part of name of text test result file.
-    string m_textFilePartialName;
+    /// Line being built.  It keeps its capacity between events.
+    string m_line;
 
-    /// First part of name of html test result files.
-    string m_htmlFilePartialName;
+    /// True for each UnitTest index whose testcase was already written.
+    vector< bool > m_written;
 
-    /// First part of name of xml test result files.
-    string m_xmlFilePartialName;
+    /// For each UnitTest index, 1 + place of its elements in m_bodies, or 0.
+    vector< unsigned int > m_bodyOf;
 
-    /// Container of UnitTest's.
-    TUnitTestChildren m_tests;
+    /// Elements of UnitTest's which showed failures, errors, or skips.
+    vector< string > m_bodies;
 
-    /// Output handler for text files and standard output.
-    TextOutputter m_textOutput;
+    /// Where totals placeholder of testsuite is in file.
+    streampos m_totalsPos;
 
-    /// Output handler for HTML files.
-    HtmlOutputter m_htmlOutput;
+    unsigned int m_caseCount;    ///< # of testcase elements.
+    unsigned int m_failureCount; ///< # of testcases with failures.
+    unsigned int m_errorCount;   ///< # of testcases with errors.
+    unsigned int m_skipCount;    ///< # of testcases skipped.
+    double m_totalTime;          ///< Sum of testcase durations.
+};
 
-    /// Output handler for xml files.
-    XmlOutputter m_xmlOutput;
+// ----------------------------------------------------------------------------
 
-    /// Container of output receivers.
-    TUnitTestReceiverSet m_receivers;
+/** @class UnitTestAbort
+ @brief Thrown when a required item fails inside UnitTestSet::RunUnitTest with
+  the FatalEndsTest option.  Only RunUnitTest catches it, so it unwinds the
+  body of the current unit test and nothing else.
+ */
+struct UnitTestAbort
+{
+};
 
-    /// True if messages without test items are sent to output.
-    bool m_showMessages;
+// ----------------------------------------------------------------------------
 
-    /// True if this sends passing items to output.
-    bool m_showPasses;
+/// Kinds of events which a child process sends to its parent.
+enum IsolatedEventKind
+{
+    IsolatedItem      = 'T', ///< Sent from UnitTest::DoTest.
+    IsolatedException = 'X', ///< Sent from UnitTest::OnException.
+    IsolatedMessage   = 'M', ///< Sent from UnitTest::OutputMessage.
+    IsolatedSkip      = 'S', ///< Sent from UnitTest::Skip.
+    IsolatedFixture   = 'F', ///< Sent when child builds a fixture.
+    IsolatedEnd       = 'E'  ///< Unit test body finished.
+};
 
-    /// True if this sends warning items to output.
-    bool m_showWarnings;
+// ----------------------------------------------------------------------------
 
-    /// True if this shows UnitTest headers.
-    bool m_showHeaders;
+/** @struct IsolatedWorker
+ @brief Child process running the body of one UnitTest, as seen by parent.
+ */
+struct IsolatedWorker
+{
+    int m_pid;                 ///< Process id of child.
+    int m_pipe;                ///< Read end of pipe from child.
+    ut::UnitTest * m_test;     ///< UnitTest whose body the child runs.
+    unsigned int m_place;      ///< Place of UnitTest within RunUnitTests.
+    double m_startTime;        ///< Time in seconds when child started.
+    bool m_timedOut;           ///< True if child was killed at time limit.
+    std::string m_events;      ///< Events received from child so far.
+};
 
-    /// True if this adds beginning and ending timestamps.
-    bool m_showTimeStamp;
+/// Container of child processes running now.
+typedef std::vector< IsolatedWorker > TIsolatedWorkers;
 
-    /// True if this uses full weekday name (e.g. - "Friday", not "Fri").
-    bool m_useFullDayName;
+// ----------------------------------------------------------------------------
 
-    /// True if host program wants a summary table at end of output.
-    bool m_showFinalTable;
+/** @struct AsyncTask
+ @brief Async UnitTest body within the event loop of RunAsyncUnitTests.
+ */
+struct AsyncTask
+{
+    ut::UnitTest * m_test;            ///< UnitTest which body records into.
+    ut::AsyncUnitTestFunction m_body; ///< Function which does each step.
+    void * m_state;                   ///< Pointer passed to body.
+    ut::AsyncWait m_wait;             ///< What body waits for now.
+    double m_deadline;                ///< When wait ends, or negative if never.
+    bool m_ready;                     ///< True if body should be called now.
+    bool m_timedOut;                  ///< True if wait for descriptor expired.
+
+    AsyncTask( ut::UnitTest * test, ut::AsyncUnitTestFunction body,
+        void * state ) :
+        m_test( test ), m_body( body ), m_state( state ),
+        m_wait( ut::AsyncWait::Again() ), m_deadline( -1.0 ),
+        m_ready( false ), m_timedOut( false ) {}
+};
 
-    /// True if this made a page header already.
-    bool m_didPageHeader;
+/// Container of async UnitTest's, in order registered.
+typedef std::vector< AsyncTask > TAsyncTasks;
 
-    /** True if currently calling test result receivers or modifying container
-     of pointers to receivers.  UnitTestSetImpl will check this boolean flag to
-     prevent re-entrancy in case a receiver calls a function in UnitTest or
-     UnitTestSet.
-     */
-    bool m_usingReceivers;
+// ----------------------------------------------------------------------------
 
-    /// True if any unit test was exercised.
-    bool m_didAnyTest;
+#if defined( _WIN32 ) && defined( _WIN32_WINNT ) && ( 0x0600 <= _WIN32_WINNT )
+    /// Windows Vista and later have condition variables.
+    #define UNIT_TEST_CONDITION_VARIABLE
+#endif
 
-    /// True if ran through entire set of tests already.
-    bool m_didFirstRun;
+/** @class Monitor
+ @brief Mutex with one condition variable, for threads of stress tests.
+  Windows versions before Vista have no condition variable, so there it is
+  made from a manual-reset event and a count of how many waiters to release.
+  Callers always check their condition again after Wait, so waking more
+  threads than needed does no harm.
+ */
+class Monitor
+{
+public:
 
-    /// Storage for timestamp.
-    time_t m_startTime;
+    inline Monitor( void )
+    {
+#if defined( UNIT_TEST_CONDITION_VARIABLE )
+        ::InitializeCriticalSection( &m_section );
+        ::InitializeConditionVariable( &m_condition );
+#elif defined( _WIN32 )
+        ::InitializeCriticalSection( &m_section );
+        m_event = ::CreateEvent( nullptr, TRUE, FALSE, nullptr );
+        m_waiters = 0;
+        m_releases = 0;
+        m_generation = 0;
+#else
+        ::pthread_mutex_init( &m_mutex, nullptr );
+        ::pthread_cond_init( &m_condition, nullptr );
+#endif
+    }
 
-    /// Number of tests.
-    unsigned int m_testCount;
+    inline ~Monitor( void )
+    {
+#if defined( UNIT_TEST_CONDITION_VARIABLE )
+        ::DeleteCriticalSection( &m_section );
+#elif defined( _WIN32 )
+        ::CloseHandle( m_event );
+        ::DeleteCriticalSection( &m_section );
+#else
+        ::pthread_cond_destroy( &m_condition );
+        ::pthread_mutex_destroy( &m_mutex );
+#endif
+    }
 
-    /// Number of tests that passed.
-    unsigned int m_testPassCount;
+    inline void Lock( void )
+    {
+#if defined( _WIN32 )
+        ::EnterCriticalSection( &m_section );
+#else
+        ::pthread_mutex_lock( &m_mutex );
+#endif
+    }
 
-    /// Number of test with at least 1 warning.
-    unsigned int m_testWarnCount;
+    inline void Unlock( void )
+    {
+#if defined( _WIN32 )
+        ::LeaveCriticalSection( &m_section );
+#else
+        ::pthread_mutex_unlock( &m_mutex );
+#endif
+    }
 
-    /// Number of tests that failed.
-    unsigned int m_testFailCount;
+    /// Unlocks, waits until woken, and locks again.  Caller must hold lock.
+    inline void Wait( void )
+    {
+#if defined( UNIT_TEST_CONDITION_VARIABLE )
+        ::SleepConditionVariableCS( &m_condition, &m_section, INFINITE );
+#elif defined( _WIN32 )
+        // Only a WakeAll after this call starts may release this thread.
+        const unsigned long generation = m_generation;
+        ++m_waiters;
+        for ( ;; )
+        {
+            ::LeaveCriticalSection( &m_section );
+            ::WaitForSingleObject( m_event, INFINITE );
+            ::EnterCriticalSection( &m_section );
+            if ( ( 0 < m_releases ) && ( generation != m_generation ) )
+                break;
+        }
+        --m_waiters;
+        if ( 0 == --m_releases )
+            ::ResetEvent( m_event );
+#else
+        ::pthread_cond_wait( &m_condition, &m_mutex );
+#endif
+    }
 
-    /// Number of tests with exceptions.
-    unsigned int m_testExceptCount;
+    /// Wakes every thread within Wait.  Caller must hold lock.
+    inline void WakeAll( void )
+    {
+#if defined( UNIT_TEST_CONDITION_VARIABLE )
+        ::WakeAllConditionVariable( &m_condition );
+#elif defined( _WIN32 )
+        if ( 0 < m_waiters )
+        {
+            ++m_generation;
+            m_releases = m_waiters;
+            ::SetEvent( m_event );
+        }
+#else
+        ::pthread_cond_broadcast( &m_condition );
+#endif
+    }
 
-    /// Total # of items among all tests.
-    unsigned int m_itemCount;
+private:
 
-    /// Total # of passing items among all tests.
-    unsigned int m_itemPassCount;
+    /// Copy-constructor is not implemented.
+    Monitor( const Monitor & );
+    /// Copy-assignment operator is not implemented.
+    Monitor & operator = ( const Monitor & );
+
+#if defined( UNIT_TEST_CONDITION_VARIABLE )
+    CRITICAL_SECTION m_section;
+    CONDITION_VARIABLE m_condition;
+#elif defined( _WIN32 )
+    CRITICAL_SECTION m_section;
+    HANDLE m_event;               ///< Set while waiters are being released.
+    unsigned int m_waiters;       ///< # of threads within Wait.
+    unsigned int m_releases;      ///< # of waiters still to be released.
+    unsigned long m_generation;   ///< # of calls to WakeAll with waiters.
+#else
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_condition;
+#endif
+};
 
-    /// Total # of warning items among all tests.
-    unsigned int m_itemWarnCount;
+// ----------------------------------------------------------------------------
 
-    /// Total # of failing items among all tests.
-    unsigned int m_itemFailCount;
+/** @class MonitorLock
+ @brief Holds lock of a Monitor for the life of this object.  Does nothing if
+  given NULL, so callers need not check whether locking is needed.
+ */
+class MonitorLock
+{
+public:
 
-    /// Total # of items that had exceptions among all tests.
-    unsigned int m_itemExceptCount;
+    inline explicit MonitorLock( Monitor * monitor ) : m_monitor( monitor )
+    {
+        if ( nullptr != m_monitor )
+            m_monitor->Lock();
+    }
 
-    /// Buffer contains timestamp of when tests began.
-    char m_timeString[ 160 ];
-};
+    inline ~MonitorLock( void )
+    {
+        if ( nullptr != m_monitor )
+            m_monitor->Unlock();
+    }
 
-// ----------------------------------------------------------------------------
+private:
 
-} // end namespace ut
+    /// Copy-constructor is not implemented.
+    MonitorLock( const MonitorLock & );
+    /// Copy-assignment operator is not implemented.
+    MonitorLock & operator = ( const MonitorLock & );
 
-namespace
-{
+    Monitor * m_monitor;          ///< Monitor which is locked, or NULL.
+};
 
-// MainPageMaker -----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
 
-/** @class MainPageMaker Creates the main unit-test-result page with links to the
- other pages.
+/** @class StressRun
+ @brief State shared by the threads of one stress test.  Threads meet at a
+  barrier before each round, and the last one to arrive decides whether time
+  is up.
  */
-class MainPageMaker
+class StressRun
 {
 public:
 
-    /// Max # of rows allowed in main HTML page.
-    static const unsigned int s_MaxRowCount;
+    StressRun( ut::UnitTest * test, ut::StressUnitTestFunction body,
+        void * state, unsigned int threadCount, double seconds ) :
+        m_test( test ), m_body( body ), m_state( state ), m_monitor(),
+        m_threadCount( threadCount ), m_arrived( 0 ), m_round( 0 ),
+        m_stopped( false ), m_seconds( seconds ),
+        m_startTime( ut::LatencyHistogram::GetTime() ) {}
 
-    /** Constructor provides the parameters needed to make the main page.
-     @param[in] info Information about current test results.
-     @param[in] today Pointer to timestamp.
-     @param[in] mainpageFilename Name of html file for main page.
-     @param[in] outputFilename Name of html file for current test page.
+    /** Waits until every thread arrives, or until the run stops.
+     @return True if the thread should call the body once more.
      */
-    MainPageMaker( const ut::UnitTestSetImpl * info, const time_t * timestamp,
-        const char * mainpageFilename, const char * outputFilename );
-
-    /// Destructor.
-    ~MainPageMaker( void );
-
-    /// Return true if file is opened.
-    bool IsOpen( void ) const;
+    bool WaitForRound( void )
+    {
+        MonitorLock lock( &m_monitor );
+        if ( m_stopped )
+            return false;
+        if ( ++m_arrived == m_threadCount )
+        {
+            m_arrived = 0;
+            ++m_round;
+            if ( m_seconds <= ut::LatencyHistogram::GetTime() - m_startTime )
+                m_stopped = true;
+            m_monitor.WakeAll();
+        }
+        else
+        {
+            const unsigned long round = m_round;
+            while ( ( round == m_round ) && !m_stopped )
+                m_monitor.Wait();
+        }
+        return !m_stopped;
+    }
 
-    /** Adds current info to file content.  It first sends some of the existing file
-     contents into the output file stream, overwriting the existing file in the
-     process.  Once it gets to the first row in the test table, it adds the current
-     test information to the file stream.  Then it sends the next however many rows
-     from the table to output - but not more than the upper limit for the table.
-     The remaining rows are skipped, and any content after the table is sent to output.
-     @param[in] Contents of existing main page.
-     */
-    bool AddToContent( const string & fileContent );
+    /// Ends run after current round, and releases threads at the barrier.
+    void Stop( void )
+    {
+        MonitorLock lock( &m_monitor );
+        m_stopped = true;
+        m_monitor.WakeAll();
+    }
 
-    /// Creates HTML file of main test page.
-    bool CreateFile( void );
+    ut::UnitTest * m_test;            ///< UnitTest which body records into.
+    ut::StressUnitTestFunction m_body; ///< Function called by each thread.
+    void * m_state;                   ///< Pointer passed to body.
 
 private:
-    /// Not implemented.
-    MainPageMaker( void );
+
     /// Copy-constructor is not implemented.
-    MainPageMaker( const MainPageMaker & );
+    StressRun( const StressRun & );
     /// Copy-assignment operator is not implemented.
-    MainPageMaker & operator = ( const MainPageMaker & );
+    StressRun & operator = ( const StressRun & );
+
+    Monitor m_monitor;            ///< Guards barrier.
+    unsigned int m_threadCount;   ///< # of threads which meet at barrier.
+    unsigned int m_arrived;       ///< # of threads waiting at barrier.
+    unsigned long m_round;        ///< # of rounds started.
+    bool m_stopped;               ///< True once no more rounds start.
+    double m_seconds;             ///< How long to keep starting rounds.
+    double m_startTime;           ///< When run started, in seconds.
+};
 
-    /** Adds project totals from current test to table.  The row is color-coded
-     to match overall test results.  A link is placed in the row for the current
-     test page.
-     */
-    bool AddCurrentOutput( void );
+#if defined( _WIN32 )
+    typedef HANDLE ThreadHandle;
+    typedef unsigned int ( __stdcall * ThreadEntry )( void * );
+#else
+    typedef pthread_t ThreadHandle;
+    typedef void * ( * ThreadEntry )( void * );
+#endif
 
-    /// Makes ending tags for HTML table.
-    void MakeEndOfTable( void );
+/// Starts a thread which calls entry with data.  False if it could not.
+inline bool StartThread( ThreadHandle & handle, ThreadEntry entry,
+    void * data )
+{
+#if defined( _WIN32 )
+    const uintptr_t started = ::_beginthreadex( nullptr, 0, entry, data, 0,
+        nullptr );
+    handle = reinterpret_cast< HANDLE >( started );
+    return ( 0 != started );
+#else
+    return ( 0 == ::pthread_create( &handle, nullptr, entry, data ) );
+#endif
+}
 
-    /// File output stream used to make HTML file.
-    ofstream m_output;
+/// Waits until a thread ends.
+inline void JoinThread( ThreadHandle & handle )
+{
+#if defined( _WIN32 )
+    ::WaitForSingleObject( handle, INFINITE );
+    ::CloseHandle( handle );
+#else
+    ::pthread_join( handle, nullptr );
+#endif
+}
 
-    /// Name of output file.
-    const char * m_outputFilename;
+/** @struct StressWorker
+ @brief One thread of a stress test.
+ */
+struct StressWorker
+{
+    ut::UnitTestSetImpl * m_impl;     ///< Runs the rounds of this thread.
+    StressRun * m_run;                ///< State shared by all threads.
+    ut::StressThread * m_thread;      ///< Index and random numbers of thread.
+    ThreadHandle m_handle;            ///< Operating system thread.
+};
 
-    /// Pointer to timestamp.
-    const time_t * m_startTime;
+/// Container of threads of a stress test.
+typedef std::vector< StressWorker > TStressWorkers;
 
-    /// Pointer to implementation details for unit tests.
-    const ut::UnitTestSetImpl * m_info;
+/// Most threads allowed for a stress test, or for running property cases.
+static const unsigned int s_MaxStressThreads = 64;
+
+// ----------------------------------------------------------------------------
+
+/** @struct PropertyRun
+ @brief State shared by threads running cases of one property.  Threads take
+  cases in chunks, in order, and skip cases past the first known failure, so
+  the first failing case does not depend on how many threads run.
+ */
+struct PropertyRun
+{
+    ut::UnitTestSetImpl * m_impl; ///< Gets counts of each thread.
+    ut::UnitTest * m_test;        ///< UnitTest which checks the property.
+    const ut::PropertyRunner * m_property; ///< Runs each case.
+    unsigned int m_seed;          ///< Seed from which each case seed comes.
+    unsigned int m_caseCount;     ///< # of cases.
+    unsigned int m_nextCase;      ///< First case which no thread took yet.
+    unsigned int m_firstFailure;  ///< First failed case, or case count.
+    unsigned int m_threadCount;   ///< # of threads started so far.
+    Monitor m_monitor;            ///< Guards next case and first failure.
+
+    PropertyRun( ut::UnitTestSetImpl * impl, ut::UnitTest * test,
+        const ut::PropertyRunner & property, unsigned int seed,
+        unsigned int caseCount ) :
+        m_impl( impl ), m_test( test ),
+        m_property( &property ), m_seed( seed ), m_caseCount( caseCount ),
+        m_nextCase( 0 ), m_firstFailure( caseCount ), m_threadCount( 0 ),
+        m_monitor() {}
 };
 
-const unsigned int MainPageMaker::s_MaxRowCount = 90;
+/// # of cases each thread takes at once.
+static const unsigned int s_PropertyChunk = 32;
 
-// MainPageMaker::MainPageMaker ---------------------------------------------------------------
+/// Size of the last property case.  Sizes grow from 1 up to this.
+static const unsigned int s_MaxPropertySize = 100;
 
-MainPageMaker::MainPageMaker( const ut::UnitTestSetImpl * info,
-    const time_t * timestamp, const char * mainpageFilename,
-    const char * outputFilename ) :
-    m_output( mainpageFilename ),
-    m_outputFilename( outputFilename ),
-    m_startTime( timestamp ),
-    m_info( info )
-{
-    assert( nullptr != this );
-}
+/// Most calls to predicate while shrinking a counterexample.
+static const unsigned int s_MaxShrinkTries = 10000;
 
-// MainPageMaker::~MainPageMaker ---------------------------------------------------------------
+// ----------------------------------------------------------------------------
 
-MainPageMaker::~MainPageMaker( void )
+/** @class MappedFile
+ @brief Maps a whole file into memory for reading.  Pages are read from the
+  file only as they are touched, so files larger than memory may be mapped.
+ */
+class MappedFile
 {
-    assert( nullptr != this );
-}
+public:
 
-// MainPageMaker::IsOpen ----------------------------------------------------------------------
+    inline MappedFile( void ) :
+#if defined( _WIN32 )
+        m_file( INVALID_HANDLE_VALUE ), m_mapping( nullptr ),
+#else
+        m_descriptor( -1 ),
+#endif
+        m_data( nullptr ), m_size( 0 ) {}
 
-bool MainPageMaker::IsOpen( void ) const
-{
-    assert( nullptr != this );
-#if defined (_MSC_VER)
-    return m_output.is_open();
+    inline ~MappedFile( void ) { Close(); }
+
+    /// Maps file.  True if mapped, or if file is empty.
+    bool Open( const char * fileName )
+    {
+        Close();
+#if defined( _WIN32 )
+        m_file = ::CreateFileA( fileName, GENERIC_READ, FILE_SHARE_READ,
+            nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+        if ( INVALID_HANDLE_VALUE == m_file )
+            return false;
+        LARGE_INTEGER size;
+        if ( !::GetFileSizeEx( m_file, &size ) )
+            return false;
+        if ( 0 == size.QuadPart )
+            return true;
+        if ( static_cast< size_t >( -1 ) < static_cast< unsigned __int64 >(
+            size.QuadPart ) )
+            return false;
+        m_mapping = ::CreateFileMappingA( m_file, nullptr, PAGE_READONLY, 0, 0,
+            nullptr );
+        if ( nullptr == m_mapping )
+            return false;
+        m_data = static_cast< const char * >( ::MapViewOfFile( m_mapping,
+            FILE_MAP_READ, 0, 0, 0 ) );
+        if ( nullptr == m_data )
+            return false;
+        m_size = static_cast< size_t >( size.QuadPart );
 #else
-    // Have to cast away const because implementation for std::ofstream
-    // does not provide const version of is_open.
-    MainPageMaker * pThis = const_cast< MainPageMaker * >( this );
-    return pThis->m_output.is_open();
+        m_descriptor = ::open( fileName, O_RDONLY );
+        if ( m_descriptor < 0 )
+            return false;
+        struct stat status;
+        if ( ::fstat( m_descriptor, &status ) != 0 )
+            return false;
+        if ( 0 == status.st_size )
+            return true;
+        // A 32 bit program may not map a file larger than its address space.
+        if ( ( status.st_size < 0 ) || ( status.st_size != static_cast< off_t >(
+            static_cast< size_t >( status.st_size ) ) ) )
+            return false;
+        void * data = ::mmap( nullptr, static_cast< size_t >( status.st_size ),
+            PROT_READ, MAP_PRIVATE, m_descriptor, 0 );
+        if ( MAP_FAILED == data )
+            return false;
+        m_data = static_cast< const char * >( data );
+        m_size = static_cast< size_t >( status.st_size );
+    #if defined( MADV_SEQUENTIAL )
+        // Chunks are taken in order, so read ahead and drop pages behind.
+        ::madvise( data, m_size, MADV_SEQUENTIAL );
+    #endif
 #endif
-}
+        return true;
+    }
 
-// MainPageMaker::AddToContent ----------------------------------------------------------------
+    void Close( void )
+    {
+#if defined( _WIN32 )
+        if ( nullptr != m_data )
+            ::UnmapViewOfFile( m_data );
+        if ( nullptr != m_mapping )
+            ::CloseHandle( m_mapping );
+        if ( INVALID_HANDLE_VALUE != m_file )
+            ::CloseHandle( m_file );
+        m_file = INVALID_HANDLE_VALUE;
+        m_mapping = nullptr;
+#else
+        if ( nullptr != m_data )
+            ::munmap( const_cast< char * >( m_data ), m_size );
+        if ( 0 <= m_descriptor )
+            ::close( m_descriptor );
+        m_descriptor = -1;
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
 
-bool MainPageMaker::AddToContent( const string & fileContent )
-{
-    assert( nullptr != this );
+    inline const char * GetData( void ) const { return m_data; }
+    inline size_t GetSize( void ) const { return m_size; }
 
-    const char * content = fileContent.c_str();
-    // This should find start of the header row ...
-    const char * firstRow = FindSubString( content, "<tr>" );
-    if ( IsEmptyString( firstRow ) )
-        return CreateFile();
+private:
 
-    ++firstRow;
-    // and this should find start of the most recently added row.
-    firstRow = FindSubString( firstRow, "<tr>" );
-    if ( IsEmptyString( firstRow ) )
-        return CreateFile();
+    /// Copy-constructor is not implemented.
+    MappedFile( const MappedFile & );
+    /// Copy-assignment operator is not implemented.
+    MappedFile & operator = ( const MappedFile & );
 
-    string temp( content, firstRow );
-    m_output << temp;
-    if ( !AddCurrentOutput() )
-        return false;
+#if defined( _WIN32 )
+    HANDLE m_file;                ///< Handle of open file.
+    HANDLE m_mapping;             ///< Handle of file mapping.
+#else
+    int m_descriptor;             ///< Descriptor of open file, or -1.
+#endif
+    const char * m_data;          ///< Start of mapped file, or NULL.
+    size_t m_size;                ///< # of bytes in file.
+};
 
-    // decide if file already has more than enough rows.
-    const char * rowNow = firstRow;
-    const char * nextRow = rowNow;
-    const char * endOfTable = FindSubString( nextRow, "</table>" );
-    unsigned int count = 1; 
-    while ( count < s_MaxRowCount )
+// ----------------------------------------------------------------------------
+
+/// Bytes of case file within each chunk which a thread takes.
+static const size_t s_CaseChunkBytes = 1024 * 1024;
+
+/// Most characters of a row quoted within a message.
+static const unsigned int s_MaxRowQuote = 200;
+
+/// Marks a chunk whose # of lines is not known yet.
+static const unsigned long s_UnknownLines = static_cast< unsigned long >( -1 );
+
+/** @struct CaseFileRun
+ @brief State shared by threads reading one case file.  A row belongs to the
+  chunk which holds its first character.  Each thread tells how many lines a
+  chunk had once done with it, so the line number of a failed row can be
+  found without counting through the whole file.
+ */
+struct CaseFileRun
+{
+    ut::UnitTestSetImpl * m_impl; ///< Records items which passed.
+    ut::UnitTest * m_test;        ///< UnitTest which body records into.
+    ut::CaseFileFunction m_body;  ///< Function called for each row.
+    void * m_state;               ///< Pointer passed to body.
+    const char * m_fileName;      ///< Name of case file.
+    const char * m_data;          ///< Start of mapped file.
+    size_t m_size;                ///< # of bytes in file.
+    size_t m_start;               ///< Place of first row after header.
+    unsigned int m_headerRows;    ///< # of lines before first row.
+    char m_separator;             ///< Character between fields.
+    size_t m_chunkCount;          ///< # of chunks after header.
+    size_t m_nextChunk;           ///< First chunk which no thread took yet.
+    vector< unsigned long > m_chunkLines; ///< # of lines in each chunk.
+    unsigned long m_rowCount;     ///< # of rows passed to body.
+    bool m_stopped;               ///< True if no more chunks should start.
+    unsigned int m_threadCount;   ///< # of threads started so far.
+    Monitor m_monitor;            ///< Guards shared parts.
+
+    CaseFileRun( ut::UnitTest * test, ut::CaseFileFunction body, void * state,
+        const char * fileName, const MappedFile & file, char separator,
+        unsigned int headerRows ) :
+        m_impl( nullptr ), m_test( test ), m_body( body ), m_state( state ),
+        m_fileName( fileName ), m_data( file.GetData() ),
+        m_size( file.GetSize() ), m_start( 0 ), m_headerRows( headerRows ),
+        m_separator( separator ), m_chunkCount( 0 ), m_nextChunk( 0 ),
+        m_chunkLines(), m_rowCount( 0 ), m_stopped( false ),
+        m_threadCount( 0 ), m_monitor()
     {
-        nextRow = FindSubString( rowNow, "<tr>" );
-        if ( ( endOfTable < nextRow ) || IsEmptyString( nextRow ) )
+        for ( unsigned int ii = 0; ( ii < headerRows ) && ( m_start < m_size );
+            ++ii )
         {
-            // next row is past end of current table, so it must be inside next table.
-            break;
+            const void * end = ::memchr( m_data + m_start, '\n',
+                m_size - m_start );
+            m_start = ( nullptr == end ) ? m_size
+                : static_cast< const char * >( end ) - m_data + 1;
         }
-        rowNow = nextRow+1;
-        ++count;
+        m_chunkCount = ( m_size - m_start + s_CaseChunkBytes - 1 )
+            / s_CaseChunkBytes;
+        m_chunkLines.resize( m_chunkCount, s_UnknownLines );
     }
 
-    if ( ( count < s_MaxRowCount ) || IsEmptyString( nextRow ) )
-        m_output << firstRow;
-    else
-    {
-        temp.assign( firstRow, nextRow-firstRow );
-        m_output << temp;
-        m_output << endOfTable;
-    }
+private:
 
-    return true;
-}
+    /// Copy-constructor is not implemented.
+    CaseFileRun( const CaseFileRun & );
+    /// Copy-assignment operator is not implemented.
+    CaseFileRun & operator = ( const CaseFileRun & );
+};
 
-// MainPageMaker::AddCurrentOutput ------------------------------------------------------------
+/** @struct CaseCursor
+ @brief Which row a thread is calling the body for, so items which fail can
+  tell the line number and text of the row.
+ */
+struct CaseCursor
+{
+    CaseFileRun * m_run;          ///< Case file being read.
+    size_t m_chunk;               ///< Chunk which holds the row.
+    unsigned long m_line;         ///< # of lines before row within chunk.
+    const ut::CaseRow * m_row;    ///< Row passed to body.
+    unsigned long m_passes;       ///< Passed items not yet added to test.
+};
 
-bool MainPageMaker::AddCurrentOutput( void )
+/// Row which this thread calls a case file body for, or NULL.
+static THREAD_LOCAL CaseCursor * s_caseCursor = nullptr;
+
+// ----------------------------------------------------------------------------
+
+/** @struct FixtureSlot
+ @brief One copy of a fixture, either for the suite or for one worker.
+ */
+struct FixtureSlot
 {
-    assert( nullptr != this );
+    void * m_fixture;             ///< Fixture, or NULL if not built.
+    bool m_building;              ///< True while a thread builds fixture.
 
-    char buffer[ 128 ];
-    const unsigned int testCount = m_info->GetTestCount();
-    const unsigned int testFailCount = m_info->GetTestFailCount();
-    const unsigned int testTossCount = m_info->GetTestExceptCount();
-    const unsigned int testWarnCount = m_info->GetTestWarnCount();
-    const unsigned int testPassCount = m_info->GetTestPassCount();
-    const unsigned int itemPassCount = m_info->GetItemPassCount();
-    const unsigned int itemWarnCount = m_info->GetItemWarnCount();
-    const unsigned int itemFailCount = m_info->GetItemFailCount();
-    const unsigned int itemTossCount = m_info->GetItemExceptCount();
-    const unsigned int itemCount = m_info->GetItemCount();
-    HtmlResultColors colors( itemCount, itemPassCount, itemWarnCount,
-        itemFailCount, itemTossCount);
+    FixtureSlot( void ) : m_fixture( nullptr ), m_building( false ) {}
+};
 
-    const char * testName = m_info->GetTestName();
-    string filenameLink( "./");
-    filenameLink += FindFileNameInPath( m_outputFilename );
-    const struct tm * timeStamp = ::localtime( m_startTime );
-    ::strftime( buffer, sizeof(buffer)-1, s_testTimeStampFormatSpec,
-        timeStamp );
-    m_output << "<tr><td><a href=\'" << filenameLink << "\'>"
-             << buffer << "</a></td>" << endl;
-    m_output << "<td>" << testName << "</td>" << endl;
-    m_output << "<td><span style=\"color: " << colors.testColor << "\">"
-             << colors.testResult << "</span></td>" << endl;
+/** @struct Fixture
+ @brief A fixture declared via UnitTestSet::AddFixture, with its copies and
+  what building them cost.  Suite fixtures keep their copy in slot zero, and
+  worker fixtures keep one copy in the slot of each worker.
+ */
+struct Fixture
+{
+    string m_name;                ///< Name of fixture.
+    ut::UnitTestSet::FixtureScope m_scope; ///< Which threads share a copy.
+    ut::FixtureSetUpFunction m_setUp;      ///< Builds fixture.
+    ut::FixtureTearDownFunction m_tearDown; ///< Tears down fixture, or NULL.
+    void * m_state;               ///< Pointer passed to setUp and tearDown.
+    vector< FixtureSlot > m_slots; ///< Copies of fixture.
+    unsigned int m_setUpCount;    ///< # of times fixture was built.
+    double m_setUpSeconds;        ///< Seconds spent building fixture.
+    double m_tearDownSeconds;     ///< Seconds spent tearing down fixture.
+    bool m_usedByChild;           ///< True if a child process built it.
+};
 
-    m_output << "<td><span style=\"color: " << colors.passColor << "\">"
-             << itemPassCount << "</span></td>" << endl;
-    m_output << "<td><span style=\"color: " << colors.warnColor << "\">"
-             << itemWarnCount << "</span></td>" << endl;
-    m_output << "<td><span style=\"color: " << colors.failColor << "\">"
-             << itemFailCount << "</span></td>" << endl;
-    m_output << "<td><span style=\"color: " << colors.tossColor << "\">"
-             << itemTossCount << "</span></td>" << endl;
-    m_output << "<td><span style=\"color: " << colors.textColor << "\">"
-             << itemCount << "</span></td>" << endl;
+/// Container of fixtures, in order declared.
+typedef std::vector< Fixture > TFixtures;
 
-    m_output << "<td><span style=\"color: " << colors.passColor << "\">"
-             << testPassCount << "</span></td>" << endl;
-    m_output << "<td><span style=\"color: " << colors.warnColor << "\">"
-             << testWarnCount << "</span></td>" << endl;
-    m_output << "<td><span style=\"color: " << colors.failColor << "\">"
-             << testFailCount << "</span></td>" << endl;
-    m_output << "<td><span style=\"color: " << colors.tossColor << "\">"
-             << testTossCount << "</span></td>" << endl;
-    m_output << "<td><span style=\"color: " << colors.textColor << "\">"
-             << testCount << "</span></td></tr>" << endl;
+/** First worker slot given to threads which the library did not start.
+ Slots below this belong to threads started for stress tests, property
+ tests, and case files, so those threads reuse worker fixtures across runs.
+ */
+static const unsigned int s_FirstHostWorkerSlot = s_MaxStressThreads + 1;
 
-    return true;
-}
+/// Slot of this thread for worker fixtures, or zero if it has none yet.
+static THREAD_LOCAL unsigned int s_workerSlot = 0;
 
-// --------------------------------------------------------------------------------------------
+/// State of random # generator for sampled test items, or zero until seeded.
+static THREAD_LOCAL unsigned int s_sampleState = 0;
 
-bool MainPageMaker::CreateFile( void )
-{
-    assert( nullptr != this );
-
-// Time Stamp   Test Name   Result   Items   Items   Total   Tests   Tests   Total
-//                                   Passed  Failed  Items   Passed  Failed  Tests
+/// True while this thread records a sampled item, which takes the record lock.
+static THREAD_LOCAL bool s_lockSampledItem = false;
 
-    m_output << "<html><head><title>Unit Test Results</title></head>" << endl
-             << "<body bgcolor=black text=white>" << endl;
+/// Which calls of CheckInvariants do checks.  See SetInvariantPolicy.
+static ut::UnitTestSet::InvariantPolicy s_invariantPolicy =
+    ut::UnitTestSet::CheckAlways;
 
-    m_output << "<br><table border=1 cellspacing=0 cellpadding=3>" << endl;
-    m_output << "<caption><em>Unit Test Results</em></caption>" << endl;
-    m_output << "<tr><th>Time Stamp</th><th>Test Name</th><th>Result</th>"
-             << "<th>Items<br>Passed</th><th>Warning<br>Items</th>"
-             << "<th>Items<br>Failed</th>"
-             << "<th>Items<br>Thrown</th><th>Total<br>Items</th>"
-             << "<th>Tests<br>Passed</th><th>Tests w/<br>Warnings</th>"
-             << "<th>Tests<br>Failed</th>"
-             << "<th>Tests<br>Thrown</th><th>Total<br>Tests</th></tr>" << endl;
-    if ( !AddCurrentOutput() )
-        return false;
-    MakeEndOfTable();
+/// One call of this many does checks under the CheckEveryNth policy.
+static unsigned int s_invariantPeriod = 1;
 
-    return true;
-}
+/// Calls of CheckInvariants within this thread until it does checks again.
+static THREAD_LOCAL unsigned int s_invariantCountdown = 0;
 
-// --------------------------------------------------------------------------------------------
+/// True while this thread makes a summary check every invariant.
+static THREAD_LOCAL bool s_forceInvariants = false;
 
-void MainPageMaker::MakeEndOfTable( void )
+/** @struct InvariantTally
+ @brief How many calls of CheckInvariants within one thread did checks, and
+  how long they took.  Only that thread adds to the counts, so it needs no
+  lock.  Summaries note how much was already shown instead of resetting them.
+ */
+struct InvariantTally
 {
-    assert( nullptr != this );
+    ut::ItemCount m_checks;       ///< # of calls which did checks.
+    double m_seconds;             ///< Seconds spent doing checks.
+    ut::ItemCount m_shownChecks;  ///< # of checks already shown by summaries.
+    double m_shownSeconds;        ///< Seconds already shown by summaries.
 
-    m_output << "</table><br>" << endl;
-    MakeColorTable( m_output );
-    m_output << "</body>" << endl << "</html>" << endl;
-}
+    InvariantTally( void ) : m_checks( 0 ), m_seconds( 0.0 ),
+        m_shownChecks( 0 ), m_shownSeconds( 0.0 ) {}
+};
 
-// ----------------------------------------------------------------------------
+typedef std::vector< InvariantTally * > InvariantTallies;
 
-FileOutputter::FileOutputter( void ) :
-    m_outFile(),
-    m_isOpen( false )
+/** @struct InvariantCost
+ @brief Tally of each thread which checked invariants.  Tallies are never
+  deleted, since a thread may check invariants while statics are destroyed.
+ */
+struct InvariantCost
 {
-    assert( nullptr != this );
-}
+    Monitor m_lock;               ///< Guards list, since any thread adds one.
+    InvariantTallies m_tallies;   ///< Tally of each thread which did checks.
 
-// ----------------------------------------------------------------------------
+    InvariantCost( void ) : m_lock(), m_tallies() {}
+};
 
-FileOutputter::~FileOutputter( void )
+/// Tally of this thread, or nullptr until it first does checks.
+static THREAD_LOCAL InvariantTally * s_invariantTally = nullptr;
+
+/** @class InvariantTimer
+ @brief Adds time from when this is made until it is destroyed to the cost
+  of checking invariants.
+ */
+class InvariantTimer
 {
-    assert( nullptr != this );
-    Close();
-}
+public:
+    inline InvariantTimer( void ) :
+        m_start( ut::LatencyHistogram::GetTime() ) {}
+    ~InvariantTimer( void );
+private:
+    /// Copy-constructor is not implemented.
+    InvariantTimer( const InvariantTimer & );
+    /// Copy-assignment operator is not implemented.
+    InvariantTimer & operator = ( const InvariantTimer & );
+
+    double m_start;               ///< When check began, in seconds.
+};
 
 // ----------------------------------------------------------------------------
 
-bool FileOutputter::Open( const char * fileName )
+/// Ways the child process of a death test can end.
+enum DeathEnding
 {
-    assert( nullptr != this );
-    if ( IsEmptyString( fileName ) )
-        return false;
-    m_outFile.open( fileName, ios::out | ios::trunc );
-    m_isOpen = m_outFile.is_open();
-    return m_isOpen;
-}
+    DeathReturned = 'R', ///< Statement returned.
+    DeathThrew    = 'X', ///< Statement threw an exception.
+    DeathExited   = 'E', ///< Process called exit.
+    DeathSignaled = 'S'  ///< Process ended by a signal.
+};
 
 // ----------------------------------------------------------------------------
 
-void FileOutputter::Close( void )
+/** @struct MemorySample
+ @brief Memory use of this process at one moment.
+ */
+struct MemorySample
 {
-    assert( nullptr != this );
-    if ( m_isOpen )
-    {
-        m_outFile.close();
-        m_isOpen = false;
-    }
-}
+    unsigned long m_residentKb;   ///< Kilobytes of resident memory now.
+    unsigned long m_peakKb;       ///< Most kilobytes of resident memory yet.
+    unsigned long m_majorFaults;  ///< Page faults which read from disk.
+    unsigned long m_minorFaults;  ///< Page faults which did not.
+};
 
-// ----------------------------------------------------------------------------
+/** Reads memory use of this process from /proc/self/statm and getrusage.
+ Values which may not be read on this system are zero.
+ */
+void TakeMemorySample( MemorySample & sample );
 
-TextOutputter::TextOutputter( ::ut::UnitTestSet::OutputOptions options ) :
-    FileOutputter(),
-    UnitTestResultReceiver(),
-    m_sendToCout( 0 != ( options & ut::UnitTestSet::SendToCout ) ),
-    m_sendToCerr( 0 != ( options & ut::UnitTestSet::SendToCerr ) ),
-    m_showDividers( 0 != ( options & ut::UnitTestSet::Dividers ) ),
-    m_showIndexes( 0 != ( options & ut::UnitTestSet::AddTestIndex ) ),
-    m_filename()
-{
-    assert( nullptr != this );
-}
+/** Returns most kilobytes of resident memory used by this process, or by any
+ child process it waited for, such as isolated workers.
+ */
+unsigned long GetPeakRssOfRun( void );
 
 // ----------------------------------------------------------------------------
 
-TextOutputter::~TextOutputter( void )
+/** @struct CounterInfo
+ @brief Describes one perf_event counter.
+ */
+struct CounterInfo
 {
-    assert( nullptr != this );
-}
+    unsigned int m_type;          ///< Type of perf event.
+    unsigned long m_config;       ///< Which event within that type.
+    const char * m_name;          ///< Name shown in text and HTML tables.
+    const char * m_key;           ///< Name of XML attribute.
+};
 
 // ----------------------------------------------------------------------------
 
-bool TextOutputter::Start( const char * name )
+/** @class PerfCounters
+ @brief Performance counters for the thread which opened them, read through
+  the Linux perf_event interface.  On other systems no counter ever opens.
+ */
+class PerfCounters
 {
-    assert( nullptr != this );
-    assert( !IsEmptyString( name ) );
-    assert( !m_isOpen );
+public:
 
-    Open( m_filename.c_str() );
-    if ( !DoesOutput() )
-        return false;
-    const char * nameHeader = "Name of Unit Tests: ";
-    if ( m_sendToCout )
-    {
-        cout << nameHeader << name << endl << flush;
-    }
-    if ( m_sendToCerr )
-    {
-        cerr << nameHeader << name << endl << flush;
-    }
-    if ( m_isOpen )
-    {
-        m_outFile << nameHeader << name << endl << flush;
-    }
+    PerfCounters( void );
+    ~PerfCounters( void );
 
-    return true;
-}
+    /** Opens the hardware counters, or the software counters if not even one
+     hardware counter may be opened.
+     @return True if any counter opened.
+     */
+    bool Open( void );
 
-// ----------------------------------------------------------------------------
+    /** Opens for the calling thread the same counters other has open, so
+     counts of both may be added together.
+     @return True if any counter opened.
+     */
+    bool OpenLike( const PerfCounters & other );
 
-const char * CheckFilenameSize( const char * fileName, unsigned int & fieldSize )
-{
-    static const unsigned int s_maxfileNameSize = 256;
-    assert( fileName != nullptr );
-    const unsigned int fileNameSize = static_cast< unsigned int >
-        ( ::strlen( fileName ) );
-    fieldSize = min( fileNameSize, s_maxfileNameSize );
-    if ( fieldSize == s_maxfileNameSize )
-        fileName += ( fileNameSize - s_maxfileNameSize );
-    return fileName;
-}
+    /// Closes any open counters.
+    void Close( void );
 
-// ----------------------------------------------------------------------------
+    inline bool IsOpen( void ) const { return m_isOpen; }
 
-unsigned int CheckMessageSize( const char * s )
-{
-    static const unsigned int s_maxMessageSize = 400;
-    assert( s != nullptr );
-    const unsigned int messageSize = static_cast< unsigned int >( ::strlen( s ) );
-    const unsigned int fieldSize = min( messageSize, s_maxMessageSize );
-    return fieldSize;
-}
+    /// Reads running totals.  Counters which did not open read as zero.
+    void Read( double * values ) const;
 
-// ----------------------------------------------------------------------------
+    /// Returns information about a counter, or NULL if it did not open.
+    inline const CounterInfo * GetInfo( unsigned int which ) const
+    { return ( which < ut::UnitTest::CounterCount ) ? m_infos[ which ] : 0; }
 
-bool TextOutputter::ShowMessage( const ut::UnitTest * test,
-    const char * fileName, unsigned int line, const char * message )
-{
-    assert( nullptr != this );
-    if ( !DoesOutput() )
-        return false;
+private:
+    /// Copy-constructor is not implemented.
+    PerfCounters( const PerfCounters & );
+    /// Copy-assignment operator is not implemented.
+    PerfCounters & operator = ( const PerfCounters & );
 
-    char buffer[ 2048 ];
-    strstream content( buffer, sizeof(buffer) );
-    unsigned int fieldSize = 0;
-    fileName = CheckFilenameSize( fileName, fieldSize );
-    content << setw( fieldSize ) << fileName << '(' << line << ") : ";
-    if ( m_showIndexes )
-        content << test->GetIndex() << ' ';
-    fieldSize = CheckMessageSize( message );
-    content << setw( fieldSize ) << message << endl << ends;
+    /// Tries to open each counter in the list, and returns true if any did.
+    bool OpenList( const CounterInfo * infos, unsigned int count );
 
-    if ( m_sendToCout )
-    {
-        cout << buffer << flush;
-    }
-    if ( m_sendToCerr )
-    {
-        cerr << buffer << flush;
-    }
-    if ( m_isOpen )
-    {
-        m_outFile << buffer << flush;
-    }
+    /// Tries to open one counter at the given place, and returns true if so.
+    bool OpenOne( unsigned int which, const CounterInfo * info );
 
-    return true;
-}
+    int m_files[ ut::UnitTest::CounterCount ];  ///< Descriptor, or -1.
+    const CounterInfo * m_infos[ ut::UnitTest::CounterCount ]; ///< Or NULL.
+    bool m_isOpen;                ///< True if any counter is open.
+};
 
 // ----------------------------------------------------------------------------
 
-bool TextOutputter::ShowTestHeader( const ut::UnitTest * test )
+/** @class WorkerCounters
+ @brief Counts events of one thread started for a stress test, a property,
+  or a case file, and adds them to the UnitTest when the thread is done.
+  Counters of the UnitTestSet count only the thread which opened them, so
+  each of these threads opens its own.  Nothing opens unless those are open.
+ */
+class WorkerCounters
 {
-    assert( nullptr != this );
-    if ( !DoesOutput() )
-        return false;
+public:
 
-    const unsigned int index = test->GetIndex();
-    const char * testName = test->GetName();
-    char buffer[ 1024 ];
-    strstream content( buffer, sizeof(buffer) );
-    content << "\nTest: " << setw( 3 ) << setfill( ' ' ) << index
-            << "\t\t" << testName << endl;
-    if ( m_showDividers )
-        content << s_DividerLine << endl;
-    content << ends;
+    WorkerCounters( ut::UnitTestSetImpl * impl, ut::UnitTest * test );
+    ~WorkerCounters( void );
 
-    if ( m_sendToCout )
-    {
-        cout << buffer << flush;
-    }
-    if ( m_sendToCerr )
-    {
-        cerr << buffer << flush;
-    }
-    if ( m_isOpen )
-    {
-        m_outFile << buffer << flush;
-    }
-    return true;
-}
+private:
+    /// Copy-constructor is not implemented.
+    WorkerCounters( const WorkerCounters & );
+    /// Copy-assignment operator is not implemented.
+    WorkerCounters & operator = ( const WorkerCounters & );
+
+    ut::UnitTestSetImpl * m_impl; ///< Adds counts to the UnitTest.
+    ut::UnitTest * m_test;        ///< UnitTest which gets the counts.
+    PerfCounters m_counters;      ///< Counters of this thread.
+    double m_start[ ut::UnitTest::CounterCount ]; ///< Counts at start.
+};
 
 // ----------------------------------------------------------------------------
 
-bool TextOutputter::ShowTestLine( const ut::UnitTest * test,
-    ut::TestResult::EnumType result, const char * fileName, unsigned int line,
-    const char * expression, const char * message )
-{
-    assert( nullptr != this );
+}; // end anonymous namespace
 
-    if ( !DoesOutput() )
-        return false;
+namespace ut
+{
 
-    const char * pResult = ut::TestResult::GetName( result );
-    char buffer[ 2048 ];
-    strstream content( buffer, sizeof(buffer) );
-    unsigned int fieldSize = 0;
-    fileName = CheckFilenameSize( fileName, fieldSize );
-    content << setw( fieldSize ) << fileName << '(' << line << ") : "
-        << setw( 8 ) << setfill( ' ' ) << pResult << "  ";
-    if ( m_showIndexes )
-    {
-        content << "  " << test->GetIndex() << ':' << test->GetItemCount();
-    }
-    else
-    {
-        content << setw( 4 ) << setfill( ' ' ) << test->GetItemCount();
-    }
-    fieldSize = CheckMessageSize( expression );
-    content << "  (" << setw( fieldSize ) << expression << ')';
-    if ( !IsEmptyString( message ) )
-    {
-        fieldSize = CheckMessageSize( message );
-        content << "  " << setw( fieldSize ) << message;
-    }
-    content << endl << ends;
+UnitTestSet * UnitTestSet::s_instance = nullptr;
 
-    if ( m_sendToCout )
-    {
-        cout << buffer << flush;
-    }
-    if ( m_sendToCerr )
-    {
-        cerr << buffer << flush;
-    }
-    if ( m_isOpen )
-    {
-        m_outFile << buffer << flush;
-    }
+const StaticUnitTestLink * StaticUnitTestLink::s_first = nullptr;
 
-    if ( ut::TestResult::Fatal == result )
-    {
-        char buffer2[ 256 ];
-        strstream content2( buffer2, sizeof(buffer2) );
-        content2 << "A required test failed!" << endl
-                 << "Unable to safely execute further tests!" << endl
-                 << "Program must exit now!" << endl << ends;
-        if ( m_sendToCout )
-        {
-            cout << buffer2 << flush;
-        }
-        if ( m_sendToCerr )
-        {
-            cerr << buffer2 << flush;
-        }
-        if ( m_isOpen )
-        {
-            m_outFile << buffer2 << flush;
-        }
-    }
-    return true;
-}
 
 // ----------------------------------------------------------------------------
 
-bool TextOutputter::ShowTimeStamp( bool isStartTime, const char * timestamp )
+StaticUnitTestLink::StaticUnitTestLink( const StaticUnitTest & record ) :
+    m_record( record ),
+    m_next( s_first )
 {
-    assert( nullptr != this );
-    assert( !IsEmptyString( timestamp ) );
-
-    if ( !DoesOutput() )
-        return false;
-    const char * description =
-        ( isStartTime ) ? s_beginTimeMessage : s_endTimeStampMessage;
-    if ( m_sendToCout )
-    {
-        if ( isStartTime )
-            cout << endl;
-        cout << description << timestamp << endl << flush;
-    }
-    if ( m_sendToCerr )
-    {
-        if ( isStartTime )
-            cerr << endl;
-        cerr << description << timestamp << endl << flush;
-    }
-    if ( m_isOpen )
-    {
-        if ( isStartTime )
-            m_outFile << endl;
-        m_outFile << description << timestamp << endl << flush;
-    }
-
-    return true;
+    s_first = this;
 }
 
+
 // ----------------------------------------------------------------------------
 
-bool TextOutputter::StartSummaryTable( void )
+const char * ut::TestResult::GetName( ut::TestResult::EnumType result )
 {
-    assert( nullptr != this );
-    if ( !DoesOutput() )
-        return false;
-
-    static const char * const s_titleLine =
-        "\n\t#  Unit Test Name\t\tPassed\tWarning\tFailed\tThrown\tTested";
-    char buffer[ 256 ];
-    strstream content( buffer, sizeof(buffer) );
-    content << s_titleLine << endl;
-    if ( m_showDividers )
-        content << s_DividerLine << endl;
-    content << ends;
-
-    if ( m_sendToCout )
-    {
-        cout << buffer << flush;
-    }
-    if ( m_sendToCerr )
-    {
-        cerr << buffer << flush;
-    }
-    if ( m_isOpen )
+    switch ( result )
     {
-        m_outFile << buffer << flush;
+        case ut::TestResult::Passed:  return "Passed";
+        case ut::TestResult::Warning: return "Warning";
+        case ut::TestResult::Failed:  return "FAILED";
+        case ut::TestResult::Fatal:   return "FATAL";
+        case ut::TestResult::Thrown:  return "THROWN";
+        case ut::TestResult::Skipped: return "SKIPPED";
+        default: break;
     }
-    return true;
+    return "UNKNOWN";
 }
 
 // ----------------------------------------------------------------------------
 
-bool TextOutputter::ShowTableLine( const ut::UnitTest * test )
-{
-    assert( nullptr != this );
-
+/** @class UnitTestSetImpl
+ @brief Contains implementation details for UnitTestSet singleton so those
+ details are not exposed to host program.
+ */
+class UnitTestSetImpl
+{
+public:
+
+    /** Constructs storage for unit tests, and how to present test results.
+     @param testName Name of overall set of unit tests.
+     @param textFileName Path and part of filename used to store test results
+      in text form.  If neither NULL nor empty string, then test results are
+      sent to a text file.  This adds a timestamp into the filename and then
+      appends ".txt" extension onto the filename.
+     @param htmlFileName Path and part of filename used to store test results
+      in HTML form.  This is the filename of a "main page" of test results -
+      which contains links to one or more HTML files showing results of unit
+      test executions.  If neither NULL nor empty string, then test results are
+      sent to an html file.  This adds a timestamp into the filename and then
+      appends ".html" extension onto the filename.
+     @param xmlFileName Path and part of filename used to store test results
+      in XML form.  If neither NULL nor empty string, then test results are
+      sent to an XML file.  This adds a timestamp into the filename and then
+      appends ".xml" extension onto the filename.
+     @param options A bitfield of all possible output options - each bit is a
+      different option.
+     */
+    UnitTestSetImpl( const char * testName, const char * textFileName,
+        const char * htmlFileName, const char * xmlFileName,
+        ut::UnitTestSet::OutputOptions info );
+
+    /// Destructor goes through all the UnitTest's and deletes them.
+    ~UnitTestSetImpl( void );
+
+    /// Returns pointer to UnitTest that matches given name.
+    const ut::UnitTest * GetUnitTest( const char * unitTestName ) const;
+
+    /** Returns pointer to UnitTest that matches given name, or makes a new one
+     if none match.  This provides strong exception safety.
+     */
+    ut::UnitTest * AddUnitTest( const char * unitTestName );
+
+    /// Creates initial page header that precedes all test result output.
+    void StartOutput( void );
+
+    /// Creates the header for a specific unit test.
+    void OutputTestHeader( const ut::UnitTest * test );
+
+    /** Called to output test results for an individual unit test item.
+     @param test Pointer to UnitTest used to tabulate results.
+     @param result Severity level of test item.
+     @param fileName Name of source code file.
+     @param line Source code line.
+     @param expression Conditional expression that was evaluated.
+     @param message Optional message placed into output.
+     */
+    void OutputTestLine( ut::UnitTest * test, ut::TestResult::EnumType result,
+        const char * fileName, unsigned int line, const char * expression,
+        const char * message );
+
+    /** Called to output a text message, but not as part of test.
+     @param test Pointer to UnitTest used to tabulate results.
+     @param fileName Name of source code file.
+     @param line Source code line.
+     @param message Text message placed into output.
+     */
+    void OutputMessage( UnitTest * test, const char * fileName,
+        unsigned int line, const char * message );
+
+    /// Sends summary information (timestamps & table) to output.
+    void OutputSummaryInfo( void );
+
+    /// Checks invariants of this and every UnitTest regardless of policy.
+    void CheckAllInvariants( void ) const;
+
+    /** Sends what checking invariants cost since the last summary table to a
+     receiver.  Does nothing if no checks were done, as in builds which do
+     not check invariants.
+     */
+    bool ShowInvariantLine( UnitTestResultReceiver * receiver,
+        ItemCount checks, double seconds ) const;
+
+    inline bool ShowPasses( void ) const { return m_showPasses; }
+    inline bool ShowWarnings( void ) const { return m_showWarnings; }
+
+    inline unsigned int GetTestCount( void ) const { return m_testCount; }
+    inline unsigned int GetTestPassCount( void ) const { return m_testPassCount; }
+    inline unsigned int GetTestWarnCount( void ) const { return m_testWarnCount; }
+    inline unsigned int GetTestFailCount( void ) const { return m_testFailCount; }
+    inline unsigned int GetTestExceptCount( void ) const { return m_testExceptCount; }
+    inline unsigned int GetTestSkipCount( void ) const { return m_testSkipCount; }
+
+    inline ItemCount GetItemCount( void ) const { return m_itemCount; }
+    inline ItemCount GetItemPassCount( void ) const { return m_itemPassCount; }
+    inline ItemCount GetItemWarnCount( void ) const { return m_itemWarnCount; }
+    inline ItemCount GetItemFailCount( void ) const { return m_itemFailCount; }
+    inline ItemCount GetItemExceptCount( void ) const { return m_itemExceptCount; }
+    inline ItemCount GetItemSkipCount( void ) const { return m_itemSkipCount; }
+
+    const char * GetTestName( void ) const { return m_testName.c_str(); }
+
+    /** True if currently calling test result receivers or modifying container
+     of pointers to receivers.
+     */
+    inline bool IsUsingReceivers( void ) const { return m_usingReceivers; }
+
+    /** True if a required item which fails in the given UnitTest should end
+     only that UnitTest instead of the program.
+     */
+    inline bool DoesFatalEndTest( const UnitTest * test ) const
+    {
+        return ( m_fatalEndsTest && ( nullptr != test )
+            && ( test == m_runningTest ) );
+    }
+
+    /// True if the given UnitTest is being unwound by a required failure.
+    inline bool IsAbortingTest( const UnitTest * test ) const
+    {
+        return ( nullptr != test ) && ( test == m_abortingTest );
+    }
+
+    /// Marks the given UnitTest as unwinding, and throws to RunUnitTest.
+    inline void AbortTest( UnitTest * test )
+    {
+        m_abortingTest = test;
+        throw UnitTestAbort();
+    }
+
+    /** Called when a required item fails and would end the program.  A
+     worker thread of a stress test or case file must not end the program
+     while other threads still run, so this unwinds it instead.  The thread
+     which joins the workers ends the program.  See EndIfFatalInThreads.
+     */
+    inline void AbortIfManyThreads( UnitTest * test )
+    {
+        if ( !m_manyThreads )
+            return;
+        m_fatalInThreads = true;
+        AbortTest( test );
+    }
+
+    /// Ends the program if a required item failed on a worker thread.
+    void EndIfFatalInThreads( void );
+
+    /// True if this is a child process which sends events to its parent.
+    inline bool IsIsolatedChild( void ) const { return ( 0 <= m_parentPipe ); }
+
+    /** Called within a child process to send an event to the parent instead
+     of to the receivers.  If the event is a fatal result, this ends the child
+     process, since the parent treats that as the end of the UnitTest.
+     */
+    void SendToParent( IsolatedEventKind kind, const UnitTest * test,
+        UnitTest::TestLevel level, bool pass, const char * fileName,
+        unsigned int line, const char * expression, const char * message );
+
+    /** Makes a child process which runs the body of a UnitTest.  The child
+     never returns from this function.
+     @return True if child started, or false if it could not.
+     */
+    bool StartWorker( UnitTest * test, UnitTestFunction body,
+        IsolatedWorker & worker );
+
+    /// True if this is a child process which runs a death test statement.
+    inline bool IsDeathChild( void ) const { return m_isDeathChild; }
+
+    /** Makes the child process for a death test.  The child sends its standard
+     error through a pipe, and records nothing.
+     @return True within the child.  False within this process, or if child
+      could not be made.
+     */
+    bool StartDeathChild( void );
+
+    /// Tells parent how the statement ended, and ends the child process.
+    void EndDeathChild( bool threw );
+
+    /** Reads standard error from the child of a death test, and waits for it
+     to end.
+     @param output Standard error of child.
+     @param ending How child ended, as a DeathEnding value.
+     @param value Exit code or signal number.
+     @return False if no child was made.
+     */
+    bool WaitForDeathChild( string & output, char & ending, int & value );
+
+    /** Returns kilobytes by which resident memory grew while a UnitTest was
+     current, including growth since it last became current.
+     */
+    long GetRssGrowth( const UnitTest * test ) const;
+
+    /** Calls one step of an async body, and works out when its next wait
+     ends.  Exceptions which escape the body are recorded as in RunUnitTest.
+     @return True if body wants to be called again.
+     */
+    bool StepAsyncTask( AsyncTask & task );
+
+    /** Waits until at least one async body is ready, and marks each body
+     which is ready or whose wait timed out.
+     */
+    void WaitForAsyncTasks( TAsyncTasks & tasks );
+
+    /** Moves virtual clock forward while async bodies wait, and adds that
+     time to the virtual time of each of their UnitTest's.
+     */
+    void AdvanceVirtualTime( TAsyncTasks & tasks, double seconds );
+
+    /** Returns lock which serializes recording of items while a stress test
+     or case file runs on many threads, or while a host thread records a
+     sampled item.  Returns NULL while only one thread records items.
+     */
+    inline Monitor * GetRecordLock( void )
+    {
+        if ( m_manyThreads )
+            return &m_recordLock;
+        if ( !s_lockSampledItem )
+            return nullptr;
+        // Only the outer call locks, so a receiver which records an item
+        // while the lock is held does not wait on itself.
+        s_lockSampledItem = false;
+        return &m_recordLock;
+    }
+
+    /// Flushes text output if the FlushInterval policy says it is due.
+    inline void FlushTextIfDue( void )
+    { m_textOutput.FlushIfDue( GetWallClockTime() ); }
+
+    /// Sends buffered text output now, such as before the program exits.
+    inline void FlushText( void ) { m_textOutput.Flush(); }
+
+    /** Starts threads of a stress test, waits for them to end, and records
+     the summary item.  See UnitTestSet::RunStressTest.
+     @return False if threads could not be made.
+     */
+    bool RunStressTest( StressRun & run, unsigned int threadCount,
+        unsigned int seed );
+
+    /// Calls body of stress test once for each round.  Runs on its own thread.
+    void RunStressThread( StressWorker & worker );
+
+    /// Returns counters which count events of the current UnitTest.
+    inline const PerfCounters & GetPerfCounters( void ) const
+    { return m_perfCounters; }
+
+    /// Adds counts of a thread which ran part of a UnitTest to that UnitTest.
+    void AddWorkerCounters( UnitTest * test, const double * counts );
+
+    /** Starts threads which read a case file, waits for them to end, and
+     records the summary item.  See UnitTestSet::RunCaseFile.
+     */
+    void RunCaseFile( CaseFileRun & run, unsigned int threadCount );
+
+    /// Returns # of cases for each property.
+    inline unsigned int GetPropertyCases( void ) const
+    { return m_propertyCases; }
+
+    /// Returns # of threads for property cases, or zero for each processor.
+    inline unsigned int GetPropertyThreads( void ) const
+    { return m_propertyThreads; }
+
+    /// Returns seed for property cases, or zero to pick one each time.
+    inline unsigned int GetPropertySeed( void ) const
+    { return m_propertySeed; }
+
+    /// Returns directory which holds golden files.
+    inline const string & GetSnapshotDirectory( void ) const
+    { return m_snapshotDirectory; }
+
+    /// Returns path of golden file with given name.
+    inline string GetSnapshotPath( const char * name ) const
+    { return m_snapshotDirectory + '/' + name; }
+
+    /// True if snapshots write golden files instead of comparing.
+    inline bool IsSnapshotUpdate( void ) const { return m_updateSnapshots; }
+
+    /** Returns fixture for this thread, and builds it first if needed.  See
+     UnitTestSet::GetFixture.
+     */
+    void * GetFixture( const char * fixtureName );
+
+    /** Builds each fixture which a child process built before, so later
+     children start with it instead of each building their own.  Fixtures no
+     child has used are not built.
+     */
+    void SetUpChildFixtures( void );
+
+    /** Adds the time a child process spent building a fixture, and marks the
+     fixture so later children get it from this process.
+     */
+    void AddChildFixture( const string & fixtureName, double seconds );
+
+    /// Tears down each fixture which was built.
+    void TearDownFixtures( void );
+
+    /** Shows a summary line for each fixture built since the last summary.
+     @return True if receiver wants more event notices.
+     */
+    bool ShowFixtureLines( UnitTestResultReceiver * receiver ) const;
+
+    /** Notes one more item for soak mode, and every so many items checks if
+     a soak snapshot is due.  Does nothing unless soak mode is on.
+     @param failed True if item failed or threw.
+     */
+    inline void CountSoakItem( bool failed )
+    {
+        if ( 0.0 == m_soakInterval )
+            return;
+        if ( failed )
+            CountSoakFailure();
+        if ( ++m_soakTicks < s_SoakCheckItems )
+            return;
+        m_soakTicks = 0;
+        CheckSoakTime();
+    }
+
+    /// Makes a soak snapshot if soak mode is on and one is due.
+    void CheckSoakTime( void );
+
+    /** Adds items which passed within a chunk of a case file to the test all
+     at once, so threads don't take the record lock for each row.
+     */
+    void AddCasePasses( UnitTest * test, unsigned long passes );
+
+    /// Adds a failed or thrown item to the current burst of failures.
+    void CountSoakFailure( void );
+
+    /** Makes a soak snapshot from counts of every UnitTest, without changing
+     them, and sends it to the text output.
+     */
+    void OutputSoakSnapshot( void );
+
+    /** Takes counts of every UnitTest as they are now, so the first soak
+     snapshot shows only growth since soak mode began.
+     */
+    void StartSoakCounts( void );
+
+    /** Waits until any child closes its pipe or runs past the time limit, and
+     reads events from each child as they arrive.  A child past the limit is
+     killed.  Returns place of child within container.
+     */
+    unsigned int WaitForWorker( TIsolatedWorkers & workers );
+
+    /** Reads remaining events from child, waits for it to end, and then sends
+     its events to the receivers.
+     */
+    void FinishWorker( IsolatedWorker & worker );
+
+    /** Called whenever a UnitTest records something.  If the UnitTest is not
+     the current one, this adds time since the last switch to the elapsed time
+     of the previous UnitTest, and makes the given one current.  This only
+     reads the clock when the current UnitTest changes.
+     @param test Pointer to UnitTest, or NULL to stop timing all tests.
+     */
+    inline void SwitchToTest( UnitTest * test )
+    {
+        if ( test != m_currentTest )
+            ChangeCurrentTest( test );
+    }
+
+    /// Checks if any class invariants were broken.
+    void CheckInvariants( void ) const;
+
+private:
+
+    friend class ut::UnitTestSet;
+
+    /// Default-constructor is not implemented.
+    UnitTestSetImpl( void );
+    /// Copy-constructor is not implemented.
+    UnitTestSetImpl( const UnitTestSetImpl & );
+    /// Copy-assignment operator is not implemented.
+    UnitTestSetImpl & operator = ( const UnitTestSetImpl & );
+
+    /// Clears contents associated with unit test results.
+    void Clear( void );
+
+    /// Clears totals which the summary table adds up from each UnitTest.
+    void ClearTableCounts( void );
+
+    /** Sends events from a child process to the receivers through the usual
+     UnitTest functions.  If child did not finish the body, this adds a
+     thrown item saying how the child ended.
+     */
+    void ReplayEvents( UnitTest * test, const string & events, int status,
+        bool timedOut );
+
+    /// Adds elapsed time to current UnitTest and then changes current one.
+    void ChangeCurrentTest( UnitTest * test );
+
+    /// Adds memory use since current UnitTest became current to a UnitTest.
+    void AddMemoryUse( UnitTest * test, const MemorySample & memory ) const;
+
+    /// Sets up text file, standard-output, and html file receivers.
+    void SetupInternalReceivers( void );
+
+    /// Adds start and stop timestamps to output.
+    void ShowTimeStamp( void );
+
+    /// Creates detail rows in the summary table - one row for each unit test.
+    void MakeTableRows( void );
+
+    /// Creates summary table for output.
+    void OutputSummaryTable( void );
+
+    /// Overall name of test.
+    string m_testName;
+
+    /// First part of name of text test result file.
+    string m_textFilePartialName;
+
+    /// First part of name of html test result files.
+    string m_htmlFilePartialName;
+
+    /// First part of name of xml test result files.
+    string m_xmlFilePartialName;
+
+    /// First part of name of JSON Lines test result files.
+    string m_jsonFilePartialName;
+
+    /// First part of name of JUnit test result files.
+    string m_junitFilePartialName;
+
+    /// Container of UnitTest's in order they were added.
+    TUnitTestChildren m_tests;
+
+    /// Storage for UnitTest objects.
+    UnitTestArena m_arena;
+
+    /// Storage for names of UnitTest's.
+    NamePool m_names;
+
+    /// Hash table to find UnitTest's by name.
+    UnitTestIndex m_index;
+
+    /// UnitTest which most recently recorded something, or NULL.
+    UnitTest * m_currentTest;
+
+    /// UnitTest whose body is called by RunUnitTest now, or NULL.
+    UnitTest * m_runningTest;
+
+    /// UnitTest which is being unwound after a required item failed, or NULL.
+    UnitTest * m_abortingTest;
+
+    /// UnitTest's registered for RunUnitTests, in order registered.
+    TUnitTestRegistrations m_registered;
+
+    /// True for index of each UnitTest within m_registered.
+    std::vector< bool > m_isRegistered;
+
+    /// Dependencies among UnitTest's for RunUnitTests.
+    TUnitTestDependencies m_dependencies;
+
+    /// Async UnitTest's registered for RunAsyncUnitTests.
+    TAsyncTasks m_async;
+
+    /// Maximum # of child processes, or zero if UnitTest's run in process.
+    unsigned int m_workerCount;
+
+    /// Seconds each child process may run, or zero for no limit.
+    double m_workerTimeout;
+
+    /// Write end of pipe to parent if this is a child process, else -1.
+    int m_parentPipe;
+
+    /// Process id of child running a death test, or -1.
+    int m_deathPid;
+
+    /// Read end of pipe from standard error of death test child, or -1.
+    int m_deathOutput;
+
+    /// Pipe telling how death test statement ended, or -1.
+    int m_deathStatus;
+
+    /// True if this is a child process running a death test statement.
+    bool m_isDeathChild;
+
+    /// Time in seconds when current UnitTest became current.
+    double m_switchTime;
+
+    /// Virtual time in seconds when current UnitTest became current.
+    double m_switchVirtual;
+
+    /// Clock which reads real time.
+    SystemClock m_systemClock;
+
+    /// Clock which moves only when told to.
+    VirtualClock m_virtualClock;
+
+    /// Either m_systemClock or m_virtualClock.
+    Clock * m_clock;
+
+    /// Performance counters for this process, if Counters option is on.
+    PerfCounters m_perfCounters;
+
+    /// Counts when current UnitTest became current.
+    double m_switchCounters[ UnitTest::CounterCount ];
+
+    /// Memory use when current UnitTest became current.
+    MemorySample m_switchMemory;
+
+    /// True if text and HTML summary tables show memory use.
+    bool m_showMemory;
+
+    /// Serializes recording of items by threads of a stress test or case file.
+    Monitor m_recordLock;
+
+    /// True while threads of a stress test or case file run.
+    bool m_manyThreads;
+
+    /// True if a required item failed on a stress test or case file thread.
+    bool m_fatalInThreads;
+
+    /// Most microseconds each stress thread waits before calling body.
+    unsigned int m_stressJitter;
+
+    /// Chance out of 100 that a stress thread yields.
+    unsigned int m_stressYield;
+
+    /// # of cases for each property.
+    unsigned int m_propertyCases;
+
+    /// # of threads for property cases, or zero for each processor.
+    unsigned int m_propertyThreads;
+
+    /// Seed for property cases, or zero to pick one each time.
+    unsigned int m_propertySeed;
+
+    /// Directory which holds golden files.
+    string m_snapshotDirectory;
+
+    /// True if snapshots write golden files instead of comparing.
+    bool m_updateSnapshots;
+
+    /// Fixtures declared via UnitTestSet::AddFixture.
+    TFixtures m_fixtures;
+
+    /// Guards fixtures, since any thread may get one.
+    Monitor m_fixtureLock;
+
+    /// Worker slot for next thread which the library did not start.
+    unsigned int m_nextWorkerSlot;
+
+    /// Seconds between soak snapshots, or zero if soak mode is off.
+    double m_soakInterval;
+
+    /// When soak mode began, in seconds.
+    double m_soakStart;
+
+    /// When last soak snapshot was made, in seconds.
+    double m_soakLast;
+
+    /// # of soak snapshots made.
+    unsigned int m_soakCount;
+
+    /// # of items since last check of whether a soak snapshot is due.
+    unsigned int m_soakTicks;
+
+    /// Counts at last soak snapshot.
+    SoakTotals m_soakTotals;
+
+    /// Failed and thrown items of each UnitTest at last soak snapshot.
+    vector< ItemCount > m_soakFailures;
+
+    /// When current burst of failures began, in seconds.
+    double m_burstStart;
+
+    /// # of failures within current burst.
+    unsigned int m_burstCount;
+
+    /// Most failures within one burst since last soak snapshot.
+    unsigned int m_peakBurst;
+
+    /// When burst with most failures since last soak snapshot began.
+    double m_peakBurstStart;
+
+    /// Output handler for text files and standard output.
+    TextOutputter m_textOutput;
+
+    /// Output handler for HTML files.
+    HtmlOutputter m_htmlOutput;
+
+    /// Output handler for xml files.
+    XmlOutputter m_xmlOutput;
+
+    /// Output handler for JSON Lines files.
+    JsonOutputter m_jsonOutput;
+
+    /// Output handler for JUnit files.
+    JUnitOutputter m_junitOutput;
+
+    /// Container of output receivers.
+    TUnitTestReceiverSet m_receivers;
+
+    /// True if messages without test items are sent to output.
+    bool m_showMessages;
+
+    /// True if this sends passing items to output.
+    bool m_showPasses;
+
+    /// True if this sends warning items to output.
+    bool m_showWarnings;
+
+    /// True if this shows UnitTest headers.
+    bool m_showHeaders;
+
+    /// True if this adds beginning and ending timestamps.
+    bool m_showTimeStamp;
+
+    /// True if this uses full weekday name (e.g. - "Friday", not "Fri").
+    bool m_useFullDayName;
+
+    /// True if host program wants a summary table at end of output.
+    bool m_showFinalTable;
+
+    /// True if a required failure ends only the UnitTest run by RunUnitTest.
+    bool m_fatalEndsTest;
+
+    /// True if this made a page header already.
+    bool m_didPageHeader;
+
+    /** True if currently calling test result receivers or modifying container
+     of pointers to receivers.  UnitTestSetImpl will check this boolean flag to
+     prevent re-entrancy in case a receiver calls a function in UnitTest or
+     UnitTestSet.
+     */
+    bool m_usingReceivers;
+
+    /// True if any unit test was exercised.
+    bool m_didAnyTest;
+
+    /// True if ran through entire set of tests already.
+    bool m_didFirstRun;
+
+    /// Storage for timestamp.
+    time_t m_startTime;
+
+    /// Number of tests.
+    unsigned int m_testCount;
+
+    /// Number of tests that passed.
+    unsigned int m_testPassCount;
+
+    /// Number of test with at least 1 warning.
+    unsigned int m_testWarnCount;
+
+    /// Number of tests that failed.
+    unsigned int m_testFailCount;
+
+    /// Number of tests with exceptions.
+    unsigned int m_testExceptCount;
+
+    /// Number of tests which were skipped and did not fail.
+    unsigned int m_testSkipCount;
+
+    /// Total # of items among all tests.
+    ItemCount m_itemCount;
+
+    /// Total # of passing items among all tests.
+    ItemCount m_itemPassCount;
+
+    /// Total # of warning items among all tests.
+    ItemCount m_itemWarnCount;
+
+    /// Total # of failing items among all tests.
+    ItemCount m_itemFailCount;
+
+    /// Total # of items that had exceptions among all tests.
+    ItemCount m_itemExceptCount;
+
+    /// Total # of items skipped among all tests.
+    ItemCount m_itemSkipCount;
+
+    /// Buffer contains timestamp of when tests began.
+    char m_timeString[ 160 ];
+};
+
+// ----------------------------------------------------------------------------
+
+} // end namespace ut
+
+namespace
+{
+
+// MainPageMaker -----------------------------------------------------------------------------
+
+/** @class MainPageMaker Creates the main unit-test-result page with links to the
+ other pages.
+ */
+class MainPageMaker
+{
+public:
+
+    /// Max # of rows allowed in main HTML page.
+    static const unsigned int s_MaxRowCount;
+
+    /** Constructor provides the parameters needed to make the main page.
+     @param[in] info Information about current test results.
+     @param[in] today Pointer to timestamp.
+     @param[in] mainpageFilename Name of html file for main page.
+     @param[in] outputFilename Name of html file for current test page.
+     */
+    MainPageMaker( const ut::UnitTestSetImpl * info, const time_t * timestamp,
+        const char * mainpageFilename, const char * outputFilename );
+
+    /// Destructor.
+    ~MainPageMaker( void );
+
+    /// Return true if file is opened.
+    bool IsOpen( void ) const;
+
+    /** Adds current info to file content.  It first sends some of the existing file
+     contents into the output file stream, overwriting the existing file in the
+     process.  Once it gets to the first row in the test table, it adds the current
+     test information to the file stream.  Then it sends the next however many rows
+     from the table to output - but not more than the upper limit for the table.
+     The remaining rows are skipped, and any content after the table is sent to output.
+     @param[in] Contents of existing main page.
+     */
+    bool AddToContent( const string & fileContent );
+
+    /// Creates HTML file of main test page.
+    bool CreateFile( void );
+
+private:
+    /// Not implemented.
+    MainPageMaker( void );
+    /// Copy-constructor is not implemented.
+    MainPageMaker( const MainPageMaker & );
+    /// Copy-assignment operator is not implemented.
+    MainPageMaker & operator = ( const MainPageMaker & );
+
+    /** Adds project totals from current test to table.  The row is color-coded
+     to match overall test results.  A link is placed in the row for the current
+     test page.
+     */
+    bool AddCurrentOutput( void );
+
+    /// Makes ending tags for HTML table.
+    void MakeEndOfTable( void );
+
+    /// File output stream used to make HTML file.
+    ofstream m_output;
+
+    /// Name of output file.
+    const char * m_outputFilename;
+
+    /// Pointer to timestamp.
+    const time_t * m_startTime;
+
+    /// Pointer to implementation details for unit tests.
+    const ut::UnitTestSetImpl * m_info;
+};
+
+const unsigned int MainPageMaker::s_MaxRowCount = 90;
+
+// MainPageMaker::MainPageMaker ---------------------------------------------------------------
+
+MainPageMaker::MainPageMaker( const ut::UnitTestSetImpl * info,
+    const time_t * timestamp, const char * mainpageFilename,
+    const char * outputFilename ) :
+    m_output( mainpageFilename ),
+    m_outputFilename( outputFilename ),
+    m_startTime( timestamp ),
+    m_info( info )
+{
+    assert( nullptr != this );
+}
+
+// MainPageMaker::~MainPageMaker ---------------------------------------------------------------
+
+MainPageMaker::~MainPageMaker( void )
+{
+    assert( nullptr != this );
+}
+
+// MainPageMaker::IsOpen ----------------------------------------------------------------------
+
+bool MainPageMaker::IsOpen( void ) const
+{
+    assert( nullptr != this );
+#if defined (_MSC_VER)
+    return m_output.is_open();
+#else
+    // Have to cast away const because implementation for std::ofstream
+    // does not provide const version of is_open.
+    MainPageMaker * pThis = const_cast< MainPageMaker * >( this );
+    return pThis->m_output.is_open();
+#endif
+}
+
+// MainPageMaker::AddToContent ----------------------------------------------------------------
+
+bool MainPageMaker::AddToContent( const string & fileContent )
+{
+    assert( nullptr != this );
+
+    const char * content = fileContent.c_str();
+    // This should find start of the header row ...
+    const char * firstRow = FindSubString( content, "<tr>" );
+    if ( IsEmptyString( firstRow ) )
+        return CreateFile();
+
+    ++firstRow;
+    // and this should find start of the most recently added row.
+    firstRow = FindSubString( firstRow, "<tr>" );
+    if ( IsEmptyString( firstRow ) )
+        return CreateFile();
+
+    string temp( content, firstRow );
+    // Pages made before the Peak RSS column existed get it in their header,
+    // and their older rows are left with an empty last cell.
+    const char * const peakHeader = "<th>Peak<br>RSS KB</th>";
+    if ( string::npos == temp.find( peakHeader ) )
+    {
+        const string::size_type headerEnd = temp.rfind( "</tr>" );
+        if ( string::npos != headerEnd )
+            temp.insert( headerEnd, peakHeader );
+    }
+    m_output << temp;
+    if ( !AddCurrentOutput() )
+        return false;
+
+    // decide if file already has more than enough rows.
+    const char * rowNow = firstRow;
+    const char * nextRow = rowNow;
+    const char * endOfTable = FindSubString( nextRow, "</table>" );
+    unsigned int count = 1; 
+    while ( count < s_MaxRowCount )
+    {
+        nextRow = FindSubString( rowNow, "<tr>" );
+        if ( ( endOfTable < nextRow ) || IsEmptyString( nextRow ) )
+        {
+            // next row is past end of current table, so it must be inside next table.
+            break;
+        }
+        rowNow = nextRow+1;
+        ++count;
+    }
+
+    if ( ( count < s_MaxRowCount ) || IsEmptyString( nextRow ) )
+        m_output << firstRow;
+    else
+    {
+        temp.assign( firstRow, nextRow-firstRow );
+        m_output << temp;
+        m_output << endOfTable;
+    }
+
+    return true;
+}
+
+// MainPageMaker::AddCurrentOutput ------------------------------------------------------------
+
+bool MainPageMaker::AddCurrentOutput( void )
+{
+    assert( nullptr != this );
+
+    char buffer[ 128 ];
+    const unsigned int testCount = m_info->GetTestCount();
+    const unsigned int testFailCount = m_info->GetTestFailCount();
+    const unsigned int testTossCount = m_info->GetTestExceptCount();
+    const unsigned int testWarnCount = m_info->GetTestWarnCount();
+    const unsigned int testPassCount = m_info->GetTestPassCount();
+    const ut::ItemCount itemPassCount = m_info->GetItemPassCount();
+    const ut::ItemCount itemWarnCount = m_info->GetItemWarnCount();
+    const ut::ItemCount itemFailCount = m_info->GetItemFailCount();
+    const ut::ItemCount itemTossCount = m_info->GetItemExceptCount();
+    const ut::ItemCount itemCount = m_info->GetItemCount();
+    HtmlResultColors colors( itemCount, itemPassCount, itemWarnCount,
+        itemFailCount, itemTossCount);
+
+    const char * testName = m_info->GetTestName();
+    string filenameLink( "./");
+    filenameLink += FindFileNameInPath( m_outputFilename );
+    const struct tm * timeStamp = ::localtime( m_startTime );
+    ::strftime( buffer, sizeof(buffer)-1, s_testTimeStampFormatSpec,
+        timeStamp );
+    m_output << "<tr><td><a href=\'" << filenameLink << "\'>"
+             << buffer << "</a></td>" << endl;
+    m_output << "<td>" << testName << "</td>" << endl;
+    m_output << "<td><span style=\"color: " << colors.testColor << "\">"
+             << colors.testResult << "</span></td>" << endl;
+
+    m_output << "<td><span style=\"color: " << colors.passColor << "\">"
+             << itemPassCount << "</span></td>" << endl;
+    m_output << "<td><span style=\"color: " << colors.warnColor << "\">"
+             << itemWarnCount << "</span></td>" << endl;
+    m_output << "<td><span style=\"color: " << colors.failColor << "\">"
+             << itemFailCount << "</span></td>" << endl;
+    m_output << "<td><span style=\"color: " << colors.tossColor << "\">"
+             << itemTossCount << "</span></td>" << endl;
+    m_output << "<td><span style=\"color: " << colors.textColor << "\">"
+             << itemCount << "</span></td>" << endl;
+
+    m_output << "<td><span style=\"color: " << colors.passColor << "\">"
+             << testPassCount << "</span></td>" << endl;
+    m_output << "<td><span style=\"color: " << colors.warnColor << "\">"
+             << testWarnCount << "</span></td>" << endl;
+    m_output << "<td><span style=\"color: " << colors.failColor << "\">"
+             << testFailCount << "</span></td>" << endl;
+    m_output << "<td><span style=\"color: " << colors.tossColor << "\">"
+             << testTossCount << "</span></td>" << endl;
+    m_output << "<td><span style=\"color: " << colors.textColor << "\">"
+             << testCount << "</span></td>" << endl;
+    m_output << "<td>" << GetPeakRssOfRun() << "</td></tr>" << endl;
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------
+
+bool MainPageMaker::CreateFile( void )
+{
+    assert( nullptr != this );
+
+// Time Stamp   Test Name   Result   Items   Items   Total   Tests   Tests   Total  Peak
+//                                   Passed  Failed  Items   Passed  Failed  Tests  RSS KB
+
+    m_output << "<html><head><title>Unit Test Results</title></head>" << endl
+             << "<body bgcolor=black text=white>" << endl;
+
+    m_output << "<br><table border=1 cellspacing=0 cellpadding=3>" << endl;
+    m_output << "<caption><em>Unit Test Results</em></caption>" << endl;
+    m_output << "<tr><th>Time Stamp</th><th>Test Name</th><th>Result</th>"
+             << "<th>Items<br>Passed</th><th>Warning<br>Items</th>"
+             << "<th>Items<br>Failed</th>"
+             << "<th>Items<br>Thrown</th><th>Total<br>Items</th>"
+             << "<th>Tests<br>Passed</th><th>Tests w/<br>Warnings</th>"
+             << "<th>Tests<br>Failed</th>"
+             << "<th>Tests<br>Thrown</th><th>Total<br>Tests</th>"
+             << "<th>Peak<br>RSS KB</th></tr>" << endl;
+    if ( !AddCurrentOutput() )
+        return false;
+    MakeEndOfTable();
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------
+
+void MainPageMaker::MakeEndOfTable( void )
+{
+    assert( nullptr != this );
+
+    m_output << "</table><br>" << endl;
+    MakeColorTable( m_output );
+    m_output << "</body>" << endl << "</html>" << endl;
+}
+
+// ----------------------------------------------------------------------------
+
+FileOutputter::FileOutputter( void ) :
+    m_outFile(),
+    m_isOpen( false )
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+FileOutputter::~FileOutputter( void )
+{
+    assert( nullptr != this );
+    Close();
+}
+
+// ----------------------------------------------------------------------------
+
+bool FileOutputter::Open( const char * fileName )
+{
+    assert( nullptr != this );
+    if ( IsEmptyString( fileName ) )
+        return false;
+    m_outFile.open( fileName, ios::out | ios::trunc );
+    m_isOpen = m_outFile.is_open();
+    return m_isOpen;
+}
+
+// ----------------------------------------------------------------------------
+
+void FileOutputter::Close( void )
+{
+    assert( nullptr != this );
+    if ( m_isOpen )
+    {
+        m_outFile.close();
+        m_isOpen = false;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+#if defined( __linux__ )
+
+/// Counters used where the hardware ones may be read.
+static const CounterInfo s_HardwareCounters[] =
+{
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,    "Cycles",       "cycles" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,  "Instructions", "instructions" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,  "CacheMisses",  "cacheMisses" },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "BranchMisses", "branchMisses" }
+};
+
+/// Counters used where hardware ones are restricted, as in containers.
+static const CounterInfo s_SoftwareCounters[] =
+{
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK,       "TaskClock",   "taskClock" },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "CtxSwitches", "contextSwitches" },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS,      "PageFaults",  "pageFaults" }
+};
+
+#endif
+
+// ----------------------------------------------------------------------------
+
+PerfCounters::PerfCounters( void ) :
+    m_isOpen( false )
+{
+    assert( nullptr != this );
+    for ( unsigned int ii = 0; ii < ut::UnitTest::CounterCount; ++ii )
+    {
+        m_files[ ii ] = -1;
+        m_infos[ ii ] = nullptr;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+PerfCounters::~PerfCounters( void )
+{
+    assert( nullptr != this );
+    Close();
+}
+
+// ----------------------------------------------------------------------------
+
+bool PerfCounters::Open( void )
+{
+    assert( nullptr != this );
+    Close();
+#if defined( __linux__ )
+    const unsigned int hardwareCount =
+        sizeof(s_HardwareCounters) / sizeof(s_HardwareCounters[0]);
+    const unsigned int softwareCount =
+        sizeof(s_SoftwareCounters) / sizeof(s_SoftwareCounters[0]);
+    m_isOpen = OpenList( s_HardwareCounters, hardwareCount )
+        || OpenList( s_SoftwareCounters, softwareCount );
+#endif
+    return m_isOpen;
+}
+
+// ----------------------------------------------------------------------------
+
+bool PerfCounters::OpenLike( const PerfCounters & other )
+{
+    assert( nullptr != this );
+    Close();
+    for ( unsigned int ii = 0; ii < ut::UnitTest::CounterCount; ++ii )
+    {
+        if ( nullptr != other.m_infos[ ii ] )
+            m_isOpen |= OpenOne( ii, other.m_infos[ ii ] );
+    }
+    return m_isOpen;
+}
+
+// ----------------------------------------------------------------------------
+
+bool PerfCounters::OpenList( const CounterInfo * infos, unsigned int count )
+{
+    assert( nullptr != this );
+    assert( count <= ut::UnitTest::CounterCount );
+    bool any = false;
+    for ( unsigned int ii = 0; ii < count; ++ii )
+        any |= OpenOne( ii, infos + ii );
+    return any;
+}
+
+// ----------------------------------------------------------------------------
+
+bool PerfCounters::OpenOne( unsigned int which, const CounterInfo * info )
+{
+    assert( nullptr != this );
+    assert( which < ut::UnitTest::CounterCount );
+#if defined( __linux__ )
+    struct perf_event_attr attributes;
+    ::memset( &attributes, 0, sizeof(attributes) );
+    attributes.size = sizeof(attributes);
+    attributes.type = info->m_type;
+    attributes.config = info->m_config;
+    // Counting only user-space events works at the default paranoia
+    // level, so more systems allow it.
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    // Pid 0 and cpu -1 count the calling thread on any processor.
+    const long file = ::syscall( __NR_perf_event_open, &attributes,
+        0, -1, -1, 0 );
+    if ( file < 0 )
+        return false;
+    m_files[ which ] = static_cast< int >( file );
+    m_infos[ which ] = info;
+    return true;
+#else
+    (void)which;
+    (void)info;
+    return false;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+void PerfCounters::Close( void )
+{
+    assert( nullptr != this );
+    for ( unsigned int ii = 0; ii < ut::UnitTest::CounterCount; ++ii )
+    {
+#if !defined( _WIN32 )
+        if ( 0 <= m_files[ ii ] )
+            ::close( m_files[ ii ] );
+#endif
+        m_files[ ii ] = -1;
+        m_infos[ ii ] = nullptr;
+    }
+    m_isOpen = false;
+}
+
+// ----------------------------------------------------------------------------
+
+void PerfCounters::Read( double * values ) const
+{
+    assert( nullptr != this );
+    assert( nullptr != values );
+    for ( unsigned int ii = 0; ii < ut::UnitTest::CounterCount; ++ii )
+    {
+        values[ ii ] = 0.0;
+#if defined( __linux__ )
+        if ( m_files[ ii ] < 0 )
+            continue;
+        // The kernel writes a 64-bit count.  A double holds it exactly up to
+        // 2 to the 53rd power, which is plenty for one test run.
+        unsigned char count[ 8 ];
+        if ( ::read( m_files[ ii ], count, sizeof(count) )
+            != static_cast< ssize_t >( sizeof(count) ) )
+            continue;
+        __u64 value = 0;
+        ::memcpy( &value, count, sizeof(value) );
+        values[ ii ] = static_cast< double >( value );
+#endif
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+WorkerCounters::WorkerCounters( ut::UnitTestSetImpl * impl,
+    ut::UnitTest * test ) :
+    m_impl( impl ),
+    m_test( test ),
+    m_counters()
+{
+    assert( nullptr != this );
+    assert( nullptr != impl );
+    if ( m_impl->GetPerfCounters().IsOpen() )
+        m_counters.OpenLike( m_impl->GetPerfCounters() );
+    m_counters.Read( m_start );
+}
+
+// ----------------------------------------------------------------------------
+
+WorkerCounters::~WorkerCounters( void )
+{
+    assert( nullptr != this );
+    if ( !m_counters.IsOpen() || ( nullptr == m_test ) )
+        return;
+    double counts[ ut::UnitTest::CounterCount ];
+    m_counters.Read( counts );
+    for ( unsigned int ii = 0; ii < ut::UnitTest::CounterCount; ++ii )
+        counts[ ii ] -= m_start[ ii ];
+    m_impl->AddWorkerCounters( m_test, counts );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Converts ru_maxrss to kilobytes, since macOS reports bytes.
+inline unsigned long MaxRssToKilobytes( long maxRss )
+{
+#if defined( __APPLE__ )
+    return static_cast< unsigned long >( maxRss ) / 1024UL;
+#else
+    return static_cast< unsigned long >( maxRss );
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+void TakeMemorySample( MemorySample & sample )
+{
+    sample.m_residentKb = 0;
+    sample.m_peakKb = 0;
+    sample.m_majorFaults = 0;
+    sample.m_minorFaults = 0;
+#if !defined( _WIN32 )
+    struct rusage usage;
+    if ( 0 == ::getrusage( RUSAGE_SELF, &usage ) )
+    {
+        sample.m_peakKb = MaxRssToKilobytes( usage.ru_maxrss );
+        sample.m_majorFaults = static_cast< unsigned long >( usage.ru_majflt );
+        sample.m_minorFaults = static_cast< unsigned long >( usage.ru_minflt );
+    }
+#endif
+#if defined( __linux__ )
+    // Second number in statm is resident pages.
+    FILE * file = ::fopen( "/proc/self/statm", "r" );
+    if ( nullptr == file )
+        return;
+    unsigned long pages = 0;
+    unsigned long resident = 0;
+    if ( 2 == ::fscanf( file, "%lu %lu", &pages, &resident ) )
+    {
+        const long pageSize = ::sysconf( _SC_PAGESIZE );
+        if ( 0 < pageSize )
+            sample.m_residentKb = resident
+                * ( static_cast< unsigned long >( pageSize ) / 1024UL );
+    }
+    ::fclose( file );
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned long GetPeakRssOfRun( void )
+{
+    unsigned long peak = 0;
+#if !defined( _WIN32 )
+    struct rusage usage;
+    if ( 0 == ::getrusage( RUSAGE_SELF, &usage ) )
+        peak = MaxRssToKilobytes( usage.ru_maxrss );
+    if ( 0 == ::getrusage( RUSAGE_CHILDREN, &usage ) )
+        peak = max( peak, MaxRssToKilobytes( usage.ru_maxrss ) );
+#endif
+    return peak;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Appends value rounded to a whole number, with no exponent or decimals.
+void AppendCount( string & target, double value )
+{
+    char digits[ 32 ];
+    char * first = digits + sizeof(digits);
+    double rest = ( 0.0 < value ) ? ::floor( value + 0.5 ) : 0.0;
+    do
+    {
+        const double next = ::floor( rest / 10.0 );
+        *--first = static_cast< char >(
+            '0' + static_cast< int >( rest - next * 10.0 ) );
+        rest = next;
+    } while ( ( 0.0 < rest ) && ( digits < first ) );
+    target.append( first, digits + sizeof(digits) - first );
+}
+
+// ----------------------------------------------------------------------------
+
+TextOutputter::TextOutputter( ::ut::UnitTestSet::OutputOptions options ) :
+    FileOutputter(),
+    UnitTestResultReceiver(),
+    m_sendToCout( 0 != ( options & ut::UnitTestSet::SendToCout ) ),
+    m_sendToCerr( 0 != ( options & ut::UnitTestSet::SendToCerr ) ),
+    m_showDividers( 0 != ( options & ut::UnitTestSet::Dividers ) ),
+    m_showIndexes( 0 != ( options & ut::UnitTestSet::AddTestIndex ) ),
+    m_showTimes( 0 != ( options & ut::UnitTestSet::Times ) ),
+    m_showMemory( 0 != ( options & ut::UnitTestSet::Memory ) ),
+    m_filename(),
+    m_buffer(),
+    m_flushPolicy( ut::UnitTestSet::FlushEveryLine ),
+    m_flushInterval( 0 ),
+    m_lastFlush( 0.0 )
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+TextOutputter::~TextOutputter( void )
+{
+    assert( nullptr != this );
+    Flush();
+}
+
+// ----------------------------------------------------------------------------
+
+void TextOutputter::SetFlushPolicy( ut::UnitTestSet::FlushPolicy policy,
+    unsigned int milliseconds )
+{
+    assert( nullptr != this );
+    Flush();
+    m_flushPolicy = policy;
+    m_flushInterval = milliseconds;
+    m_lastFlush = GetWallClockTime();
+}
+
+// ----------------------------------------------------------------------------
+
+void TextOutputter::Append( const char * s )
+{
+    assert( nullptr != this );
+    assert( nullptr != s );
+    m_buffer.append( s );
+}
+
+// ----------------------------------------------------------------------------
+
+void TextOutputter::Append( const char * s, unsigned int width, bool alignLeft )
+{
+    assert( nullptr != this );
+    assert( nullptr != s );
+    const size_t length = ::strlen( s );
+    const size_t padding = ( length < width ) ? width - length : 0;
+    if ( !alignLeft )
+        m_buffer.append( padding, ' ' );
+    m_buffer.append( s, length );
+    if ( alignLeft )
+        m_buffer.append( padding, ' ' );
+}
+
+// ----------------------------------------------------------------------------
+
+void TextOutputter::AppendTableName( const char * name )
+{
+    assert( nullptr != this );
+    assert( nullptr != name );
+    // One space always follows the name, so the next tab goes to next stop.
+    static const size_t width = 24;
+    const size_t length = ::strlen( name );
+    if ( length < width )
+    {
+        m_buffer.append( name, length );
+        m_buffer.append( width - length, ' ' );
+        return;
+    }
+    m_buffer.append( name, width - 2 );
+    m_buffer.append( "~ " );
+}
+
+// ----------------------------------------------------------------------------
+
+void TextOutputter::Append( ut::ItemCount value, unsigned int width )
+{
+    assert( nullptr != this );
+    char digits[ 24 ];
+    char * first = digits + sizeof(digits);
+    do
+    {
+        *--first = static_cast< char >( '0' + ( value % 10 ) );
+        value /= 10;
+    } while ( 0 != value );
+    const unsigned int length = static_cast< unsigned int >
+        ( digits + sizeof(digits) - first );
+    if ( length < width )
+        m_buffer.append( width - length, ' ' );
+    m_buffer.append( first, length );
+}
+
+// ----------------------------------------------------------------------------
+
+void TextOutputter::AppendSeconds( double seconds, unsigned int width )
+{
+    assert( nullptr != this );
+    if ( seconds < 0.0 )
+        seconds = 0.0;
+    if ( 999999.0 < seconds )
+        seconds = 999999.0;
+    unsigned int whole = static_cast< unsigned int >( seconds );
+    unsigned int milli = static_cast< unsigned int >
+        ( ( seconds - whole ) * 1000.0 + 0.5 );
+    if ( 1000 <= milli )
+    {
+        ++whole;
+        milli -= 1000;
+    }
+    Append( whole, ( 4 < width ) ? width - 4 : 0 );
+    m_buffer += '.';
+    m_buffer += static_cast< char >( '0' + ( milli / 100 ) );
+    m_buffer += static_cast< char >( '0' + ( milli / 10 ) % 10 );
+    m_buffer += static_cast< char >( '0' + ( milli % 10 ) );
+}
+
+// ----------------------------------------------------------------------------
+
+void TextOutputter::AppendKilobytes( long kilobytes, unsigned int width )
+{
+    assert( nullptr != this );
+    string text;
+    if ( kilobytes < 0 )
+        text += '-';
+    AppendCount( text, static_cast< double >(
+        ( kilobytes < 0 ) ? -kilobytes : kilobytes ) );
+    Append( text.c_str(), width, false );
+}
+
+// ----------------------------------------------------------------------------
+
+void TextOutputter::AppendCounters( const ut::UnitTest * test )
+{
+    assert( nullptr != this );
+    const ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    string count;
+    for ( unsigned int ii = 0; ii < ut::UnitTest::CounterCount; ++ii )
+    {
+        const char * name = uts.GetCounterName( ii );
+        if ( nullptr == name )
+            continue;
+        Append( "\t" );
+        if ( nullptr == test )
+        {
+            Append( name, 12, false );
+            continue;
+        }
+        count.clear();
+        AppendCount( count, test->GetCounter( ii ) );
+        Append( count.c_str(), 12, false );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void TextOutputter::Send( bool isFailure )
+{
+    assert( nullptr != this );
+
+    bool flushNow = ( s_MaxBufferSize <= m_buffer.size() );
+    switch ( m_flushPolicy )
+    {
+        default:                                // fall into next case.
+        case ut::UnitTestSet::FlushEveryLine:
+            flushNow = true;
+            break;
+        case ut::UnitTestSet::FlushInterval:
+            if ( m_flushInterval <=
+                ( GetWallClockTime() - m_lastFlush ) * 1000.0 )
+                flushNow = true;
+            break;
+        case ut::UnitTestSet::FlushOnFailure:
+            if ( isFailure )
+                flushNow = true;
+            break;
+        case ut::UnitTestSet::FlushAtExit:
+            break;
+    }
+    if ( flushNow )
+        Flush();
+}
+
+// ----------------------------------------------------------------------------
+
+void TextOutputter::FlushIfDue( double now )
+{
+    assert( nullptr != this );
+
+    if ( ( m_flushPolicy == ut::UnitTestSet::FlushInterval )
+      && !m_buffer.empty()
+      && ( m_flushInterval <= ( now - m_lastFlush ) * 1000.0 ) )
+        Flush();
+}
+
+// ----------------------------------------------------------------------------
+
+void TextOutputter::Flush( void )
+{
+    assert( nullptr != this );
+
+    if ( m_flushPolicy == ut::UnitTestSet::FlushInterval )
+        m_lastFlush = GetWallClockTime();
+    if ( m_buffer.empty() )
+        return;
+    const char * content = m_buffer.data();
+    const streamsize size = static_cast< streamsize >( m_buffer.size() );
+    if ( m_sendToCout )
+    {
+        cout.write( content, size );
+        cout << flush;
+    }
+    if ( m_sendToCerr )
+    {
+        cerr.write( content, size );
+        cerr << flush;
+    }
+    if ( m_isOpen )
+    {
+        m_outFile.write( content, size );
+        m_outFile << flush;
+    }
+    // Clearing the string keeps its capacity, so later lines reuse memory.
+    m_buffer.erase();
+}
+
+// ----------------------------------------------------------------------------
+
+bool TextOutputter::Start( const char * name )
+{
+    assert( nullptr != this );
+    assert( !IsEmptyString( name ) );
+    assert( !m_isOpen );
+
+    Open( m_filename.c_str() );
+    if ( !DoesOutput() )
+        return false;
+    m_lastFlush = GetWallClockTime();
+    Append( "Name of Unit Tests: " );
+    Append( name );
+    Append( "\n" );
+    Send( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+const char * CheckFilenameSize( const char * fileName )
+{
+    static const size_t s_maxfileNameSize = 256;
+    assert( fileName != nullptr );
+    const size_t fileNameSize = ::strlen( fileName );
+    if ( s_maxfileNameSize < fileNameSize )
+        fileName += ( fileNameSize - s_maxfileNameSize );
+    return fileName;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TextOutputter::ShowMessage( const ut::UnitTest * test,
+    const char * fileName, unsigned int line, const char * message )
+{
+    assert( nullptr != this );
+    if ( !DoesOutput() )
+        return false;
+
+    Append( CheckFilenameSize( fileName ) );
+    Append( "(" );
+    Append( line, 0 );
+    Append( ") : " );
+    if ( m_showIndexes )
+    {
+        Append( test->GetIndex(), 0 );
+        Append( " " );
+    }
+    Append( message );
+    Append( "\n" );
+    Send( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TextOutputter::ShowTestHeader( const ut::UnitTest * test )
+{
+    assert( nullptr != this );
+    if ( !DoesOutput() )
+        return false;
+
+    Append( "\nTest: " );
+    Append( test->GetIndex(), 3 );
+    Append( "\t\t" );
+    Append( test->GetName() );
+    Append( "\n" );
+    if ( m_showDividers )
+    {
+        Append( s_DividerLine );
+        Append( "\n" );
+    }
+    Send( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TextOutputter::ShowTestLine( const ut::UnitTest * test,
+    ut::TestResult::EnumType result, const char * fileName, unsigned int line,
+    const char * expression, const char * message )
+{
+    assert( nullptr != this );
+
+    if ( !DoesOutput() )
+        return false;
+
+    Append( CheckFilenameSize( fileName ) );
+    Append( "(" );
+    Append( line, 0 );
+    Append( ") : " );
+    Append( ut::TestResult::GetName( result ), 8, false );
+    Append( "  " );
+    if ( m_showIndexes )
+    {
+        Append( "  " );
+        Append( test->GetIndex(), 0 );
+        Append( ":" );
+        Append( test->GetItemCount(), 0 );
+    }
+    else
+    {
+        Append( test->GetItemCount(), 4 );
+    }
+    Append( "  (" );
+    Append( expression );
+    Append( ")" );
+    if ( !IsEmptyString( message ) )
+    {
+        Append( "  " );
+        Append( message );
+    }
+    Append( "\n" );
+
+    if ( ut::TestResult::Fatal == result )
+    {
+        if ( ut::UnitTestSet::GetIt().WillFatalEndProgram( test ) )
+            Append( "A required test failed!\n"
+                    "Unable to safely execute further tests!\n"
+                    "Program must exit now!\n" );
+        else
+            Append( "A required test failed!\n"
+                    "Unable to safely execute further items!\n"
+                    "Unit test must end now!\n" );
+        // The program or unit test is about to end, so this flushes no
+        // matter what the policy says.
+        Flush();
+        return true;
+    }
+
+    const bool isFailure = ( ut::TestResult::Failed == result )
+        || ( ut::TestResult::Thrown == result );
+    Send( isFailure );
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TextOutputter::ShowTimeStamp( bool isStartTime, const char * timestamp )
+{
+    assert( nullptr != this );
+    assert( !IsEmptyString( timestamp ) );
+
+    if ( !DoesOutput() )
+        return false;
+    if ( isStartTime )
+        Append( "\n" );
+    Append( ( isStartTime ) ? s_beginTimeMessage : s_endTimeStampMessage );
+    Append( timestamp );
+    Append( "\n" );
+    // The ending timestamp comes after all tests are done.
+    if ( isStartTime )
+        Send( false );
+    else
+        Flush();
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TextOutputter::StartSummaryTable( void )
+{
+    assert( nullptr != this );
+    if ( !DoesOutput() )
+        return false;
+
+    static const char * const s_titleLine =
+        "\n\t#  Unit Test Name\t\tPassed\tWarning\tFailed\tThrown\tSkipped"
+        "\tTested";
+    Append( s_titleLine );
+    if ( m_showTimes )
+        Append( "\t Seconds\t Virtual" );
+    if ( m_showMemory )
+        Append( "\t Grew KB\t Peak KB\t MajFlt\t MinFlt" );
+    AppendCounters( nullptr );
+    Append( "\n" );
+    if ( m_showDividers )
+    {
+        Append( s_DividerLine );
+        Append( "\n" );
+    }
+    Send( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TextOutputter::ShowTableLine( const ut::UnitTest * test )
+{
+    assert( nullptr != this );
+
+    if ( !DoesOutput() )
+        return false;
+
+    const ut::ItemCount failCount = test->GetFailCount();
+    const ut::ItemCount itemCount = test->GetItemCount();
+    const ut::ItemCount exceptCount = test->GetExceptionCount();
+    const ut::ItemCount skipCount = test->GetSkipCount();
+    const char * result = "Passed";
+    if ( ( 0 < exceptCount ) || ( 0 < failCount ) )
+    {
+        result = "FAILED";
+    } else if ( 0 < skipCount )
+    {
+        result = "Skip  ";
+    } else if ( 0 == itemCount )
+    {
+        result = "Empty!";
+    }
+
+    Append( result );
+    Append( "  " );
+    Append( test->GetIndex(), 3 );
+    Append( "  " );
+    AppendTableName( test->GetName() );
+    Append( "\t" );
+    Append( test->GetPassCount(), 6 );
+    Append( "\t" );
+    Append( test->GetWarnCount(), 6 );
+    Append( "\t" );
+    Append( failCount, 6 );
+    Append( "\t" );
+    Append( exceptCount, 6 );
+    Append( "\t" );
+    Append( skipCount, 6 );
+    Append( "\t" );
+    Append( itemCount, 6 );
+    if ( m_showTimes )
+    {
+        Append( "\t" );
+        AppendSeconds( test->GetElapsedTime(), 8 );
+        Append( "\t" );
+        AppendSeconds( test->GetVirtualTime(), 8 );
+    }
+    if ( m_showMemory )
+    {
+        Append( "\t" );
+        AppendKilobytes( test->GetRssGrowth(), 8 );
+        Append( "\t" );
+        AppendKilobytes( static_cast< long >( test->GetPeakRss() ), 8 );
+        Append( "\t" );
+        Append( test->GetMajorFaults(), 7 );
+        Append( "\t" );
+        Append( test->GetMinorFaults(), 7 );
+    }
+    AppendCounters( test );
+    Append( "\n" );
+    Send( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+void TextOutputter::AppendTotals( const char * title,
+    ut::ItemCount passCount, ut::ItemCount warnCount, ut::ItemCount failCount,
+    ut::ItemCount exceptCount, ut::ItemCount skipCount,
+    ut::ItemCount totalCount )
+{
+    assert( nullptr != this );
+
+    const bool passed = ( ( 0 == failCount ) && ( 0 == exceptCount ) );
+    if ( m_showDividers )
+    {
+        Append( s_DividerLine );
+        Append( "\n" );
+    }
+    Append( ( passed ) ? "Pass" : "FAIL" );
+    Append( "\t   " );
+    Append( title );
+    Append( "\t" );
+    Append( passCount, 6 );
+    Append( "\t" );
+    Append( warnCount, 6 );
+    Append( "\t" );
+    Append( failCount, 6 );
+    Append( "\t" );
+    Append( exceptCount, 6 );
+    Append( "\t" );
+    Append( skipCount, 6 );
+    Append( "\t" );
+    Append( totalCount, 6 );
+    Append( "\n\n" );
+}
+
+// ----------------------------------------------------------------------------
+
+bool TextOutputter::ShowLongTotalLine( ut::ItemCount passCount,
+    ut::ItemCount warnCount, ut::ItemCount failCount,
+    ut::ItemCount exceptCount, ut::ItemCount skipCount,
+    ut::ItemCount itemCount )
+{
+    assert( nullptr != this );
+
+    if ( !DoesOutput() )
+        return false;
+    AppendTotals( "Item Totals             ", passCount, warnCount,
+        failCount, exceptCount, skipCount, itemCount );
+    Send( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TextOutputter::ShowSummaryLineWithSkips( unsigned int passCount,
+    unsigned int warnCount, unsigned int failCount, unsigned int exceptCount,
+    unsigned int skipCount, unsigned int testCount )
+{
+    assert( nullptr != this );
+
+    if ( !DoesOutput() )
+        return false;
+    AppendTotals( "Unit Test Totals        ", passCount, warnCount,
+        failCount, exceptCount, skipCount, testCount );
+    Send( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TextOutputter::ShowFixtureLine( const char * fixtureName,
+    bool isWorker, unsigned int setUpCount, double setUpSeconds,
+    double tearDownSeconds )
+{
+    assert( nullptr != this );
+
+    if ( !DoesOutput() )
+        return false;
+    Append( "Fixture  " );
+    AppendTableName( fixtureName );
+    Append( ( isWorker ) ? "\tWorker\t" : "\tSuite \t" );
+    Append( setUpCount, 6 );
+    Append( " set ups took " );
+    AppendSeconds( setUpSeconds, 8 );
+    Append( " seconds, and tear downs took " );
+    AppendSeconds( tearDownSeconds, 8 );
+    Append( " seconds.\n" );
+    Send( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool TextOutputter::ShowInvariantLine( ut::ItemCount checks, double seconds,
+    unsigned int period )
+{
+    assert( nullptr != this );
+
+    if ( !DoesOutput() )
+        return false;
+    Append( "Invariants  " );
+    Append( checks, 0 );
+    Append( " checks took " );
+    AppendSeconds( seconds, 0 );
+    Append( " seconds, checking " );
+    if ( 0 == period )
+        Append( "only at summary time.\n" );
+    else if ( 1 == period )
+        Append( "at every call.\n" );
+    else
+    {
+        Append( "one call of every " );
+        Append( period, 0 );
+        Append( ".\n" );
+    }
+    Send( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+void TextOutputter::ShowSoakSnapshot( const SoakSnapshot & snapshot )
+{
+    assert( nullptr != this );
+
     if ( !DoesOutput() )
+        return;
+    const SoakTotals & totals = snapshot.m_totals;
+    const SoakTotals & deltas = snapshot.m_deltas;
+    Append( "\nSoak Snapshot " );
+    Append( snapshot.m_number, 0 );
+    Append( " at " );
+    AppendSeconds( snapshot.m_runSeconds, 0 );
+    Append( " seconds, " );
+    AppendSeconds( snapshot.m_intervalSeconds, 0 );
+    Append( " seconds after the last one.\n" );
+    if ( m_showDividers )
+    {
+        Append( s_DividerLine );
+        Append( "\n" );
+    }
+    Append( "\t\tPassed\tWarning\tFailed\tThrown\tSkipped\tTested\n" );
+    // First row has totals, and second has growth since last snapshot.
+    for ( unsigned int row = 0; row < 2; ++row )
+    {
+        const SoakTotals & line = ( 0 == row ) ? totals : deltas;
+        Append( ( 0 == row ) ? "Totals\t\t" : "Growth\t\t" );
+        Append( line.m_passCount, 6 );
+        Append( "\t" );
+        Append( line.m_warnCount, 6 );
+        Append( "\t" );
+        Append( line.m_failCount, 6 );
+        Append( "\t" );
+        Append( line.m_exceptCount, 6 );
+        Append( "\t" );
+        Append( line.m_skipCount, 6 );
+        Append( "\t" );
+        Append( line.m_itemCount, 6 );
+        Append( "\n" );
+    }
+    Append( "Rates:  " );
+    const double interval = snapshot.m_intervalSeconds;
+    const double run = snapshot.m_runSeconds;
+    Append( static_cast< ut::ItemCount >( ( 0.0 < interval )
+        ? static_cast< double >( deltas.m_itemCount ) / interval + 0.5
+        : 0.0 ), 0 );
+    Append( " items per second since the last snapshot, and " );
+    Append( static_cast< ut::ItemCount >( ( 0.0 < run )
+        ? static_cast< double >( totals.m_itemCount ) / run + 0.5
+        : 0.0 ), 0 );
+    Append( " for the whole run.\n" );
+    if ( 0 == snapshot.m_burstCount )
+        Append( "Bursts: No failures since the last snapshot.\n" );
+    else
+    {
+        Append( "Bursts: Worst had " );
+        Append( snapshot.m_burstCount, 0 );
+        Append( " failures within one second, starting at " );
+        AppendSeconds( snapshot.m_burstSeconds, 0 );
+        Append( " seconds.\n" );
+        Append( "New failures in: " );
+        Append( snapshot.m_failedTests.c_str() );
+        Append( "\n" );
+    }
+    Append( "\n" );
+    Flush();
+}
+
+// ----------------------------------------------------------------------------
+
+bool TextOutputter::EndSummaryTable( void )
+{
+    assert( nullptr != this );
+    Flush();
+    Close();
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+void TextOutputter::FinalEnd( void )
+{
+    assert( nullptr != this );
+    Flush();
+}
+
+// ----------------------------------------------------------------------------
+
+HtmlOutputter::HtmlOutputter( const ut::UnitTestSetImpl * info,
+    ::ut::UnitTestSet::OutputOptions options ) :
+    FileOutputter(),
+    UnitTestResultReceiver(),
+    m_info( info ),
+    m_startTime( nullptr ),
+    m_showIndexes( 0 != ( options & ut::UnitTestSet::AddTestIndex ) ),
+    m_htmlFileName(),
+    m_mainPageName()
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+HtmlOutputter::~HtmlOutputter( void )
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+bool HtmlOutputter::Start( const char * name )
+{
+    assert( nullptr != this );
+    assert( !IsEmptyString( name ) );
+    assert( !m_isOpen );
+
+    Open( m_htmlFileName.c_str() );
+    if ( !m_isOpen )
+        return false;
+
+    string filenameLink( "./");
+    filenameLink += FindFileNameInPath( m_mainPageName.c_str() );
+    m_outFile
+        << "<html><head><title>Unit Test Results</title></head>" << endl
+        << endl << "<body bgcolor=black text=white>" << endl
+        << "<a href=\'" << filenameLink
+        << "\'>Unit Test Main Page</a><br>" << endl;
+    m_outFile << "Name of Unit Tests: " << name << "<br>" << endl;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HtmlOutputter::ShowMessage( const ut::UnitTest * test,
+    const char * fileName, unsigned int line, const char * message )
+{
+    assert( nullptr != this );
+    if ( !m_isOpen )
+        return false;
+    m_outFile << fileName << '(' << line << ") : ";
+    if ( m_showIndexes )
+        m_outFile << test->GetIndex() << ' ';
+    m_outFile << message << "<br>" << endl;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HtmlOutputter::ShowTestHeader( const ut::UnitTest * test )
+{
+    assert( nullptr != this );
+    if ( !m_isOpen )
+        return false;
+    const unsigned int index = test->GetIndex();
+    m_outFile
+        << "<br>Test Number: " << index << "  " << test->GetName()
+        << "<br>" << endl;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HtmlOutputter::ShowTestLine( const ut::UnitTest * test,
+    ut::TestResult::EnumType result, const char * fileName, unsigned int line,
+    const char * expression, const char * message )
+{
+    assert( nullptr != this );
+
+    if ( !m_isOpen )
+        return false;
+
+    const char * status = ut::TestResult::GetName( result );
+    const char * lineColor = GetColor( result );
+    m_outFile << "<span style=\"color: " << lineColor << "\">"
+        << fileName << '(' << line << ") : " << status << "    ";
+    if ( m_showIndexes )
+        m_outFile << test->GetIndex() << ':';
+    m_outFile << test->GetItemCount() << "  (" << expression << ")";
+    if ( !IsEmptyString( message ) )
+        m_outFile << "  " << message;
+    m_outFile << "</span><br>" << endl;
+
+    if ( ut::TestResult::Fatal == result )
+    {
+        m_outFile
+            << "<span style=\"color: red\">A required test failed!<br>" << endl;
+        if ( ut::UnitTestSet::GetIt().WillFatalEndProgram( test ) )
+            m_outFile << "Unable to safely execute further tests!<br>" << endl
+                << "Program must exit now!</span><br>" << endl;
+        else
+            m_outFile << "Unable to safely execute further items!<br>" << endl
+                << "Unit test must end now!</span><br>" << endl;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HtmlOutputter::ShowTimeStamp( bool isStartTime, const char * timestamp )
+{
+    assert( nullptr != this );
+    assert( !IsEmptyString( timestamp ) );
+
+    if ( !m_isOpen )
+        return false;
+    const char * description =
+        ( isStartTime ) ? s_beginTimeMessage : s_endTimeStampMessage;
+    if ( isStartTime )
+        m_outFile << "<br>" << endl;
+    m_outFile << description << timestamp << "<br>" << endl << flush;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns an empty cell for each memory and performance counter column.
+string EmptyCounterCells( void )
+{
+    const ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    string cells;
+    if ( uts.DoesOutputOption( ut::UnitTestSet::Memory ) )
+        cells.append( "<th>-</th><th>-</th><th>-</th><th>-</th>" );
+    for ( unsigned int ii = 0; ii < ut::UnitTest::CounterCount; ++ii )
+    {
+        if ( nullptr != uts.GetCounterName( ii ) )
+            cells.append( "<th>-</th>" );
+    }
+    return cells;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HtmlOutputter::StartSummaryTable( void )
+{
+    assert( nullptr != this );
+    if ( !m_isOpen )
+        return false;
+    m_outFile << endl << "<br><table border=1 cellspacing=0 cellpadding=3>" << endl;
+    m_outFile << "<caption><em>Unit Test Results</em></caption>" << endl;
+    m_outFile << "<tr><th>Result</th><th>#</th><th>Unit Test Name</th>"
+              << "<th>Passed</th><th>Warnings</th><th>Failed</th>"
+              << "<th>Exceptions</th><th>Skipped</th><th>Tested</th>";
+    const ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    if ( uts.DoesOutputOption( ut::UnitTestSet::Memory ) )
+    {
+        m_outFile << "<th>Grew KB</th><th>Peak KB</th>"
+                  << "<th>Major Faults</th><th>Minor Faults</th>";
+    }
+    for ( unsigned int ii = 0; ii < ut::UnitTest::CounterCount; ++ii )
+    {
+        const char * name = uts.GetCounterName( ii );
+        if ( nullptr != name )
+            m_outFile << "<th>" << name << "</th>";
+    }
+    m_outFile << "</tr>" << endl;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HtmlOutputter::ShowTableLine( const ut::UnitTest * test )
+{
+    assert( nullptr != this );
+
+    if ( !m_isOpen )
+        return false;
+
+    const unsigned int index = test->GetIndex();
+    const ut::ItemCount failCount = test->GetFailCount();
+    const ut::ItemCount warnCount = test->GetWarnCount();
+    const ut::ItemCount passCount = test->GetPassCount();
+    const ut::ItemCount itemCount = test->GetItemCount();
+    const ut::ItemCount exceptCount = test->GetExceptionCount();
+    const ut::ItemCount skipCount = test->GetSkipCount();
+    HtmlResultColors colors( itemCount, passCount, warnCount,
+        failCount, exceptCount, skipCount );
+
+    m_outFile
+        << "<tr><td><span style=\"color: " << colors.testColor << "\">" << colors.testResult << "</span></td>"
+        << "<td>" << index << "</td>"
+        << "<td>" << test->GetName() << "</td>"
+        << "<th><span style=\"color: " << colors.passColor << "\">" << passCount   << "</span></th>"
+        << "<th><span style=\"color: " << colors.warnColor << "\">" << warnCount   << "</span></th>"
+        << "<th><span style=\"color: " << colors.failColor << "\">" << failCount   << "</span></th>"
+        << "<th><span style=\"color: " << colors.tossColor << "\">" << exceptCount << "</span></th>"
+        << "<th><span style=\"color: " << colors.skipColor << "\">" << skipCount   << "</span></th>"
+        << "<th>" << itemCount << "</th>";
+    const ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    if ( uts.DoesOutputOption( ut::UnitTestSet::Memory ) )
+    {
+        m_outFile
+            << "<td align=right>" << test->GetRssGrowth() << "</td>"
+            << "<td align=right>" << test->GetPeakRss() << "</td>"
+            << "<td align=right>" << test->GetMajorFaults() << "</td>"
+            << "<td align=right>" << test->GetMinorFaults() << "</td>";
+    }
+    string count;
+    for ( unsigned int ii = 0; ii < ut::UnitTest::CounterCount; ++ii )
+    {
+        if ( nullptr == uts.GetCounterName( ii ) )
+            continue;
+        count.clear();
+        AppendCount( count, test->GetCounter( ii ) );
+        m_outFile << "<td align=right>" << count << "</td>";
+    }
+    m_outFile << "</tr>" << endl;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HtmlOutputter::ShowLongTotalLine( ut::ItemCount passCount,
+    ut::ItemCount warnCount, ut::ItemCount failCount,
+    ut::ItemCount exceptCount, ut::ItemCount skipCount,
+    ut::ItemCount itemCount )
+{
+    assert( nullptr != this );
+
+    if ( !m_isOpen )
+        return false;
+
+    HtmlResultColors colors( itemCount, passCount, warnCount,
+        failCount, exceptCount, skipCount );
+    m_outFile
+        << "<tr><th><span style=\"color: " << colors.testColor << "\">"
+        << colors.testResult << "</span></th><th>-</th><th>Item Totals</th>"
+        << "<th><span style=\"color: " << colors.passColor << "\">" << passCount   << "</span></th>"
+        << "<th><span style=\"color: " << colors.warnColor << "\">" << warnCount   << "</span></th>"
+        << "<th><span style=\"color: " << colors.failColor << "\">" << failCount   << "</span></th>"
+        << "<th><span style=\"color: " << colors.tossColor << "\">" << exceptCount << "</span></th>"
+        << "<th><span style=\"color: " << colors.skipColor << "\">" << skipCount   << "</span></th>"
+        << "<th>" << itemCount << "</th>" << EmptyCounterCells() << "</tr>"
+        << endl;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HtmlOutputter::ShowSummaryLineWithSkips( unsigned int passCount,
+    unsigned int warnCount, unsigned int failCount, unsigned int exceptCount,
+    unsigned int skipCount, unsigned int testCount )
+{
+    assert( nullptr != this );
+
+    if ( !m_isOpen )
+        return false;
+
+    HtmlResultColors colors( testCount, passCount, warnCount,
+        failCount, exceptCount, skipCount );
+    m_outFile
+        << "<tr><th><span style=\"color: " << colors.testColor << "\">" << colors.testResult 
+        << "</span></th><th>-</th><th>Unit Test Results</th>"
+        << "<th><span style=\"color: " << colors.passColor << "\">" << passCount   << "</span></th>"
+        << "<th><span style=\"color: " << colors.warnColor << "\">" << warnCount   << "</span></th>"
+        << "<th><span style=\"color: " << colors.failColor << "\">" << failCount   << "</span></th>"
+        << "<th><span style=\"color: " << colors.tossColor << "\">" << exceptCount << "</span></th>"
+        << "<th><span style=\"color: " << colors.skipColor << "\">" << skipCount   << "</span></th>"
+        << "<th>" << testCount << "</th>" << EmptyCounterCells() << "</tr>"
+        << endl << "</table><br>" << endl;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HtmlOutputter::EndSummaryTable( void )
+{
+    assert( nullptr != this );
+
+    if ( !m_isOpen )
+        return false;
+
+    string contents;
+    const bool read_file = ReadFileIntoString( m_mainPageName.c_str(),
+        contents );
+    MainPageMaker mainPage( m_info, m_startTime,
+        m_mainPageName.c_str(), m_htmlFileName.c_str() );
+    const bool okay = read_file ?
+        mainPage.AddToContent( contents ) : mainPage.CreateFile();
+    assert( okay );
+    (void)okay;
+
+    MakeColorTable( m_outFile );
+    m_outFile << "</body>" << endl << "</html>" << endl;
+    Close();
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Appends s to target with XML escapes.  Chars XML can't hold become '?'.
+void AppendXmlEscaped( string & target, const char * s )
+{
+    assert( nullptr != s );
+    const char * run = s;
+    for ( ; '\0' != *s; ++s )
+    {
+        const unsigned char ch = static_cast< unsigned char >( *s );
+        const char * escape = nullptr;
+        switch ( ch )
+        {
+            case '&':  escape = "&amp;";  break;
+            case '<':  escape = "&lt;";   break;
+            case '>':  escape = "&gt;";   break;
+            case '\"': escape = "&quot;"; break;
+            case '\'': escape = "&apos;"; break;
+            case '\t': escape = "&#9;";   break;
+            case '\n': escape = "&#10;";  break;
+            case '\r': escape = "&#13;";  break;
+            default:
+                if ( ch < 0x20 )
+                    escape = "?";
+                break;
+        }
+        if ( nullptr == escape )
+            continue;
+        target.append( run, s - run );
+        target.append( escape );
+        run = s + 1;
+    }
+    target.append( run, s - run );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns s with XML escapes, so it may be streamed into XML output.
+string XmlEscaped( const char * s )
+{
+    string text;
+    AppendXmlEscaped( text, s );
+    return text;
+}
+
+// ----------------------------------------------------------------------------
+
+XmlOutputter::XmlOutputter( ::ut::UnitTestSet::OutputOptions options ) :
+    FileOutputter(),
+    UnitTestResultReceiver(),
+    m_showIndexes( 0 != ( options & ut::UnitTestSet::AddTestIndex ) ),
+    m_filename()
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+XmlOutputter::~XmlOutputter( void )
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+bool XmlOutputter::Start( const char * name )
+{
+    assert( nullptr != this );
+    assert( !IsEmptyString( name ) );
+    assert( !m_isOpen );
+
+    Open( m_filename.c_str() );
+    if ( !m_isOpen )
+        return false;
+    m_outFile
+        << "<UnitTestResults" << endl
+        << "\tname=\"" << XmlEscaped( name ) << "\">" << endl
+        << "\t<Tests>" << endl << flush;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool XmlOutputter::ShowMessage( const ut::UnitTest * test,
+    const char * fileName, unsigned int line, const char * message )
+{
+    assert( nullptr != this );
+    assert( test != nullptr );
+    assert( !IsEmptyString( fileName ) );
+    assert( !IsEmptyString( message ) );
+    if ( !m_isOpen )
+        return false;
+
+    m_outFile
+        << "\t\t<Message" << endl
+        << "\t\t\tfile=\"" << XmlEscaped( fileName ) << '\"' << endl
+        << "\t\t\tline=\"" << line << '\"' << endl
+        << "\t\t\tunit=\"" << test->GetIndex() << "\">" << endl
+        << "\t\t\t<message>\"" << XmlEscaped( message ) << "\"</message>"
+        << endl
+        << "\t\t</Message>" << endl << flush;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool XmlOutputter::ShowTestHeader( const ut::UnitTest * test )
+{
+    assert( nullptr != this );
+    assert( test != nullptr );
+    if ( !m_isOpen )
+        return false;
+
+    m_outFile
+        << "\t\t<Unit" << endl
+        << "\t\t\tname=\"" << XmlEscaped( test->GetName() ) << '\"' << endl
+        << "\t\t\tunit=\"" << test->GetIndex() << "\">" << endl
+        << "\t\t</Unit>" << endl << flush;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool XmlOutputter::ShowTestLine( const ut::UnitTest * test,
+    ut::TestResult::EnumType result, const char * fileName,
+    unsigned int line, const char * expression, const char * message )
+{
+    assert( nullptr != this );
+    assert( test != nullptr );
+    assert( !IsEmptyString( fileName ) );
+    assert( !IsEmptyString( expression ) );
+    if ( !m_isOpen )
+        return false;
+
+    const char * resultName = ut::TestResult::GetName( result );
+    m_outFile
+        << "\t\t<Test" << endl
+        << "\t\t\tfile=\"" << XmlEscaped( fileName ) << '\"' << endl
+        << "\t\t\tline=\"" << line << '\"' << endl
+        << "\t\t\tresult=\"" << resultName << '\"' << endl
+        << "\t\t\tunit=\"" << test->GetIndex() << '\"' << endl
+        << "\t\t\tindex=\"" << test->GetItemCount() << "\">" << endl
+        << "\t\t\t<expression>\"" << XmlEscaped( expression )
+        << "\"</expression>" << endl;
+    if ( !IsEmptyString( message ) )
+        m_outFile << "\t\t\t<message>\"" << XmlEscaped( message )
+            << "\"</message>" << endl;
+    if ( ut::TestResult::Fatal == result )
+    {
+        m_outFile
+            << "\t\t\t<fatal>\"A required test failed!  ";
+        if ( ut::UnitTestSet::GetIt().WillFatalEndProgram( test ) )
+            m_outFile << "Unable to safely execute further tests!  "
+                << "Program must exit now!\"</fatal>" << endl;
+        else
+            m_outFile << "Unable to safely execute further items!  "
+                << "Unit test must end now!\"</fatal>" << endl;
+    }
+     m_outFile << "\t\t</Test>" << endl << flush;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool XmlOutputter::ShowTimeStamp( bool isStartTime, const char * timestamp )
+{
+    assert( nullptr != this );
+    assert( !IsEmptyString( timestamp ) );
+    if ( !m_isOpen )
+        return false;
+
+    const char * name = ( isStartTime ) ? "\t\tstart=\"" : "\t\tstop=\"";
+    if ( isStartTime )
+        m_outFile << "\t</Tests>" << endl << "\t<TimeStamps" << endl;
+    m_outFile << name << timestamp << '\"';
+    if ( !isStartTime )
+        m_outFile << '>' << endl << "\t</TimeStamps>";
+    m_outFile << endl << flush;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool XmlOutputter::StartSummaryTable( void )
+{
+    assert( nullptr != this );
+    return m_isOpen;
+}
+
+// ----------------------------------------------------------------------------
+
+bool XmlOutputter::ShowTableLine( const ut::UnitTest * test )
+{
+    assert( nullptr != this );
+    assert( test != nullptr );
+    if ( !m_isOpen )
+        return false;
+
+    const bool passed = test->DidPass();
+    const char * result = ( passed ) ? "Passed" : "FAILED";
+    if ( passed && test->WasSkipped() )
+        result = "Skipped";
+    if ( test->GetIndex() == 1 )
+        m_outFile << "\t<SummaryTable>" << endl;
+    m_outFile
+        << "\t\t<UnitTest" << endl
+        << "\t\t\tname=\"" << XmlEscaped( test->GetName() ) << '\"' << endl
+        << "\t\t\tindex=\"" << test->GetIndex() << '\"' << endl
+        << "\t\t\tresult=\"" << result << '\"' << endl
+        << "\t\t\tpassed=\"" << test->GetPassCount() << '\"' << endl
+        << "\t\t\twarnings=\"" << test->GetWarnCount() << '\"' << endl
+        << "\t\t\tfailed=\"" << test->GetFailCount() << '\"' << endl
+        << "\t\t\texceptions=\"" << test->GetExceptionCount() << '\"' << endl
+        << "\t\t\tskipped=\"" << test->GetSkipCount() << '\"' << endl
+        << "\t\t\ttested=\"" << test->GetItemCount() << '\"' << endl
+        << "\t\t\tseconds=\"" << test->GetElapsedTime() << '\"' << endl
+        << "\t\t\tvirtualSeconds=\"" << test->GetVirtualTime() << '\"' << endl
+        << "\t\t\trssGrowthKb=\"" << test->GetRssGrowth() << '\"' << endl
+        << "\t\t\tpeakRssKb=\"" << test->GetPeakRss() << '\"' << endl
+        << "\t\t\tmajorFaults=\"" << test->GetMajorFaults() << '\"' << endl
+        << "\t\t\tminorFaults=\"" << test->GetMinorFaults() << '\"';
+    // Counts may pass 2 to the 32nd power, so they bypass the stream's
+    // exponent format.
+    const ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    string count;
+    for ( unsigned int ii = 0; ii < ut::UnitTest::CounterCount; ++ii )
+    {
+        const char * key = uts.GetCounterKey( ii );
+        if ( nullptr == key )
+            continue;
+        count.clear();
+        AppendCount( count, test->GetCounter( ii ) );
+        m_outFile << endl << "\t\t\t" << key << "=\"" << count << '\"';
+    }
+    m_outFile << ">" << endl
+        << "\t\t</UnitTest>" << endl << flush;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool XmlOutputter::ShowLongTotalLine( ut::ItemCount passCount,
+    ut::ItemCount warnCount, ut::ItemCount failCount,
+    ut::ItemCount exceptCount, ut::ItemCount skipCount,
+    ut::ItemCount itemCount )
+{
+    assert( nullptr != this );
+    if ( !m_isOpen )
+        return false;
+
+    const bool passed = ( failCount == 0 ) && ( exceptCount == 0 );
+    const char * result = ( passed ) ? "Passed" : "FAILED";
+    m_outFile
+        << "\t\t<ItemTotals" << endl
+        << "\t\t\tresult=\"" << result << '\"' << endl
+        << "\t\t\tpassed=\"" << passCount << '\"' << endl
+        << "\t\t\twarnings=\"" << warnCount << '\"' << endl
+        << "\t\t\tfailed=\"" << failCount << '\"' << endl
+        << "\t\t\texceptions=\"" << exceptCount << '\"' << endl
+        << "\t\t\tskipped=\"" << skipCount << '\"' << endl
+        << "\t\t\ttested=\"" << itemCount << "\">" << endl
+        << "\t\t</ItemTotals>" << endl << flush;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool XmlOutputter::ShowSummaryLineWithSkips( unsigned int passCount,
+    unsigned int warnCount, unsigned int failCount,
+    unsigned int exceptCount, unsigned int skipCount, unsigned int testCount )
+{
+    assert( nullptr != this );
+    if ( !m_isOpen )
+        return false;
+
+    const bool passed = ( failCount == 0 ) && ( exceptCount == 0 );
+    const char * result = ( passed ) ? "Passed" : "FAILED";
+    m_outFile
+        << "\t\t<TestTotals" << endl
+        << "\t\t\tresult=\"" << result << '\"' << endl
+        << "\t\t\tpassed=\"" << passCount << '\"' << endl
+        << "\t\t\twarnings=\"" << warnCount << '\"' << endl
+        << "\t\t\tfailed=\"" << failCount << '\"' << endl
+        << "\t\t\texceptions=\"" << exceptCount << '\"' << endl
+        << "\t\t\tskipped=\"" << skipCount << '\"' << endl
+        << "\t\t\ttested=\"" << testCount << "\">" << endl
+        << "\t\t</TestTotals>" << endl << flush;
+    m_outFile << "\t</SummaryTable>" << endl << flush;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool XmlOutputter::EndSummaryTable( void )
+{
+    assert( nullptr != this );
+    m_outFile << "</UnitTestResults>" << endl << flush;
+    Close();
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+/** Lookup table for escaping chars within JSON strings.  Zero means the char
+ is copied as is, 'u' means it needs a \u00XX escape, and any other value is
+ the char placed after a backslash.
+ */
+static const char s_JsonEscapes[ 256 ] =
+{
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+      0,   0, '"',   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,'\\',   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, 'u'
+    // Remaining entries are zero so bytes of UTF-8 sequences are copied as is.
+};
+
+// ----------------------------------------------------------------------------
+
+/// Appends s to target with JSON escapes, copying runs of plain chars at once.
+void AppendJsonEscaped( string & target, const char * s )
+{
+    static const char * const s_hexDigits = "0123456789abcdef";
+    assert( nullptr != s );
+    const char * run = s;
+    for ( ; '\0' != *s; ++s )
+    {
+        const unsigned char ch = static_cast< unsigned char >( *s );
+        const char escape = s_JsonEscapes[ ch ];
+        if ( 0 == escape )
+            continue;
+        target.append( run, s - run );
+        run = s + 1;
+        target += '\\';
+        target += escape;
+        if ( 'u' == escape )
+        {
+            target.append( "00", 2 );
+            target += s_hexDigits[ ch >> 4 ];
+            target += s_hexDigits[ ch & 0x0F ];
+        }
+    }
+    target.append( run, s - run );
+}
+
+// ----------------------------------------------------------------------------
+
+/** Appends decimal digits of value to target.
+ @param width Minimum # of digits.  Zeros are added in front to fill width.
+ */
+void AppendNumber( string & target, ut::ItemCount value,
+    unsigned int width = 0 )
+{
+    char digits[ 24 ];
+    char * first = digits + sizeof(digits);
+    do
+    {
+        *--first = static_cast< char >( '0' + ( value % 10 ) );
+        value /= 10;
+    } while ( 0 != value );
+    const unsigned int length = static_cast< unsigned int >
+        ( digits + sizeof(digits) - first );
+    if ( length < width )
+        target.append( width - length, '0' );
+    target.append( first, length );
+}
+
+// ----------------------------------------------------------------------------
+
+JsonOutputter::JsonOutputter( void ) :
+    FileOutputter(),
+    UnitTestResultReceiver(),
+    m_filename(),
+    m_line()
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+JsonOutputter::~JsonOutputter( void )
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+void JsonOutputter::StartEvent( const char * event )
+{
+    assert( nullptr != this );
+    m_line.erase();
+    m_line.append( "{\"event\":\"" );
+    m_line.append( event );
+    m_line += '\"';
+}
+
+// ----------------------------------------------------------------------------
+
+void JsonOutputter::AddString( const char * name, const char * value )
+{
+    assert( nullptr != this );
+    m_line.append( ",\"" );
+    m_line.append( name );
+    m_line.append( "\":\"" );
+    AppendJsonEscaped( m_line, value );
+    m_line += '\"';
+}
+
+// ----------------------------------------------------------------------------
+
+void JsonOutputter::AddNumber( const char * name, ut::ItemCount value )
+{
+    assert( nullptr != this );
+    m_line.append( ",\"" );
+    m_line.append( name );
+    m_line.append( "\":" );
+    AppendNumber( m_line, value );
+}
+
+// ----------------------------------------------------------------------------
+
+void JsonOutputter::AddSeconds( const char * name, double seconds )
+{
+    assert( nullptr != this );
+    if ( seconds < 0.0 )
+        seconds = 0.0;
+    unsigned long whole = static_cast< unsigned long >( seconds );
+    unsigned long micro = static_cast< unsigned long >
+        ( ( seconds - whole ) * 1000000.0 + 0.5 );
+    if ( 1000000UL <= micro )
+    {
+        ++whole;
+        micro -= 1000000UL;
+    }
+    m_line.append( ",\"" );
+    m_line.append( name );
+    m_line.append( "\":" );
+    AppendNumber( m_line, whole );
+    m_line += '.';
+    AppendNumber( m_line, micro, 6 );
+}
+
+// ----------------------------------------------------------------------------
+
+void JsonOutputter::AddCounts( ut::ItemCount passCount,
+    ut::ItemCount warnCount, ut::ItemCount failCount,
+    ut::ItemCount exceptCount, ut::ItemCount skipCount,
+    ut::ItemCount totalCount )
+{
+    assert( nullptr != this );
+    const bool passed = ( failCount == 0 ) && ( exceptCount == 0 );
+    const char * result = ( passed ) ? "Passed" : "FAILED";
+    if ( passed && ( 0 < skipCount ) )
+        result = "Skipped";
+    AddString( "result", result );
+    AddNumber( "passed", passCount );
+    AddNumber( "warnings", warnCount );
+    AddNumber( "failed", failCount );
+    AddNumber( "exceptions", exceptCount );
+    AddNumber( "skipped", skipCount );
+    AddNumber( "tested", totalCount );
+}
+
+// ----------------------------------------------------------------------------
+
+void JsonOutputter::EndEvent( bool flushNow )
+{
+    assert( nullptr != this );
+    m_line.append( "}\n" );
+    m_outFile.write( m_line.data(), static_cast< streamsize >( m_line.size() ) );
+    if ( flushNow )
+        m_outFile << flush;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JsonOutputter::Start( const char * name )
+{
+    assert( nullptr != this );
+    assert( !IsEmptyString( name ) );
+    assert( !m_isOpen );
+
+    Open( m_filename.c_str() );
+    if ( !m_isOpen )
+        return false;
+    m_line.reserve( 1024 );
+    StartEvent( "start" );
+    AddString( "name", name );
+    EndEvent( true );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JsonOutputter::ShowMessage( const ut::UnitTest * test,
+    const char * fileName, unsigned int line, const char * message )
+{
+    assert( nullptr != this );
+    assert( test != nullptr );
+    if ( !m_isOpen )
+        return false;
+
+    StartEvent( "message" );
+    AddNumber( "unit", test->GetIndex() );
+    AddString( "file", fileName );
+    AddNumber( "line", line );
+    AddString( "message", message );
+    EndEvent( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JsonOutputter::ShowTestHeader( const ut::UnitTest * test )
+{
+    assert( nullptr != this );
+    assert( test != nullptr );
+    if ( !m_isOpen )
+        return false;
+
+    StartEvent( "header" );
+    AddNumber( "unit", test->GetIndex() );
+    AddString( "name", test->GetName() );
+    EndEvent( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JsonOutputter::ShowTestLine( const ut::UnitTest * test,
+    ut::TestResult::EnumType result, const char * fileName,
+    unsigned int line, const char * expression, const char * message )
+{
+    assert( nullptr != this );
+    assert( test != nullptr );
+    if ( !m_isOpen )
+        return false;
+
+    StartEvent( "item" );
+    AddNumber( "unit", test->GetIndex() );
+    AddString( "name", test->GetName() );
+    AddNumber( "index", test->GetItemCount() );
+    AddString( "result", ut::TestResult::GetName( result ) );
+    AddString( "file", fileName );
+    AddNumber( "line", line );
+    AddString( "expression", expression );
+    if ( !IsEmptyString( message ) )
+        AddString( "message", message );
+    // Failures are flushed right away so they are in the file even if the
+    // host program crashes or exits before the summary.
+    const bool isFailure = ( ut::TestResult::Passed != result )
+        && ( ut::TestResult::Warning != result );
+    EndEvent( isFailure );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JsonOutputter::ShowTimeStamp( bool isStartTime, const char * timestamp )
+{
+    assert( nullptr != this );
+    assert( !IsEmptyString( timestamp ) );
+    if ( !m_isOpen )
+        return false;
+
+    StartEvent( "timestamp" );
+    AddString( "kind", ( isStartTime ) ? "start" : "stop" );
+    AddString( "time", timestamp );
+    EndEvent( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JsonOutputter::StartSummaryTable( void )
+{
+    assert( nullptr != this );
+    return m_isOpen;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JsonOutputter::ShowTableLine( const ut::UnitTest * test )
+{
+    assert( nullptr != this );
+    assert( test != nullptr );
+    if ( !m_isOpen )
+        return false;
+
+    StartEvent( "table" );
+    AddNumber( "unit", test->GetIndex() );
+    AddString( "name", test->GetName() );
+    AddCounts( test->GetPassCount(), test->GetWarnCount(),
+        test->GetFailCount(), test->GetExceptionCount(),
+        test->GetSkipCount(), test->GetItemCount() );
+    AddSeconds( "seconds", test->GetElapsedTime() );
+    AddSeconds( "virtual_seconds", test->GetVirtualTime() );
+    EndEvent( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JsonOutputter::ShowLongTotalLine( ut::ItemCount passCount,
+    ut::ItemCount warnCount, ut::ItemCount failCount,
+    ut::ItemCount exceptCount, ut::ItemCount skipCount,
+    ut::ItemCount itemCount )
+{
+    assert( nullptr != this );
+    if ( !m_isOpen )
+        return false;
+
+    StartEvent( "item_totals" );
+    AddCounts( passCount, warnCount, failCount, exceptCount, skipCount,
+        itemCount );
+    EndEvent( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JsonOutputter::ShowSummaryLineWithSkips( unsigned int passCount,
+    unsigned int warnCount, unsigned int failCount, unsigned int exceptCount,
+    unsigned int skipCount, unsigned int testCount )
+{
+    assert( nullptr != this );
+    if ( !m_isOpen )
+        return false;
+
+    StartEvent( "test_totals" );
+    AddCounts( passCount, warnCount, failCount, exceptCount, skipCount,
+        testCount );
+    EndEvent( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JsonOutputter::ShowFixtureLine( const char * fixtureName,
+    bool isWorker, unsigned int setUpCount, double setUpSeconds,
+    double tearDownSeconds )
+{
+    assert( nullptr != this );
+    if ( !m_isOpen )
+        return false;
+
+    StartEvent( "fixture" );
+    AddString( "name", fixtureName );
+    AddString( "scope", ( isWorker ) ? "worker" : "suite" );
+    AddNumber( "set_ups", setUpCount );
+    AddSeconds( "set_up_seconds", setUpSeconds );
+    AddSeconds( "tear_down_seconds", tearDownSeconds );
+    EndEvent( false );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JsonOutputter::EndSummaryTable( void )
+{
+    assert( nullptr != this );
+    if ( !m_isOpen )
+        return false;
+
+    StartEvent( "end" );
+    EndEvent( true );
+    Close();
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+
+// ----------------------------------------------------------------------------
+
+/** Appends seconds with 6 decimal places to target.  The whole part is padded
+ with zeros to 9 digits so the text always has the same width.
+ */
+void AppendSeconds( string & target, double seconds )
+{
+    if ( seconds < 0.0 )
+        seconds = 0.0;
+    if ( 999999999.0 < seconds )
+        seconds = 999999999.0;
+    unsigned long whole = static_cast< unsigned long >( seconds );
+    unsigned long micro = static_cast< unsigned long >
+        ( ( seconds - whole ) * 1000000.0 + 0.5 );
+    if ( 1000000UL <= micro )
+    {
+        ++whole;
+        micro -= 1000000UL;
+    }
+    AppendNumber( target, whole, 9 );
+    target += '.';
+    AppendNumber( target, micro, 6 );
+}
+
+// ----------------------------------------------------------------------------
+
+JUnitOutputter::JUnitOutputter( void ) :
+    FileOutputter(),
+    UnitTestResultReceiver(),
+    m_filename(),
+    m_suiteName(),
+    m_line(),
+    m_written(),
+    m_bodyOf(),
+    m_bodies(),
+    m_totalsPos(),
+    m_caseCount( 0 ),
+    m_failureCount( 0 ),
+    m_errorCount( 0 ),
+    m_skipCount( 0 ),
+    m_totalTime( 0.0 )
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+JUnitOutputter::~JUnitOutputter( void )
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+void JUnitOutputter::WriteLine( void )
+{
+    assert( nullptr != this );
+    m_outFile.write( m_line.data(), static_cast< streamsize >( m_line.size() ) );
+    m_line.erase();
+}
+
+// ----------------------------------------------------------------------------
+
+bool JUnitOutputter::Start( const char * name )
+{
+    assert( nullptr != this );
+    assert( !IsEmptyString( name ) );
+    assert( !m_isOpen );
+
+    Open( m_filename.c_str() );
+    if ( !m_isOpen )
+        return false;
+
+    m_suiteName.erase();
+    AppendXmlEscaped( m_suiteName, name );
+    m_written.clear();
+    m_bodyOf.clear();
+    m_bodies.clear();
+    m_caseCount = 0;
+    m_failureCount = 0;
+    m_errorCount = 0;
+    m_skipCount = 0;
+    m_totalTime = 0.0;
+    m_line.reserve( 1024 );
+
+    m_line.append( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n" );
+    m_line.append( "  <testsuite name=\"" );
+    m_line.append( m_suiteName );
+    m_line += '\"';
+    WriteLine();
+    m_totalsPos = m_outFile.tellp();
+    // Placeholder has same width as totals written by Finish.
+    m_line.append( " tests=\"0000000000\" failures=\"0000000000\""
+        " errors=\"0000000000\" skipped=\"0000000000\""
+        " time=\"000000000.000000\">\n" );
+    WriteLine();
+    m_outFile << flush;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+string & JUnitOutputter::GetBody( const ut::UnitTest * test )
+{
+    assert( nullptr != this );
+    const unsigned int index = test->GetIndex();
+    if ( m_bodyOf.size() <= index )
+        m_bodyOf.resize( index + 1, 0 );
+    if ( 0 == m_bodyOf[ index ] )
+    {
+        m_bodies.push_back( string() );
+        m_bodyOf[ index ] = static_cast< unsigned int >( m_bodies.size() );
+    }
+    return m_bodies[ m_bodyOf[ index ] - 1 ];
+}
+
+// ----------------------------------------------------------------------------
+
+void JUnitOutputter::WriteTestCase( const ut::UnitTest * test )
+{
+    assert( nullptr != this );
+
+    const unsigned int index = test->GetIndex();
+    if ( ( index < m_written.size() ) && m_written[ index ] )
+        return;
+    if ( m_written.size() <= index )
+        m_written.resize( index + 1, false );
+    m_written[ index ] = true;
+
+    const double seconds = test->GetElapsedTime();
+    m_totalTime += seconds;
+    ++m_caseCount;
+    // A testcase with both errors and failures counts as an error.
+    const bool isError = ( 0 < test->GetExceptionCount() );
+    const bool isEmpty = ( 0 == test->GetItemCount() );
+    if ( isError )
+        ++m_errorCount;
+    else if ( !test->DidPass() )
+        ++m_failureCount;
+    else if ( isEmpty || ( 0 < test->GetSkipCount() ) )
+        ++m_skipCount;
+
+    m_line.append( "    <testcase classname=\"" );
+    m_line.append( m_suiteName );
+    m_line.append( "\" name=\"" );
+    AppendXmlEscaped( m_line, test->GetName() );
+    m_line.append( "\" time=\"" );
+    AppendSeconds( m_line, seconds );
+    m_line.append( "\">\n" );
+
+    const unsigned int place =
+        ( index < m_bodyOf.size() ) ? m_bodyOf[ index ] : 0;
+    if ( 0 != place )
+    {
+        // Release memory, since this UnitTest is done with.
+        string & body = m_bodies[ place - 1 ];
+        m_line.append( body );
+        string empty;
+        body.swap( empty );
+    }
+    else if ( isEmpty )
+        m_line.append( "      <skipped message=\"No test items\"/>\n" );
+    else if ( !test->DidPass() )
+    {
+        // Failures were not shown, so only counts are known.
+        const char * element = ( isError ) ? "error" : "failure";
+        m_line.append( "      <" );
+        m_line.append( element );
+        m_line.append( " message=\"" );
+        AppendNumber( m_line, test->GetFailCount() );
+        m_line.append( " failed, " );
+        AppendNumber( m_line, test->GetExceptionCount() );
+        m_line.append( " thrown\"/>\n" );
+    }
+    m_line.append( "    </testcase>\n" );
+    WriteLine();
+}
+
+// ----------------------------------------------------------------------------
+
+bool JUnitOutputter::ShowTestLine( const ut::UnitTest * test,
+    ut::TestResult::EnumType result, const char * fileName,
+    unsigned int line, const char * expression, const char * message )
+{
+    assert( nullptr != this );
+    assert( test != nullptr );
+    if ( !m_isOpen )
+        return false;
+
+    if ( ( ut::TestResult::Passed == result )
+      || ( ut::TestResult::Warning == result ) )
+        return true;
+    // Elements are kept until the testcase is written, since items of other
+    // UnitTest's may come between items of this one.
+    string & body = GetBody( test );
+    if ( ut::TestResult::Skipped == result )
+    {
+        body.append( "      <skipped message=\"" );
+        AppendXmlEscaped( body, expression );
+        if ( !IsEmptyString( message ) )
+        {
+            body.append( ": " );
+            AppendXmlEscaped( body, message );
+        }
+        body.append( "\"/>\n" );
+        return true;
+    }
+
+    const bool isError = ( ut::TestResult::Thrown == result );
+    const char * element = ( isError ) ? "error" : "failure";
+    body.append( "      <" );
+    body.append( element );
+    body.append( " type=\"" );
+    body.append( ut::TestResult::GetName( result ) );
+    body.append( "\" message=\"" );
+    AppendXmlEscaped( body, expression );
+    body.append( "\">" );
+    AppendXmlEscaped( body, fileName );
+    body += '(';
+    AppendNumber( body, line );
+    body.append( ") : " );
+    AppendXmlEscaped( body, expression );
+    if ( !IsEmptyString( message ) )
+    {
+        body.append( "  " );
+        AppendXmlEscaped( body, message );
+    }
+    body.append( "</" );
+    body.append( element );
+    body.append( ">\n" );
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JUnitOutputter::StartSummaryTable( void )
+{
+    assert( nullptr != this );
+    return m_isOpen;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JUnitOutputter::ShowTableLine( const ut::UnitTest * test )
+{
+    assert( nullptr != this );
+    assert( test != nullptr );
+    if ( !m_isOpen )
+        return false;
+
+    WriteTestCase( test );
+    m_outFile << flush;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+void JUnitOutputter::ShowTestCases( const TUnitTestChildren & tests )
+{
+    assert( nullptr != this );
+    if ( !m_isOpen )
+        return;
+
+    TUnitTestChildrenCIter last( tests.end() );
+    for ( TUnitTestChildrenCIter it( tests.begin() ); it != last; ++it )
+    {
+        if ( nullptr != *it )
+            WriteTestCase( *it );
+    }
+    m_outFile << flush;
+    // Indexes of UnitTest's made later start over, so forget these.
+    m_written.clear();
+    m_bodyOf.clear();
+    m_bodies.clear();
+}
+
+// ----------------------------------------------------------------------------
+
+void JUnitOutputter::Finish( void )
+{
+    assert( nullptr != this );
+    if ( !m_isOpen )
+        return;
+
+    m_line.append( "  </testsuite>\n</testsuites>\n" );
+    WriteLine();
+
+    m_outFile.seekp( m_totalsPos );
+    m_line.append( " tests=\"" );
+    AppendNumber( m_line, m_caseCount, 10 );
+    m_line.append( "\" failures=\"" );
+    AppendNumber( m_line, m_failureCount, 10 );
+    m_line.append( "\" errors=\"" );
+    AppendNumber( m_line, m_errorCount, 10 );
+    m_line.append( "\" skipped=\"" );
+    AppendNumber( m_line, m_skipCount, 10 );
+    m_line.append( "\" time=\"" );
+    AppendSeconds( m_line, m_totalTime );
+    WriteLine();
+    Close();
+}
+
+// ----------------------------------------------------------------------------
+
+bool JUnitOutputter::EndSummaryTable( void )
+{
+    assert( nullptr != this );
+    if ( !m_isOpen )
+        return false;
+    Finish();
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+void JUnitOutputter::FinalEnd( void )
+{
+    assert( nullptr != this );
+    Finish();
+}
+
+// ----------------------------------------------------------------------------
+
+/// UnitTest's whose prerequisites are done, lowest place first.
+typedef std::priority_queue< unsigned int, std::vector< unsigned int >,
+    std::greater< unsigned int > > TReadyUnitTests;
+
+/// Adds each dependent to ready queue once all its prerequisites are done.
+void ReleaseDependents( const std::vector< unsigned int > & dependents,
+    std::vector< unsigned int > & waitCount, TReadyUnitTests & ready )
+{
+    for ( unsigned int ii = 0; ii < dependents.size(); ++ii )
+        if ( 0 == --waitCount[ dependents[ ii ] ] )
+            ready.push( dependents[ ii ] );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Length sent in place of a NULL string within an isolated event.
+static const unsigned int s_NoString = 0xFFFFFFFF;
+
+/// Most child processes which may run at once.
+static const unsigned int s_MaxWorkers = 64;
+
+/// Most chars of standard error kept from the child of a death test.
+static const size_t s_MaxDeathOutput = 65536;
+
+/// Most chars of standard error placed into a failure message.
+static const size_t s_MaxDeathQuote = 120;
+
+/// Adds number in native form, since parent and child are the same program.
+inline void AppendEventNumber( string & target, unsigned int value )
+{
+    target.append( reinterpret_cast< const char * >( &value ), sizeof(value) );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Adds length of string and its chars, or just s_NoString if NULL.
+void AppendEventString( string & target, const char * value )
+{
+    if ( nullptr == value )
+    {
+        AppendEventNumber( target, s_NoString );
+        return;
+    }
+    const size_t length = ::strlen( value );
+    AppendEventNumber( target, static_cast< unsigned int >( length ) );
+    target.append( value, length );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Reads a number added by AppendEventNumber, or returns false if cut off.
+bool ReadEventNumber( const string & source, size_t & place,
+    unsigned int & value )
+{
+    if ( source.size() < place + sizeof(value) )
+        return false;
+    ::memcpy( &value, source.data() + place, sizeof(value) );
+    place += sizeof(value);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Reads a string added by AppendEventString, or returns false if cut off.
+bool ReadEventString( const string & source, size_t & place, string & value,
+    bool & exists )
+{
+    unsigned int length = 0;
+    if ( !ReadEventNumber( source, place, length ) )
+        return false;
+    exists = ( s_NoString != length );
+    value.erase();
+    if ( !exists )
+        return true;
+    if ( source.size() < place + length )
+        return false;
+    value.assign( source, place, length );
+    place += length;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+/** @struct IsolatedEvent
+ @brief Contents of one event sent by a child process.
+ */
+struct IsolatedEvent
+{
+    char m_kind;               ///< One of IsolatedEventKind.
+    unsigned int m_level;      ///< Severity level of test item.
+    unsigned int m_pass;       ///< Nonzero if test item passed.
+    unsigned int m_line;       ///< Source code line.
+    string m_test;             ///< Name of UnitTest.
+    string m_fileName;         ///< Name of source code file.
+    string m_expression;       ///< Expression, or text of message.
+    string m_message;          ///< Optional message.
+    bool m_hasMessage;         ///< True if message was not NULL.
+};
+
+// ----------------------------------------------------------------------------
+
+/// Reads next event from child, or returns false if none are complete.
+bool ReadEvent( const string & source, size_t & place, IsolatedEvent & event )
+{
+    if ( source.size() <= place )
+        return false;
+    event.m_kind = source[ place ];
+    ++place;
+    bool exists = false;
+    return ReadEventNumber( source, place, event.m_level )
+        && ReadEventNumber( source, place, event.m_pass )
+        && ReadEventNumber( source, place, event.m_line )
+        && ReadEventString( source, place, event.m_test, exists )
+        && ReadEventString( source, place, event.m_fileName, exists )
+        && ReadEventString( source, place, event.m_expression, exists )
+        && ReadEventString( source, place, event.m_message,
+            event.m_hasMessage );
+}
+
+// ----------------------------------------------------------------------------
+
+#if !defined( _WIN32 )
+
+/// Writes all of data to pipe, or returns false if pipe is broken.
+bool WriteAll( int pipe, const char * data, size_t size )
+{
+    while ( 0 < size )
+    {
+        const ssize_t written = ::write( pipe, data, size );
+        if ( written < 0 )
+        {
+            if ( EINTR == errno )
+                continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast< size_t >( written );
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Reads whatever child sent, or returns false once child closed its pipe.
+bool ReadSome( IsolatedWorker & worker )
+{
+    char buffer[ 4096 ];
+    for ( ;; )
+    {
+        const ssize_t size = ::read( worker.m_pipe, buffer, sizeof(buffer) );
+        if ( 0 < size )
+        {
+            worker.m_events.append( buffer, static_cast< size_t >( size ) );
+            return true;
+        }
+        if ( ( size < 0 ) && ( EINTR == errno ) )
+            continue;
+        return false;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+/// Reads from pipe until the writer closes it, and keeps up to limit chars.
+void ReadAll( int pipe, string & target, size_t limit )
+{
+    char buffer[ 4096 ];
+    for ( ;; )
+    {
+        const ssize_t size = ::read( pipe, buffer, sizeof(buffer) );
+        if ( ( size < 0 ) && ( EINTR == errno ) )
+            continue;
+        if ( size <= 0 )
+            return;
+        const size_t room = ( target.size() < limit )
+            ? limit - target.size() : 0;
+        const size_t count = static_cast< size_t >( size );
+        target.append( buffer, ( count < room ) ? count : room );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+/** Returns true if text matches the extended regular expression, where ^ and
+ $ also match at each line.  Sets valid to false if pattern is not a regular
+ expression.
+ */
+bool MatchesPattern( const string & text, const char * pattern, bool & valid )
+{
+    regex_t expression;
+    const int flags = REG_EXTENDED | REG_NEWLINE | REG_NOSUB;
+    valid = ( 0 == ::regcomp( &expression, pattern, flags ) );
+    if ( !valid )
+        return false;
+    const bool matched =
+        ( 0 == ::regexec( &expression, text.c_str(), 0, nullptr, 0 ) );
+    ::regfree( &expression );
+    return matched;
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+
+/// Appends nanoseconds with 3 significant digits, in ns, us, ms, or s.
+void AppendDuration( string & target, double nanoseconds )
+{
+    const char * unit = " ns";
+    if ( 1.0e9 <= nanoseconds )
+    {
+        nanoseconds /= 1.0e9;
+        unit = " s";
+    }
+    else if ( 1.0e6 <= nanoseconds )
+    {
+        nanoseconds /= 1.0e6;
+        unit = " ms";
+    }
+    else if ( 1.0e3 <= nanoseconds )
+    {
+        nanoseconds /= 1.0e3;
+        unit = " us";
+    }
+    char text[ 32 ];
+    ::sprintf( text, "%.3g", nanoseconds );
+    target += text;
+    target += unit;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Largest sample count for which U distribution is counted exactly.
+const unsigned int s_MaxExactSamples = 20;
+
+// ----------------------------------------------------------------------------
+
+/// Returns median of values, which this sorts.
+double GetMedian( vector< double > & values )
+{
+    assert( !values.empty() );
+    ::std::sort( values.begin(), values.end() );
+    const size_t middle = values.size() / 2;
+    if ( 0 != ( values.size() % 2 ) )
+        return values[ middle ];
+    return ( values[ middle - 1 ] + values[ middle ] ) / 2.0;
+}
+
+// ----------------------------------------------------------------------------
+
+/** Returns chance a standard normal variable is greater than z.  This uses
+ the Chebyshev fit for erfc from Numerical Recipes, accurate to 1.2e-7, since
+ not every compiler provides erfc.
+ */
+double GetNormalTail( double z )
+{
+    const double x = ::fabs( z ) / ::sqrt( 2.0 );
+    const double t = 1.0 / ( 1.0 + 0.5 * x );
+    const double erfc = t * ::exp( -x * x - 1.26551223 + t * ( 1.00002368
+        + t * ( 0.37409196 + t * ( 0.09678418 + t * ( -0.18628806
+        + t * ( 0.27886807 + t * ( -1.13520398 + t * ( 1.48851587
+        + t * ( -0.82215223 + t * 0.17087277 ) ) ) ) ) ) ) ) );
+    return ( 0.0 <= z ) ? erfc / 2.0 : 1.0 - erfc / 2.0;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns z such that the chance a standard normal is greater than z is tail.
+double GetNormalQuantile( double tail )
+{
+    double low = -40.0;
+    double high = 40.0;
+    for ( unsigned int ii = 0; ii < 100; ++ii )
+    {
+        const double middle = ( low + high ) / 2.0;
+        if ( GetNormalTail( middle ) < tail )
+            high = middle;
+        else
+            low = middle;
+    }
+    return ( low + high ) / 2.0;
+}
+
+// ----------------------------------------------------------------------------
+
+/** Finds chance of each U value when two sets of m and n samples have no ties.
+ The # of orderings with a given U follows N(m,n,u) = N(m-1,n,u-n) +
+ N(m,n-1,u), so this builds one row of the table for each baseline sample.
+ @param m # of baseline samples.
+ @param n # of candidate samples.
+ @param chances Gets m*n+1 chances, one for each value of U.
+ */
+void GetUDistribution( unsigned int m, unsigned int n,
+    vector< double > & chances )
+{
+    vector< vector< double > > previous( n + 1, vector< double >( 1, 1.0 ) );
+    vector< vector< double > > current( n + 1 );
+    for ( unsigned int ii = 1; ii <= m; ++ii )
+    {
+        current[ 0 ].assign( 1, 1.0 );
+        for ( unsigned int jj = 1; jj <= n; ++jj )
+        {
+            vector< double > & counts = current[ jj ];
+            counts.assign( ii * jj + 1, 0.0 );
+            const vector< double > & fewerBase = previous[ jj ];
+            for ( size_t uu = jj; uu < counts.size(); ++uu )
+            {
+                if ( uu - jj < fewerBase.size() )
+                    counts[ uu ] += fewerBase[ uu - jj ];
+            }
+            const vector< double > & fewerCandidate = current[ jj - 1 ];
+            for ( size_t uu = 0; uu < fewerCandidate.size(); ++uu )
+                counts[ uu ] += fewerCandidate[ uu ];
+        }
+        previous.swap( current );
+    }
+    chances.swap( previous[ n ] );
+    double total = 0.0;
+    for ( size_t uu = 0; uu < chances.size(); ++uu )
+        total += chances[ uu ];
+    for ( size_t uu = 0; uu < chances.size(); ++uu )
+        chances[ uu ] /= total;
+}
+
+// ----------------------------------------------------------------------------
+
+/** Returns cost of checking invariants.  This is made at first use, so objects
+ made at static-initialization time may check invariants.
+ */
+InvariantCost & GetInvariantCost( void )
+{
+    static InvariantCost cost;
+    return cost;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns true if this call of CheckInvariants should do checks.
+inline bool IsInvariantCheckDue( void )
+{
+    if ( s_forceInvariants )
+        return true;
+    switch ( s_invariantPolicy )
+    {
+        case ut::UnitTestSet::CheckAlways:
+            return true;
+        case ut::UnitTestSet::CheckEveryNth:
+            if ( 0 != s_invariantCountdown )
+            {
+                --s_invariantCountdown;
+                return false;
+            }
+            s_invariantCountdown = s_invariantPeriod - 1;
+            return true;
+        default:
+            break;
+    }
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns tally of this thread, and adds one the first time it checks.
+InvariantTally & GetInvariantTally( void )
+{
+    if ( nullptr == s_invariantTally )
+    {
+        InvariantTally * tally = new InvariantTally;
+        InvariantCost & cost = GetInvariantCost();
+        MonitorLock lock( &cost.m_lock );
+        cost.m_tallies.push_back( tally );
+        s_invariantTally = tally;
+    }
+    return *s_invariantTally;
+}
+
+// ----------------------------------------------------------------------------
+
+/** Adds up checks of every thread since the last summary.  Threads still
+ running may add to their tallies meanwhile, so counts taken while tests run
+ elsewhere can be a few checks behind.
+ @param markShown True if the next summary should start over from here.
+ */
+void AddUpInvariantCost( ut::ItemCount & checks, double & seconds,
+    bool markShown )
+{
+    checks = 0;
+    seconds = 0.0;
+    InvariantCost & cost = GetInvariantCost();
+    MonitorLock lock( &cost.m_lock );
+    InvariantTallies::iterator last( cost.m_tallies.end() );
+    for ( InvariantTallies::iterator it( cost.m_tallies.begin() );
+        it != last; ++it )
+    {
+        InvariantTally & tally = **it;
+        const ut::ItemCount tallyChecks = tally.m_checks;
+        const double tallySeconds = tally.m_seconds;
+        checks += tallyChecks - tally.m_shownChecks;
+        seconds += tallySeconds - tally.m_shownSeconds;
+        if ( !markShown )
+            continue;
+        tally.m_shownChecks = tallyChecks;
+        tally.m_shownSeconds = tallySeconds;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+InvariantTimer::~InvariantTimer( void )
+{
+    assert( nullptr != this );
+    const double seconds = ut::LatencyHistogram::GetTime() - m_start;
+    InvariantTally & tally = GetInvariantTally();
+    ++tally.m_checks;
+    tally.m_seconds += seconds;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Picks a seed for stress tests and properties from the time and process id.
+unsigned int PickSeed( void )
+{
+    const double now = ut::LatencyHistogram::GetTime();
+    unsigned int seed = static_cast< unsigned int >( ::time( nullptr ) );
+    seed ^= static_cast< unsigned int >( ( now - ::floor( now ) ) * 1.0e9 );
+#if defined( _WIN32 )
+    seed ^= static_cast< unsigned int >( ::GetCurrentProcessId() ) << 16;
+#else
+    seed ^= static_cast< unsigned int >( ::getpid() ) << 16;
+#endif
+    return ( 0 == seed ) ? 1 : seed;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Entry point of each thread of a stress test.
+#if defined( _WIN32 )
+unsigned int __stdcall StressThreadEntry( void * data )
+#else
+void * StressThreadEntry( void * data )
+#endif
+{
+    StressWorker * worker = reinterpret_cast< StressWorker * >( data );
+    s_workerSlot = worker->m_thread->GetIndex() + 1;
+    worker->m_impl->RunStressThread( *worker );
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns # of processors available to this process, or 1 if unknown.
+unsigned int GetProcessorCount( void )
+{
+#if defined( _WIN32 )
+    SYSTEM_INFO info;
+    ::GetSystemInfo( &info );
+    const long count = static_cast< long >( info.dwNumberOfProcessors );
+#else
+    const long count = ::sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+    return ( count < 1 ) ? 1 : static_cast< unsigned int >( count );
+}
+
+// ----------------------------------------------------------------------------
+
+/** Returns seed for one case of a property.  Nearby cases get unrelated
+ seeds, since the bits are mixed as in the finalizer of MurmurHash3.
+ */
+unsigned int GetCaseSeed( unsigned int seed, unsigned int index )
+{
+    unsigned int mixed = seed + ( index + 1 ) * 0x9E3779B9u;
+    mixed ^= mixed >> 16;
+    mixed *= 0x85EBCA6Bu;
+    mixed ^= mixed >> 13;
+    mixed *= 0xC2B2AE35u;
+    mixed ^= mixed >> 16;
+    return mixed;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns size of one case of a property, growing from 1 for the first.
+inline unsigned int GetCaseSize( unsigned int index, unsigned int caseCount )
+{
+    return 1 + static_cast< unsigned int >( static_cast< double >( index )
+        * ( s_MaxPropertySize - 1 ) / caseCount );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Takes chunks of cases and runs them until none are left.
+void RunPropertyCases( PropertyRun & run )
+{
+    for ( ; ; )
+    {
+        unsigned int first = 0;
+        unsigned int end = 0;
+        {
+            MonitorLock lock( &run.m_monitor );
+            first = run.m_nextCase;
+            if ( run.m_firstFailure <= first )
+                return;
+            end = first + s_PropertyChunk;
+            if ( run.m_firstFailure < end )
+                end = run.m_firstFailure;
+            run.m_nextCase = end;
+        }
+        for ( unsigned int ii = first; ii < end; ++ii )
+        {
+            if ( run.m_property->RunCase( GetCaseSeed( run.m_seed, ii ),
+                GetCaseSize( ii, run.m_caseCount ) ) )
+                continue;
+            MonitorLock lock( &run.m_monitor );
+            if ( ii < run.m_firstFailure )
+                run.m_firstFailure = ii;
+            break;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+/// Entry point of each thread which runs property cases.
+#if defined( _WIN32 )
+unsigned int __stdcall PropertyThreadEntry( void * data )
+#else
+void * PropertyThreadEntry( void * data )
+#endif
+{
+    PropertyRun & run = *reinterpret_cast< PropertyRun * >( data );
+    {
+        MonitorLock lock( &run.m_monitor );
+        s_workerSlot = ++run.m_threadCount;
+    }
+    WorkerCounters counters( run.m_impl, run.m_test );
+    RunPropertyCases( run );
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+/** Runs cases of a property on several threads, including this one.
+ @return Index of first case which failed, or case count if none failed.
+ */
+unsigned int FindPropertyFailure( ut::UnitTestSetImpl * impl,
+    ut::UnitTest * test, const ut::PropertyRunner & property,
+    unsigned int seed, unsigned int caseCount, unsigned int threadCount )
+{
+    if ( 0 == threadCount )
+        threadCount = GetProcessorCount();
+    if ( s_MaxStressThreads < threadCount )
+        threadCount = s_MaxStressThreads;
+    const unsigned int chunks = ( caseCount + s_PropertyChunk - 1 )
+        / s_PropertyChunk;
+    if ( chunks < threadCount )
+        threadCount = ( 0 == chunks ) ? 1 : chunks;
+
+    PropertyRun run( impl, test, property, seed, caseCount );
+    vector< ThreadHandle > handles( threadCount );
+    unsigned int started = 0;
+    while ( ( started + 1 < threadCount )
+        && StartThread( handles[ started ], &PropertyThreadEntry, &run ) )
+        ++started;
+    // This thread runs cases too, so all cases run even if no thread starts.
+    RunPropertyCases( run );
+    for ( unsigned int ii = 0; ii < started; ++ii )
+        JoinThread( handles[ ii ] );
+    return run.m_firstFailure;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns place of first row which starts at or after offset.
+size_t FindRowStart( const CaseFileRun & run, size_t offset )
+{
+    if ( offset <= run.m_start )
+        return run.m_start;
+    const void * end = ::memchr( run.m_data + offset - 1, '\n',
+        run.m_size - offset + 1 );
+    return ( nullptr == end ) ? run.m_size
+        : static_cast< const char * >( end ) - run.m_data + 1;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns # of lines which start within a chunk.
+unsigned long CountChunkLines( const CaseFileRun & run, size_t chunk )
+{
+    const size_t begin = run.m_start + chunk * s_CaseChunkBytes;
+    const size_t end = ( run.m_size - begin < s_CaseChunkBytes )
+        ? run.m_size : begin + s_CaseChunkBytes;
+    unsigned long lines = 0;
+    for ( size_t at = FindRowStart( run, begin ); at < end; ++lines )
+    {
+        const void * newline = ::memchr( run.m_data + at, '\n',
+            run.m_size - at );
+        at = ( nullptr == newline ) ? run.m_size
+            : static_cast< const char * >( newline ) - run.m_data + 1;
+    }
+    return lines;
+}
+
+// ----------------------------------------------------------------------------
+
+/** Adds line number and text of the row a thread is at to the start of a
+ message.  Counts lines of earlier chunks which no thread has finished yet.
+ */
+void AppendCaseRow( string & message, const CaseCursor & cursor )
+{
+    CaseFileRun & run = *cursor.m_run;
+    unsigned long line = run.m_headerRows + cursor.m_line + 1;
+    for ( size_t ii = 0; ii < cursor.m_chunk; ++ii )
+    {
+        unsigned long lines = s_UnknownLines;
+        {
+            MonitorLock lock( &run.m_monitor );
+            lines = run.m_chunkLines[ ii ];
+        }
+        if ( s_UnknownLines == lines )
+        {
+            lines = CountChunkLines( run, ii );
+            MonitorLock lock( &run.m_monitor );
+            run.m_chunkLines[ ii ] = lines;
+        }
+        line += lines;
+    }
+
+    message += "Line ";
+    AppendNumber( message, line );
+    message += ": ";
+    const unsigned int length = cursor.m_row->GetLength();
+    message.append( cursor.m_row->GetText(),
+        ( length < s_MaxRowQuote ) ? length : s_MaxRowQuote );
+    if ( s_MaxRowQuote < length )
+        message += "...";
+}
+
+// ----------------------------------------------------------------------------
+
+/** Calls body for each row which starts within a chunk.
+ @return False if the run should stop, since a required item failed or an
+  exception escaped.
+ */
+bool RunCaseChunk( CaseFileRun & run, CaseCursor & cursor, ut::CaseRow & row,
+    unsigned long & calls )
+{
+    const size_t begin = run.m_start + cursor.m_chunk * s_CaseChunkBytes;
+    const size_t end = ( run.m_size - begin < s_CaseChunkBytes )
+        ? run.m_size : begin + s_CaseChunkBytes;
+    cursor.m_line = 0;
+    for ( size_t at = FindRowStart( run, begin ); at < end; ++cursor.m_line )
+    {
+        const char * text = run.m_data + at;
+        const void * newline = ::memchr( text, '\n', run.m_size - at );
+        size_t length = ( nullptr == newline ) ? run.m_size - at
+            : static_cast< const char * >( newline ) - text;
+        at += length + 1;
+        if ( ( 0 < length ) && ( '\r' == text[ length - 1 ] ) )
+            --length;
+        if ( 0 == length )
+            continue;
+        row.Split( text, static_cast< unsigned int >( length ),
+            run.m_separator );
+        ++calls;
+        try
+        {
+            run.m_body( run.m_test, run.m_state, row );
+        }
+        catch ( const UnitTestAbort & )
+        {
+            return false;
+        }
+        catch ( ... )
+        {
+            // Another thread may be unwinding from a required failure, in
+            // which case OnException throws rather than recording this.
+            try
+            {
+                run.m_test->OnException( __FILE__, __LINE__,
+                    ut::UnitTest::Checked, run.m_test->GetName(),
+                    "Exception escaped from case file body." );
+            }
+            catch ( const UnitTestAbort & )
+            {
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Takes chunks of a case file and reads them until none are left.
+void RunCaseChunks( CaseFileRun & run )
+{
+    ut::CaseRow row;
+    CaseCursor cursor;
+    cursor.m_run = &run;
+    cursor.m_chunk = 0;
+    cursor.m_line = 0;
+    cursor.m_row = &row;
+    cursor.m_passes = 0;
+    s_caseCursor = &cursor;
+    for ( ; ; )
+    {
+        {
+            MonitorLock lock( &run.m_monitor );
+            if ( run.m_stopped || ( run.m_chunkCount <= run.m_nextChunk ) )
+                break;
+            cursor.m_chunk = run.m_nextChunk++;
+        }
+        unsigned long calls = 0;
+        const bool finished = RunCaseChunk( run, cursor, row, calls );
+        run.m_impl->AddCasePasses( run.m_test, cursor.m_passes );
+        cursor.m_passes = 0;
+        MonitorLock lock( &run.m_monitor );
+        run.m_rowCount += calls;
+        if ( finished )
+            run.m_chunkLines[ cursor.m_chunk ] = cursor.m_line;
+        else
+            run.m_stopped = true;
+    }
+    s_caseCursor = nullptr;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Entry point of each thread which reads a case file.
+#if defined( _WIN32 )
+unsigned int __stdcall CaseFileThreadEntry( void * data )
+#else
+void * CaseFileThreadEntry( void * data )
+#endif
+{
+    CaseFileRun & run = *reinterpret_cast< CaseFileRun * >( data );
+    {
+        MonitorLock lock( &run.m_monitor );
+        s_workerSlot = ++run.m_threadCount;
+    }
+    WorkerCounters counters( run.m_impl, run.m_test );
+    RunCaseChunks( run );
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+/// # of bytes compared at once while looking for first difference.
+static const size_t s_CompareBlock = 4096;
+
+/// # of bytes shown before and after first difference of a snapshot.
+static const size_t s_SnapshotContext = 32;
+
+/** Returns offset of first byte which differs, or size if none do.  Blocks
+ are compared with memcmp, which the C library vectorizes, and only the block
+ which differs is searched byte by byte.
+ */
+size_t FindFirstDifference( const char * left, const char * right,
+    size_t size )
+{
+    if ( ::memcmp( left, right, size ) == 0 )
+        return size;
+    size_t at = 0;
+    for ( ; at < size; at += s_CompareBlock )
+    {
+        const size_t block = ( size - at < s_CompareBlock )
+            ? size - at : s_CompareBlock;
+        if ( ::memcmp( left + at, right + at, block ) != 0 )
+            break;
+    }
+    while ( ( at < size ) && ( left[ at ] == right[ at ] ) )
+        ++at;
+    return at;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Adds bytes around offset to message, within quotes and with C escapes.
+void AppendSnapshotContext( string & message, const char * data, size_t size,
+    size_t offset )
+{
+    const size_t begin = ( offset < s_SnapshotContext )
+        ? 0 : offset - s_SnapshotContext;
+    const size_t end = ( size - offset < s_SnapshotContext )
+        ? size : offset + s_SnapshotContext;
+    ut::PropertyText text;
+    if ( 0 < begin )
+        text.Append( "..." );
+    text.Append( '"' );
+    for ( size_t ii = begin; ii < end; ++ii )
+        text.AppendEscaped( data[ ii ], '"' );
+    text.Append( '"' );
+    if ( end < size )
+        text.Append( "..." );
+    message += text.GetText();
+}
+
+// ----------------------------------------------------------------------------
+
+/// Writes golden file, and makes its directory if needed.
+bool WriteSnapshot( const string & directory, const string & path,
+    const char * data, size_t size )
+{
+    {
+        ofstream golden( path.c_str(), ios::out | ios::binary | ios::trunc );
+        if ( golden.is_open() )
+        {
+            golden.write( data, size );
+            return golden.good();
+        }
+    }
+#if defined( _WIN32 )
+    ::_mkdir( directory.c_str() );
+#else
+    ::mkdir( directory.c_str(), 0777 );
+#endif
+    ofstream golden( path.c_str(), ios::out | ios::binary | ios::trunc );
+    if ( !golden.is_open() )
+        return false;
+    golden.write( data, size );
+    return golden.good();
+}
+
+// ----------------------------------------------------------------------------
+
+/// True if UNIT_TEST_CASE record is usable and its name contains the filter.
+inline bool IsStaticUnitTestSelected( const ut::StaticUnitTest & record,
+    const char * filter )
+{
+    // Linkers may pad sections with zeroes between records.
+    if ( IsEmptyString( record.m_name ) || ( nullptr == record.m_body ) )
+        return false;
+    return IsEmptyString( filter )
+        || ( nullptr != ::strstr( record.m_name, filter ) );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Orders UNIT_TEST_CASE records by source file, and then by line.
+bool IsStaticUnitTestBefore( const ut::StaticUnitTest * left,
+    const ut::StaticUnitTest * right )
+{
+    const int order = ::strcmp( left->m_file, right->m_file );
+    return ( order < 0 )
+        || ( ( 0 == order ) && ( left->m_line < right->m_line ) );
+}
+
+// ----------------------------------------------------------------------------
+
+/** Finds records made by UNIT_TEST_CASE whose names contain the filter, both
+ within the linker section and within the list of links.  Only pointers to
+ the records are copied, so unselected records cost one string search each.
+ */
+void FindStaticUnitTests( const char * filter,
+    std::vector< const ut::StaticUnitTest * > & found )
+{
+#if defined( __GNUC__ ) && defined( __ELF__ )
+    for ( const ut::StaticUnitTest * record = __start_ut_cases;
+        record < __stop_ut_cases; ++record )
+    {
+        if ( IsStaticUnitTestSelected( *record, filter ) )
+            found.push_back( record );
+    }
+#endif
+    for ( const ut::StaticUnitTestLink * link =
+        ut::StaticUnitTestLink::GetFirst(); nullptr != link;
+        link = link->GetNext() )
+    {
+        if ( IsStaticUnitTestSelected( link->GetRecord(), filter ) )
+            found.push_back( &link->GetRecord() );
+    }
+    std::stable_sort( found.begin(), found.end(), IsStaticUnitTestBefore );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Stores a fixture which a thread built, and adds the time spent to it.
+void FinishFixture( Fixture & fixture, unsigned int slot, void * built,
+    double start )
+{
+    fixture.m_slots[ slot ].m_building = false;
+    fixture.m_slots[ slot ].m_fixture = built;
+    ++fixture.m_setUpCount;
+    fixture.m_setUpSeconds += ut::LatencyHistogram::GetTime() - start;
+}
+
+// ----------------------------------------------------------------------------
+
+/// True if environment asks for golden files to be written.
+bool IsSnapshotUpdateSet( void )
+{
+    const char * value = ::getenv( "UNIT_TEST_UPDATE_SNAPSHOTS" );
+    return !IsEmptyString( value ) && ( ::strcmp( value, "0" ) != 0 );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns count as an unsigned int, or largest unsigned int if too big.
+inline unsigned int ClampCount( ut::ItemCount count )
+{
+    const unsigned int largest = static_cast< unsigned int >( -1 );
+    return ( count < largest ) ? static_cast< unsigned int >( count ) : largest;
+}
+
+// ----------------------------------------------------------------------------
+
+}; // end anonymous namespace
+
+namespace ut
+{
+
+// ----------------------------------------------------------------------------
+
+UnitTest::UnitTest( const char * name ) :
+    m_madeHeader( false ),
+    m_name( nullptr ),
+    m_index( 0 ),
+    m_itemCount( 0 ),
+    m_failCount( 0 ),
+    m_warnCount( 0 ),
+    m_passCount( 0 ),
+    m_exceptions( 0 ),
+    m_skipCount( 0 ),
+    m_elapsedTime( 0.0 ),
+    m_virtualTime( 0.0 ),
+    m_rssGrowth( 0 ),
+    m_peakRss( 0 ),
+    m_majorFaults( 0 ),
+    m_minorFaults( 0 )
+{
+    assert( nullptr != this );
+    m_name = name;
+    for ( unsigned int ii = 0; ii < CounterCount; ++ii )
+        m_counters[ ii ] = 0.0;
+    DEBUG_CODE( CheckInvariants() );
+}
+
+// ----------------------------------------------------------------------------
+
+UnitTest::~UnitTest( void )
+{
+    assert( nullptr != this );
+    DEBUG_CODE( CheckInvariants() );
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTest::DoTest( const char * filename, unsigned int line,
+    TestLevel level, bool pass, const char * expression, const char * message )
+{
+    assert( nullptr != this );
+    UnitTestSet & uts = UnitTestSet::GetIt();
+    if ( pass && ( nullptr != s_caseCursor )
+      && ( this == s_caseCursor->m_run->m_test ) && !uts.m_impl->ShowPasses()
+      && !uts.m_impl->IsDeathChild() && !uts.m_impl->IsIsolatedChild()
+      && !IsEmptyString( filename ) && !IsEmptyString( expression ) )
+    {
+        // Each case file thread counts its own passes, and adds them to this
+        // after each chunk.  See UnitTestSetImpl::AddCasePasses.
+        ++s_caseCursor->m_passes;
+        return pass;
+    }
+    MonitorLock lock( uts.m_impl->GetRecordLock() );
+    DEBUG_CODE( UnitTestChecker guard( this ); (void)guard; );
+
+    if ( uts.m_impl->IsUsingReceivers() || uts.m_impl->IsDeathChild() )
+        return pass;
+    if ( IsEmptyString( filename ) || IsEmptyString( expression ) )
+        return pass;
+    if ( uts.m_impl->IsIsolatedChild() )
+    {
+        uts.m_impl->SendToParent( IsolatedItem, this, level, pass,
+            filename, line, expression, message );
+        return pass;
+    }
+    string rowMessage;
+    if ( !pass && ( nullptr != s_caseCursor ) )
+    {
+        AppendCaseRow( rowMessage, *s_caseCursor );
+        if ( !IsEmptyString( message ) )
+        {
+            rowMessage += "  ";
+            rowMessage += message;
+        }
+        message = rowMessage.c_str();
+    }
+    uts.m_impl->SwitchToTest( this );
+
+    const TestResult::EnumType result = Convert( level, pass );
+    if ( 0 == m_itemCount )
+        uts.m_impl->StartOutput();
+    ++m_itemCount;
+    bool showItem = true;
+    switch ( result )
+    {
+        default:                  // fall into next case.
+        case TestResult::Failed:  // fall into next case.
+        case TestResult::Fatal:
+            ++m_failCount;
+            break;
+        case TestResult::Thrown:
+            assert(false);  // Why was result set to Thrown?
+            break;
+        case TestResult::Passed:
+            ++m_passCount;
+            showItem = uts.m_impl->ShowPasses();
+            break;
+        case TestResult::Warning:
+            ++m_warnCount;
+            showItem = uts.m_impl->ShowWarnings();
+            break;
+    }
+    uts.m_impl->CountSoakItem( ( TestResult::Failed == result )
+        || ( TestResult::Fatal == result ) );
+
+    if ( showItem )
+    {
+        if ( !m_madeHeader )
+        {
+            uts.m_impl->OutputTestHeader( this );
+            m_madeHeader = true;
+        }
+        uts.m_impl->OutputTestLine(
+            this, result, filename, line, expression, message );
+        if ( result == TestResult::Fatal )
+        {
+            if ( uts.m_impl->DoesFatalEndTest( this ) )
+                uts.m_impl->AbortTest( this );
+            uts.m_impl->AbortIfManyThreads( this );
+            uts.OutputSummary();
+            ::exit( 1 );
+        }
+    }
+
+    return pass;
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTest::OnException( const char * filename, unsigned int line,
+    TestLevel level, const char * expression, const char * message )
+{
+    assert( nullptr != this );
+    MonitorLock lock( UnitTestSet::GetIt().m_impl->GetRecordLock() );
+    DEBUG_CODE( UnitTestChecker guard( this ); (void)guard; );
+
+    UnitTestSet & uts = UnitTestSet::GetIt();
+    if ( uts.m_impl->IsAbortingTest( this ) )
+    {
+        // The test macros call this from their catch blocks, so an abort
+        // thrown by DoTest lands here first.  Send it on to RunUnitTest.  A
+        // new abort is thrown instead of rethrowing, since a host may call
+        // this outside any catch block, where rethrowing would terminate.
+        throw UnitTestAbort();
+    }
+    if ( uts.m_impl->IsUsingReceivers() || uts.m_impl->IsDeathChild() )
+        return;
+    if ( IsEmptyString( filename ) || IsEmptyString( expression ) )
+        return;
+    if ( uts.m_impl->IsIsolatedChild() )
+    {
+        uts.m_impl->SendToParent( IsolatedException, this, level, false,
+            filename, line, expression, message );
+        return;
+    }
+    string rowMessage;
+    if ( nullptr != s_caseCursor )
+    {
+        AppendCaseRow( rowMessage, *s_caseCursor );
+        if ( !IsEmptyString( message ) )
+        {
+            rowMessage += "  ";
+            rowMessage += message;
+        }
+        message = rowMessage.c_str();
+    }
+    uts.m_impl->SwitchToTest( this );
+
+    const TestResult::EnumType result = ( UnitTest::Require == level )
+        ? TestResult::Fatal : TestResult::Thrown;
+    if ( 0 == m_itemCount )
+        uts.m_impl->StartOutput();
+    ++m_itemCount;
+    ++m_exceptions;
+    uts.m_impl->CountSoakItem( true );
+    if ( !m_madeHeader )
+    {
+        uts.m_impl->OutputTestHeader( this );
+        m_madeHeader = true;
+    }
+    uts.m_impl->OutputTestLine(
+        this, result, filename, line, expression, message );
+    if ( result == TestResult::Fatal )
+    {
+        if ( uts.m_impl->DoesFatalEndTest( this ) )
+            uts.m_impl->AbortTest( this );
+        uts.m_impl->AbortIfManyThreads( this );
+        // Host may have asked for no summary at exit, so send lines now.
+        uts.m_impl->FlushText();
+        ::exit( 1 );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTest::Skip( const char * filename, unsigned int line,
+    const char * expression, const char * message )
+{
+    assert( nullptr != this );
+    MonitorLock lock( UnitTestSet::GetIt().m_impl->GetRecordLock() );
+    DEBUG_CODE( UnitTestChecker guard( this ); (void)guard; );
+
+    UnitTestSet & uts = UnitTestSet::GetIt();
+    if ( uts.m_impl->IsUsingReceivers() || uts.m_impl->IsDeathChild() )
+        return;
+    if ( IsEmptyString( filename ) || IsEmptyString( expression ) )
+        return;
+    if ( uts.m_impl->IsIsolatedChild() )
+    {
+        uts.m_impl->SendToParent( IsolatedSkip, this, Checked, true,
+            filename, line, expression, message );
+        return;
+    }
+    uts.m_impl->SwitchToTest( this );
+
+    if ( 0 == m_itemCount )
+        uts.m_impl->StartOutput();
+    ++m_itemCount;
+    ++m_skipCount;
+    uts.m_impl->CountSoakItem( false );
+    if ( !m_madeHeader )
+    {
+        uts.m_impl->OutputTestHeader( this );
+        m_madeHeader = true;
+    }
+    uts.m_impl->OutputTestLine(
+        this, TestResult::Skipped, filename, line, expression, message );
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTest::DoSampledTest( const char * filename, unsigned int line,
+    bool pass, bool threw, const char * expression )
+{
+    assert( nullptr != this );
+
+    s_lockSampledItem = true;
+    try
+    {
+        if ( threw )
+            OnException( filename, line, Checked, expression, nullptr );
+        else
+            pass = DoTest( filename, line, Checked, pass, expression );
+    }
+    catch ( ... )
+    {
+        s_lockSampledItem = false;
+        throw;
+    }
+    s_lockSampledItem = false;
+    return pass && !threw;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned int UnitTest::GetSampleGap( unsigned int oneIn )
+{
+    if ( oneIn < 2 )
+        return 0;
+    unsigned int state = s_sampleState;
+    if ( 0 == state )
+    {
+        // Address of the state differs for each thread, so threads seeded at
+        // once still get different gaps.
+        state = PickSeed() ^ static_cast< unsigned int >(
+            reinterpret_cast< size_t >( &s_sampleState ) );
+        // Xorshift never leaves zero, so a zero state would repeat forever.
+        if ( 0 == state )
+            state = 0x9E3779B9u;
+    }
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    s_sampleState = state;
+    unsigned int span = oneIn - 1;
+    if ( 0x7FFFFFFF < span )
+        span = 0x7FFFFFFF;
+    return state % ( span * 2 + 1 );
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTest::OutputMessage( const char * filename, unsigned int line,
+    const char * message )
+{
+    assert( nullptr != this );
+    MonitorLock lock( UnitTestSet::GetIt().m_impl->GetRecordLock() );
+    DEBUG_CODE( UnitTestChecker guard( this ); (void)guard; );
+
+    UnitTestSet & uts = UnitTestSet::GetIt();
+    if ( uts.m_impl->IsUsingReceivers() || uts.m_impl->IsDeathChild() )
+        return;
+    if ( IsEmptyString( filename ) || IsEmptyString( message ) )
+        return;
+    if ( uts.m_impl->IsIsolatedChild() )
+    {
+        uts.m_impl->SendToParent( IsolatedMessage, this, Checked, true,
+            filename, line, message, nullptr );
+        return;
+    }
+    uts.m_impl->OutputMessage( this, filename, line, message );
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTest::StartDeathTest( void )
+{
+    assert( nullptr != this );
+    DEBUG_CODE( CheckInvariants() );
+    UnitTestSet & uts = UnitTestSet::GetIt();
+    return uts.m_impl->StartDeathChild();
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTest::EndDeathTest( bool threw )
+{
+    assert( nullptr != this );
+    UnitTestSet & uts = UnitTestSet::GetIt();
+    uts.m_impl->EndDeathChild( threw );
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTest::CheckMemoryBudget( const char * filename, unsigned int line,
+    TestLevel level, unsigned long kilobytes, const char * expression )
+{
+    assert( nullptr != this );
+    DEBUG_CODE( CheckInvariants() );
+
+    UnitTestSet & uts = UnitTestSet::GetIt();
+    const long growth = uts.m_impl->GetRssGrowth( this );
+    const bool pass = ( growth <= 0 )
+        || ( static_cast< unsigned long >( growth ) <= kilobytes );
+    string message( "Resident memory grew by " );
+    if ( growth < 0 )
+        message += '-';
+    AppendNumber( message, static_cast< unsigned long >(
+        ( growth < 0 ) ? -growth : growth ) );
+    message += " KB, and budget is ";
+    AppendNumber( message, kilobytes );
+    message += " KB.";
+    return DoTest( filename, line, level, pass, expression, message.c_str() );
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTest::CheckLatency( const char * filename, unsigned int line,
+    TestLevel level, const LatencyHistogram & histogram, double percentile,
+    double seconds, const char * expression )
+{
+    assert( nullptr != this );
+    DEBUG_CODE( CheckInvariants() );
+
+    const double latency = histogram.GetPercentile( percentile );
+    const bool pass = ( 0 < histogram.GetCount() ) && ( latency <= seconds );
+    char text[ 32 ];
+    string condition( expression );
+    ::sprintf( text, ": p%g <= ", percentile );
+    condition += text;
+    AppendDuration( condition, seconds * 1.0e9 );
+    if ( pass )
+        return DoTest( filename, line, level, pass, condition.c_str(), nullptr );
+    vector< char > message( histogram.GetSummary( nullptr, 0 ) + 1 );
+    histogram.GetSummary( &message[ 0 ], static_cast< unsigned int >(
+        message.size() ) );
+    return DoTest( filename, line, level, pass, condition.c_str(),
+        &message[ 0 ] );
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTest::CheckProperty( const char * filename, unsigned int line,
+    TestLevel level, const PropertyRunner & property, const char * expression )
+{
+    assert( nullptr != this );
+    DEBUG_CODE( CheckInvariants() );
+
+    UnitTestSet & uts = UnitTestSet::GetIt();
+    const unsigned int caseCount = uts.m_impl->GetPropertyCases();
+    unsigned int seed = uts.m_impl->GetPropertySeed();
+    if ( 0 == seed )
+        seed = PickSeed();
+    const unsigned int failed = FindPropertyFailure( uts.m_impl, this,
+        property, seed, caseCount, uts.m_impl->GetPropertyThreads() );
+    if ( caseCount <= failed )
+        return DoTest( filename, line, level, true, expression, nullptr );
+
+    PropertyText text;
+    const unsigned int shrinks = property.ShrinkCase(
+        GetCaseSeed( seed, failed ), GetCaseSize( failed, caseCount ),
+        s_MaxShrinkTries, text );
+    string message( "Counterexample: " );
+    message += text.GetText();
+    message += ".  Seed ";
+    AppendNumber( message, seed );
+    message += ", case ";
+    AppendNumber( message, failed + 1 );
+    message += " of ";
+    AppendNumber( message, caseCount );
+    message += ", shrinks ";
+    AppendNumber( message, shrinks );
+    message += ".";
+    return DoTest( filename, line, level, false, expression, message.c_str() );
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTest::CheckSnapshot( const char * filename, unsigned int line,
+    TestLevel level, const char * name, const void * data, size_t size,
+    const char * expression )
+{
+    assert( nullptr != this );
+    DEBUG_CODE( CheckInvariants() );
+
+    if ( IsEmptyString( name ) || ( ( nullptr == data ) && ( 0 < size ) ) )
+        return DoTest( filename, line, level, false, expression,
+            "Snapshot needs a name and bytes." );
+    UnitTestSet & uts = UnitTestSet::GetIt();
+    const char * bytes = static_cast< const char * >( data );
+    const string path( uts.m_impl->GetSnapshotPath( name ) );
+    MappedFile golden;
+    const bool found = golden.Open( path.c_str() );
+    const bool same = found && ( golden.GetSize() == size ) && ( ( 0 == size )
+        || ( FindFirstDifference( bytes, golden.GetData(), size ) == size ) );
+    string message;
+
+    if ( uts.m_impl->IsSnapshotUpdate() )
+    {
+        if ( same )
+            return DoTest( filename, line, level, true, expression, nullptr );
+        // Windows can't replace a file while it is mapped.
+        golden.Close();
+        const bool written = WriteSnapshot( uts.m_impl->GetSnapshotDirectory(),
+            path, bytes, size );
+        message = written
+            ? "Updated golden file " : "Unable to write golden file ";
+        message += path;
+        message += ".";
+        return DoTest( filename, line, level, written, expression,
+            message.c_str() );
+    }
+
+    if ( same )
+        return DoTest( filename, line, level, true, expression, nullptr );
+    if ( !found )
+    {
+        message = "Golden file ";
+        message += path;
+        message += " is missing.  Set UNIT_TEST_UPDATE_SNAPSHOTS=1 to make it.";
+        return DoTest( filename, line, level, false, expression,
+            message.c_str() );
+    }
+
+    const size_t goldenSize = golden.GetSize();
+    const size_t offset = FindFirstDifference( bytes, golden.GetData(),
+        ( size < goldenSize ) ? size : goldenSize );
+    message = "Differs from golden file ";
+    message += path;
+    message += " at byte ";
+    AppendNumber( message, static_cast< unsigned long >( offset ) );
+    message += ", line ";
+    AppendNumber( message, static_cast< unsigned long >(
+        1 + ::std::count( bytes, bytes + offset, '\n' ) ) );
+    message += ".  Made ";
+    AppendNumber( message, static_cast< unsigned long >( size ) );
+    message += " bytes, and golden file has ";
+    AppendNumber( message, static_cast< unsigned long >( goldenSize ) );
+    message += ".  Made: ";
+    AppendSnapshotContext( message, bytes, size, offset );
+    message += "  Golden: ";
+    AppendSnapshotContext( message, golden.GetData(), goldenSize, offset );
+    return DoTest( filename, line, level, false, expression, message.c_str() );
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTest::CheckDeathTest( const char * filename, unsigned int line,
+    TestLevel level, const char * expression, DeathKind kind, int expected,
+    const char * pattern )
+{
+    assert( nullptr != this );
+    DEBUG_CODE( CheckInvariants() );
+
+    UnitTestSet & uts = UnitTestSet::GetIt();
+    string output;
+    char ending = DeathReturned;
+    int value = 0;
+    if ( !uts.m_impl->WaitForDeathChild( output, ending, value ) )
+    {
+        Skip( filename, line, expression,
+            "Unable to make child process for death test." );
+        return false;
+    }
+
+    bool pass = false;
+    string message;
+    switch ( ending )
+    {
+        default:                  // fall into next case.
+        case DeathReturned:
+            message = "Statement returned instead of ending the process.";
+            break;
+        case DeathThrew:
+            message = "Statement threw instead of ending the process.";
+            break;
+        case DeathExited:
+            pass = ( AnyDeath == kind ) ? ( 0 != value )
+                : ( ( ExitCode == kind ) && ( expected == value ) );
+            message = "Process called exit with code ";
+            AppendNumber( message, static_cast< unsigned long >( value ) );
+            message += ".";
+            break;
+        case DeathSignaled:
+            pass = ( AnyDeath == kind )
+                || ( ( Signal == kind ) && ( expected == value ) );
+            message = "Process ended by signal ";
+            AppendNumber( message, static_cast< unsigned long >( value ) );
+            message += ".";
+            break;
+    }
+
+#if !defined( _WIN32 )
+    if ( pass && !IsEmptyString( pattern ) )
+    {
+        bool valid = true;
+        pass = MatchesPattern( output, pattern, valid );
+        if ( !valid )
+            message = "Pattern is not a valid regular expression.";
+        else if ( !pass )
+        {
+            message += "  Standard error did not match pattern: \"";
+            const size_t length = ( output.size() < s_MaxDeathQuote )
+                ? output.size() : s_MaxDeathQuote;
+            for ( size_t ii = 0; ii < length; ++ii )
+                message += ( '\n' == output[ ii ] ) ? ' ' : output[ ii ];
+            message += "\"";
+        }
+    }
+#else
+    (void)pattern;
+#endif
+
+    return DoTest( filename, line, level, pass, expression, message.c_str() );
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTest::CheckInvariants( void ) const
+{
+    assert( nullptr != this );
+    if ( !IsInvariantCheckDue() )
+        return;
+    InvariantTimer timer;
+    (void)timer;
+    assert( !IsEmptyString( GetName() ) );
+    const ItemCount total =
+        m_failCount + m_passCount + m_warnCount + m_exceptions + m_skipCount;
+    assert( m_itemCount == total );
+    (void)total;
+    if ( ( 0 < m_failCount ) || ( 0 < m_exceptions ) || ( 0 < m_skipCount ) )
+    {
+        assert( m_madeHeader );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+double SystemClock::GetSeconds( void ) const
+{
+    assert( nullptr != this );
+    return GetWallClockTime();
+}
+
+// ----------------------------------------------------------------------------
+
+void SystemClock::Sleep( double seconds )
+{
+    assert( nullptr != this );
+    if ( seconds <= 0.0 )
+        return;
+#if defined( _WIN32 )
+    // Only the standard headers are used on Windows, so this polls the clock.
+    const double until = GetWallClockTime() + seconds;
+    while ( GetWallClockTime() < until )
+    {
+    }
+#else
+    struct timespec wait;
+    wait.tv_sec = static_cast< time_t >( seconds );
+    wait.tv_nsec = static_cast< long >( ( seconds - wait.tv_sec ) * 1.0e9 );
+    while ( ( ::nanosleep( &wait, &wait ) != 0 ) && ( EINTR == errno ) )
+    {
+    }
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+double VirtualClock::GetSeconds( void ) const
+{
+    assert( nullptr != this );
+    return m_seconds;
+}
+
+// ----------------------------------------------------------------------------
+
+void VirtualClock::Sleep( double seconds )
+{
+    assert( nullptr != this );
+    Advance( seconds );
+}
+
+// ----------------------------------------------------------------------------
+
+void VirtualClock::Advance( double seconds )
+{
+    assert( nullptr != this );
+    if ( 0.0 < seconds )
+        m_seconds += seconds;
+}
+
+// ----------------------------------------------------------------------------
+
+SampleComparison::SampleComparison( const double * baseline,
+    unsigned int baselineCount, const double * candidate,
+    unsigned int candidateCount, double confidence ) :
+    m_verdict( TooFewSamples ),
+    m_baselineMedian( 0.0 ),
+    m_candidateMedian( 0.0 ),
+    m_shift( 0.0 ),
+    m_lowerBound( 0.0 ),
+    m_upperBound( 0.0 ),
+    m_probability( 1.0 ),
+    m_u( 0.0 )
+{
+    assert( nullptr != this );
+    assert( ( nullptr != baseline ) || ( 0 == baselineCount ) );
+    assert( ( nullptr != candidate ) || ( 0 == candidateCount ) );
+
+    vector< double > base( baseline, baseline + baselineCount );
+    vector< double > other( candidate, candidate + candidateCount );
+    if ( !base.empty() )
+        m_baselineMedian = GetMedian( base );
+    if ( !other.empty() )
+        m_candidateMedian = GetMedian( other );
+    if ( ( baselineCount < 2 ) || ( candidateCount < 2 ) )
+        return;
+
+    // Every difference between a candidate and a baseline sample.
+    vector< double > differences;
+    differences.reserve( baselineCount * candidateCount );
+    for ( unsigned int ii = 0; ii < baselineCount; ++ii )
+    {
+        for ( unsigned int jj = 0; jj < candidateCount; ++jj )
+            differences.push_back( other[ jj ] - base[ ii ] );
+    }
+    m_shift = GetMedian( differences );
+
+    // U counts pairs where the baseline sample is larger, and half of ties.
+    unsigned int tieCount = 0;
+    for ( size_t ii = 0; ii < differences.size(); ++ii )
+    {
+        if ( differences[ ii ] < 0.0 )
+            m_u += 1.0;
+        else if ( 0.0 == differences[ ii ] )
+        {
+            m_u += 0.5;
+            ++tieCount;
+        }
+    }
+
+    const double m = baselineCount;
+    const double n = candidateCount;
+    const double pairs = m * n;
+    const double alpha = 1.0 - confidence;
+    // Lower bound is the k-th smallest difference, and upper bound is k-th
+    // largest, where k is one more than the biggest U in the lower tail.
+    size_t kk = 0;
+    // Ties within one set do not change U, so only ties between sets matter.
+    const bool isExact = ( 0 == tieCount )
+        && ( baselineCount <= s_MaxExactSamples )
+        && ( candidateCount <= s_MaxExactSamples );
+    if ( isExact )
+    {
+        vector< double > chances;
+        GetUDistribution( baselineCount, candidateCount, chances );
+        const size_t low =
+            static_cast< size_t >( ::std::min( m_u, pairs - m_u ) );
+        double tail = 0.0;
+        for ( size_t uu = 0; uu <= low; ++uu )
+            tail += chances[ uu ];
+        m_probability = ::std::min( 1.0, 2.0 * tail );
+        double below = 0.0;
+        while ( ( kk < chances.size() )
+            && ( below + chances[ kk ] <= alpha / 2.0 ) )
+        {
+            below += chances[ kk ];
+            ++kk;
+        }
+    }
+    else
+    {
+        const double total = m + n;
+        double tieSum = 0.0;
+        vector< double > all( base );
+        all.insert( all.end(), other.begin(), other.end() );
+        ::std::sort( all.begin(), all.end() );
+        for ( size_t first = 0; first < all.size(); )
+        {
+            size_t last = first + 1;
+            while ( ( last < all.size() ) && ( all[ last ] == all[ first ] ) )
+                ++last;
+            const double tied = static_cast< double >( last - first );
+            tieSum += tied * tied * tied - tied;
+            first = last;
+        }
+        const double spread = ::sqrt( pairs / 12.0
+            * ( ( total + 1.0 ) - tieSum / ( total * ( total - 1.0 ) ) ) );
+        if ( 0.0 < spread )
+        {
+            // Half a point of continuity correction.
+            const double distance = ::fabs( m_u - pairs / 2.0 ) - 0.5;
+            const double z = ( distance < 0.0 ) ? 0.0 : distance / spread;
+            m_probability = ::std::min( 1.0, 2.0 * GetNormalTail( z ) );
+            const double edge = pairs / 2.0
+                - GetNormalQuantile( alpha / 2.0 ) * spread;
+            kk = ( 0.0 < edge ) ? static_cast< size_t >( ::floor( edge ) ) : 0;
+        }
+    }
+    if ( kk < 1 )
+        kk = 1;
+    if ( differences.size() < kk )
+        kk = differences.size();
+    m_lowerBound = differences[ kk - 1 ];
+    m_upperBound = differences[ differences.size() - kk ];
+
+    if ( alpha < m_probability )
+        m_verdict = Unchanged;
+    else if ( 0.0 < m_shift )
+        m_verdict = Regressed;
+    else if ( m_shift < 0.0 )
+        m_verdict = Improved;
+    else
+        m_verdict = Unchanged;
+}
+
+// ----------------------------------------------------------------------------
+
+const char * SampleComparison::GetVerdictName( Verdict verdict )
+{
+    switch ( verdict )
+    {
+        case Unchanged: return "Unchanged";
+        case Improved:  return "Improved";
+        case Regressed: return "Regressed";
+        default:        break;
+    }
+    return "Too Few";
+}
+
+// ----------------------------------------------------------------------------
+
+LatencyHistogram::LatencyHistogram( void ) :
+    m_count( 0 ),
+    m_min( 0.0 ),
+    m_max( 0.0 ),
+    m_sum( 0.0 )
+{
+    assert( nullptr != this );
+    Clear();
+}
+
+// ----------------------------------------------------------------------------
+
+double LatencyHistogram::GetTime( void )
+{
+#if defined( _WIN32 )
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+    if ( !::QueryPerformanceFrequency( &frequency )
+      || !::QueryPerformanceCounter( &now ) )
+    {
+        return GetWallClockTime();
+    }
+    return static_cast< double >( now.QuadPart )
+        / static_cast< double >( frequency.QuadPart );
+#else
+    struct timespec now;
+    if ( 0 != ::clock_gettime( CLOCK_MONOTONIC, &now ) )
+        return GetWallClockTime();
+    return static_cast< double >( now.tv_sec ) + now.tv_nsec / 1.0e9;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+void LatencyHistogram::Record( double seconds )
+{
+    assert( nullptr != this );
+    if ( seconds < 0.0 )
+        seconds = 0.0;
+    ++m_counts[ GetBucket( seconds * 1.0e9 ) ];
+    if ( ( 0 == m_count ) || ( seconds < m_min ) )
+        m_min = seconds;
+    if ( ( 0 == m_count ) || ( m_max < seconds ) )
+        m_max = seconds;
+    ++m_count;
+    m_sum += seconds;
+}
+
+// ----------------------------------------------------------------------------
+
+void LatencyHistogram::Clear( void )
+{
+    assert( nullptr != this );
+    for ( unsigned int ii = 0; ii < BucketCount; ++ii )
+        m_counts[ ii ] = 0;
+    m_count = 0;
+    m_min = 0.0;
+    m_max = 0.0;
+    m_sum = 0.0;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned int LatencyHistogram::GetBucket( double nanoseconds )
+{
+    if ( nanoseconds < static_cast< double >( SubBucketCount ) )
+        return static_cast< unsigned int >( nanoseconds );
+    // Nanoseconds is fraction times 2 to the exponent, and fraction is from
+    // one half up to one, so top 6 bits pick octave and bucket within it.
+    int exponent = 0;
+    ::frexp( nanoseconds, &exponent );
+    const unsigned int octave = static_cast< unsigned int >( exponent - 6 );
+    if ( OctaveCount <= octave )
+        return BucketCount - 1;
+    const double scaled = ::ldexp( nanoseconds, -static_cast< int >( octave ) );
+    unsigned int sub = static_cast< unsigned int >( scaled ) - SubBucketCount;
+    if ( SubBucketCount <= sub )
+        sub = SubBucketCount - 1;
+    return ( octave + 1 ) * SubBucketCount + sub;
+}
+
+// ----------------------------------------------------------------------------
+
+double LatencyHistogram::GetUpperEdge( unsigned int bucket )
+{
+    if ( bucket < SubBucketCount )
+        return bucket + 1.0;
+    const unsigned int octave = bucket / SubBucketCount - 1;
+    const unsigned int sub = bucket % SubBucketCount;
+    return ::ldexp( static_cast< double >( SubBucketCount + sub + 1 ),
+        static_cast< int >( octave ) );
+}
+
+// ----------------------------------------------------------------------------
+
+double LatencyHistogram::GetPercentile( double percentile ) const
+{
+    assert( nullptr != this );
+    if ( 0 == m_count )
+        return 0.0;
+    if ( percentile < 0.0 )
+        percentile = 0.0;
+    if ( 100.0 < percentile )
+        percentile = 100.0;
+    double rank = ::ceil( percentile / 100.0 * m_count );
+    if ( rank < 1.0 )
+        rank = 1.0;
+    double seen = 0.0;
+    for ( unsigned int ii = 0; ii < BucketCount; ++ii )
+    {
+        seen += m_counts[ ii ];
+        if ( rank <= seen )
+        {
+            const double edge = GetUpperEdge( ii ) / 1.0e9;
+            return ( m_max < edge ) ? m_max : edge;
+        }
+    }
+    return m_max;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned int LatencyHistogram::GetSummary( char * buffer,
+    unsigned int size ) const
+{
+    assert( nullptr != this );
+    assert( ( nullptr != buffer ) || ( 0 == size ) );
+
+    string summary;
+    if ( 0 == m_count )
+        summary = "No latencies were recorded.";
+    else
+    {
+        summary = "Latencies: ";
+        AppendNumber( summary, m_count );
+        summary += ", min ";
+        AppendDuration( summary, m_min * 1.0e9 );
+        summary += ", mean ";
+        AppendDuration( summary, GetMean() * 1.0e9 );
+        summary += ", max ";
+        AppendDuration( summary, m_max * 1.0e9 );
+        static const double s_percentiles[] = { 50.0, 90.0, 99.0, 99.9, 99.99 };
+        static const char * const s_names[] =
+            { "p50", "p90", "p99", "p99.9", "p99.99" };
+        for ( unsigned int ii = 0; ii < 5; ++ii )
+        {
+            summary += ( 0 == ii ) ? ".  " : ", ";
+            summary += s_names[ ii ];
+            summary += ' ';
+            AppendDuration( summary,
+                GetPercentile( s_percentiles[ ii ] ) * 1.0e9 );
+        }
+        summary += ".  Buckets:";
+        // Buckets are merged by power of two to keep the message readable.
+        double lower = 0.0;
+        unsigned long count = 0;
+        for ( unsigned int ii = 0; ii < BucketCount; ++ii )
+        {
+            count += m_counts[ ii ];
+            const bool isLast = ( ii + 1 == BucketCount );
+            if ( !isLast && ( ( ii < SubBucketCount )
+                || ( 0 != ( ( ii + 1 ) % SubBucketCount ) ) ) )
+            {
+                continue;
+            }
+            const double upper = GetUpperEdge( ii );
+            if ( 0 != count )
+            {
+                summary += ' ';
+                AppendDuration( summary, lower );
+                summary += " to ";
+                AppendDuration( summary, upper );
+                summary += ": ";
+                AppendNumber( summary, count );
+                summary += ';';
+            }
+            lower = upper;
+            count = 0;
+        }
+        // Last bucket listed ends with a period instead of a semicolon.
+        summary[ summary.size() - 1 ] = '.';
+    }
+
+    if ( 0 < size )
+    {
+        const size_t length = ::std::min( summary.size(),
+            static_cast< size_t >( size - 1 ) );
+        summary.copy( buffer, length );
+        buffer[ length ] = '\0';
+    }
+    return static_cast< unsigned int >( summary.size() );
+}
+
+// ----------------------------------------------------------------------------
+
+StressThread::StressThread( unsigned int index, unsigned int seed,
+    unsigned int yieldPercent ) :
+    m_index( index ),
+    m_calls( 0 ),
+    m_random( seed ^ ( ( index + 1 ) * 0x9E3779B9u ) ),
+    m_yieldPercent( yieldPercent )
+{
+    assert( nullptr != this );
+    // Xorshift never leaves zero, so a zero state would repeat forever.
+    if ( 0 == m_random )
+        m_random = 0x9E3779B9u;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned int StressThread::GetRandom( void )
+{
+    assert( nullptr != this );
+    m_random ^= m_random << 13;
+    m_random ^= m_random >> 17;
+    m_random ^= m_random << 5;
+    return m_random;
+}
+
+// ----------------------------------------------------------------------------
+
+void StressThread::MaybeYield( void )
+{
+    assert( nullptr != this );
+    if ( ( 0 == m_yieldPercent ) || ( m_yieldPercent <= GetRandom() % 100 ) )
+        return;
+#if defined( _WIN32 )
+    ::SwitchToThread();
+#else
+    ::sched_yield();
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+PropertyRandom::PropertyRandom( unsigned int seed ) :
+    m_state( ( 0 == seed ) ? 0x9E3779B9u : seed )
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned int PropertyRandom::GetNext( void )
+{
+    assert( nullptr != this );
+    m_state ^= m_state << 13;
+    m_state ^= m_state >> 17;
+    m_state ^= m_state << 5;
+    return m_state;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned int PropertyRandom::GetBelow( unsigned int limit )
+{
+    assert( nullptr != this );
+    return ( 0 == limit ) ? 0 : GetNext() % limit;
+}
+
+// ----------------------------------------------------------------------------
+
+double PropertyRandom::GetFraction( void )
+{
+    assert( nullptr != this );
+    return GetNext() / 4294967296.0;
+}
+
+// ----------------------------------------------------------------------------
+
+PropertyText::PropertyText( void ) :
+    m_length( 0 )
+{
+    assert( nullptr != this );
+    m_text[ 0 ] = '\0';
+}
+
+// ----------------------------------------------------------------------------
+
+void PropertyText::Append( char c )
+{
+    assert( nullptr != this );
+    static const unsigned int s_Ellipsis = 3;
+    if ( m_length + s_Ellipsis < MaxLength )
+    {
+        m_text[ m_length++ ] = c;
+        m_text[ m_length ] = '\0';
+    }
+    else if ( m_length + s_Ellipsis == MaxLength )
+    {
+        ::strcpy( m_text + m_length, "..." );
+        m_length = MaxLength;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void PropertyText::Append( const char * text )
+{
+    assert( nullptr != this );
+    if ( nullptr == text )
+        return;
+    for ( ; '\0' != *text; ++text )
+        Append( *text );
+}
+
+// ----------------------------------------------------------------------------
+
+void PropertyText::AppendSigned( long value )
+{
+    assert( nullptr != this );
+    char text[ 32 ];
+    ::sprintf( text, "%ld", value );
+    Append( text );
+}
+
+// ----------------------------------------------------------------------------
+
+void PropertyText::AppendUnsigned( unsigned long value )
+{
+    assert( nullptr != this );
+    char text[ 32 ];
+    ::sprintf( text, "%lu", value );
+    Append( text );
+}
+
+// ----------------------------------------------------------------------------
+
+void PropertyText::AppendReal( double value )
+{
+    assert( nullptr != this );
+    char text[ 32 ];
+    ::sprintf( text, "%.17g", value );
+    Append( text );
+}
+
+// ----------------------------------------------------------------------------
+
+CaseRow::CaseRow( void ) :
+    m_text( "" ),
+    m_length( 0 ),
+    m_fieldCount( 0 )
+{
+    assert( nullptr != this );
+}
+
+// ----------------------------------------------------------------------------
+
+void CaseRow::Split( const char * text, unsigned int length, char separator )
+{
+    assert( nullptr != this );
+    assert( ( nullptr != text ) || ( 0 == length ) );
+    m_text = text;
+    m_length = length;
+    m_fieldCount = 0;
+    unsigned int at = 0;
+    while ( m_fieldCount + 1 < MaxFields )
+    {
+        const void * end = ::memchr( text + at, separator, length - at );
+        if ( nullptr == end )
+            break;
+        at = static_cast< unsigned int >(
+            static_cast< const char * >( end ) - text );
+        m_ends[ m_fieldCount++ ] = at;
+        ++at;
+    }
+    m_ends[ m_fieldCount++ ] = length;
+}
+
+// ----------------------------------------------------------------------------
+
+const char * CaseRow::GetField( unsigned int which,
+    unsigned int & length ) const
+{
+    assert( nullptr != this );
+    length = 0;
+    if ( m_fieldCount <= which )
+        return nullptr;
+    const unsigned int start = ( 0 == which ) ? 0 : m_ends[ which - 1 ] + 1;
+    length = m_ends[ which ] - start;
+    return m_text + start;
+}
+
+// ----------------------------------------------------------------------------
+
+bool CaseRow::IsField( unsigned int which, const char * text ) const
+{
+    assert( nullptr != this );
+    unsigned int length = 0;
+    const char * field = GetField( which, length );
+    if ( ( nullptr == field ) || ( nullptr == text ) )
+        return false;
+    return ( ::strlen( text ) == length )
+        && ( ::memcmp( field, text, length ) == 0 );
+}
+
+// ----------------------------------------------------------------------------
+
+bool CaseRow::GetLong( unsigned int which, long & value ) const
+{
+    assert( nullptr != this );
+    // Field is not nul terminated, so copy it to a buffer on the stack.
+    unsigned int length = 0;
+    const char * field = GetField( which, length );
+    char text[ 64 ];
+    if ( ( nullptr == field ) || ( 0 == length )
+      || ( sizeof( text ) <= length ) )
+        return false;
+    ::memcpy( text, field, length );
+    text[ length ] = '\0';
+    char * end = nullptr;
+    errno = 0;
+    value = ::strtol( text, &end, 10 );
+    return ( end == text + length ) && ( 0 == errno );
+}
+
+// ----------------------------------------------------------------------------
+
+bool CaseRow::GetDouble( unsigned int which, double & value ) const
+{
+    assert( nullptr != this );
+    unsigned int length = 0;
+    const char * field = GetField( which, length );
+    char text[ 64 ];
+    if ( ( nullptr == field ) || ( 0 == length )
+      || ( sizeof( text ) <= length ) )
+        return false;
+    ::memcpy( text, field, length );
+    text[ length ] = '\0';
+    char * end = nullptr;
+    value = ::strtod( text, &end );
+    return ( end == text + length );
+}
+
+// ----------------------------------------------------------------------------
+
+void PropertyText::AppendEscaped( char c, char quote )
+{
+    assert( nullptr != this );
+    const unsigned char code = static_cast< unsigned char >( c );
+    char text[ 8 ];
+    if ( ( c == quote ) || ( '\\' == c ) )
+    {
+        Append( '\\' );
+        Append( c );
+        return;
+    }
+    switch ( c )
+    {
+        case '\n': Append( "\\n" ); return;
+        case '\r': Append( "\\r" ); return;
+        case '\t': Append( "\\t" ); return;
+        case '\0': Append( "\\0" ); return;
+        default: break;
+    }
+    if ( ( code < 32 ) || ( 127 <= code ) )
+    {
+        ::sprintf( text, "\\x%02X", static_cast< unsigned int >( code ) );
+        Append( text );
+    }
+    else
+        Append( c );
+}
+
+// ----------------------------------------------------------------------------
+
+UnitTestSetImpl::UnitTestSetImpl( const char * testName,
+    const char * textFilePartialName, const char * htmlFilePartialName,
+    const char * xmlFilePartialName, UnitTestSet::OutputOptions info ) :
+    m_testName( testName ),
+    m_textFilePartialName(),
+    m_htmlFilePartialName(),
+    m_xmlFilePartialName(),
+    m_jsonFilePartialName(),
+    m_junitFilePartialName(),
+    m_tests(),
+    m_arena(),
+    m_names(),
+    m_index(),
+    m_currentTest( nullptr ),
+    m_runningTest( nullptr ),
+    m_abortingTest( nullptr ),
+    m_registered(),
+    m_isRegistered(),
+    m_dependencies(),
+    m_async(),
+    m_workerCount( 0 ),
+    m_workerTimeout( 300.0 ),
+    m_parentPipe( -1 ),
+    m_deathPid( -1 ),
+    m_deathOutput( -1 ),
+    m_deathStatus( -1 ),
+    m_isDeathChild( false ),
+    m_switchTime( 0.0 ),
+    m_switchVirtual( 0.0 ),
+    m_systemClock(),
+    m_virtualClock(),
+    m_clock( &m_systemClock ),
+    m_perfCounters(),
+    m_switchMemory(),
+    m_showMemory( 0 != ( info & UnitTestSet::Memory ) ),
+    m_recordLock(),
+    m_manyThreads( false ),
+    m_fatalInThreads( false ),
+    m_stressJitter( 50 ),
+    m_stressYield( 10 ),
+    m_propertyCases( 2000 ),
+    m_propertyThreads( 0 ),
+    m_propertySeed( 0 ),
+    m_snapshotDirectory( "snapshots" ),
+    m_updateSnapshots( IsSnapshotUpdateSet() ),
+    m_fixtures(),
+    m_fixtureLock(),
+    m_nextWorkerSlot( s_FirstHostWorkerSlot ),
+    m_soakInterval( 0.0 ),
+    m_soakStart( 0.0 ),
+    m_soakLast( 0.0 ),
+    m_soakCount( 0 ),
+    m_soakTicks( 0 ),
+    m_soakTotals(),
+    m_soakFailures(),
+    m_burstStart( 0.0 ),
+    m_burstCount( 0 ),
+    m_peakBurst( 0 ),
+    m_peakBurstStart( 0.0 ),
+    m_textOutput( info ),
+    m_htmlOutput( this, info ),
+    m_xmlOutput( info ),
+    m_jsonOutput(),
+    m_junitOutput(),
+    m_receivers(),
+    m_showMessages( 0 != ( info & UnitTestSet::Messages ) ),
+    m_showPasses( 0 != ( info & UnitTestSet::Passes ) ),
+    m_showWarnings( 0 != ( info & UnitTestSet::Warnings ) ),
+    m_showHeaders( 0 != ( info & UnitTestSet::Headers ) ),
+    m_showTimeStamp( 0 != ( info & UnitTestSet::TimeStamp ) ),
+    m_useFullDayName( 0 != ( info & UnitTestSet::FullDayName ) ),
+    m_showFinalTable( 0 != ( info & UnitTestSet::SummaryTable ) ),
+    m_fatalEndsTest( 0 != ( info & UnitTestSet::FatalEndsTest ) ),
+    m_didPageHeader( false ),
+    m_usingReceivers( false ),
+    m_didAnyTest( false ),
+    m_didFirstRun( false ),
+    m_startTime(),
+    m_testCount( 0 ),
+    m_testPassCount( 0 ),
+    m_testWarnCount( 0 ),
+    m_testFailCount( 0 ),
+    m_testExceptCount( 0 ),
+    m_testSkipCount( 0 ),
+    m_itemCount( 0 ),
+    m_itemPassCount( 0 ),
+    m_itemWarnCount( 0 ),
+    m_itemFailCount( 0 ),
+    m_itemExceptCount( 0 ),
+    m_itemSkipCount( 0 )
+{
+    assert( nullptr != this );
+
+    if ( !IsEmptyString( xmlFilePartialName ) )
+        m_xmlFilePartialName = xmlFilePartialName;
+    if ( !IsEmptyString( textFilePartialName ) )
+        m_textFilePartialName = textFilePartialName;
+    if ( !IsEmptyString( htmlFilePartialName ) )
+    {
+        m_htmlFilePartialName = htmlFilePartialName;
+    }
+    if ( !IsEmptyString( xmlFilePartialName ) )
+    {
+        m_xmlFilePartialName = xmlFilePartialName;
+    }
+
+    if ( !m_useFullDayName )
+    {
+        s_testTimeStampFormatSpec = "%a, %Y - %B - %d, %H : %M : %S";
+        s_timeStampFormatSpec     = "%a, %Y %b %d at %H:%M:%S in %z";
+    }
+
+    if ( 0 != ( info & UnitTestSet::Counters ) )
+        m_perfCounters.Open();
+    m_perfCounters.Read( m_switchCounters );
+    TakeMemorySample( m_switchMemory );
+
+    DEBUG_CODE( CheckInvariants() );
+}
+
+// ----------------------------------------------------------------------------
+
+UnitTestSetImpl::~UnitTestSetImpl( void )
+{
+    assert( nullptr != this );
+    DEBUG_CODE( CheckInvariants() );
+    TearDownFixtures();
+    Clear();
+
+    assert( !m_usingReceivers );
+    m_usingReceivers = true;
+    TUnitTestReceiverSetIter end( m_receivers.end() );
+    for ( TUnitTestReceiverSetIter it( m_receivers.begin() ); it != end; ++it )
+    {
+        UnitTestResultReceiver * receiver = *it;
+        if ( receiver == nullptr )
+            continue;
+        try
+        {
+            receiver->FinalEnd();
+            *it = nullptr;
+        }
+        catch ( ... ) { }
+    }
+    assert( m_usingReceivers );
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::Clear( void )
+{
+    assert( nullptr != this );
+    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
+
+    // Without a summary table, this is the last chance to write testcases.
+    m_junitOutput.ShowTestCases( m_tests );
+    TUnitTestChildrenIter last( m_tests.end() );
+    for ( TUnitTestChildrenIter it( m_tests.begin() ); it != last; ++it )
+    {
+        UnitTest * pTest = *it;
+        if ( nullptr != pTest )
+            pTest->~UnitTest();
+    }
+    m_tests.clear();
+    m_currentTest = nullptr;
+    m_runningTest = nullptr;
+    m_abortingTest = nullptr;
+    m_registered.clear();
+    m_isRegistered.clear();
+    m_dependencies.clear();
+    const TFixtures::iterator lastFixture( m_fixtures.end() );
+    for ( TFixtures::iterator it( m_fixtures.begin() ); it != lastFixture;
+        ++it )
+    {
+        it->m_setUpCount = 0;
+        it->m_setUpSeconds = 0.0;
+        it->m_tearDownSeconds = 0.0;
+    }
+    // Counts start over from zero, so soak snapshots do too.
+    m_soakTotals = SoakTotals();
+    m_soakFailures.clear();
+    m_index.Clear();
+    m_names.Clear();
+    m_arena.Clear();
+    m_didAnyTest = false;
+    m_didPageHeader = false;
+    ClearTableCounts();
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::ClearTableCounts( void )
+{
+    assert( nullptr != this );
+
+    m_testCount = 0;
+    m_testPassCount = 0;
+    m_testWarnCount = 0;
+    m_testFailCount = 0;
+    m_testExceptCount = 0;
+    m_testSkipCount = 0;
+    m_itemCount = 0;
+    m_itemPassCount = 0;
+    m_itemWarnCount = 0;
+    m_itemFailCount = 0;
+    m_itemExceptCount = 0;
+    m_itemSkipCount = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::ChangeCurrentTest( UnitTest * test )
+{
+    assert( nullptr != this );
+    assert( test != m_currentTest );
+
+    const double now = GetWallClockTime();
+    const double virtualNow = m_virtualClock.GetSeconds();
+    double counters[ UnitTest::CounterCount ];
+    m_perfCounters.Read( counters );
+    // Each UnitTest gets a baseline when it becomes current, so a memory
+    // budget counts growth from then on, even without the Memory option.
+    MemorySample memory;
+    TakeMemorySample( memory );
+    if ( nullptr != m_currentTest )
+    {
+        m_currentTest->m_elapsedTime += ( now - m_switchTime );
+        m_currentTest->m_virtualTime += ( virtualNow - m_switchVirtual );
+        for ( unsigned int ii = 0; ii < UnitTest::CounterCount; ++ii )
+            m_currentTest->m_counters[ ii ] += counters[ ii ] - m_switchCounters[ ii ];
+        AddMemoryUse( m_currentTest, memory );
+    }
+    m_currentTest = test;
+    m_switchTime = now;
+    m_switchVirtual = virtualNow;
+    for ( unsigned int ii = 0; ii < UnitTest::CounterCount; ++ii )
+        m_switchCounters[ ii ] = counters[ ii ];
+    m_switchMemory = memory;
+    m_textOutput.FlushIfDue( now );
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::AddMemoryUse( UnitTest * test,
+    const MemorySample & memory ) const
+{
+    assert( nullptr != this );
+    assert( nullptr != test );
+
+    test->m_rssGrowth += static_cast< long >( memory.m_residentKb )
+        - static_cast< long >( m_switchMemory.m_residentKb );
+    test->m_peakRss = max( test->m_peakRss,
+        max( memory.m_residentKb, m_switchMemory.m_residentKb ) );
+    // A new peak for the process must have happened during this UnitTest.
+    if ( m_switchMemory.m_peakKb < memory.m_peakKb )
+        test->m_peakRss = max( test->m_peakRss, memory.m_peakKb );
+    test->m_majorFaults += memory.m_majorFaults - m_switchMemory.m_majorFaults;
+    test->m_minorFaults += memory.m_minorFaults - m_switchMemory.m_minorFaults;
+}
+
+// ----------------------------------------------------------------------------
+
+long UnitTestSetImpl::GetRssGrowth( const UnitTest * test ) const
+{
+    assert( nullptr != this );
+    assert( nullptr != test );
+
+    long growth = test->m_rssGrowth;
+    if ( test == m_currentTest )
+    {
+        MemorySample memory;
+        TakeMemorySample( memory );
+        growth += static_cast< long >( memory.m_residentKb )
+            - static_cast< long >( m_switchMemory.m_residentKb );
+    }
+    return growth;
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::SendToParent( IsolatedEventKind kind,
+    const UnitTest * test, UnitTest::TestLevel level, bool pass,
+    const char * fileName, unsigned int line, const char * expression,
+    const char * message )
+{
+    assert( nullptr != this );
+    assert( IsIsolatedChild() );
+
+    string event;
+    event.reserve( 256 );
+    event += static_cast< char >( kind );
+    AppendEventNumber( event, static_cast< unsigned int >( level ) );
+    AppendEventNumber( event, pass ? 1 : 0 );
+    AppendEventNumber( event, line );
+    AppendEventString( event, test->GetName() );
+    AppendEventString( event, fileName );
+    AppendEventString( event, expression );
+    AppendEventString( event, message );
+
+    const bool isFatal = ( UnitTest::Require == level ) && ( !pass )
+        && ( ( IsolatedItem == kind ) || ( IsolatedException == kind ) );
+    if ( isFatal )
+    {
+        // The parent ends this UnitTest once it sees the fatal result.
+        event += static_cast< char >( IsolatedEnd );
+        for ( unsigned int ii = 0; ii < 3; ++ii )
+            AppendEventNumber( event, 0 );
+        for ( unsigned int ii = 0; ii < 4; ++ii )
+            AppendEventString( event, nullptr );
+    }
+#if !defined( _WIN32 )
+    if ( !WriteAll( m_parentPipe, event.data(), event.size() ) )
+        ::_exit( 1 );
+    if ( isFatal )
+        ::_exit( 0 );
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTestSetImpl::StepAsyncTask( AsyncTask & task )
+{
+    assert( nullptr != this );
+    assert( nullptr != task.m_test );
+
+    UnitTest * test = task.m_test;
+    UnitTest * outerTest = m_runningTest;
+    m_runningTest = test;
+    // Only time spent within the body counts for its UnitTest.
+    SwitchToTest( test );
+    bool going = false;
+    try
+    {
+        task.m_wait = task.m_body( test, task.m_state, task.m_timedOut );
+        going = ( AsyncWait::Finished != task.m_wait.GetKind() );
+    }
+    catch ( const UnitTestAbort & )
+    {
+        assert( m_abortingTest == test );
+    }
+    catch ( ... )
+    {
+        test->OnException( __FILE__, __LINE__, UnitTest::Checked,
+            test->GetName(), "Exception escaped from unit test." );
+    }
+    SwitchToTest( nullptr );
+    m_abortingTest = nullptr;
+    m_runningTest = outerTest;
+
+    task.m_ready = false;
+    task.m_timedOut = false;
+    task.m_deadline = -1.0;
+    const AsyncWait::Kind kind = task.m_wait.GetKind();
+    const unsigned int milliseconds = task.m_wait.GetMilliseconds();
+    if ( ( AsyncWait::Timer == kind ) || ( 0 < milliseconds ) )
+        task.m_deadline = m_clock->GetSeconds() + milliseconds / 1000.0;
+    return going;
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::WaitForAsyncTasks( TAsyncTasks & tasks )
+{
+    assert( nullptr != this );
+    assert( !tasks.empty() );
+
+    const unsigned int count = static_cast< unsigned int >( tasks.size() );
+    bool anyReady = false;
+    bool watching = false;
+    double soonest = -1.0;
+    double now = m_clock->GetSeconds();
+#if !defined( _WIN32 )
+    fd_set readable;
+    fd_set writable;
+    FD_ZERO( &readable );
+    FD_ZERO( &writable );
+    int highest = -1;
+#endif
+    for ( unsigned int ii = 0; ii < count; ++ii )
+    {
+        AsyncTask & task = tasks[ ii ];
+        const AsyncWait::Kind kind = task.m_wait.GetKind();
+        const int descriptor = task.m_wait.GetDescriptor();
+        task.m_ready = ( AsyncWait::Ready == kind );
+        task.m_timedOut = false;
+        if ( ( AsyncWait::Readable == kind ) || ( AsyncWait::Writable == kind ) )
+        {
+#if defined( _WIN32 )
+            task.m_ready = true;
+#else
+            // A descriptor which select can't watch is left for the body to
+            // check on its next step.
+            if ( ( descriptor < 0 ) || ( FD_SETSIZE <= descriptor ) )
+                task.m_ready = true;
+            else
+            {
+                FD_SET( descriptor, ( AsyncWait::Readable == kind )
+                    ? &readable : &writable );
+                if ( highest < descriptor )
+                    highest = descriptor;
+                watching = true;
+            }
+#endif
+        }
+        if ( ( 0.0 <= task.m_deadline ) && !task.m_ready
+          && ( ( soonest < 0.0 ) || ( task.m_deadline < soonest ) ) )
+            soonest = task.m_deadline;
+        if ( task.m_ready )
+            anyReady = true;
+    }
+
+    const bool isVirtual = ( m_clock == &m_virtualClock );
+    if ( isVirtual && !anyReady && !watching && ( now < soonest ) )
+    {
+        // Every body waits on a timer, so nothing can happen before the
+        // soonest one.  Virtual time jumps there without any real waiting.
+        AdvanceVirtualTime( tasks, soonest - now );
+        now = soonest;
+    }
+
+#if defined( _WIN32 )
+    // Without select, the loop polls the clock until the soonest timer.
+    while ( !anyReady && ( now < soonest ) )
+        now = m_clock->GetSeconds();
+#else
+    const double wallStart = GetWallClockTime();
+    struct timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = 0;
+    if ( !anyReady && ( 0.0 <= soonest ) && ( now < soonest ) )
+    {
+        const double seconds = soonest - now;
+        timeout.tv_sec = static_cast< long >( seconds );
+        timeout.tv_usec = static_cast< long >(
+            ( seconds - timeout.tv_sec ) * 1000000.0 ) + 1;
+        // Rounding up may reach a whole second, which select rejects.
+        if ( 1000000 <= timeout.tv_usec )
+        {
+            ++timeout.tv_sec;
+            timeout.tv_usec -= 1000000;
+        }
+    }
+    const bool forever = !anyReady && ( soonest < 0.0 );
+    const int result = ::select( highest + 1, &readable, &writable, nullptr,
+        ( forever ) ? nullptr : &timeout );
+    // If select failed for any reason but a signal, such as a descriptor
+    // closed by its body, waiting again would fail the same way.  So each
+    // body waiting on a descriptor gets to check it, as on Windows.
+    const bool failed = ( result < 0 ) && ( EINTR != errno );
+    if ( isVirtual )
+        AdvanceVirtualTime( tasks, GetWallClockTime() - wallStart );
+    now = m_clock->GetSeconds();
+    for ( unsigned int ii = 0; ( ( 0 < result ) || failed ) && ( ii < count );
+        ++ii )
+    {
+        AsyncTask & task = tasks[ ii ];
+        const AsyncWait::Kind kind = task.m_wait.GetKind();
+        const int descriptor = task.m_wait.GetDescriptor();
+        if ( task.m_ready || ( descriptor < 0 )
+          || ( FD_SETSIZE <= descriptor ) )
+            continue;
+        if ( failed )
+            task.m_ready = ( ( AsyncWait::Readable == kind )
+                || ( AsyncWait::Writable == kind ) );
+        else if ( ( ( AsyncWait::Readable == kind )
+            && FD_ISSET( descriptor, &readable ) )
+          || ( ( AsyncWait::Writable == kind )
+            && FD_ISSET( descriptor, &writable ) ) )
+            task.m_ready = true;
+    }
+#endif
+
+    for ( unsigned int ii = 0; ii < count; ++ii )
+    {
+        AsyncTask & task = tasks[ ii ];
+        if ( task.m_ready || ( task.m_deadline < 0.0 )
+          || ( now < task.m_deadline ) )
+            continue;
+        task.m_ready = true;
+        task.m_timedOut = ( AsyncWait::Timer != task.m_wait.GetKind() );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::AdvanceVirtualTime( TAsyncTasks & tasks, double seconds )
+{
+    assert( nullptr != this );
+    // SwitchToTest( nullptr ) was called after the last step, so none of
+    // this time goes to the current UnitTest as well.
+    assert( nullptr == m_currentTest );
+    if ( seconds <= 0.0 )
+        return;
+    m_virtualClock.Advance( seconds );
+    const unsigned int count = static_cast< unsigned int >( tasks.size() );
+    for ( unsigned int ii = 0; ii < count; ++ii )
+        tasks[ ii ].m_test->m_virtualTime += seconds;
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTestSetImpl::RunStressTest( StressRun & run,
+    unsigned int threadCount, unsigned int seed )
+{
+    assert( nullptr != this );
+    assert( 0 < threadCount );
+    assert( !m_manyThreads );
+
+    UnitTest * test = run.m_test;
+    const ut::ItemCount failCount = test->GetFailCount();
+    const ut::ItemCount exceptionCount = test->GetExceptionCount();
+    vector< StressThread > threads;
+    threads.reserve( threadCount );
+    TStressWorkers workers( threadCount );
+    for ( unsigned int ii = 0; ii < threadCount; ++ii )
+    {
+        threads.push_back( StressThread( ii, seed, m_stressYield ) );
+        workers[ ii ].m_impl = this;
+        workers[ ii ].m_run = &run;
+        workers[ ii ].m_thread = &threads[ ii ];
+    }
+
+    // Tests may run other tests, so restore the outer one when done.  Every
+    // thread records into the same UnitTest, so it stays current throughout.
+    UnitTest * outerTest = m_runningTest;
+    m_runningTest = test;
+    SwitchToTest( test );
+    m_manyThreads = true;
+    const double startTime = LatencyHistogram::GetTime();
+    unsigned int started = 0;
+    for ( ; started < threadCount; ++started )
+    {
+        StressWorker & worker = workers[ started ];
+        if ( !StartThread( worker.m_handle, &StressThreadEntry, &worker ) )
+        {
+            // Threads which did start would wait forever for the rest.
+            run.Stop();
+            break;
+        }
+    }
+    for ( unsigned int ii = 0; ii < started; ++ii )
+        JoinThread( workers[ ii ].m_handle );
+    const double seconds = LatencyHistogram::GetTime() - startTime;
+    m_manyThreads = false;
+    m_abortingTest = nullptr;
+    m_runningTest = outerTest;
+    EndIfFatalInThreads();
+
+    if ( started < threadCount )
+    {
+        test->Skip( __FILE__, __LINE__, test->GetName(),
+            "Unable to make threads for stress test." );
+        return false;
+    }
+
+    const bool pass = ( failCount == test->GetFailCount() )
+        && ( exceptionCount == test->GetExceptionCount() );
+    char text[ 64 ];
+    string message;
+    AppendNumber( message, threadCount );
+    ::sprintf( text, " threads ran for %.3g seconds with seed ", seconds );
+    message += text;
+    AppendNumber( message, seed );
+    message += ".  Calls per second by thread:";
+    for ( unsigned int ii = 0; ii < threadCount; ++ii )
+    {
+        const double rate = ( 0.0 < seconds )
+            ? threads[ ii ].GetCallCount() / seconds : 0.0;
+        message += ( 0 == ii ) ? " " : ", ";
+        AppendNumber( message, static_cast< unsigned long >( rate + 0.5 ) );
+    }
+    message += ".";
+    test->DoTest( __FILE__, __LINE__, UnitTest::Checked, pass, "stress run",
+        message.c_str() );
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::RunCaseFile( CaseFileRun & run,
+    unsigned int threadCount )
+{
+    assert( nullptr != this );
+    assert( !m_manyThreads );
+
+    UnitTest * test = run.m_test;
+    const ut::ItemCount failCount = test->GetFailCount();
+    const ut::ItemCount exceptionCount = test->GetExceptionCount();
+    if ( 0 == threadCount )
+        threadCount = GetProcessorCount();
+    if ( s_MaxStressThreads < threadCount )
+        threadCount = s_MaxStressThreads;
+    if ( run.m_chunkCount < threadCount )
+        threadCount = ( 0 == run.m_chunkCount ) ? 1
+            : static_cast< unsigned int >( run.m_chunkCount );
+
+    // Tests may run other tests, so restore the outer one when done.
+    UnitTest * outerTest = m_runningTest;
+    m_runningTest = test;
+    SwitchToTest( test );
+    m_manyThreads = true;
+    run.m_impl = this;
+    const double startTime = LatencyHistogram::GetTime();
+    vector< ThreadHandle > handles( threadCount );
+    unsigned int started = 0;
+    while ( ( started + 1 < threadCount )
+        && StartThread( handles[ started ], &CaseFileThreadEntry, &run ) )
+        ++started;
+    // This thread reads chunks too, so all rows are read even if no thread
+    // starts.
+    RunCaseChunks( run );
+    for ( unsigned int ii = 0; ii < started; ++ii )
+        JoinThread( handles[ ii ] );
+    const double seconds = LatencyHistogram::GetTime() - startTime;
+    m_manyThreads = false;
+    m_abortingTest = nullptr;
+    m_runningTest = outerTest;
+    EndIfFatalInThreads();
+
+    const bool pass = ( failCount == test->GetFailCount() )
+        && ( exceptionCount == test->GetExceptionCount() );
+    char text[ 80 ];
+    string message;
+    AppendNumber( message, run.m_rowCount );
+    message += " rows from ";
+    message += run.m_fileName;
+    ::sprintf( text, " in %.3g seconds, at %.4g MB per second.", seconds,
+        ( 0.0 < seconds ) ? run.m_size / seconds / 1.0e6 : 0.0 );
+    message += text;
+    test->DoTest( __FILE__, __LINE__, UnitTest::Checked, pass, "case file",
+        message.c_str() );
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::EndIfFatalInThreads( void )
+{
+    assert( nullptr != this );
+    assert( !m_manyThreads );
+
+    if ( !m_fatalInThreads )
+        return;
+    m_fatalInThreads = false;
+    UnitTestSet::GetIt().OutputSummary();
+    ::exit( 1 );
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::AddWorkerCounters( UnitTest * test,
+    const double * counts )
+{
+    assert( nullptr != this );
+    assert( nullptr != test );
+    assert( nullptr != counts );
+
+    MonitorLock lock( &m_recordLock );
+    for ( unsigned int ii = 0; ii < UnitTest::CounterCount; ++ii )
+        test->m_counters[ ii ] += counts[ ii ];
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::AddCasePasses( UnitTest * test,
+    unsigned long passes )
+{
+    assert( nullptr != this );
+    assert( nullptr != test );
+
+    if ( 0 == passes )
+        return;
+    MonitorLock lock( GetRecordLock() );
+    if ( 0 == test->m_itemCount )
+        StartOutput();
+    test->m_itemCount += passes;
+    test->m_passCount += passes;
+    if ( 0.0 == m_soakInterval )
+        return;
+    m_soakTicks += passes;
+    if ( m_soakTicks < s_SoakCheckItems )
+        return;
+    m_soakTicks = 0;
+    CheckSoakTime();
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::RunStressThread( StressWorker & worker )
+{
+    assert( nullptr != this );
+    assert( nullptr != worker.m_run );
+    assert( nullptr != worker.m_thread );
+
+    StressRun & run = *worker.m_run;
+    StressThread & thread = *worker.m_thread;
+    WorkerCounters counters( this, run.m_test );
+    while ( run.WaitForRound() )
+    {
+        // Threads leave the barrier together, so a random pause varies which
+        // one reaches the body first.  Sleeping would take far too long.
+        if ( 0 < m_stressJitter )
+        {
+            const double until = LatencyHistogram::GetTime()
+                + ( thread.GetRandom() % ( m_stressJitter + 1 ) ) / 1.0e6;
+            while ( LatencyHistogram::GetTime() < until )
+                continue;
+        }
+        thread.MaybeYield();
+        try
+        {
+            run.m_body( run.m_test, run.m_state, thread );
+        }
+        catch ( const UnitTestAbort & )
+        {
+            run.Stop();
+        }
+        catch ( ... )
+        {
+            // Another thread may be unwinding from a required failure, in
+            // which case OnException throws rather than recording this.
+            try
+            {
+                run.m_test->OnException( __FILE__, __LINE__,
+                    UnitTest::Checked, run.m_test->GetName(),
+                    "Exception escaped from stress test." );
+            }
+            catch ( const UnitTestAbort & )
+            {
+            }
+            run.Stop();
+        }
+        ++thread.m_calls;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTestSetImpl::StartDeathChild( void )
+{
+    assert( nullptr != this );
+    assert( m_deathPid < 0 );
+    m_deathPid = -1;
+#if defined( _WIN32 )
+    return false;
+#else
+    // A death test within the child of another death test would take over
+    // the pipe its own parent waits on.
+    if ( IsDeathChild() )
+        return false;
+    int output[ 2 ];
+    int status[ 2 ];
+    if ( ::pipe( output ) != 0 )
+        return false;
+    if ( ::pipe( status ) != 0 )
+    {
+        ::close( output[ 0 ] );
+        ::close( output[ 1 ] );
+        return false;
+    }
+    // Same reason as in StartWorker.
+    m_textOutput.Flush();
+    cout << flush;
+    cerr << flush;
+    const pid_t pid = ::fork();
+    if ( pid < 0 )
+    {
+        ::close( output[ 0 ] );
+        ::close( output[ 1 ] );
+        ::close( status[ 0 ] );
+        ::close( status[ 1 ] );
+        return false;
+    }
+    if ( 0 == pid )
+    {
+        // Child process.  The statement runs once this returns.
+        ::close( output[ 0 ] );
+        ::close( status[ 0 ] );
+        ::dup2( output[ 1 ], 2 );
+        ::close( output[ 1 ] );
+        m_deathStatus = status[ 1 ];
+        m_isDeathChild = true;
+        return true;
+    }
+
+    ::close( output[ 1 ] );
+    ::close( status[ 1 ] );
+    m_deathPid = static_cast< int >( pid );
+    m_deathOutput = output[ 0 ];
+    m_deathStatus = status[ 0 ];
+    return false;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::EndDeathChild( bool threw )
+{
+    assert( nullptr != this );
+    assert( IsDeathChild() );
+#if !defined( _WIN32 )
+    const char ending = static_cast< char >(
+        ( threw ) ? DeathThrew : DeathReturned );
+    WriteAll( m_deathStatus, &ending, 1 );
+    ::_exit( 0 );
+#else
+    (void)threw;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTestSetImpl::WaitForDeathChild( string & output, char & ending,
+    int & value )
+{
+    assert( nullptr != this );
+    if ( m_deathPid < 0 )
         return false;
+#if defined( _WIN32 )
+    (void)output;
+    (void)ending;
+    (void)value;
+    return false;
+#else
+    // The child closes both pipes when it ends, so reading standard error
+    // first can not leave the child stuck on a full status pipe.
+    ReadAll( m_deathOutput, output, s_MaxDeathOutput );
+    string said;
+    ReadAll( m_deathStatus, said, 1 );
+    ::close( m_deathOutput );
+    ::close( m_deathStatus );
+    int status = 0;
+    const pid_t pid = static_cast< pid_t >( m_deathPid );
+    while ( ( ::waitpid( pid, &status, 0 ) < 0 ) && ( EINTR == errno ) )
+    {
+    }
+    m_deathPid = -1;
+    m_deathOutput = -1;
+    m_deathStatus = -1;
+
+    value = 0;
+    if ( !said.empty() )
+        ending = said[ 0 ];
+    else if ( WIFSIGNALED( status ) )
+    {
+        ending = DeathSignaled;
+        value = WTERMSIG( status );
+    }
+    else
+    {
+        ending = DeathExited;
+        value = WIFEXITED( status ) ? WEXITSTATUS( status ) : 0;
+    }
+    return true;
+#endif
+}
 
-    const unsigned int index = test->GetIndex();
-    const unsigned int failCount = test->GetFailCount();
-    const unsigned int warnCount = test->GetWarnCount();
-    const unsigned int passCount = test->GetPassCount();
-    const unsigned int itemCount = test->GetItemCount();
-    const unsigned int exceptCount = test->GetExceptionCount();
-    const char * name = test->GetName();
-    const char * result = "Passed";
-    if ( ( 0 < exceptCount ) || ( 0 < failCount ) )
+// ----------------------------------------------------------------------------
+
+void * UnitTestSetImpl::GetFixture( const char * fixtureName )
+{
+    assert( nullptr != this );
+    assert( !IsEmptyString( fixtureName ) );
+
+    // Fixtures are found by place rather than by reference, since another
+    // thread may declare one while the lock is released.
+    MonitorLock lock( &m_fixtureLock );
+    unsigned int index = 0;
+    while ( ( index < m_fixtures.size() )
+        && ( m_fixtures[ index ].m_name != fixtureName ) )
+        ++index;
+    if ( m_fixtures.size() <= index )
+        return nullptr;
+    if ( 0 == s_workerSlot )
+        s_workerSlot = m_nextWorkerSlot++;
+    const unsigned int slot =
+        ( UnitTestSet::SuiteFixture == m_fixtures[ index ].m_scope )
+        ? 0 : s_workerSlot;
+    if ( m_fixtures[ index ].m_slots.size() <= slot )
+        m_fixtures[ index ].m_slots.resize( slot + 1 );
+    // Another thread may be building the suite copy.
+    while ( m_fixtures[ index ].m_slots[ slot ].m_building )
+        m_fixtureLock.Wait();
+    if ( nullptr != m_fixtures[ index ].m_slots[ slot ].m_fixture )
+        return m_fixtures[ index ].m_slots[ slot ].m_fixture;
+
+    // The lock is released while building, so a set-up function may get
+    // other fixtures, and other threads may get theirs.
+    m_fixtures[ index ].m_slots[ slot ].m_building = true;
+    const FixtureSetUpFunction setUp = m_fixtures[ index ].m_setUp;
+    void * state = m_fixtures[ index ].m_state;
+    m_fixtureLock.Unlock();
+    const double start = LatencyHistogram::GetTime();
+    void * fixture = nullptr;
+    try
     {
-        result = "FAILED";
-    } else if ( 0 == itemCount )
+        fixture = setUp( state );
+    }
+    catch ( ... )
+    {
+        m_fixtureLock.Lock();
+        FinishFixture( m_fixtures[ index ], slot, nullptr, start );
+        m_fixtureLock.WakeAll();
+        throw;
+    }
+    m_fixtureLock.Lock();
+    FinishFixture( m_fixtures[ index ], slot, fixture, start );
+    m_fixtureLock.WakeAll();
+    if ( IsIsolatedChild() && ( nullptr != m_runningTest ) )
+    {
+        // The parent shows what building it cost, and builds it for later
+        // children.
+        char seconds[ 32 ];
+        ::sprintf( seconds, "%.9g", LatencyHistogram::GetTime() - start );
+        SendToParent( IsolatedFixture, m_runningTest, UnitTest::Checked, true,
+            __FILE__, __LINE__, fixtureName, seconds );
+    }
+    return fixture;
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::SetUpChildFixtures( void )
+{
+    assert( nullptr != this );
+
+    for ( unsigned int ii = 0; ; ++ii )
+    {
+        string name;
+        {
+            MonitorLock lock( &m_fixtureLock );
+            if ( m_fixtures.size() <= ii )
+                break;
+            if ( !m_fixtures[ ii ].m_usedByChild )
+                continue;
+            name = m_fixtures[ ii ].m_name;
+        }
+        try
+        {
+            GetFixture( name.c_str() );
+        }
+        catch ( ... )
+        {
+            // The child process tries again, and records the exception.
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::AddChildFixture( const string & fixtureName,
+    double seconds )
+{
+    assert( nullptr != this );
+
+    MonitorLock lock( &m_fixtureLock );
+    const TFixtures::iterator last( m_fixtures.end() );
+    for ( TFixtures::iterator it( m_fixtures.begin() ); it != last; ++it )
+    {
+        if ( it->m_name != fixtureName )
+            continue;
+        ++it->m_setUpCount;
+        it->m_setUpSeconds += seconds;
+        it->m_usedByChild = true;
+        break;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::TearDownFixtures( void )
+{
+    assert( nullptr != this );
+
+    // Later fixtures may use earlier ones, so they are torn down first.  The
+    // lock is released while tear-down functions run, since they may get
+    // other fixtures.
+    unsigned int ii = 0;
+    {
+        MonitorLock lock( &m_fixtureLock );
+        ii = static_cast< unsigned int >( m_fixtures.size() );
+    }
+    for ( ; 0 < ii; --ii )
+    {
+        vector< void * > built;
+        FixtureTearDownFunction tearDown = nullptr;
+        void * state = nullptr;
+        {
+            MonitorLock lock( &m_fixtureLock );
+            Fixture & fixture = m_fixtures[ ii - 1 ];
+            tearDown = fixture.m_tearDown;
+            state = fixture.m_state;
+            // Children build it again on first use, as they did at first.
+            fixture.m_usedByChild = false;
+            const unsigned int count =
+                static_cast< unsigned int >( fixture.m_slots.size() );
+            for ( unsigned int slot = 0; slot < count; ++slot )
+            {
+                if ( nullptr == fixture.m_slots[ slot ].m_fixture )
+                    continue;
+                built.push_back( fixture.m_slots[ slot ].m_fixture );
+                fixture.m_slots[ slot ].m_fixture = nullptr;
+            }
+        }
+        if ( ( nullptr == tearDown ) || built.empty() )
+            continue;
+        const double start = LatencyHistogram::GetTime();
+        for ( size_t jj = 0; jj < built.size(); ++jj )
+        {
+            try
+            {
+                tearDown( built[ jj ], state );
+            }
+            catch ( ... )
+            {
+                // No UnitTest is running, so there is nowhere to record it.
+            }
+        }
+        MonitorLock lock( &m_fixtureLock );
+        m_fixtures[ ii - 1 ].m_tearDownSeconds +=
+            LatencyHistogram::GetTime() - start;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTestSetImpl::ShowFixtureLines(
+    UnitTestResultReceiver * receiver ) const
+{
+    assert( nullptr != this );
+    assert( nullptr != receiver );
+
+    bool keep = true;
+    const TFixtures::const_iterator last( m_fixtures.end() );
+    for ( TFixtures::const_iterator it( m_fixtures.begin() );
+        keep && ( it != last ); ++it )
+    {
+        if ( 0 == it->m_setUpCount )
+            continue;
+        keep = receiver->ShowFixtureLine( it->m_name.c_str(),
+            UnitTestSet::WorkerFixture == it->m_scope, it->m_setUpCount,
+            it->m_setUpSeconds, it->m_tearDownSeconds );
+    }
+    return keep;
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::CheckSoakTime( void )
+{
+    assert( nullptr != this );
+    if ( ( 0.0 < m_soakInterval ) && ( m_soakInterval
+        <= LatencyHistogram::GetTime() - m_soakLast ) )
+        OutputSoakSnapshot();
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::CountSoakFailure( void )
+{
+    assert( nullptr != this );
+    const double now = LatencyHistogram::GetTime();
+    if ( ( 0 == m_burstCount )
+      || ( s_SoakBurstSeconds < now - m_burstStart ) )
+    {
+        m_burstStart = now;
+        m_burstCount = 0;
+    }
+    ++m_burstCount;
+    if ( m_peakBurst < m_burstCount )
+    {
+        m_peakBurst = m_burstCount;
+        m_peakBurstStart = m_burstStart;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::StartSoakCounts( void )
+{
+    assert( nullptr != this );
+
+    m_soakTotals = SoakTotals();
+    const unsigned int testCount =
+        static_cast< unsigned int >( m_tests.size() );
+    m_soakFailures.assign( testCount, 0 );
+    for ( unsigned int ii = 0; ii < testCount; ++ii )
+    {
+        const UnitTest * test = m_tests[ ii ];
+        if ( nullptr == test )
+            continue;
+        AddSoakTotals( m_soakTotals, *test );
+        m_soakFailures[ ii ] = test->GetFailCount()
+            + test->GetExceptionCount();
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::OutputSoakSnapshot( void )
+{
+    assert( nullptr != this );
+
+    const double now = LatencyHistogram::GetTime();
+    SoakSnapshot snapshot;
+    snapshot.m_number = ++m_soakCount;
+    snapshot.m_runSeconds = now - m_soakStart;
+    snapshot.m_intervalSeconds = now - m_soakLast;
+    snapshot.m_totals = SoakTotals();
+    SoakTotals & totals = snapshot.m_totals;
+    unsigned int nameCount = 0;
+    const unsigned int testCount =
+        static_cast< unsigned int >( m_tests.size() );
+    m_soakFailures.resize( testCount, 0 );
+    for ( unsigned int ii = 0; ii < testCount; ++ii )
+    {
+        const UnitTest * test = m_tests[ ii ];
+        if ( nullptr == test )
+            continue;
+        AddSoakTotals( totals, *test );
+        const ItemCount failures =
+            test->GetFailCount() + test->GetExceptionCount();
+        if ( failures <= m_soakFailures[ ii ] )
+            continue;
+        if ( nameCount < s_MaxSoakNames )
+        {
+            if ( 0 < nameCount )
+                snapshot.m_failedTests += ", ";
+            snapshot.m_failedTests += test->GetName();
+            snapshot.m_failedTests += " (+";
+            AppendNumber( snapshot.m_failedTests,
+                failures - m_soakFailures[ ii ] );
+            snapshot.m_failedTests += ')';
+        }
+        ++nameCount;
+        m_soakFailures[ ii ] = failures;
+    }
+    if ( s_MaxSoakNames < nameCount )
+    {
+        snapshot.m_failedTests += ", and ";
+        AppendNumber( snapshot.m_failedTests, nameCount - s_MaxSoakNames );
+        snapshot.m_failedTests += " more";
+    }
+
+    SoakTotals & deltas = snapshot.m_deltas;
+    deltas.m_passCount = totals.m_passCount - m_soakTotals.m_passCount;
+    deltas.m_warnCount = totals.m_warnCount - m_soakTotals.m_warnCount;
+    deltas.m_failCount = totals.m_failCount - m_soakTotals.m_failCount;
+    deltas.m_exceptCount = totals.m_exceptCount - m_soakTotals.m_exceptCount;
+    deltas.m_skipCount = totals.m_skipCount - m_soakTotals.m_skipCount;
+    deltas.m_itemCount = totals.m_itemCount - m_soakTotals.m_itemCount;
+    m_soakTotals = totals;
+
+    snapshot.m_burstCount = m_peakBurst;
+    snapshot.m_burstSeconds = m_peakBurstStart - m_soakStart;
+    m_peakBurst = 0;
+    m_soakLast = now;
+    m_textOutput.ShowSoakSnapshot( snapshot );
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTestSetImpl::StartWorker( UnitTest * test, UnitTestFunction body,
+    IsolatedWorker & worker )
+{
+    assert( nullptr != this );
+    assert( !IsIsolatedChild() );
+#if defined( _WIN32 )
+    (void)test;
+    (void)body;
+    (void)worker;
+    return false;
+#else
+    SetUpChildFixtures();
+    int ends[ 2 ];
+    if ( ::pipe( ends ) != 0 )
+        return false;
+    if ( FD_SETSIZE <= ends[ 0 ] )
+    {
+        // WaitForWorker could not select on this pipe.
+        ::close( ends[ 0 ] );
+        ::close( ends[ 1 ] );
+        return false;
+    }
+    // Anything waiting in the output buffer would otherwise go out twice if
+    // the child flushed it, so send it first.
+    m_textOutput.Flush();
+    cout << flush;
+    cerr << flush;
+    const pid_t pid = ::fork();
+    if ( pid < 0 )
+    {
+        ::close( ends[ 0 ] );
+        ::close( ends[ 1 ] );
+        return false;
+    }
+    if ( 0 == pid )
+    {
+        // Child process.  It sends events to parent, and never returns, so
+        // nothing at exit time runs twice.
+        ::close( ends[ 0 ] );
+        m_parentPipe = ends[ 1 ];
+        m_runningTest = test;
+        m_abortingTest = nullptr;
+        if ( m_perfCounters.IsOpen() )
+        {
+            // Counters opened by parent would also count parent's events.
+            m_perfCounters.Open();
+            m_perfCounters.Read( m_switchCounters );
+        }
+        SwitchToTest( test );
+        try
+        {
+            body( test );
+        }
+        catch ( ... )
+        {
+            SendToParent( IsolatedException, test, UnitTest::Checked, false,
+                __FILE__, __LINE__, test->GetName(),
+                "Exception escaped from unit test." );
+        }
+        // The end event carries virtual milliseconds in place of a line, and
+        // the performance counts in place of a message.
+        SwitchToTest( nullptr );
+        const double milliseconds = test->m_virtualTime * 1000.0 + 0.5;
+        const unsigned int virtualTime = ( milliseconds < 4.0e9 )
+            ? static_cast< unsigned int >( milliseconds ) : 4000000000U;
+        string counts;
+        for ( unsigned int ii = 0; ii < UnitTest::CounterCount; ++ii )
+        {
+            if ( 0 != ii )
+                counts += ' ';
+            AppendCount( counts, test->m_counters[ ii ] );
+        }
+        counts += ( test->m_rssGrowth < 0 ) ? " -" : " ";
+        AppendNumber( counts, static_cast< unsigned long >(
+            ( test->m_rssGrowth < 0 ) ? -test->m_rssGrowth : test->m_rssGrowth ) );
+        counts += ' ';
+        AppendNumber( counts, test->m_peakRss );
+        counts += ' ';
+        AppendNumber( counts, test->m_majorFaults );
+        counts += ' ';
+        AppendNumber( counts, test->m_minorFaults );
+        SendToParent( IsolatedEnd, test, UnitTest::Checked, true, nullptr,
+            virtualTime, nullptr, counts.c_str() );
+        ::_exit( 0 );
+    }
+
+    ::close( ends[ 1 ] );
+    worker.m_pid = static_cast< int >( pid );
+    worker.m_pipe = ends[ 0 ];
+    worker.m_test = test;
+    worker.m_startTime = GetWallClockTime();
+    worker.m_timedOut = false;
+    worker.m_events.erase();
+    return true;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned int UnitTestSetImpl::WaitForWorker( TIsolatedWorkers & workers )
+{
+    assert( nullptr != this );
+    assert( !workers.empty() );
+#if !defined( _WIN32 )
+    const unsigned int count = static_cast< unsigned int >( workers.size() );
+    for ( ;; )
+    {
+        fd_set readable;
+        FD_ZERO( &readable );
+        int highest = -1;
+        double deadline = 0.0;
+        for ( unsigned int ii = 0; ii < count; ++ii )
+        {
+            FD_SET( workers[ ii ].m_pipe, &readable );
+            if ( highest < workers[ ii ].m_pipe )
+                highest = workers[ ii ].m_pipe;
+            const double end = workers[ ii ].m_startTime + m_workerTimeout;
+            if ( ( 0 == ii ) || ( end < deadline ) )
+                deadline = end;
+        }
+        timeval wait;
+        timeval * waitPointer = nullptr;
+        if ( 0.0 < m_workerTimeout )
+        {
+            const double now = GetWallClockTime();
+            if ( deadline <= now )
+            {
+                // Child is hung.  Once killed, its pipe closes and FinishWorker
+                // reads what it sent before then.
+                for ( unsigned int ii = 0; ii < count; ++ii )
+                {
+                    IsolatedWorker & worker = workers[ ii ];
+                    if ( worker.m_startTime + m_workerTimeout <= now )
+                    {
+                        ::kill( static_cast< pid_t >( worker.m_pid ), SIGKILL );
+                        worker.m_timedOut = true;
+                        return ii;
+                    }
+                }
+            }
+            const double left = deadline - now;
+            wait.tv_sec = static_cast< time_t >( left );
+            wait.tv_usec = static_cast< suseconds_t >(
+                ( left - static_cast< double >( wait.tv_sec ) ) * 1.0e6 );
+            if ( 999999 < wait.tv_usec )
+                wait.tv_usec = 999999;
+            waitPointer = &wait;
+        }
+        if ( ::select( highest + 1, &readable, nullptr, nullptr,
+            waitPointer ) < 0 )
+        {
+            if ( EINTR == errno )
+                continue;
+            // FinishWorker reads this child until it ends.
+            return 0;
+        }
+        for ( unsigned int ii = 0; ii < count; ++ii )
+        {
+            if ( FD_ISSET( workers[ ii ].m_pipe, &readable )
+              && !ReadSome( workers[ ii ] ) )
+                return ii;
+        }
+    }
+#endif
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::FinishWorker( IsolatedWorker & worker )
+{
+    assert( nullptr != this );
+    int status = 0;
+#if !defined( _WIN32 )
+    while ( ReadSome( worker ) )
+    {
+    }
+    ::close( worker.m_pipe );
+    const pid_t pid = static_cast< pid_t >( worker.m_pid );
+    while ( ( ::waitpid( pid, &status, 0 ) < 0 ) && ( EINTR == errno ) )
+    {
+    }
+#endif
+    // Children overlap each other, so the time spent in the child is added
+    // here instead of by SwitchToTest.
+    worker.m_test->m_elapsedTime += GetWallClockTime() - worker.m_startTime;
+    ReplayEvents( worker.m_test, worker.m_events, status, worker.m_timedOut );
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::ReplayEvents( UnitTest * test, const string & events,
+    int status, bool timedOut )
+{
+    assert( nullptr != this );
+    assert( nullptr != test );
+
+    // The child already ended the UnitTest after any fatal result, so the
+    // replay does the same no matter what the FatalEndsTest option is.
+    UnitTest * outerTest = m_runningTest;
+    const bool fatalEndsTest = m_fatalEndsTest;
+    m_fatalEndsTest = true;
+    bool finished = false;
+    size_t place = 0;
+    IsolatedEvent event;
+    try
+    {
+        while ( !finished && ReadEvent( events, place, event ) )
+        {
+            if ( IsolatedEnd == event.m_kind )
+            {
+                test->m_virtualTime += event.m_line / 1000.0;
+                const char * counts = event.m_message.c_str();
+                for ( unsigned int ii = 0; ii < UnitTest::CounterCount; ++ii )
+                {
+                    char * end = nullptr;
+                    const double count = ::strtod( counts, &end );
+                    if ( end == counts )
+                        break;
+                    test->m_counters[ ii ] += count;
+                    counts = end;
+                }
+                char * end = nullptr;
+                test->m_rssGrowth += ::strtol( counts, &end, 10 );
+                counts = end;
+                test->m_peakRss = max( test->m_peakRss,
+                    ::strtoul( counts, &end, 10 ) );
+                counts = end;
+                test->m_majorFaults += ::strtoul( counts, &end, 10 );
+                counts = end;
+                test->m_minorFaults += ::strtoul( counts, &end, 10 );
+                finished = true;
+                break;
+            }
+            UnitTest * target = ( event.m_test == test->GetName() )
+                ? test : AddUnitTest( event.m_test.c_str() );
+            if ( nullptr == target )
+                continue;
+            m_runningTest = target;
+            const UnitTest::TestLevel level =
+                static_cast< UnitTest::TestLevel >( event.m_level );
+            const char * message =
+                ( event.m_hasMessage ) ? event.m_message.c_str() : nullptr;
+            switch ( event.m_kind )
+            {
+                case IsolatedItem:
+                    target->DoTest( event.m_fileName.c_str(), event.m_line,
+                        level, ( 0 != event.m_pass ),
+                        event.m_expression.c_str(), message );
+                    break;
+                case IsolatedException:
+                    target->OnException( event.m_fileName.c_str(),
+                        event.m_line, level, event.m_expression.c_str(),
+                        message );
+                    break;
+                case IsolatedMessage:
+                    target->OutputMessage( event.m_fileName.c_str(),
+                        event.m_line, event.m_expression.c_str() );
+                    break;
+                case IsolatedSkip:
+                    target->Skip( event.m_fileName.c_str(), event.m_line,
+                        event.m_expression.c_str(), message );
+                    break;
+                case IsolatedFixture:
+                    AddChildFixture( event.m_expression,
+                        ::strtod( event.m_message.c_str(), nullptr ) );
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    catch ( const UnitTestAbort & )
+    {
+        finished = true;
+    }
+    m_abortingTest = nullptr;
+    m_runningTest = outerTest;
+    SwitchToTest( outerTest );
+    m_fatalEndsTest = fatalEndsTest;
+    if ( finished )
+        return;
+
+    string reason( "Unit test process " );
+#if !defined( _WIN32 )
+    if ( timedOut )
+    {
+        reason.append( "was killed since it ran longer than " );
+        AppendNumber( reason, static_cast< unsigned long >(
+            m_workerTimeout * 1000.0 + 0.5 ) );
+        reason.append( " milliseconds." );
+    }
+    else if ( WIFSIGNALED( status ) )
+    {
+        reason.append( "ended by signal " );
+        AppendNumber( reason, static_cast< unsigned long >(
+            WTERMSIG( status ) ) );
+        reason += '.';
+    }
+    else if ( WIFEXITED( status ) )
+    {
+        reason.append( "called exit with code " );
+        AppendNumber( reason, static_cast< unsigned long >(
+            WEXITSTATUS( status ) ) );
+        reason += '.';
+    }
+    else
+#else
+    (void)status;
+#endif
+    {
+        reason.append( "ended early." );
+    }
+    test->OnException( __FILE__, __LINE__, UnitTest::Checked,
+        test->GetName(), reason.c_str() );
+}
+
+// ----------------------------------------------------------------------------
+
+void UnitTestSetImpl::OutputTestLine( UnitTest * test,
+    TestResult::EnumType result, const char * fileName, unsigned int line,
+    const char * expression, const char * message )
+{
+    assert( nullptr != this );
+    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
+
+    bool keep = false;
+    assert( !m_usingReceivers );
+    m_usingReceivers = true;
+    TUnitTestReceiverSetIter end( m_receivers.end() );
+    for ( TUnitTestReceiverSetIter it( m_receivers.begin() ); it != end; ++it )
     {
-        result = "Empty!";
+        UnitTestResultReceiver * receiver = *it;
+        if ( receiver == nullptr )
+            continue;
+        try
+        {
+            keep = receiver->ShowTestLine( test, result, fileName, line,
+                expression, message );
+        }
+        catch ( ... )
+        {
+            keep = false;
+        }
+        if ( !keep )
+            *it = nullptr;
     }
+    assert( m_usingReceivers );
+    m_usingReceivers = false;
+}
 
-    char buffer[ 1024 ];
-    strstream content( buffer, sizeof(buffer) );
-    content << result << "  "
-        << setw(  3 ) << setfill( ' ' ) << right << index << "  "
-        << setw( 24 ) << setfill( ' ' ) << left  << name << '\t'
-        << setw(  6 ) << setfill( ' ' ) << right << passCount << '\t'
-        << setw(  6 ) << setfill( ' ' ) << right << warnCount << '\t'
-        << setw(  6 ) << setfill( ' ' ) << right << failCount << '\t'
-        << setw(  6 ) << setfill( ' ' ) << right << exceptCount << '\t'
-        << setw(  6 ) << setfill( ' ' ) << right << itemCount << endl << ends;
+// ----------------------------------------------------------------------------
 
-    if ( m_sendToCout )
+void UnitTestSetImpl::OutputMessage( UnitTest * test, const char * fileName,
+    unsigned int line, const char * message )
+{
+    assert( nullptr != this );
+    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
+
+    if ( !m_showMessages )
     {
-        cout << buffer << flush;
+        return;
     }
-    if ( m_sendToCerr )
+    if ( !test->m_madeHeader )
     {
-        cerr << buffer << flush;
+        OutputTestHeader( test );
+        test->m_madeHeader = true;
     }
-    if ( m_isOpen )
+
+    bool keep = false;
+    assert( !m_usingReceivers );
+    m_usingReceivers = true;
+    TUnitTestReceiverSetIter end( m_receivers.end() );
+    for ( TUnitTestReceiverSetIter it( m_receivers.begin() ); it != end; ++it )
     {
-        m_outFile << buffer << flush;
+        UnitTestResultReceiver * receiver = *it;
+        if ( receiver == nullptr )
+            continue;
+        try
+        {
+            keep = receiver->ShowMessage( test, fileName, line, message );
+        }
+        catch ( ... )
+        {
+            keep = false;
+        }
+        if ( !keep )
+            *it = nullptr;
     }
+    assert( m_usingReceivers );
+    m_usingReceivers = false;
+}
 
-    return true;
+// ----------------------------------------------------------------------------
+
+const UnitTest * UnitTestSetImpl::GetUnitTest( const char * unitTestName ) const
+{
+    assert( nullptr != this );
+    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
+
+    size_t length = 0;
+    const unsigned int hash = HashName( unitTestName, length );
+    return m_index.Find( unitTestName, hash );
 }
 
 // ----------------------------------------------------------------------------
 
-bool TextOutputter::ShowTotalLine( unsigned int passCount,
-    unsigned int warnCount, unsigned int failCount, unsigned int exceptCount,
-    unsigned int itemCount )
+UnitTest * UnitTestSetImpl::AddUnitTest( const char * unitTestName )
 {
     assert( nullptr != this );
+    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
 
-    if ( !DoesOutput() )
-        return false;
+    size_t length = 0;
+    const unsigned int hash = HashName( unitTestName, length );
+    UnitTest * test = m_index.Find( unitTestName, hash );
+    if ( nullptr != test )
+        return test;
 
-    char buffer[ 1024 ];
-    const bool passed = ( ( 0 == failCount ) && ( 0 == exceptCount ) );
-    const char * pResult = ( passed ) ? "Pass" : "FAIL";
-    strstream content( buffer, sizeof(buffer) );
-    if ( m_showDividers )
-        content << s_DividerLine << endl;
-    content
-        << pResult << "	   Item Totals             \t"
-        << setw( 6 ) << setfill( ' ' ) << right << passCount << '\t'
-        << setw( 6 ) << setfill( ' ' ) << right << warnCount << '\t'
-        << setw( 6 ) << setfill( ' ' ) << right << failCount << '\t'
-        << setw( 6 ) << setfill( ' ' ) << right << exceptCount << '\t'
-        << setw( 6 ) << setfill( ' ' ) << right << itemCount
-        << endl << endl << ends;
+    // Get all the memory needed first.  If any of these throw, nothing
+    // visible has changed.  None of the steps after these can throw.
+    const size_t count = m_tests.size() + 1;
+    ReserveGrowth( m_tests, count );
+    m_index.Reserve( count );
+    m_arena.Reserve();
+    m_names.Reserve( length );
 
-    if ( m_sendToCout )
-    {
-        cout << buffer << flush;
-    }
-    if ( m_sendToCerr )
-    {
-        cerr << buffer << flush;
-    }
-    if ( m_isOpen )
-    {
-        m_outFile << buffer << flush;
-    }
+    const char * name = m_names.Intern( unitTestName, length );
+    test = new ( m_arena.Allocate() ) UnitTest( name );
+    m_tests.push_back( test );
+    test->m_index = static_cast< unsigned int >( count );
+    m_index.Insert( test, hash );
 
-    return true;
+    return test;
 }
 
 // ----------------------------------------------------------------------------
 
-bool TextOutputter::ShowSummaryLine( unsigned int passCount,
-    unsigned int warnCount, unsigned int failCount, unsigned int exceptCount,
-    unsigned int testCount )
+void UnitTestSetImpl::SetupInternalReceivers( void )
 {
     assert( nullptr != this );
+    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
 
-    if ( !DoesOutput() )
-        return false;
+    ::memset( m_timeString, 0, sizeof(m_timeString) );
+    time( &m_startTime );
+    if ( m_showTimeStamp )
+    {
+        const struct tm * timeStamp = ::localtime( &m_startTime );
+        ::strftime( m_timeString, sizeof(m_timeString)-1,
+            s_timeStampFormatSpec, timeStamp );
+    }
 
-    char buffer[ 1024 ];
-    const bool passed = ( ( 0 == failCount ) && ( 0 == exceptCount ) );
-    const char * pResult = ( passed ) ? "Pass" : "FAIL";
-    strstream content( buffer, sizeof(buffer) );
-    if ( m_showDividers )
-        content << s_DividerLine << endl;
-    content
-        << pResult << "	   Unit Test Totals        \t"
-        << setw( 6 ) << setfill( ' ' ) << right << passCount << '\t'
-        << setw( 6 ) << setfill( ' ' ) << right << warnCount << '\t'
-        << setw( 6 ) << setfill( ' ' ) << right << failCount << '\t'
-        << setw( 6 ) << setfill( ' ' ) << right << exceptCount << '\t'
-        << setw( 6 ) << setfill( ' ' ) << right << testCount
-        << endl << endl << ends;
+    const bool sendToText = ( m_textFilePartialName.size() != 0 );
+    const bool sendToHtml = ( m_htmlFilePartialName.size() != 0 );
+    const bool sendToXml  = ( m_xmlFilePartialName.size()  != 0 );
 
-    if ( m_sendToCout )
+    if ( sendToText || sendToHtml || sendToXml )
     {
-        cout << buffer << flush;
+        string xmlFileName;
+        string textFileName;
+        string currentHtmlFileName;
+        string mainHtmlFileName;
+        MakeFileNames( &m_startTime, m_textFilePartialName.c_str(),
+            m_htmlFilePartialName.c_str(), m_xmlFilePartialName.c_str(),
+            textFileName, currentHtmlFileName, mainHtmlFileName, xmlFileName );
+
+        if ( sendToText )
+            m_textOutput.SetFileName( textFileName.c_str() );
+        if ( sendToHtml )
+        {
+            m_htmlOutput.SetMainPageName( mainHtmlFileName.c_str() );
+            m_htmlOutput.SetCurrentPageName( currentHtmlFileName.c_str() );
+            m_htmlOutput.SetTimeStampInfo( &m_startTime );
+            if ( !m_didFirstRun )
+                m_receivers.push_back( &m_htmlOutput );
+        }
+        if ( sendToXml )
+        {
+            m_xmlOutput.SetFileName( xmlFileName.c_str() );
+            if ( !m_didFirstRun )
+                m_receivers.push_back( &m_xmlOutput );
+        }
     }
-    if ( m_sendToCerr )
+    if ( m_jsonFilePartialName.size() != 0 )
     {
-        cerr << buffer << flush;
+        string jsonFileName;
+        MakeTimeStampedFileName( &m_startTime, m_jsonFilePartialName.c_str(),
+            ".jsonl", jsonFileName );
+        m_jsonOutput.SetFileName( jsonFileName.c_str() );
+        if ( !m_didFirstRun )
+            m_receivers.push_back( &m_jsonOutput );
     }
-    if ( m_isOpen )
+    if ( m_junitFilePartialName.size() != 0 )
     {
-        m_outFile << buffer << flush;
+        string junitFileName;
+        MakeTimeStampedFileName( &m_startTime, m_junitFilePartialName.c_str(),
+            ".junit.xml", junitFileName );
+        m_junitOutput.SetFileName( junitFileName.c_str() );
+        if ( !m_didFirstRun )
+            m_receivers.push_back( &m_junitOutput );
     }
-
-    return true;
+    if ( ( m_textOutput.DoesSendToCout() || sendToText )
+      && ( !m_didFirstRun ) )
+        m_receivers.push_back( &m_textOutput );
 }
 
 // ----------------------------------------------------------------------------
 
-bool TextOutputter::EndSummaryTable( void )
+void UnitTestSetImpl::StartOutput( void )
 {
     assert( nullptr != this );
-    Close();
-    return true;
-}
-
-// ----------------------------------------------------------------------------
+    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
 
-HtmlOutputter::HtmlOutputter( const ut::UnitTestSetImpl * info,
-    ::ut::UnitTestSet::OutputOptions options ) :
-    FileOutputter(),
-    UnitTestResultReceiver(),
-    m_info( info ),
-    m_startTime( nullptr ),
-    m_showIndexes( 0 != ( options & ut::UnitTestSet::AddTestIndex ) ),
-    m_htmlFileName(),
-    m_mainPageName()
-{
-    assert( nullptr != this );
-}
+    if ( m_didPageHeader )
+        return;
 
-// ----------------------------------------------------------------------------
+    assert( !m_usingReceivers );
+    m_usingReceivers = true;
+    m_didAnyTest = true;
+    SetupInternalReceivers();
 
-HtmlOutputter::~HtmlOutputter( void )
-{
-    assert( nullptr != this );
+    bool keep = false;
+    TUnitTestReceiverSetIter end( m_receivers.end() );
+    for ( TUnitTestReceiverSetIter it( m_receivers.begin() ); it != end; ++it )
+    {
+        UnitTestResultReceiver * receiver = *it;
+        if ( receiver == nullptr )
+            continue;
+        try
+        {
+            keep = receiver->Start( m_testName.c_str() );
+        }
+        catch ( ... )
+        {
+            keep = false;
+        }
+        if ( !keep )
+            *it = nullptr;
+    }
+    assert( m_usingReceivers );
+    m_usingReceivers = false;
+    m_didPageHeader = true;
 }
 
 // ----------------------------------------------------------------------------
 
-bool HtmlOutputter::Start( const char * name )
+void UnitTestSetImpl::OutputTestHeader( const UnitTest * test )
 {
     assert( nullptr != this );
-    assert( !IsEmptyString( name ) );
-    assert( !m_isOpen );
-
-    Open( m_htmlFileName.c_str() );
-    if ( !m_isOpen )
-        return false;
+    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
 
-    string filenameLink( "./");
-    filenameLink += FindFileNameInPath( m_mainPageName.c_str() );
-    m_outFile
-        << "<html><head><title>Unit Test Results</title></head>" << endl
-        << endl << "<body bgcolor=black text=white>" << endl
-        << "<a href=\'" << filenameLink
-        << "\'>Unit Test Main Page</a><br>" << endl;
-    m_outFile << "Name of Unit Tests: " << name << "<br>" << endl;
+    if ( !m_showHeaders )
+        return;
+    m_didAnyTest = true;
 
-    return true;
+    bool keep = false;
+    assert( !m_usingReceivers );
+    m_usingReceivers = true;
+    TUnitTestReceiverSetIter end( m_receivers.end() );
+    for ( TUnitTestReceiverSetIter it( m_receivers.begin() ); it != end; ++it )
+    {
+        UnitTestResultReceiver * receiver = *it;
+        if ( receiver == nullptr )
+            continue;
+        try
+        {
+            keep = receiver->ShowTestHeader( test );
+        }
+        catch ( ... )
+        {
+            keep = false;
+        }
+        if ( !keep )
+            *it = nullptr;
+    }
+    assert( m_usingReceivers );
+    m_usingReceivers = false;
 }
 
 // ----------------------------------------------------------------------------
 
-bool HtmlOutputter::ShowMessage( const ut::UnitTest * test,
-    const char * fileName, unsigned int line, const char * message )
+void UnitTestSetImpl::ShowTimeStamp( void )
 {
     assert( nullptr != this );
-    if ( !m_isOpen )
-        return false;
-    m_outFile << fileName << '(' << line << ") : ";
-    if ( m_showIndexes )
-        m_outFile << test->GetIndex() << ' ';
-    m_outFile << message << "<br>" << endl;
-    return true;
+    assert( m_usingReceivers );
+    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
+
+    time_t timeNow;
+    time( &timeNow );
+    const tm * endTime = ::localtime( &timeNow );
+    char buffer[ 160 ];
+    ::strftime( buffer, sizeof(buffer)-1, s_timeStampFormatSpec, endTime );
+
+    bool keep = false;
+    TUnitTestReceiverSetIter end( m_receivers.end() );
+    for ( TUnitTestReceiverSetIter it( m_receivers.begin() ); it != end; ++it )
+    {
+        UnitTestResultReceiver * receiver = *it;
+        if ( receiver == nullptr )
+            continue;
+        try
+        {
+            keep  = receiver->ShowTimeStamp( true, m_timeString );
+            keep &= receiver->ShowTimeStamp( false, buffer );
+        }
+        catch ( ... )
+        {
+            keep = false;
+        }
+        if ( !keep )
+            *it = nullptr;
+    }
 }
 
 // ----------------------------------------------------------------------------
 
-bool HtmlOutputter::ShowTestHeader( const ut::UnitTest * test )
+void UnitTestSetImpl::MakeTableRows( void )
 {
     assert( nullptr != this );
-    if ( !m_isOpen )
-        return false;
-    const unsigned int index = test->GetIndex();
-    m_outFile
-        << "<br>Test Number: " << index << "  " << test->GetName()
-        << "<br>" << endl;
-    return true;
-}
+    assert( m_showFinalTable );
+    assert( m_usingReceivers );
 
-// ----------------------------------------------------------------------------
+    bool keep = false;
+    const char * pResult = nullptr;
+    UnitTestResultReceiver * receiver = nullptr;
+    TUnitTestReceiverSetIter recvEnd( m_receivers.end() );
+    TUnitTestReceiverSetIter recvIt;
+    TUnitTestChildrenCIter last( m_tests.end() );
 
-bool HtmlOutputter::ShowTestLine( const ut::UnitTest * test,
-    ut::TestResult::EnumType result, const char * fileName, unsigned int line,
-    const char * expression, const char * message )
-{
-    assert( nullptr != this );
+    for ( TUnitTestChildrenCIter it( m_tests.begin() ); it != last; ++it )
+    {
+        const UnitTest * pTest = *it;
+        if ( nullptr == pTest )
+            continue;
 
-    if ( !m_isOpen )
-        return false;
+        ++m_testCount;
+        const bool pass = pTest->DidPass();
+        if ( !pass )
+            ++m_testFailCount;
+        else if ( pTest->WasSkipped() )
+            ++m_testSkipCount;
+        else
+            ++m_testPassCount;
+        if ( 0 < pTest->GetWarnCount() )
+            ++m_testWarnCount;
+        pResult = pass ? "Pass" : "FAIL";
 
-    const char * status = ut::TestResult::GetName( result );
-    const char * lineColor = GetColor( result );
-    m_outFile << "<span style=\"color: " << lineColor << "\">"
-        << fileName << '(' << line << ") : " << status << "    ";
-    if ( m_showIndexes )
-        m_outFile << test->GetIndex() << ':';
-    m_outFile << test->GetItemCount() << "  (" << expression << ")";
-    if ( !IsEmptyString( message ) )
-        m_outFile << "  " << message;
-    m_outFile << "</span><br>" << endl;
+        m_itemPassCount += pTest->GetPassCount();
+        m_itemWarnCount += pTest->GetWarnCount();
+        m_itemFailCount += pTest->GetFailCount();
+        m_itemCount += pTest->GetItemCount();
+        ut::ItemCount exceptCount = pTest->GetExceptionCount();
+        m_itemExceptCount += exceptCount;
+        if ( exceptCount != 0 )
+            ++m_testExceptCount;
+        m_itemSkipCount += pTest->GetSkipCount();
 
-    if ( ut::TestResult::Fatal == result )
-    {
-        m_outFile
-            << "<span style=\"color: red\">A required test failed!<br>" << endl
-            << "Unable to safely execute further tests!<br>" << endl
-            << "Program must exit now!</span><br>" << endl;
+        for ( recvIt = m_receivers.begin(); recvIt != recvEnd; ++recvIt )
+        {
+            receiver = *recvIt;
+            if ( receiver == nullptr )
+                continue;
+            keep = true;
+            try
+            {
+                keep = receiver->ShowTableLine( pTest );
+            }
+            catch ( ... )
+            {
+                keep = false;
+            }
+            if ( !keep )
+                *recvIt = nullptr;
+        }
     }
-    return true;
 }
 
 // ----------------------------------------------------------------------------
 
-bool HtmlOutputter::ShowTimeStamp( bool isStartTime, const char * timestamp )
+void UnitTestSetImpl::OutputSummaryTable( void )
 {
     assert( nullptr != this );
-    assert( !IsEmptyString( timestamp ) );
+    assert( m_showFinalTable );
+    assert( m_usingReceivers );
+    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
 
-    if ( !m_isOpen )
-        return false;
-    const char * description =
-        ( isStartTime ) ? s_beginTimeMessage : s_endTimeStampMessage;
-    if ( isStartTime )
-        m_outFile << "<br>" << endl;
-    m_outFile << description << timestamp << "<br>" << endl << flush;
+    const bool hasAnyTests = ( 0 < m_tests.size() );
+    bool keep = false;
+    UnitTestResultReceiver * receiver = nullptr;
+    TUnitTestReceiverSetIter recvEnd( m_receivers.end() );
+    TUnitTestReceiverSetIter recvIt;
+    for ( recvIt = m_receivers.begin(); recvIt != recvEnd; ++recvIt )
+    {
+        receiver = *recvIt;
+        if ( receiver == nullptr )
+            continue;
+        try
+        {
+            keep = receiver->StartSummaryTable();
+        }
+        catch ( ... )
+        {
+            keep = false;
+        }
+        if ( !keep )
+            *recvIt = nullptr;
+    }
 
-    return true;
-}
+    if ( hasAnyTests )
+    {
+        MakeTableRows();
+    }
 
-// ----------------------------------------------------------------------------
+    // Take cost of checking invariants, so next summary starts over.
+    ItemCount invariantChecks = 0;
+    double invariantSeconds = 0.0;
+    AddUpInvariantCost( invariantChecks, invariantSeconds, true );
 
-bool HtmlOutputter::StartSummaryTable( void )
-{
-    assert( nullptr != this );
-    if ( !m_isOpen )
-        return false;
-    m_outFile << endl << "<br><table border=1 cellspacing=0 cellpadding=3>" << endl;
-    m_outFile << "<caption><em>Unit Test Results</em></caption>" << endl;
-    m_outFile << "<tr><th>Result</th><th>#</th><th>Unit Test Name</th>"
-              << "<th>Passed</th><th>Warnings</th><th>Failed</th>"
-              << "<th>Exceptions</th><th>Tested</th></tr>" << endl;
-    return true;
+    for ( recvIt = m_receivers.begin(); recvIt != recvEnd; ++recvIt )
+    {
+        receiver = *recvIt;
+        if ( receiver == nullptr )
+            continue;
+        try
+        {
+            keep  = receiver->ShowLongTotalLine( m_itemPassCount,
+                m_itemWarnCount, m_itemFailCount, m_itemExceptCount,
+                m_itemSkipCount, m_itemCount );
+            keep &= receiver->ShowSummaryLineWithSkips( m_testPassCount,
+                m_testWarnCount, m_testFailCount, m_testExceptCount,
+                m_testSkipCount, m_testCount );
+            keep &= ShowFixtureLines( receiver );
+            keep &= ShowInvariantLine( receiver, invariantChecks,
+                invariantSeconds );
+            keep &= receiver->EndSummaryTable();
+        }
+        catch ( ... )
+        {
+            keep = false;
+        }
+        if ( !keep )
+            *recvIt = nullptr;
+    }
 }
 
 // ----------------------------------------------------------------------------
 
-bool HtmlOutputter::ShowTableLine( const ut::UnitTest * test )
+void UnitTestSetImpl::OutputSummaryInfo( void )
 {
     assert( nullptr != this );
+    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
 
-    if ( !m_isOpen )
-        return false;
+    if ( !m_didAnyTest )
+    {
+        StartOutput();
+    }
 
-    const unsigned int index = test->GetIndex();
-    const unsigned int failCount = test->GetFailCount();
-    const unsigned int warnCount = test->GetWarnCount();
-    const unsigned int passCount = test->GetPassCount();
-    const unsigned int itemCount = test->GetItemCount();
-    const unsigned int exceptCount = test->GetExceptionCount();
-    HtmlResultColors colors( itemCount, passCount, warnCount,
-        failCount, exceptCount);
+    // A soak run may make summaries along the way, so those keep every
+    // UnitTest and fixture.  The summary at exit still covers the whole run.
+    const bool keepTests = ( 0.0 < m_soakInterval );
+    if ( !keepTests )
+        TearDownFixtures();
+    DEBUG_CODE( CheckAllInvariants() );
+    SwitchToTest( nullptr );
+    assert( !m_usingReceivers );
+    m_usingReceivers = true;
+    if ( m_showTimeStamp )
+    {
+        ShowTimeStamp();
+    }
+    if ( m_showFinalTable )
+    {
+        OutputSummaryTable();
+    }
+    m_textOutput.Flush();
 
-    m_outFile
-        << "<tr><td><span style=\"color: " << colors.testColor << "\">" << colors.testResult << "</span></td>"
-        << "<td>" << index << "</td>"
-        << "<td>" << test->GetName() << "</td>"
-        << "<th><span style=\"color: " << colors.passColor << "\">" << passCount   << "</span></th>"
-        << "<th><span style=\"color: " << colors.warnColor << "\">" << warnCount   << "</span></th>"
-        << "<th><span style=\"color: " << colors.failColor << "\">" << failCount   << "</span></th>"
-        << "<th><span style=\"color: " << colors.tossColor << "\">" << exceptCount << "</span></th>"
-        << "<th>" << itemCount << "</th></tr>" << endl;
-    return true;
+    if ( keepTests )
+        ClearTableCounts();
+    else
+        Clear();
+    assert( m_usingReceivers );
+    m_usingReceivers = false;
+    m_didFirstRun = true;
 }
 
 // ----------------------------------------------------------------------------
 
-bool HtmlOutputter::ShowTotalLine( unsigned int passCount,
-    unsigned int warnCount, unsigned int failCount, unsigned int exceptCount,
-    unsigned int itemCount )
+void UnitTestSetImpl::CheckAllInvariants( void ) const
 {
     assert( nullptr != this );
 
-    if ( !m_isOpen )
-        return false;
-
-    HtmlResultColors colors( itemCount, passCount, warnCount,
-        failCount, exceptCount );
-    m_outFile
-        << "<tr><th><span style=\"color: " << colors.testColor << "\">"
-        << colors.testResult << "</span></th><th>-</th><th>Item Totals</th>"
-        << "<th><span style=\"color: " << colors.passColor << "\">" << passCount   << "</span></th>"
-        << "<th><span style=\"color: " << colors.warnColor << "\">" << warnCount   << "</span></th>"
-        << "<th><span style=\"color: " << colors.failColor << "\">" << failCount   << "</span></th>"
-        << "<th><span style=\"color: " << colors.tossColor << "\">" << exceptCount << "</span></th>"
-        << "<th>" << itemCount << "</th></tr>" << endl;
-    return true;
+    s_forceInvariants = true;
+    CheckInvariants();
+    TUnitTestChildrenCIter last( m_tests.end() );
+    for ( TUnitTestChildrenCIter it( m_tests.begin() ); it != last; ++it )
+        ( *it )->CheckInvariants();
+    s_forceInvariants = false;
 }
 
 // ----------------------------------------------------------------------------
 
-bool HtmlOutputter::ShowSummaryLine( unsigned int passCount,
-    unsigned int warnCount, unsigned int failCount, unsigned int exceptCount,
-    unsigned int testCount )
+bool UnitTestSetImpl::ShowInvariantLine( UnitTestResultReceiver * receiver,
+    ItemCount checks, double seconds ) const
 {
     assert( nullptr != this );
-
-    if ( !m_isOpen )
-        return false;
-
-    HtmlResultColors colors( testCount, passCount, warnCount,
-        failCount, exceptCount );
-    m_outFile
-        << "<tr><th><span style=\"color: " << colors.testColor << "\">" << colors.testResult 
-        << "</span></th><th>-</th><th>Unit Test Results</th>"
-        << "<th><span style=\"color: " << colors.passColor << "\">" << passCount   << "</span></th>"
-        << "<th><span style=\"color: " << colors.warnColor << "\">" << warnCount   << "</span></th>"
-        << "<th><span style=\"color: " << colors.failColor << "\">" << failCount   << "</span></th>"
-        << "<th><span style=\"color: " << colors.tossColor << "\">" << exceptCount << "</span></th>"
-        << "<th>" << testCount << "</th></tr>" << endl << "</table><br>" << endl;
-
-    return true;
+    assert( nullptr != receiver );
+
+    if ( 0 == checks )
+        return true;
+    unsigned int period = 0;
+    if ( UnitTestSet::CheckAlways == s_invariantPolicy )
+        period = 1;
+    else if ( UnitTestSet::CheckEveryNth == s_invariantPolicy )
+        period = s_invariantPeriod;
+    return receiver->ShowInvariantLine( checks, seconds, period );
 }
 
 // ----------------------------------------------------------------------------
 
-bool HtmlOutputter::EndSummaryTable( void )
+void UnitTestSetImpl::CheckInvariants( void ) const
 {
     assert( nullptr != this );
+    if ( !IsInvariantCheckDue() )
+        return;
+    InvariantTimer timer;
+    (void)timer;
+    assert( m_testName.size() != 0 );
+    ItemCount total = m_itemPassCount + m_itemWarnCount
+        + m_itemFailCount + m_itemExceptCount + m_itemSkipCount;
+    (void)total;
+    assert( m_itemCount == total );
+    assert( m_testWarnCount <= m_testCount );
+    assert( m_testExceptCount <= m_testFailCount );
+    total = m_testPassCount + m_testFailCount + m_testSkipCount;
+    (void)total;
+    assert( total == m_testCount );
 
-    if ( !m_isOpen )
-        return false;
-
-    string contents;
-    const bool read_file = ReadFileIntoString( m_mainPageName.c_str(),
-        contents );
-    MainPageMaker mainPage( m_info, m_startTime,
-        m_mainPageName.c_str(), m_htmlFileName.c_str() );
-    const bool okay = read_file ?
-        mainPage.AddToContent( contents ) : mainPage.CreateFile();
-    assert( okay );
-    (void)okay;
-
-    MakeColorTable( m_outFile );
-    m_outFile << "</body>" << endl << "</html>" << endl;
-    Close();
-
-    return true;
+    unsigned int index = 1;
+    TUnitTestChildrenCIter last( m_tests.end() );
+    for ( TUnitTestChildrenCIter it( m_tests.begin() ); it != last; ++it )
+    {
+        const UnitTest * pTest = *it;
+        (void)pTest;
+        assert( nullptr != pTest );
+        assert( pTest->GetIndex() == index );
+        ++index;
+    }
 }
 
 // ----------------------------------------------------------------------------
 
-XmlOutputter::XmlOutputter( ::ut::UnitTestSet::OutputOptions options ) :
-    FileOutputter(),
-    UnitTestResultReceiver(),
-    m_showIndexes( 0 != ( options & ut::UnitTestSet::AddTestIndex ) ),
-    m_filename()
+UnitTestSet::ErrorState UnitTestSet::Create( const char * testName,
+    const char * textFileName, const char * htmlFileName,
+    const char * xmlFileName, UnitTestSet::OutputOptions info,
+    bool deleteAtExitTime )
 {
-    assert( nullptr != this );
+    if ( s_instance != nullptr )
+    {
+        return UnitTestSet::AlreadyExists;
+    }
+
+    if ( IsEmptyString( testName ) )
+    {
+        testName = "Unit Tests";
+    }
+    s_instance = new UnitTestSet( testName, textFileName, htmlFileName,
+        xmlFileName, info );
+    if ( s_instance == nullptr )
+    {
+        return UnitTestSet::CantCreate;
+    }
+    if ( deleteAtExitTime )
+    {
+        ::atexit( Destroy );
+    }
+
+    return UnitTestSet::Success;
 }
 
 // ----------------------------------------------------------------------------
 
-XmlOutputter::~XmlOutputter( void )
+void UnitTestSet::Destroy( void )
 {
-    assert( nullptr != this );
+    if ( s_instance != nullptr )
+    {
+        assert( s_instance->m_impl != nullptr );
+        // A child process which called exit must not make output or close
+        // the files its parent still uses.
+        if ( s_instance->m_impl->IsIsolatedChild()
+          || s_instance->m_impl->IsDeathChild() )
+            return;
+        s_instance->OutputSummary();
+        delete s_instance;
+        s_instance = nullptr;
+    }
 }
 
 // ----------------------------------------------------------------------------
 
-bool XmlOutputter::Start( const char * name )
+UnitTestSet::UnitTestSet( const char * testName, const char * textFileName,
+    const char * htmlFileName, const char * xmlFileName,
+    UnitTestSet::OutputOptions info ) :
+    m_impl( nullptr )
 {
     assert( nullptr != this );
-    assert( !IsEmptyString( name ) );
-    assert( !m_isOpen );
-
-    Open( m_filename.c_str() );
-    if ( !m_isOpen )
-        return false;
-    m_outFile
-        << "<UnitTestResults" << endl
-        << "\tname=\"" << name << "\">" << endl
-        << "\t<Tests>" << endl << flush;
-
-    return true;
+    m_impl = new UnitTestSetImpl( testName, textFileName, htmlFileName,
+        xmlFileName, info );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
 }
 
 // ----------------------------------------------------------------------------
 
-bool XmlOutputter::ShowMessage( const ut::UnitTest * test,
-    const char * fileName, unsigned int line, const char * message )
+UnitTestSet::~UnitTestSet( void )
 {
     assert( nullptr != this );
-    assert( test != nullptr );
-    assert( !IsEmptyString( fileName ) );
-    assert( !IsEmptyString( message ) );
-    if ( !m_isOpen )
-        return false;
-
-    m_outFile
-        << "\t\t<Message" << endl
-        << "\t\t\tfile=\"" << fileName << '\"' << endl
-        << "\t\t\tline=\"" << line << '\"' << endl
-        << "\t\t\tunit=\"" << test->GetIndex() << "\">" << endl
-        << "\t\t\t<message>\"" << message << "\"</message>" << endl
-        << "\t\t</Message>" << endl << flush;
-
-    return true;
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    delete m_impl;
 }
 
 // ----------------------------------------------------------------------------
 
-bool XmlOutputter::ShowTestHeader( const ut::UnitTest * test )
+bool UnitTestSet::AddReceiver( UnitTestResultReceiver * receiver )
 {
     assert( nullptr != this );
-    assert( test != nullptr );
-    if ( !m_isOpen )
+    assert( nullptr != m_impl );
+    DEBUG_CODE( UnitTestSetChecker guard( m_impl ); (void)guard; );
+
+    if ( nullptr == receiver )
+        return false;
+    if ( m_impl->m_usingReceivers )
         return false;
 
-    m_outFile
-        << "\t\t<Unit" << endl
-        << "\t\t\tname=\"" << test->GetName() << '\"' << endl
-        << "\t\t\tunit=\"" << test->GetIndex() << "\">" << endl
-        << "\t\t</Unit>" << endl << flush;
+    assert( !m_impl->m_usingReceivers );
+    m_impl->m_usingReceivers = true;
+    bool hasReceiver = false;
+    bool hasHole = false;
+    TUnitTestReceiverSetIter hole;
+    TUnitTestReceiverSetIter end( m_impl->m_receivers.end() );
+    for ( TUnitTestReceiverSetIter it( m_impl->m_receivers.begin() );
+        it != end; ++it )
+    {
+        UnitTestResultReceiver * recv = *it;
+        if ( recv == receiver )
+        {
+            hasReceiver = true;
+            break;
+        }
+        if ( recv == nullptr )
+            hole = it;
+    }
+
+    if ( !hasReceiver )
+    {
+        if ( hasHole )
+            *hole = receiver;
+        else
+            m_impl->m_receivers.push_back( receiver );
+    }
+    assert( m_impl->m_usingReceivers );
+    m_impl->m_usingReceivers = false;
 
     return true;
 }
 
 // ----------------------------------------------------------------------------
 
-bool XmlOutputter::ShowTestLine( const ut::UnitTest * test,
-    ut::TestResult::EnumType result, const char * fileName,
-    unsigned int line, const char * expression, const char * message )
+bool UnitTestSet::RemoveReceiver( UnitTestResultReceiver * receiver )
 {
     assert( nullptr != this );
-    assert( test != nullptr );
-    assert( !IsEmptyString( fileName ) );
-    assert( !IsEmptyString( expression ) );
-    if ( !m_isOpen )
+    assert( nullptr != m_impl );
+    DEBUG_CODE( UnitTestSetChecker guard( m_impl ); (void)guard; );
+
+    if ( nullptr == receiver )
+        return false;
+    if ( m_impl->m_usingReceivers )
         return false;
 
-    const char * resultName = ut::TestResult::GetName( result );
-    m_outFile
-        << "\t\t<Test" << endl
-        << "\t\t\tfile=\"" << fileName << '\"' << endl
-        << "\t\t\tline=\"" << line << '\"' << endl
-        << "\t\t\tresult=\"" << resultName << '\"' << endl
-        << "\t\t\tunit=\"" << test->GetIndex() << '\"' << endl
-        << "\t\t\tindex=\"" << test->GetItemCount() << "\">" << endl
-        << "\t\t\t<expression>\"" << expression << "\"</expression>" << endl;
-    if ( !IsEmptyString( message ) )
-        m_outFile << "\t\t\t<message>\"" << message << "\"</message>" << endl;
-    if ( ut::TestResult::Fatal == result )
+    bool found = false;
+    assert( !m_impl->m_usingReceivers );
+    m_impl->m_usingReceivers = true;
+    TUnitTestReceiverSetIter end( m_impl->m_receivers.end() );
+    for ( TUnitTestReceiverSetIter it( m_impl->m_receivers.begin() );
+        it != end; ++it )
     {
-        m_outFile
-            << "\t\t\t<fatal>\"A required test failed!  "
-            << "Unable to safely execute further tests!  "
-            << "Program must exit now!\"</fatal>" << endl;
+        UnitTestResultReceiver * recv = *it;
+        if ( recv != receiver )
+            continue;
+        *it = nullptr;
+        found = true;
+        break;
     }
-     m_outFile << "\t\t</Test>" << endl << flush;
+    assert( m_impl->m_usingReceivers );
+    m_impl->m_usingReceivers = false;
 
-    return true;
+    return found;
 }
 
 // ----------------------------------------------------------------------------
 
-bool XmlOutputter::ShowTimeStamp( bool isStartTime, const char * timestamp )
+bool UnitTestSet::DoesSendToTextFile( void ) const
 {
     assert( nullptr != this );
-    assert( !IsEmptyString( timestamp ) );
-    if ( !m_isOpen )
-        return false;
-
-    const char * name = ( isStartTime ) ? "\t\tstart=\"" : "\t\tstop=\"";
-    if ( isStartTime )
-        m_outFile << "\t</Tests>" << endl << "\t<TimeStamps" << endl;
-    m_outFile << name << timestamp << '\"';
-    if ( !isStartTime )
-        m_outFile << '>' << endl << "\t</TimeStamps>";
-    m_outFile << endl << flush;
-
-    return true;
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    return m_impl->m_textOutput.IsOpen();
 }
 
 // ----------------------------------------------------------------------------
 
-bool XmlOutputter::StartSummaryTable( void )
+bool UnitTestSet::DoesSendToHtmlFile( void ) const
 {
     assert( nullptr != this );
-    return m_isOpen;
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    return m_impl->m_htmlOutput.IsOpen();
 }
 
 // ----------------------------------------------------------------------------
 
-bool XmlOutputter::ShowTableLine( const ut::UnitTest * test )
+bool UnitTestSet::DoesSendToXmlFile( void ) const
 {
     assert( nullptr != this );
-    assert( test != nullptr );
-    if ( !m_isOpen )
-        return false;
-
-    const bool passed = test->DidPass();
-    const char * result = ( passed ) ? "Passed" : "FAILED";
-    if ( test->GetIndex() == 1 )
-        m_outFile << "\t<SummaryTable>" << endl;
-    m_outFile
-        << "\t\t<UnitTest" << endl
-        << "\t\t\tname=\"" << test->GetName() << '\"' << endl
-        << "\t\t\tindex=\"" << test->GetIndex() << '\"' << endl
-        << "\t\t\tresult=\"" << result << '\"' << endl
-        << "\t\t\tpassed=\"" << test->GetPassCount() << '\"' << endl
-        << "\t\t\twarnings=\"" << test->GetWarnCount() << '\"' << endl
-        << "\t\t\tfailed=\"" << test->GetFailCount() << '\"' << endl
-        << "\t\t\texceptions=\"" << test->GetExceptionCount() << '\"' << endl
-        << "\t\t\ttested=\"" << test->GetItemCount() << "\">" << endl
-        << "\t\t</UnitTest>" << endl << flush;
-
-    return true;
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    return m_impl->m_xmlOutput.IsOpen();
 }
 
 // ----------------------------------------------------------------------------
 
-bool XmlOutputter::ShowTotalLine( unsigned int passCount, unsigned int warnCount,
-    unsigned int failCount, unsigned int exceptCount,
-    unsigned int itemCount )
+bool UnitTestSet::DoesSendToJsonFile( void ) const
 {
     assert( nullptr != this );
-    if ( !m_isOpen )
-        return false;
-
-    const bool passed = ( failCount == 0 ) && ( exceptCount == 0 );
-    const char * result = ( passed ) ? "Passed" : "FAILED";
-    m_outFile
-        << "\t\t<ItemTotals" << endl
-        << "\t\t\tresult=\"" << result << '\"' << endl
-        << "\t\t\tpassed=\"" << passCount << '\"' << endl
-        << "\t\t\twarnings=\"" << warnCount << '\"' << endl
-        << "\t\t\tfailed=\"" << failCount << '\"' << endl
-        << "\t\t\texceptions=\"" << exceptCount << '\"' << endl
-        << "\t\t\ttested=\"" << itemCount << "\">" << endl
-        << "\t\t</ItemTotals>" << endl << flush;
-
-    return true;
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    return m_impl->m_jsonOutput.IsOpen();
 }
 
 // ----------------------------------------------------------------------------
 
-bool XmlOutputter::ShowSummaryLine( unsigned int passCount,
-    unsigned int warnCount, unsigned int failCount,
-    unsigned int exceptCount, unsigned int testCount )
+bool UnitTestSet::SetJsonFileName( const char * jsonFileName )
 {
     assert( nullptr != this );
-    if ( !m_isOpen )
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+
+    if ( m_impl->m_usingReceivers || m_impl->m_didPageHeader
+      || m_impl->m_didFirstRun )
         return false;
+    if ( IsEmptyString( jsonFileName ) )
+        m_impl->m_jsonFilePartialName.clear();
+    else
+        m_impl->m_jsonFilePartialName = jsonFileName;
+    return true;
+}
 
-    const bool passed = ( failCount == 0 ) && ( exceptCount == 0 );
-    const char * result = ( passed ) ? "Passed" : "FAILED";
-    m_outFile
-        << "\t\t<TestTotals" << endl
-        << "\t\t\tresult=\"" << result << '\"' << endl
-        << "\t\t\tpassed=\"" << passCount << '\"' << endl
-        << "\t\t\twarnings=\"" << warnCount << '\"' << endl
-        << "\t\t\tfailed=\"" << failCount << '\"' << endl
-        << "\t\t\texceptions=\"" << exceptCount << '\"' << endl
-        << "\t\t\ttested=\"" << testCount << "\">" << endl
-        << "\t\t</TestTotals>" << endl << flush;
-    m_outFile << "\t</SummaryTable>" << endl << flush;
+// ----------------------------------------------------------------------------
 
-    return true;
+bool UnitTestSet::DoesSendToJUnitFile( void ) const
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    return m_impl->m_junitOutput.IsOpen();
 }
 
 // ----------------------------------------------------------------------------
 
-bool XmlOutputter::EndSummaryTable( void )
+bool UnitTestSet::SetJUnitFileName( const char * junitFileName )
 {
     assert( nullptr != this );
-    m_outFile << "</UnitTestResults>" << endl << flush;
-    Close();
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+
+    if ( m_impl->m_usingReceivers || m_impl->m_didPageHeader
+      || m_impl->m_didFirstRun )
+        return false;
+    if ( IsEmptyString( junitFileName ) )
+        m_impl->m_junitFilePartialName.clear();
+    else
+        m_impl->m_junitFilePartialName = junitFileName;
     return true;
 }
 
 // ----------------------------------------------------------------------------
 
-}; // end anonymous namespace
-
-namespace ut
+bool UnitTestSet::DoesSendToCout( void ) const
 {
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    return m_impl->m_textOutput.DoesSendToCout();
+}
 
 // ----------------------------------------------------------------------------
 
-UnitTest::UnitTest( const char * name ) :
-    m_madeHeader( false ),
-    m_name(),
-    m_index( 0 ),
-    m_itemCount( 0 ),
-    m_failCount( 0 ),
-    m_warnCount( 0 ),
-    m_passCount( 0 ),
-    m_exceptions( 0 )
+bool UnitTestSet::DoesSendToCerr( void ) const
 {
     assert( nullptr != this );
-    ::strncpy( m_name, name, MaxNameSize );
-    m_name[ MaxNameSize ] = '\0';
-    DEBUG_CODE( CheckInvariants() );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    return m_impl->m_textOutput.DoesSendToCerr();
 }
 
 // ----------------------------------------------------------------------------
 
-UnitTest::~UnitTest( void )
+const char * UnitTestSet::GetTextFileName( void ) const
 {
     assert( nullptr != this );
-    DEBUG_CODE( CheckInvariants() );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    return m_impl->m_textOutput.GetFileName();
 }
 
 // ----------------------------------------------------------------------------
 
-bool UnitTest::DoTest( const char * filename, unsigned int line,
-    TestLevel level, bool pass, const char * expression, const char * message )
+const char * UnitTestSet::GetHtmlFileName( void ) const
 {
     assert( nullptr != this );
-    DEBUG_CODE( CheckInvariants() );
-    DEBUG_CODE( UnitTestChecker guard( this ); (void)guard; );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    return m_impl->m_htmlOutput.GetCurrentPageName();
+}
 
-    UnitTestSet & uts = UnitTestSet::GetIt();
-    if ( uts.m_impl->IsUsingReceivers() )
-        return pass;
-    if ( IsEmptyString( filename ) || IsEmptyString( expression ) )
-        return pass;
+// ----------------------------------------------------------------------------
 
-    const TestResult::EnumType result = Convert( level, pass );
-    if ( 0 == m_itemCount )
-        uts.m_impl->StartOutput();
-    ++m_itemCount;
-    bool showItem = true;
-    switch ( result )
-    {
-        default:                  // fall into next case.
-        case TestResult::Failed:  // fall into next case.
-        case TestResult::Fatal:
-            ++m_failCount;
-            break;
-        case TestResult::Thrown:
-            assert(false);  // Why was result set to Thrown?
-            break;
-        case TestResult::Passed:
-            ++m_passCount;
-            showItem = uts.m_impl->ShowPasses();
-            break;
-        case TestResult::Warning:
-            ++m_warnCount;
-            showItem = uts.m_impl->ShowWarnings();
-            break;
-    }
+const char * UnitTestSet::GetMainHtmlFileName( void ) const
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    return m_impl->m_htmlOutput.GetMainPageName();
+}
 
-    if ( showItem )
-    {
-        if ( !m_madeHeader )
-        {
-            uts.m_impl->OutputTestHeader( this );
-            m_madeHeader = true;
-        }
-        uts.m_impl->OutputTestLine(
-            this, result, filename, line, expression, message );
-        if ( result == TestResult::Fatal )
-        {
-            uts.OutputSummary();
-            ::exit( 1 );
-        }
-    }
+// ----------------------------------------------------------------------------
 
-    return pass;
+const char * UnitTestSet::GetXmlFileName( void ) const
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    return m_impl->m_xmlOutput.GetFileName();
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTest::OnException( const char * filename, unsigned int line,
-    TestLevel level, const char * expression, const char * message )
+const char * UnitTestSet::GetJsonFileName( void ) const
 {
     assert( nullptr != this );
-    DEBUG_CODE( CheckInvariants() );
-    DEBUG_CODE( UnitTestChecker guard( this ); (void)guard; );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    return m_impl->m_jsonOutput.GetFileName();
+}
 
-    UnitTestSet & uts = UnitTestSet::GetIt();
-    if ( uts.m_impl->IsUsingReceivers() )
-        return;
-    if ( IsEmptyString( filename ) || IsEmptyString( expression ) )
-        return;
+// ----------------------------------------------------------------------------
 
-    const TestResult::EnumType result = ( UnitTest::Require == level )
-        ? TestResult::Fatal : TestResult::Thrown;
-    if ( 0 == m_itemCount )
-        uts.m_impl->StartOutput();
-    ++m_itemCount;
-    ++m_exceptions;
-    if ( !m_madeHeader )
-    {
-        uts.m_impl->OutputTestHeader( this );
-        m_madeHeader = true;
-    }
-    uts.m_impl->OutputTestLine(
-        this, result, filename, line, expression, message );
-    if ( result == TestResult::Fatal )
-    {
-        ::exit( 1 );
-    }
+const char * UnitTestSet::GetJUnitFileName( void ) const
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    return m_impl->m_junitOutput.GetFileName();
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTest::OutputMessage( const char * filename, unsigned int line,
-    const char * message )
+void UnitTestSet::OutputSummary( void )
 {
     assert( nullptr != this );
-    DEBUG_CODE( CheckInvariants() );
-    DEBUG_CODE( UnitTestChecker guard( this ); (void)guard; );
-
-    UnitTestSet & uts = UnitTestSet::GetIt();
-    if ( uts.m_impl->IsUsingReceivers() )
-        return;
-    if ( IsEmptyString( filename ) || IsEmptyString( message ) )
+    assert( nullptr != m_impl );
+    if ( m_impl->IsIsolatedChild() || m_impl->IsDeathChild() )
         return;
-    uts.m_impl->OutputMessage( this, filename, line, message );
+    const bool hasAnyTests = ( 0 < m_impl->m_tests.size() );
+    if ( hasAnyTests || ( !m_impl->m_didFirstRun ) )
+    {
+        m_impl->OutputSummaryInfo();
+    }
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTest::CheckInvariants( void ) const
+void UnitTestSet::SetTextFlushPolicy( UnitTestSet::FlushPolicy policy,
+    unsigned int milliseconds )
 {
     assert( nullptr != this );
-    assert( !IsEmptyString( GetName() ) );
-    assert( ::strlen( GetName() ) <= ut::UnitTest::MaxNameSize );
-    const unsigned int total =
-        m_failCount + m_passCount + m_warnCount + m_exceptions;
-    assert( m_itemCount == total );
-    (void)total;
-    if ( ( 0 < m_failCount ) || ( 0 < m_exceptions ) )
-    {
-        assert( m_madeHeader );
-    }
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    if ( m_impl->m_usingReceivers )
+        return;
+    m_impl->m_textOutput.SetFlushPolicy( policy, milliseconds );
 }
 
 // ----------------------------------------------------------------------------
 
-UnitTestSetImpl::UnitTestSetImpl( const char * testName,
-    const char * textFilePartialName, const char * htmlFilePartialName,
-    const char * xmlFilePartialName, UnitTestSet::OutputOptions info ) :
-    m_testName( testName ),
-    m_textFilePartialName(),
-    m_htmlFilePartialName(),
-    m_xmlFilePartialName(),
-    m_tests(),
-    m_textOutput( info ),
-    m_htmlOutput( this, info ),
-    m_xmlOutput( info ),
-    m_receivers(),
-    m_showMessages( 0 != ( info & UnitTestSet::Messages ) ),
-    m_showPasses( 0 != ( info & UnitTestSet::Passes ) ),
-    m_showWarnings( 0 != ( info & UnitTestSet::Warnings ) ),
-    m_showHeaders( 0 != ( info & UnitTestSet::Headers ) ),
-    m_showTimeStamp( 0 != ( info & UnitTestSet::TimeStamp ) ),
-    m_useFullDayName( 0 != ( info & UnitTestSet::FullDayName ) ),
-    m_showFinalTable( 0 != ( info & UnitTestSet::SummaryTable ) ),
-    m_didPageHeader( false ),
-    m_usingReceivers( false ),
-    m_didAnyTest( false ),
-    m_didFirstRun( false ),
-    m_startTime(),
-    m_testCount( 0 ),
-    m_testPassCount( 0 ),
-    m_testWarnCount( 0 ),
-    m_testFailCount( 0 ),
-    m_testExceptCount( 0 ),
-    m_itemCount( 0 ),
-    m_itemPassCount( 0 ),
-    m_itemWarnCount( 0 ),
-    m_itemFailCount( 0 ),
-    m_itemExceptCount( 0 )
+bool UnitTestSet::DoesOutputOption( UnitTestSet::OutputOptions options ) const
 {
     assert( nullptr != this );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
 
-    if ( !IsEmptyString( xmlFilePartialName ) )
-        m_xmlFilePartialName = xmlFilePartialName;
-    if ( !IsEmptyString( textFilePartialName ) )
-        m_textFilePartialName = textFilePartialName;
-    if ( !IsEmptyString( htmlFilePartialName ) )
+    if ( ( 0 != ( options & UnitTestSet::Passes ) )
+      && ( !m_impl->m_showPasses ) )
     {
-        m_htmlFilePartialName = htmlFilePartialName;
+        return false;
     }
-    if ( !IsEmptyString( xmlFilePartialName ) )
+    if ( ( 0 != ( options & UnitTestSet::Warnings ) )
+      && ( !m_impl->m_showWarnings ) )
     {
-        m_xmlFilePartialName = xmlFilePartialName;
+        return false;
+    }
+    if ( ( 0 != ( options & UnitTestSet::Messages ) )
+      && ( !m_impl->m_showMessages ) )
+    {
+        return false;
+    }
+    if ( ( 0 != ( options & UnitTestSet::Headers ) )
+      && ( !m_impl->m_showHeaders ) )
+    {
+        return false;
+    }
+    if ( ( 0 != ( options & UnitTestSet::TimeStamp ) )
+      && ( !m_impl->m_showTimeStamp ) )
+    {
+        return false;
+    }
+    if ( ( 0 != ( options & UnitTestSet::FullDayName ) )
+      && ( !m_impl->m_useFullDayName ) )
+    {
+        return false;
+    }
+    if ( ( 0 != ( options & UnitTestSet::Dividers ) )
+      && ( !m_impl->m_textOutput.ShowDividers() ) )
+    {
+        return false;
+    }
+    if ( ( 0 != ( options & UnitTestSet::AddTestIndex ) )
+        && ( !m_impl->m_textOutput.DoesShowIndexes() ) )
+    {
+        return false;
+    }
+    if ( ( 0 != ( options & UnitTestSet::FatalEndsTest ) )
+      && ( !m_impl->m_fatalEndsTest ) )
+    {
+        return false;
+    }
+    if ( ( 0 != ( options & UnitTestSet::Times ) )
+      && ( !m_impl->m_textOutput.DoesShowTimes() ) )
+    {
+        return false;
+    }
+    if ( ( 0 != ( options & UnitTestSet::Counters ) )
+      && ( !m_impl->m_perfCounters.IsOpen() ) )
+    {
+        return false;
     }
-
-    if ( !m_useFullDayName )
+    if ( ( 0 != ( options & UnitTestSet::Memory ) )
+      && ( !m_impl->m_showMemory ) )
     {
-        s_testTimeStampFormatSpec = "%a, %Y - %B - %d, %H : %M : %S";
-        s_timeStampFormatSpec     = "%a, %Y %b %d at %H:%M:%S in %z";
+        return false;
     }
 
-    DEBUG_CODE( CheckInvariants() );
+    return true;
 }
 
 // ----------------------------------------------------------------------------
 
-UnitTestSetImpl::~UnitTestSetImpl( void )
+unsigned int UnitTestSet::GetUnitTestCount( void ) const
 {
     assert( nullptr != this );
-    DEBUG_CODE( CheckInvariants() );
-    Clear();
-
-    assert( !m_usingReceivers );
-    m_usingReceivers = true;
-    TUnitTestReceiverSetIter end( m_receivers.end() );
-    for ( TUnitTestReceiverSetIter it( m_receivers.begin() ); it != end; ++it )
-    {
-        UnitTestResultReceiver * receiver = *it;
-        if ( receiver == nullptr )
-            continue;
-        try
-        {
-            receiver->FinalEnd();
-            *it = nullptr;
-        }
-        catch ( ... ) { }
-    }
-    assert( m_usingReceivers );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    return static_cast< unsigned int >( m_impl->m_tests.size() );
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTestSetImpl::Clear( void )
+UnitTest * UnitTestSet::AddUnitTest( const char * unitTestName )
 {
     assert( nullptr != this );
-    DEBUG_CODE( CheckInvariants() );
-    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( UnitTestSetChecker guard( m_impl ); (void)guard; );
 
-    TUnitTestChildrenIter last( m_tests.end() );
-    for ( TUnitTestChildrenIter it( m_tests.begin() ); it != last; ++it )
-    {
-        UnitTest * pTest = *it;
-        if ( nullptr != pTest )
-            delete pTest;
-    }
-    m_tests.clear();
-    m_didAnyTest = false;
-    m_didPageHeader = false;
-    m_testCount = 0;
-    m_testPassCount = 0;
-    m_testWarnCount = 0;
-    m_testFailCount = 0;
-    m_testExceptCount = 0;
-    m_itemCount = 0;
-    m_itemPassCount = 0;
-    m_itemWarnCount = 0;
-    m_itemFailCount = 0;
-    m_itemExceptCount = 0;
+    if ( IsEmptyString( unitTestName ) )
+        return nullptr;
+    return m_impl->AddUnitTest( unitTestName );
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTestSetImpl::OutputTestLine( UnitTest * test,
-    TestResult::EnumType result, const char * fileName, unsigned int line,
-    const char * expression, const char * message )
+bool UnitTestSet::RunUnitTest( const char * unitTestName,
+    UnitTestFunction body )
 {
     assert( nullptr != this );
-    DEBUG_CODE( CheckInvariants() );
-    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
 
-    bool keep = false;
-    assert( !m_usingReceivers );
-    m_usingReceivers = true;
-    TUnitTestReceiverSetIter end( m_receivers.end() );
-    for ( TUnitTestReceiverSetIter it( m_receivers.begin() ); it != end; ++it )
+    if ( ( nullptr == body ) || m_impl->m_usingReceivers )
+        return false;
+    UnitTest * test = AddUnitTest( unitTestName );
+    if ( nullptr == test )
+        return false;
+
+    if ( ( 0 < m_impl->m_workerCount ) && !m_impl->IsIsolatedChild() )
     {
-        UnitTestResultReceiver * receiver = *it;
-        if ( receiver == nullptr )
-            continue;
-        try
-        {
-            keep = receiver->ShowTestLine( test, result, fileName, line,
-                expression, message );
-        }
-        catch ( ... )
+        // WaitForWorker enforces the time limit for the one child.
+        TIsolatedWorkers workers( 1 );
+        if ( m_impl->StartWorker( test, body, workers[ 0 ] ) )
         {
-            keep = false;
+            m_impl->WaitForWorker( workers );
+            m_impl->FinishWorker( workers[ 0 ] );
+            return test->DidPass();
         }
-        if ( !keep )
-            *it = nullptr;
     }
-    assert( m_usingReceivers );
-    m_usingReceivers = false;
-}
-
-// ----------------------------------------------------------------------------
-
-void UnitTestSetImpl::OutputMessage( UnitTest * test, const char * fileName,
-    unsigned int line, const char * message )
-{
-    assert( nullptr != this );
-    DEBUG_CODE( CheckInvariants() );
-    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
 
-    if ( !m_showMessages )
+    // Tests may run other tests, so restore the outer one when done.  Time
+    // spent before the first item also belongs to this UnitTest.
+    UnitTest * outerTest = m_impl->m_runningTest;
+    m_impl->m_runningTest = test;
+    m_impl->SwitchToTest( test );
+    try
     {
-        return;
+        body( test );
     }
-    if ( !test->m_madeHeader )
+    catch ( const UnitTestAbort & )
     {
-        OutputTestHeader( test );
-        test->m_madeHeader = true;
+        assert( m_impl->m_abortingTest == test );
     }
-
-    bool keep = false;
-    assert( !m_usingReceivers );
-    m_usingReceivers = true;
-    TUnitTestReceiverSetIter end( m_receivers.end() );
-    for ( TUnitTestReceiverSetIter it( m_receivers.begin() ); it != end; ++it )
+    catch ( ... )
     {
-        UnitTestResultReceiver * receiver = *it;
-        if ( receiver == nullptr )
-            continue;
-        try
-        {
-            keep = receiver->ShowMessage( test, fileName, line, message );
-        }
-        catch ( ... )
-        {
-            keep = false;
-        }
-        if ( !keep )
-            *it = nullptr;
+        test->OnException( __FILE__, __LINE__, UnitTest::Checked,
+            unitTestName, "Exception escaped from unit test." );
     }
-    assert( m_usingReceivers );
-    m_usingReceivers = false;
+    m_impl->m_abortingTest = nullptr;
+    m_impl->m_runningTest = outerTest;
+    // Time after the body belongs to the outer UnitTest, or to none at all.
+    m_impl->SwitchToTest( outerTest );
+    {
+        MonitorLock lock( m_impl->GetRecordLock() );
+        m_impl->CheckSoakTime();
+        m_impl->FlushTextIfDue();
+    }
+
+    return test->DidPass();
 }
 
 // ----------------------------------------------------------------------------
 
-const UnitTest * UnitTestSetImpl::GetUnitTest( const char * unitTestName ) const
+bool UnitTestSet::SetIsolatedWorkers( unsigned int workerCount )
 {
     assert( nullptr != this );
-    DEBUG_CODE( CheckInvariants() );
-    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
 
-    FChildNameFinder oFinder( unitTestName );
-    TUnitTestChildrenCIter start( m_tests.begin() );
-    TUnitTestChildrenCIter last( m_tests.end() );
-    TUnitTestChildrenCIter cit( find_if( start, last, oFinder ) );
-    if ( last == cit )
-        return nullptr;
-    return *cit;
+    if ( m_impl->m_usingReceivers )
+        return false;
+#if defined( _WIN32 )
+    return ( 0 == workerCount );
+#else
+    if ( s_MaxWorkers < workerCount )
+        workerCount = s_MaxWorkers;
+    m_impl->m_workerCount = workerCount;
+    return true;
+#endif
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTestSetImpl::SetupInternalReceivers( void )
+unsigned int UnitTestSet::GetIsolatedWorkers( void ) const
 {
     assert( nullptr != this );
-    DEBUG_CODE( CheckInvariants() );
-    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
-
-    ::memset( m_timeString, 0, sizeof(m_timeString) );
-    time( &m_startTime );
-    if ( m_showTimeStamp )
-    {
-        const struct tm * timeStamp = ::localtime( &m_startTime );
-        ::strftime( m_timeString, sizeof(m_timeString)-1,
-            s_timeStampFormatSpec, timeStamp );
-    }
-
-    const bool sendToText = ( m_textFilePartialName.size() != 0 );
-    const bool sendToHtml = ( m_htmlFilePartialName.size() != 0 );
-    const bool sendToXml  = ( m_xmlFilePartialName.size()  != 0 );
-
-    if ( sendToText || sendToHtml || sendToXml )
-    {
-        string xmlFileName;
-        string textFileName;
-        string currentHtmlFileName;
-        string mainHtmlFileName;
-        MakeFileNames( &m_startTime, m_textFilePartialName.c_str(),
-            m_htmlFilePartialName.c_str(), m_xmlFilePartialName.c_str(),
-            textFileName, currentHtmlFileName, mainHtmlFileName, xmlFileName );
-
-        if ( sendToText )
-            m_textOutput.SetFileName( textFileName.c_str() );
-        if ( sendToHtml )
-        {
-            m_htmlOutput.SetMainPageName( mainHtmlFileName.c_str() );
-            m_htmlOutput.SetCurrentPageName( currentHtmlFileName.c_str() );
-            m_htmlOutput.SetTimeStampInfo( &m_startTime );
-            if ( !m_didFirstRun )
-                m_receivers.push_back( &m_htmlOutput );
-        }
-        if ( sendToXml )
-        {
-            m_xmlOutput.SetFileName( xmlFileName.c_str() );
-            if ( !m_didFirstRun )
-                m_receivers.push_back( &m_xmlOutput );
-        }
-    }
-    if ( ( m_textOutput.DoesSendToCout() || sendToText )
-      && ( !m_didFirstRun ) )
-        m_receivers.push_back( &m_textOutput );
+    assert( nullptr != m_impl );
+    return m_impl->m_workerCount;
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTestSetImpl::StartOutput( void )
+bool UnitTestSet::SetIsolatedTimeout( double seconds )
 {
     assert( nullptr != this );
-    DEBUG_CODE( CheckInvariants() );
-    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
-
-    if ( m_didPageHeader )
-        return;
-
-    assert( !m_usingReceivers );
-    m_usingReceivers = true;
-    m_didAnyTest = true;
-    SetupInternalReceivers();
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
 
-    bool keep = false;
-    TUnitTestReceiverSetIter end( m_receivers.end() );
-    for ( TUnitTestReceiverSetIter it( m_receivers.begin() ); it != end; ++it )
-    {
-        UnitTestResultReceiver * receiver = *it;
-        if ( receiver == nullptr )
-            continue;
-        try
-        {
-            keep = receiver->Start( m_testName.c_str() );
-        }
-        catch ( ... )
-        {
-            keep = false;
-        }
-        if ( !keep )
-            *it = nullptr;
-    }
-    assert( m_usingReceivers );
-    m_usingReceivers = false;
-    m_didPageHeader = true;
+    if ( ( seconds < 0.0 ) || m_impl->m_usingReceivers )
+        return false;
+    m_impl->m_workerTimeout = seconds;
+    return true;
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTestSetImpl::OutputTestHeader( const UnitTest * test )
-{
-    assert( nullptr != this );
-    DEBUG_CODE( CheckInvariants() );
-    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
-
-    if ( !m_showHeaders )
-        return;
-    m_didAnyTest = true;
-
-    bool keep = false;
-    assert( !m_usingReceivers );
-    m_usingReceivers = true;
-    TUnitTestReceiverSetIter end( m_receivers.end() );
-    for ( TUnitTestReceiverSetIter it( m_receivers.begin() ); it != end; ++it )
-    {
-        UnitTestResultReceiver * receiver = *it;
-        if ( receiver == nullptr )
-            continue;
-        try
-        {
-            keep = receiver->ShowTestHeader( test );
-        }
-        catch ( ... )
-        {
-            keep = false;
-        }
-        if ( !keep )
-            *it = nullptr;
-    }
-    assert( m_usingReceivers );
-    m_usingReceivers = false;
+double UnitTestSet::GetIsolatedTimeout( void ) const
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    return m_impl->m_workerTimeout;
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTestSetImpl::ShowTimeStamp( void )
+bool UnitTestSet::RunStressTest( const char * unitTestName,
+    StressUnitTestFunction body, void * state, unsigned int threadCount,
+    double seconds, unsigned int seed )
 {
     assert( nullptr != this );
-    assert( m_usingReceivers );
-    DEBUG_CODE( CheckInvariants() );
-    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
 
-    time_t timeNow;
-    time( &timeNow );
-    const tm * endTime = ::localtime( &timeNow );
-    char buffer[ 160 ];
-    ::strftime( buffer, sizeof(buffer)-1, s_timeStampFormatSpec, endTime );
+    if ( ( nullptr == body ) || m_impl->m_usingReceivers )
+        return false;
+    if ( ( 0 == threadCount ) || ( s_MaxStressThreads < threadCount ) )
+        return false;
+    UnitTest * test = AddUnitTest( unitTestName );
+    if ( nullptr == test )
+        return false;
+    if ( 0 == seed )
+        seed = PickSeed();
 
-    bool keep = false;
-    TUnitTestReceiverSetIter end( m_receivers.end() );
-    for ( TUnitTestReceiverSetIter it( m_receivers.begin() ); it != end; ++it )
-    {
-        UnitTestResultReceiver * receiver = *it;
-        if ( receiver == nullptr )
-            continue;
-        try
-        {
-            keep  = receiver->ShowTimeStamp( true, m_timeString );
-            keep &= receiver->ShowTimeStamp( false, buffer );
-        }
-        catch ( ... )
-        {
-            keep = false;
-        }
-        if ( !keep )
-            *it = nullptr;
-    }
+    StressRun run( test, body, state, threadCount, seconds );
+    if ( !m_impl->RunStressTest( run, threadCount, seed ) )
+        return false;
+    return test->DidPass();
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTestSetImpl::MakeTableRows( void )
+void UnitTestSet::SetStressInjection( unsigned int jitterMicroseconds,
+    unsigned int yieldPercent )
 {
     assert( nullptr != this );
-    assert( m_showFinalTable );
-    assert( m_usingReceivers );
+    assert( nullptr != m_impl );
+    m_impl->m_stressJitter = jitterMicroseconds;
+    m_impl->m_stressYield = ( 100 < yieldPercent ) ? 100 : yieldPercent;
+}
 
-    bool keep = false;
-    const char * pResult = nullptr;
-    UnitTestResultReceiver * receiver = nullptr;
-    TUnitTestReceiverSetIter recvEnd( m_receivers.end() );
-    TUnitTestReceiverSetIter recvIt;
-    TUnitTestChildrenCIter last( m_tests.end() );
+// ----------------------------------------------------------------------------
 
-    for ( TUnitTestChildrenCIter it( m_tests.begin() ); it != last; ++it )
+bool UnitTestSet::RunCaseFile( const char * unitTestName,
+    const char * fileName, CaseFileFunction body, void * state,
+    char separator, unsigned int headerRows, unsigned int threadCount )
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+
+    if ( ( nullptr == body ) || IsEmptyString( fileName )
+      || m_impl->m_usingReceivers )
+        return false;
+    UnitTest * test = AddUnitTest( unitTestName );
+    if ( nullptr == test )
+        return false;
+    MappedFile file;
+    if ( !file.Open( fileName ) )
     {
-        const UnitTest * pTest = *it;
-        if ( nullptr == pTest )
-            continue;
+        test->Skip( __FILE__, __LINE__, fileName,
+            "Unable to map case file." );
+        return false;
+    }
 
-        ++m_testCount;
-        const bool pass = pTest->DidPass();
-        if ( pass )
-            ++m_testPassCount;
-        else
-            ++m_testFailCount;
-        if ( 0 < pTest->GetWarnCount() )
-            ++m_testWarnCount;
-        pResult = pass ? "Pass" : "FAIL";
+    CaseFileRun run( test, body, state, fileName, file, separator,
+        headerRows );
+    m_impl->RunCaseFile( run, threadCount );
+    return test->DidPass();
+}
 
-        m_itemPassCount += pTest->GetPassCount();
-        m_itemWarnCount += pTest->GetWarnCount();
-        m_itemFailCount += pTest->GetFailCount();
-        m_itemCount += pTest->GetItemCount();
-        unsigned int exceptCount = pTest->GetExceptionCount();
-        m_itemExceptCount += exceptCount;
-        if ( exceptCount != 0 )
-            ++m_testExceptCount;
+// ----------------------------------------------------------------------------
 
-        for ( recvIt = m_receivers.begin(); recvIt != recvEnd; ++recvIt )
-        {
-            receiver = *recvIt;
-            if ( receiver == nullptr )
-                continue;
-            keep = true;
-            try
-            {
-                keep = receiver->ShowTableLine( pTest );
-            }
-            catch ( ... )
-            {
-                keep = false;
-            }
-            if ( !keep )
-                *recvIt = nullptr;
-        }
-    }
+bool UnitTestSet::SetSnapshotDirectory( const char * directory )
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    if ( IsEmptyString( directory ) )
+        return false;
+    m_impl->m_snapshotDirectory = directory;
+    return true;
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTestSetImpl::OutputSummaryTable( void )
+const char * UnitTestSet::GetSnapshotDirectory( void ) const
 {
     assert( nullptr != this );
-    assert( m_showFinalTable );
-    assert( m_usingReceivers );
-    DEBUG_CODE( CheckInvariants() );
-    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
+    assert( nullptr != m_impl );
+    return m_impl->m_snapshotDirectory.c_str();
+}
 
-    const bool hasAnyTests = ( 0 < m_tests.size() );
-    bool keep = false;
-    UnitTestResultReceiver * receiver = nullptr;
-    TUnitTestReceiverSetIter recvEnd( m_receivers.end() );
-    TUnitTestReceiverSetIter recvIt;
-    for ( recvIt = m_receivers.begin(); recvIt != recvEnd; ++recvIt )
-    {
-        receiver = *recvIt;
-        if ( receiver == nullptr )
-            continue;
-        try
-        {
-            keep = receiver->StartSummaryTable();
-        }
-        catch ( ... )
-        {
-            keep = false;
-        }
-        if ( !keep )
-            *recvIt = nullptr;
-    }
+// ----------------------------------------------------------------------------
 
-    if ( hasAnyTests )
-    {
-        MakeTableRows();
-    }
+void UnitTestSet::SetSnapshotUpdate( bool update )
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    m_impl->m_updateSnapshots = update;
+}
 
-    for ( recvIt = m_receivers.begin(); recvIt != recvEnd; ++recvIt )
-    {
-        receiver = *recvIt;
-        if ( receiver == nullptr )
-            continue;
-        try
-        {
-            keep  = receiver->ShowTotalLine( m_itemPassCount,
-                m_itemWarnCount, m_itemFailCount, m_itemExceptCount,
-                m_itemCount );
-            keep &= receiver->ShowSummaryLine( m_testPassCount,
-                m_testWarnCount, m_testFailCount, m_testExceptCount,
-                m_testCount );
-            keep &= receiver->EndSummaryTable();
-        }
-        catch ( ... )
-        {
-            keep = false;
-        }
-        if ( !keep )
-            *recvIt = nullptr;
-    }
+// ----------------------------------------------------------------------------
+
+bool UnitTestSet::IsSnapshotUpdate( void ) const
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    return m_impl->m_updateSnapshots;
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTestSetImpl::OutputSummaryInfo( void )
+void UnitTestSet::SetPropertyOptions( unsigned int caseCount,
+    unsigned int threadCount, unsigned int seed )
 {
     assert( nullptr != this );
-    DEBUG_CODE( CheckInvariants() );
-    DEBUG_CODE( UnitTestSetChecker guard( this ); (void)guard; );
+    assert( nullptr != m_impl );
+    m_impl->m_propertyCases = ( 0 == caseCount ) ? 1 : caseCount;
+    m_impl->m_propertyThreads = ( s_MaxStressThreads < threadCount )
+        ? s_MaxStressThreads : threadCount;
+    m_impl->m_propertySeed = seed;
+}
 
-    if ( !m_didAnyTest )
-    {
-        StartOutput();
-    }
+// ----------------------------------------------------------------------------
 
-    assert( !m_usingReceivers );
-    m_usingReceivers = true;
-    if ( m_showTimeStamp )
-    {
-        ShowTimeStamp();
-    }
-    if ( m_showFinalTable )
-    {
-        OutputSummaryTable();
-    }
+bool UnitTestSet::SetVirtualClock( bool useVirtual )
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
 
-    Clear();
-    assert( m_usingReceivers );
-    m_usingReceivers = false;
-    m_didFirstRun = true;
+    if ( m_impl->m_usingReceivers )
+        return false;
+    if ( useVirtual )
+        m_impl->m_clock = &m_impl->m_virtualClock;
+    else
+        m_impl->m_clock = &m_impl->m_systemClock;
+    return true;
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTestSetImpl::CheckInvariants( void ) const
+Clock & UnitTestSet::GetClock( void )
 {
     assert( nullptr != this );
-    assert( m_testName.size() != 0 );
-    unsigned int total = m_itemPassCount + m_itemWarnCount
-        + m_itemFailCount + m_itemExceptCount;
-    (void)total;
-    assert( m_itemCount == total );
-    assert( m_testWarnCount <= m_testPassCount );
-    assert( m_testExceptCount <= m_testFailCount );
-    total = m_testPassCount + m_testFailCount;
-    (void)total;
-    assert( total == m_testCount );
+    assert( nullptr != m_impl );
+    return *m_impl->m_clock;
+}
 
-    unsigned int index = 1;
-    TUnitTestChildrenCIter last( m_tests.end() );
-    for ( TUnitTestChildrenCIter it( m_tests.begin() ); it != last; ++it )
-    {
-        const UnitTest * pTest = *it;
-        (void)pTest;
-        assert( nullptr != pTest );
-        assert( pTest->GetIndex() == index );
-        ++index;
-    }
+// ----------------------------------------------------------------------------
+
+VirtualClock & UnitTestSet::GetVirtualClock( void )
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    return m_impl->m_virtualClock;
 }
 
 // ----------------------------------------------------------------------------
 
-UnitTestSet::ErrorState UnitTestSet::Create( const char * testName,
-    const char * textFileName, const char * htmlFileName,
-    const char * xmlFileName, UnitTestSet::OutputOptions info,
-    bool deleteAtExitTime )
+const char * UnitTestSet::GetCounterName( unsigned int which ) const
 {
-    if ( s_instance != nullptr )
-    {
-        return UnitTestSet::AlreadyExists;
-    }
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    const CounterInfo * info = m_impl->m_perfCounters.GetInfo( which );
+    return ( nullptr == info ) ? nullptr : info->m_name;
+}
 
-    if ( IsEmptyString( testName ) )
-    {
-        testName = "Unit Tests";
-    }
-    s_instance = new UnitTestSet( testName, textFileName, htmlFileName,
-        xmlFileName, info );
-    if ( s_instance == nullptr )
-    {
-        return UnitTestSet::CantCreate;
-    }
-    if ( deleteAtExitTime )
-    {
-        ::atexit( Destroy );
-    }
+// ----------------------------------------------------------------------------
 
-    return UnitTestSet::Success;
+const char * UnitTestSet::GetCounterKey( unsigned int which ) const
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    const CounterInfo * info = m_impl->m_perfCounters.GetInfo( which );
+    return ( nullptr == info ) ? nullptr : info->m_key;
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTestSet::Destroy( void )
+bool UnitTestSet::ReadCounters( double * values ) const
 {
-    if ( s_instance != nullptr )
-    {
-        assert( s_instance->m_impl != nullptr );
-        s_instance->OutputSummary();
-        delete s_instance;
-        s_instance = nullptr;
-    }
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    assert( nullptr != values );
+    m_impl->m_perfCounters.Read( values );
+    return m_impl->m_perfCounters.IsOpen();
 }
 
 // ----------------------------------------------------------------------------
 
-UnitTestSet::UnitTestSet( const char * testName, const char * textFileName,
-    const char * htmlFileName, const char * xmlFileName,
-    UnitTestSet::OutputOptions info ) :
-    m_impl( nullptr )
+bool UnitTestSet::WillFatalEndProgram( const UnitTest * test ) const
 {
     assert( nullptr != this );
-    m_impl = new UnitTestSetImpl( testName, textFileName, htmlFileName,
-        xmlFileName, info );
     assert( nullptr != m_impl );
-    DEBUG_CODE( m_impl->CheckInvariants() );
+    return !m_impl->DoesFatalEndTest( test );
 }
 
 // ----------------------------------------------------------------------------
 
-UnitTestSet::~UnitTestSet( void )
+bool UnitTestSet::RegisterUnitTest( const char * unitTestName,
+    UnitTestFunction body )
 {
     assert( nullptr != this );
     assert( nullptr != m_impl );
     DEBUG_CODE( m_impl->CheckInvariants() );
-    delete m_impl;
+
+    if ( ( nullptr == body ) || m_impl->m_usingReceivers )
+        return false;
+    UnitTest * test = AddUnitTest( unitTestName );
+    if ( nullptr == test )
+        return false;
+    // AddUnitTest found the UnitTest via the name index, so its index tells
+    // whether it is registered without searching the registrations.
+    std::vector< bool > & isRegistered = m_impl->m_isRegistered;
+    const unsigned int index = test->GetIndex();
+    if ( isRegistered.size() <= index )
+        isRegistered.resize( m_impl->m_tests.size() + 1, false );
+    else if ( isRegistered[ index ] )
+        return false;
+    isRegistered[ index ] = true;
+    m_impl->m_registered.push_back( TUnitTestRegistration( test, body ) );
+    return true;
 }
 
 // ----------------------------------------------------------------------------
 
-bool UnitTestSet::AddReceiver( UnitTestResultReceiver * receiver )
+bool UnitTestSet::RegisterAsyncUnitTest( const char * unitTestName,
+    AsyncUnitTestFunction body, void * state )
 {
     assert( nullptr != this );
     assert( nullptr != m_impl );
     DEBUG_CODE( m_impl->CheckInvariants() );
-    DEBUG_CODE( UnitTestSetChecker guard( m_impl ); (void)guard; );
 
-    if ( nullptr == receiver )
+    if ( ( nullptr == body ) || m_impl->m_usingReceivers )
         return false;
-    if ( m_impl->m_usingReceivers )
+    UnitTest * test = AddUnitTest( unitTestName );
+    if ( nullptr == test )
         return false;
-
-    assert( !m_impl->m_usingReceivers );
-    m_impl->m_usingReceivers = true;
-    bool hasReceiver = false;
-    bool hasHole = false;
-    TUnitTestReceiverSetIter hole;
-    TUnitTestReceiverSetIter end( m_impl->m_receivers.end() );
-    for ( TUnitTestReceiverSetIter it( m_impl->m_receivers.begin() );
-        it != end; ++it )
-    {
-        UnitTestResultReceiver * recv = *it;
-        if ( recv == receiver )
-        {
-            hasReceiver = true;
-            break;
-        }
-        if ( recv == nullptr )
-            hole = it;
-    }
-
-    if ( !hasReceiver )
-    {
-        if ( hasHole )
-            *hole = receiver;
-        else
-            m_impl->m_receivers.push_back( receiver );
-    }
-    assert( m_impl->m_usingReceivers );
-    m_impl->m_usingReceivers = false;
-
+    m_impl->m_async.push_back( AsyncTask( test, body, state ) );
     return true;
 }
 
 // ----------------------------------------------------------------------------
 
-bool UnitTestSet::RemoveReceiver( UnitTestResultReceiver * receiver )
+bool UnitTestSet::RunAsyncUnitTests( void )
 {
     assert( nullptr != this );
     assert( nullptr != m_impl );
     DEBUG_CODE( m_impl->CheckInvariants() );
-    DEBUG_CODE( UnitTestSetChecker guard( m_impl ); (void)guard; );
 
-    if ( nullptr == receiver )
-        return false;
     if ( m_impl->m_usingReceivers )
         return false;
 
-    bool found = false;
-    assert( !m_impl->m_usingReceivers );
-    m_impl->m_usingReceivers = true;
-    TUnitTestReceiverSetIter end( m_impl->m_receivers.end() );
-    for ( TUnitTestReceiverSetIter it( m_impl->m_receivers.begin() );
-        it != end; ++it )
+    // Every body starts out ready, so each one gets called once before the
+    // loop waits on anything.  Time spent waiting belongs to no UnitTest.
+    m_impl->SwitchToTest( nullptr );
+    TAsyncTasks tasks;
+    tasks.swap( m_impl->m_async );
+    bool allPassed = true;
+    while ( !tasks.empty() )
     {
-        UnitTestResultReceiver * recv = *it;
-        if ( recv != receiver )
-            continue;
-        *it = nullptr;
-        found = true;
-        break;
+        m_impl->WaitForAsyncTasks( tasks );
+        for ( unsigned int ii = 0; ii < tasks.size(); )
+        {
+            if ( !tasks[ ii ].m_ready || m_impl->StepAsyncTask( tasks[ ii ] ) )
+            {
+                ++ii;
+                continue;
+            }
+            if ( !tasks[ ii ].m_test->DidPass() )
+                allPassed = false;
+            tasks.erase( tasks.begin() + ii );
+        }
+        // Bodies registered by other bodies join this loop.
+        tasks.insert( tasks.end(), m_impl->m_async.begin(),
+            m_impl->m_async.end() );
+        m_impl->m_async.clear();
     }
-    assert( m_impl->m_usingReceivers );
-    m_impl->m_usingReceivers = false;
 
-    return found;
+    return allPassed;
 }
 
 // ----------------------------------------------------------------------------
 
-bool UnitTestSet::DoesSendToTextFile( void ) const
+bool UnitTestSet::AddDependency( const char * unitTestName,
+    const char * prerequisiteName )
 {
     assert( nullptr != this );
     assert( nullptr != m_impl );
     DEBUG_CODE( m_impl->CheckInvariants() );
-    return m_impl->m_textOutput.IsOpen();
+
+    if ( IsEmptyString( unitTestName ) || IsEmptyString( prerequisiteName )
+      || m_impl->m_usingReceivers )
+        return false;
+    m_impl->m_dependencies.push_back(
+        TUnitTestDependency( unitTestName, prerequisiteName ) );
+    return true;
 }
 
 // ----------------------------------------------------------------------------
 
-bool UnitTestSet::DoesSendToHtmlFile( void ) const
+bool UnitTestSet::RunUnitTests( void )
 {
     assert( nullptr != this );
     assert( nullptr != m_impl );
     DEBUG_CODE( m_impl->CheckInvariants() );
-    return m_impl->m_htmlOutput.IsOpen();
-}
 
-// ----------------------------------------------------------------------------
+    if ( m_impl->m_usingReceivers )
+        return false;
 
-bool UnitTestSet::DoesSendToXmlFile( void ) const
-{
-    assert( nullptr != this );
-    assert( nullptr != m_impl );
-    DEBUG_CODE( m_impl->CheckInvariants() );
-    return m_impl->m_xmlOutput.IsOpen();
-}
+    // Take the registrations so a test body may register more for a later
+    // call without disturbing this one.
+    TUnitTestRegistrations registered;
+    TUnitTestDependencies dependencies;
+    registered.swap( m_impl->m_registered );
+    dependencies.swap( m_impl->m_dependencies );
+    m_impl->m_isRegistered.clear();
+    const unsigned int count = static_cast< unsigned int >( registered.size() );
+
+    // Maps index of each UnitTest to its place in registered, or to count if
+    // it is not registered.
+    std::vector< unsigned int > place( m_impl->m_tests.size() + 1, count );
+    for ( unsigned int ii = 0; ii < count; ++ii )
+        place[ registered[ ii ].first->GetIndex() ] = ii;
+
+    std::vector< unsigned int > waitCount( count, 0 );
+    std::vector< std::vector< unsigned int > > dependents( count );
+    std::vector< std::vector< const char * > > prerequisites( count );
+    const TUnitTestDependencies::const_iterator last( dependencies.end() );
+    for ( TUnitTestDependencies::const_iterator it( dependencies.begin() );
+        it != last; ++it )
+    {
+        const UnitTest * test = GetUnitTest( it->first.c_str() );
+        if ( nullptr == test )
+            continue;
+        const unsigned int dependent = place[ test->GetIndex() ];
+        if ( count == dependent )
+            continue;
+        prerequisites[ dependent ].push_back( it->second.c_str() );
+        const UnitTest * prerequisite = GetUnitTest( it->second.c_str() );
+        if ( nullptr == prerequisite )
+            continue;
+        const unsigned int before = place[ prerequisite->GetIndex() ];
+        if ( count == before )
+            continue;
+        dependents[ before ].push_back( dependent );
+        ++waitCount[ dependent ];
+    }
 
-// ----------------------------------------------------------------------------
+    // Kahn's algorithm, where the lowest place among ready UnitTest's goes
+    // first so the order is the same on every run.
+    TReadyUnitTests ready;
+    for ( unsigned int ii = 0; ii < count; ++ii )
+        if ( 0 == waitCount[ ii ] )
+            ready.push( ii );
+
+    // Isolated UnitTest's start as soon as they are ready, and their
+    // dependents are released once their child processes end.
+    const unsigned int workerCount =
+        ( m_impl->IsIsolatedChild() ) ? 0 : m_impl->m_workerCount;
+    TIsolatedWorkers workers;
+    bool allPassed = true;
+    unsigned int doneCount = 0;
+    while ( !ready.empty() || !workers.empty() )
+    {
+        if ( !workers.empty()
+          && ( ready.empty() || ( workerCount <= workers.size() ) ) )
+        {
+            const unsigned int ii = m_impl->WaitForWorker( workers );
+            IsolatedWorker worker( workers[ ii ] );
+            workers.erase( workers.begin() + ii );
+            m_impl->FinishWorker( worker );
+            if ( !worker.m_test->DidPass() )
+                allPassed = false;
+            ReleaseDependents( dependents[ worker.m_place ], waitCount,
+                ready );
+            continue;
+        }
+        const unsigned int current = ready.top();
+        ready.pop();
+        ++doneCount;
+        UnitTest * test = registered[ current ].first;
+        const char * blocker = nullptr;
+        const std::vector< const char * > & before = prerequisites[ current ];
+        for ( unsigned int ii = 0; ii < before.size(); ++ii )
+        {
+            const UnitTest * prerequisite = GetUnitTest( before[ ii ] );
+            if ( ( nullptr == prerequisite ) || !prerequisite->DidPass()
+              || prerequisite->WasSkipped() )
+            {
+                blocker = before[ ii ];
+                break;
+            }
+        }
+        if ( nullptr != blocker )
+        {
+            allPassed = false;
+            test->Skip( __FILE__, __LINE__, blocker,
+                "Prerequisite unit test did not pass." );
+        }
+        else
+        {
+            if ( 0 < workerCount )
+            {
+                IsolatedWorker worker;
+                worker.m_place = current;
+                if ( m_impl->StartWorker( test, registered[ current ].second,
+                    worker ) )
+                {
+                    workers.push_back( worker );
+                    continue;
+                }
+            }
+            // Runs within this process, either by choice or since a child
+            // process could not start.
+            const unsigned int outerWorkers = m_impl->m_workerCount;
+            m_impl->m_workerCount = 0;
+            if ( !RunUnitTest( test->GetName(),
+                registered[ current ].second ) )
+                allPassed = false;
+            m_impl->m_workerCount = outerWorkers;
+        }
+        ReleaseDependents( dependents[ current ], waitCount, ready );
+    }
 
-bool UnitTestSet::DoesSendToCout( void ) const
-{
-    assert( nullptr != this );
-    assert( nullptr != m_impl );
-    DEBUG_CODE( m_impl->CheckInvariants() );
-    return m_impl->m_textOutput.DoesSendToCout();
+    if ( doneCount < count )
+    {
+        // Whatever is still waiting is part of, or depends upon, a cycle.
+        allPassed = false;
+        for ( unsigned int ii = 0; ii < count; ++ii )
+        {
+            if ( 0 == waitCount[ ii ] )
+                continue;
+            UnitTest * test = registered[ ii ].first;
+            test->Skip( __FILE__, __LINE__, test->GetName(),
+                "Unit test is part of a cycle of dependencies." );
+        }
+    }
+
+    return allPassed;
 }
 
 // ----------------------------------------------------------------------------
 
-bool UnitTestSet::DoesSendToCerr( void ) const
+bool UnitTestSet::RunStaticUnitTests( const char * filter )
 {
     assert( nullptr != this );
     assert( nullptr != m_impl );
     DEBUG_CODE( m_impl->CheckInvariants() );
-    return m_impl->m_textOutput.DoesSendToCerr();
-}
 
-// ----------------------------------------------------------------------------
+    if ( m_impl->m_usingReceivers )
+        return false;
 
-const char * UnitTestSet::GetTextFileName( void ) const
-{
-    assert( nullptr != this );
-    assert( nullptr != m_impl );
-    DEBUG_CODE( m_impl->CheckInvariants() );
-    return m_impl->m_textOutput.GetFileName();
+    // UnitTest's are made here only for the records which match.
+    std::vector< const StaticUnitTest * > found;
+    FindStaticUnitTests( filter, found );
+    const unsigned int count = static_cast< unsigned int >( found.size() );
+    for ( unsigned int ii = 0; ii < count; ++ii )
+        RegisterUnitTest( found[ ii ]->m_name, found[ ii ]->m_body );
+    return RunUnitTests();
 }
 
 // ----------------------------------------------------------------------------
 
-const char * UnitTestSet::GetHtmlFileName( void ) const
+bool UnitTestSet::AddFixture( const char * fixtureName, FixtureScope scope,
+    FixtureSetUpFunction setUp, FixtureTearDownFunction tearDown,
+    void * state )
 {
     assert( nullptr != this );
     assert( nullptr != m_impl );
     DEBUG_CODE( m_impl->CheckInvariants() );
-    return m_impl->m_htmlOutput.GetCurrentPageName();
+
+    if ( IsEmptyString( fixtureName ) || ( nullptr == setUp )
+      || m_impl->m_usingReceivers )
+        return false;
+    MonitorLock lock( &m_impl->m_fixtureLock );
+    TFixtures & fixtures = m_impl->m_fixtures;
+    const TFixtures::const_iterator last( fixtures.end() );
+    for ( TFixtures::const_iterator it( fixtures.begin() ); it != last; ++it )
+    {
+        if ( it->m_name == fixtureName )
+            return false;
+    }
+    Fixture fixture;
+    fixture.m_name = fixtureName;
+    fixture.m_scope = scope;
+    fixture.m_setUp = setUp;
+    fixture.m_tearDown = tearDown;
+    fixture.m_state = state;
+    fixture.m_setUpCount = 0;
+    fixture.m_setUpSeconds = 0.0;
+    fixture.m_tearDownSeconds = 0.0;
+    fixture.m_usedByChild = false;
+    fixtures.push_back( fixture );
+    return true;
 }
 
 // ----------------------------------------------------------------------------
 
-const char * UnitTestSet::GetMainHtmlFileName( void ) const
+void * UnitTestSet::GetFixture( const char * fixtureName )
 {
     assert( nullptr != this );
     assert( nullptr != m_impl );
-    DEBUG_CODE( m_impl->CheckInvariants() );
-    return m_impl->m_htmlOutput.GetMainPageName();
+    // Invariants are not checked since other threads may be recording items.
+    if ( IsEmptyString( fixtureName ) )
+        return nullptr;
+    return m_impl->GetFixture( fixtureName );
 }
 
 // ----------------------------------------------------------------------------
 
-const char * UnitTestSet::GetXmlFileName( void ) const
+void UnitTestSet::TearDownFixtures( void )
 {
     assert( nullptr != this );
     assert( nullptr != m_impl );
     DEBUG_CODE( m_impl->CheckInvariants() );
-    return m_impl->m_xmlOutput.GetFileName();
+    m_impl->TearDownFixtures();
 }
 
 // ----------------------------------------------------------------------------
 
-void UnitTestSet::OutputSummary( void )
+bool UnitTestSet::SetSoakMode( double minutes )
 {
     assert( nullptr != this );
     assert( nullptr != m_impl );
-    const bool hasAnyTests = ( 0 < m_impl->m_tests.size() );
-    if ( hasAnyTests || ( !m_impl->m_didFirstRun ) )
+    DEBUG_CODE( m_impl->CheckInvariants() );
+
+    if ( ( minutes < 0.0 ) || m_impl->m_usingReceivers )
+        return false;
+    if ( 0.0 == m_impl->m_soakInterval )
     {
-        m_impl->OutputSummaryInfo();
+        // Times and bursts start over each time soak mode turns on.
+        m_impl->m_soakStart = LatencyHistogram::GetTime();
+        m_impl->m_soakLast = m_impl->m_soakStart;
+        m_impl->m_soakTicks = 0;
+        m_impl->m_burstCount = 0;
+        m_impl->m_peakBurst = 0;
+        m_impl->StartSoakCounts();
     }
+    m_impl->m_soakInterval = minutes * 60.0;
+    return true;
 }
 
 // ----------------------------------------------------------------------------
 
-bool UnitTestSet::DoesOutputOption( UnitTestSet::OutputOptions options ) const
+bool UnitTestSet::SetInvariantPolicy( InvariantPolicy policy, unsigned int n )
 {
     assert( nullptr != this );
     assert( nullptr != m_impl );
-    DEBUG_CODE( m_impl->CheckInvariants() );
 
-    if ( ( 0 != ( options & UnitTestSet::Passes ) )
-      && ( !m_impl->m_showPasses ) )
-    {
-        return false;
-    }
-    if ( ( 0 != ( options & UnitTestSet::Warnings ) )
-      && ( !m_impl->m_showWarnings ) )
-    {
-        return false;
-    }
-    if ( ( 0 != ( options & UnitTestSet::Messages ) )
-      && ( !m_impl->m_showMessages ) )
-    {
-        return false;
-    }
-    if ( ( 0 != ( options & UnitTestSet::Headers ) )
-      && ( !m_impl->m_showHeaders ) )
-    {
-        return false;
-    }
-    if ( ( 0 != ( options & UnitTestSet::TimeStamp ) )
-      && ( !m_impl->m_showTimeStamp ) )
-    {
-        return false;
-    }
-    if ( ( 0 != ( options & UnitTestSet::FullDayName ) )
-      && ( !m_impl->m_useFullDayName ) )
-    {
-        return false;
-    }
-    if ( ( 0 != ( options & UnitTestSet::Dividers ) )
-      && ( !m_impl->m_textOutput.ShowDividers() ) )
-    {
-        return false;
-    }
-    if ( ( 0 != ( options & UnitTestSet::AddTestIndex ) )
-        && ( !m_impl->m_textOutput.DoesShowIndexes() ) )
+    switch ( policy )
     {
-        return false;
+        case CheckEveryNth:
+            if ( 0 == n )
+                return false;
+            s_invariantPeriod = n;
+            break;
+        case CheckAlways:
+        case CheckAtSummary:
+            s_invariantPeriod = 1;
+            break;
+        default:
+            return false;
     }
-
+    s_invariantPolicy = policy;
+    s_invariantCountdown = 0;
     return true;
 }
 
 // ----------------------------------------------------------------------------
 
-unsigned int UnitTestSet::GetUnitTestCount( void ) const
+ItemCount UnitTestSet::GetInvariantCheckCount( void ) const
 {
     assert( nullptr != this );
     assert( nullptr != m_impl );
-    DEBUG_CODE( m_impl->CheckInvariants() );
-    return static_cast< unsigned int >( m_impl->m_tests.size() );
+    ItemCount checks = 0;
+    double seconds = 0.0;
+    AddUpInvariantCost( checks, seconds, false );
+    return checks;
 }
 
 // ----------------------------------------------------------------------------
 
-UnitTest * UnitTestSet::AddUnitTest( const char * unitTestName )
+void UnitTestSet::OutputSoakSnapshot( void )
 {
     assert( nullptr != this );
     assert( nullptr != m_impl );
+    MonitorLock lock( m_impl->GetRecordLock() );
     DEBUG_CODE( m_impl->CheckInvariants() );
-    DEBUG_CODE( UnitTestSetChecker guard( m_impl ); (void)guard; );
-
-    if ( IsEmptyString( unitTestName ) )
-        return nullptr;
-    UnitTest * test = const_cast< UnitTest * >
-        ( m_impl->GetUnitTest( unitTestName ) );
-    if ( nullptr != test )
-        return test;
+    m_impl->OutputSoakSnapshot();
+}
 
-    try
-    {
-        test = new UnitTest( unitTestName );
-        m_impl->m_tests.push_back( test );
-        test->m_index = static_cast< unsigned int >( m_impl->m_tests.size() );
-    }
-    catch ( ... )
-    {
-        delete test;
-        throw;
-    }
+// ----------------------------------------------------------------------------
 
-    return test;
+unsigned int UnitTestSet::GetSoakSnapshotCount( void ) const
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    return m_impl->m_soakCount;
 }
 
 // ----------------------------------------------------------------------------
@@ -3279,6 +10989,29 @@ bool UnitTestResultReceiver::ShowTotalLine( unsigned int passCount,
 
 // ----------------------------------------------------------------------------
 
+bool UnitTestResultReceiver::ShowTotalLineWithSkips( unsigned int passCount,
+    unsigned int warnCount, unsigned int failCount,
+    unsigned int exceptCount, unsigned int skipCount, unsigned int itemCount )
+{
+    (void)skipCount;
+    return ShowTotalLine( passCount, warnCount, failCount, exceptCount,
+        itemCount );
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTestResultReceiver::ShowLongTotalLine( ItemCount passCount,
+    ItemCount warnCount, ItemCount failCount, ItemCount exceptCount,
+    ItemCount skipCount, ItemCount itemCount )
+{
+    return ShowTotalLineWithSkips( ClampCount( passCount ),
+        ClampCount( warnCount ), ClampCount( failCount ),
+        ClampCount( exceptCount ), ClampCount( skipCount ),
+        ClampCount( itemCount ) );
+}
+
+// ----------------------------------------------------------------------------
+
 bool UnitTestResultReceiver::ShowSummaryLine( unsigned int passCount,
     unsigned int warnCount, unsigned int failCount,
     unsigned int exceptCount, unsigned int testCount )
@@ -3293,6 +11026,42 @@ bool UnitTestResultReceiver::ShowSummaryLine( unsigned int passCount,
 
 // ----------------------------------------------------------------------------
 
+bool UnitTestResultReceiver::ShowSummaryLineWithSkips(
+    unsigned int passCount, unsigned int warnCount, unsigned int failCount,
+    unsigned int exceptCount, unsigned int skipCount, unsigned int testCount )
+{
+    (void)skipCount;
+    return ShowSummaryLine( passCount, warnCount, failCount, exceptCount,
+        testCount );
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTestResultReceiver::ShowFixtureLine( const char * fixtureName,
+    bool isWorker, unsigned int setUpCount, double setUpSeconds,
+    double tearDownSeconds )
+{
+    (void)fixtureName;
+    (void)isWorker;
+    (void)setUpCount;
+    (void)setUpSeconds;
+    (void)tearDownSeconds;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+bool UnitTestResultReceiver::ShowInvariantLine( ItemCount checks,
+    double seconds, unsigned int period )
+{
+    (void)checks;
+    (void)seconds;
+    (void)period;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
 bool UnitTestResultReceiver::EndSummaryTable( void )
 {
     return true;
@@ -65,6 +65,12 @@ typedef TUnitTestChildren::iterator TUnitTestChildrenIter;
 /// Iterator across container of UnitTest pointers.
 typedef TUnitTestChildren::const_iterator TUnitTestChildrenCIter;
 
+/// Container of pointers to interrupt contexts.
+typedef std::vector< ut::InterruptContext * > TInterruptContexts;
+
+/// Iterator across container of interrupt contexts.
+typedef TInterruptContexts::iterator TInterruptContextsIter;
+
 
 // ----------------------------------------------------------------------------
 
@@ -252,6 +258,9 @@ private:
     /// Container of output receivers.
     ut::UnitTestResultReceiver * m_receiver;
 
+    /// Contexts which hold test items recorded by interrupt handlers.
+    TInterruptContexts m_contexts;
+
     /// True if messages without test items are sent to output.
     bool m_showMessages;
 
@@ -481,11 +490,102 @@ void UnitTest::CheckInvariants( void ) const
 
 // ----------------------------------------------------------------------------
 
+InterruptContext::InterruptContext( unsigned int capacity ) :
+    m_events( nullptr ),
+    m_size( capacity + 1 ),
+    m_head( 0 ),
+    m_tail( 0 ),
+    m_recordCount( 0 ),
+    m_failCount( 0 ),
+    m_dropCount( 0 )
+{
+    assert( nullptr != this );
+    assert( 0 < capacity );
+    // One slot always stays empty so a full ring differs from an empty one.
+    m_events = new Event[ m_size ];
+}
+
+// ----------------------------------------------------------------------------
+
+InterruptContext::~InterruptContext( void )
+{
+    assert( nullptr != this );
+    delete [] m_events;
+}
+
+// ----------------------------------------------------------------------------
+
+bool InterruptContext::Record( UnitTest * test, const char * file,
+    unsigned int line, UnitTest::TestLevel level, bool pass,
+    const char * expression, const char * message )
+{
+    assert( nullptr != this );
+    if ( ( nullptr == test ) || IsEmptyString( file )
+      || IsEmptyString( expression ) )
+        return pass;
+
+    // Only this function changes m_head, and only Pump changes m_tail.
+    const unsigned int head = m_head;
+    const unsigned int next = ( head + 1 == m_size ) ? 0 : head + 1;
+    if ( next == m_tail )
+    {
+        // Volatile counters get an explicit load and store, since C++20
+        // deprecates ++ on volatile.
+        m_dropCount = m_dropCount + 1;
+        return pass;
+    }
+
+    Event & event = m_events[ head ];
+    event.m_test = test;
+    event.m_file = file;
+    event.m_expression = expression;
+    event.m_message = message;
+    event.m_line = line;
+    event.m_level = level;
+    event.m_pass = pass;
+    // Event must be visible to consumer before consumer sees the new head.
+    UNIT_TEST_MEMORY_BARRIER();
+    m_head = next;
+    m_recordCount = m_recordCount + 1;
+    if ( !pass )
+        m_failCount = m_failCount + 1;
+
+    return pass;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned int InterruptContext::Pump( void )
+{
+    assert( nullptr != this );
+
+    unsigned int count = 0;
+    unsigned int tail = m_tail;
+    while ( tail != m_head )
+    {
+        // Must not read event until producer finished writing it.
+        UNIT_TEST_MEMORY_BARRIER();
+        const Event event = m_events[ tail ];
+        // Must finish copying event before producer may reuse the slot.
+        UNIT_TEST_MEMORY_BARRIER();
+        tail = ( tail + 1 == m_size ) ? 0 : tail + 1;
+        m_tail = tail;
+        event.m_test->DoTest( event.m_file, event.m_line, event.m_level,
+            event.m_pass, event.m_expression, event.m_message );
+        ++count;
+    }
+
+    return count;
+}
+
+// ----------------------------------------------------------------------------
+
 UnitTestSetImpl::UnitTestSetImpl( const char * testName,
     UnitTestResultReceiver * receiver, UnitTestSet::OutputOptions info ) :
     m_testName( testName ),
     m_tests(),
     m_receiver( receiver ),
+    m_contexts(),
     m_showMessages( 0 != ( info & UnitTestSet::Messages ) ),
     m_showPasses( 0 != ( info & UnitTestSet::Passes ) ),
     m_showWarnings( 0 != ( info & UnitTestSet::Warnings ) ),
@@ -521,6 +621,13 @@ UnitTestSetImpl::~UnitTestSetImpl( void )
     DEBUG_CODE( CheckInvariants() );
     Clear();
 
+    TInterruptContextsIter last( m_contexts.end() );
+    for ( TInterruptContextsIter it( m_contexts.begin() ); it != last; ++it )
+    {
+        delete *it;
+    }
+    m_contexts.clear();
+
     if ( nullptr == m_receiver )
         return;
     assert( !m_usingReceivers );
@@ -1000,10 +1107,57 @@ bool UnitTestSet::SetReceiver( UnitTestResultReceiver * receiver )
 
 // ----------------------------------------------------------------------------
 
+InterruptContext * UnitTestSet::AddInterruptContext( unsigned int capacity )
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+
+    if ( 0 == capacity )
+        return nullptr;
+    InterruptContext * context = nullptr;
+    try
+    {
+        context = new InterruptContext( capacity );
+        m_impl->m_contexts.push_back( context );
+    }
+    catch ( ... )
+    {
+        delete context;
+        throw;
+    }
+
+    return context;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned int UnitTestSet::PumpInterruptEvents( void )
+{
+    assert( nullptr != this );
+    assert( nullptr != m_impl );
+    DEBUG_CODE( m_impl->CheckInvariants() );
+    if ( m_impl->IsUsingReceivers() )
+        return 0;
+
+    unsigned int count = 0;
+    TInterruptContextsIter last( m_impl->m_contexts.end() );
+    for ( TInterruptContextsIter it( m_impl->m_contexts.begin() ); it != last;
+        ++it )
+    {
+        count += ( *it )->Pump();
+    }
+
+    return count;
+}
+
+// ----------------------------------------------------------------------------
+
 void UnitTestSet::OutputSummary( void )
 {
     assert( nullptr != this );
     assert( nullptr != m_impl );
+    PumpInterruptEvents();
     const bool hasAnyTests = ( 0 < m_impl->m_tests.size() );
     if ( hasAnyTests || ( !m_impl->m_didFirstRun ) )
     {
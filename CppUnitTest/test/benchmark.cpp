@@ -0,0 +1,801 @@
+// ----------------------------------------------------------------------------
+// The C++ Unit Test Library
+// Copyright (c) 2008 by Rich Sposato
+//
+// Permission to use, copy, modify, distribute and sell this software for any
+// purpose is hereby granted under the terms stated in the GNU Library Public
+// License, provided that the above copyright notice appear in all copies and
+// that both that copyright notice and this permission notice appear in
+// supporting documentation.
+//
+// ----------------------------------------------------------------------------
+
+// $Header: $
+
+
+// ----------------------------------------------------------------------------
+
+/** @file benchmark.cpp
+ @brief Measures how much time the unit test library itself needs.
+
+ @par Why Separate Processes
+  The UnitTestSet is a singleton which can only be created once per process,
+  and its output options can't change once it exists.  So each benchmark runs
+  in its own process.  When called without a -b parameter, this program runs
+  itself once for every benchmark and every combination of output options.
+
+ @par Output Format
+  Results are appended to a comma-separated file (benchmark_results.csv by
+  default) so library performance can be tracked over time.  Each line has:
+  benchmark,passes,warnings,cout,text,html,xml,sample,count,seconds,rate,
+  counters,counter1,counter2,counter3,counter4
+  - benchmark is DoTest, AddUnitTest, AddManyUnitTests, OutputSummary, or
+    MainPage.
+  - passes through xml are 1 if that output option was used, else 0.
+  - sample is the repetition number, starting at 1.
+  - count is how many operations were timed in the sample.
+  - seconds is processor time used by the sample.
+  - rate is operations per second.
+  - counters names the performance counters, split by slashes, with a dash
+    for each counter which could not be opened.  Counters are read only if
+    the -p parameter is given, since opening them changes what is measured.
+  - counter1 through counter4 are counts of those events during the sample.
+
+ @par Comparing Results
+  With -c, this program compares samples in a baseline result file with those
+  in the -r result file instead of running benchmarks.  Samples are matched by
+  benchmark name and output options, and compared as microseconds per
+  operation with ut::SampleComparison.  An HTML page shows the change in each
+  benchmark with its 95% confidence interval, and flags significant
+  regressions and improvements.  The program returns 1 if any benchmark
+  regressed, so scripts can stop on a regression.
+ */
+
+#include "UnitTest.hpp"
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+/// Name of file where results go when host does not provide one.
+const char * s_defaultResultFile = "benchmark_results.csv";
+
+/// Name of HTML file made by comparing two result files.
+const char * s_defaultCompareFile = "benchmark_compare.html";
+
+/// Confidence level used when comparing result files.
+const double s_confidence = 0.95;
+
+/// Column names placed at top of new result file.
+const char * s_resultHeader =
+    "benchmark,passes,warnings,cout,text,html,xml,sample,count,seconds,rate,"
+    "counters,counter1,counter2,counter3,counter4";
+
+/// Performance counts when current sample started.
+double s_startCounts[ ut::UnitTest::CounterCount ];
+
+/// Standard output of child processes goes here so it doesn't flood console.
+const char * s_childOutputFile = "benchmark_output.txt";
+
+/// Partial file name used for text, html, and xml output files.
+const char * s_partialName = "Benchmark";
+
+/// Number of UnitTest's made by AddUnitTest and OutputSummary benchmarks.
+const unsigned int s_unitTestCount = 10000;
+
+/** Number of UnitTest's made by AddManyUnitTests benchmark.  If adding them
+ costs more per UnitTest than AddUnitTest does, registration does not scale.
+ */
+const unsigned int s_manyUnitTestCount = 200000;
+
+/** Number of summaries made before timing MainPage benchmark.  This is higher
+ than the max number of rows kept in the main html page, so the history is as
+ large as it gets.
+ */
+const unsigned int s_historyCount = 100;
+
+// These bits select which output goes into the benchmark.
+const unsigned int s_usePasses   = 0x01;
+const unsigned int s_useWarnings = 0x02;
+const unsigned int s_useCout     = 0x04;
+const unsigned int s_useText     = 0x08;
+const unsigned int s_useHtml     = 0x10;
+const unsigned int s_useXml      = 0x20;
+const unsigned int s_useAll      = 0x3F;
+
+// ----------------------------------------------------------------------------
+
+/** @class BenchmarkArgs
+ @brief Parses and validates command line parameters for benchmark program.
+ */
+class BenchmarkArgs
+{
+public:
+
+    /** Parses through and validates the command line parameters.
+     @param[in] argc Count of parameters.
+     @param[in] argv Array of parameters.
+     */
+    BenchmarkArgs( unsigned int argc, const char * const argv[] );
+
+    inline ~BenchmarkArgs( void ) {}
+
+    void ShowHelp( void ) const;
+
+    inline bool IsValid( void ) const { return m_valid; }
+    inline bool DoShowHelp( void ) const { return m_doShowHelp; }
+    inline const char * GetBenchmark( void ) const { return m_benchmark; }
+    inline unsigned int GetOutputs( void ) const { return m_outputs; }
+    inline unsigned int GetCount( void ) const { return m_count; }
+    inline unsigned int GetSamples( void ) const { return m_samples; }
+    inline bool DoReadCounters( void ) const { return m_readCounters; }
+    inline const char * GetResultFile( void ) const { return m_resultFile; }
+    inline const char * GetBaselineFile( void ) const { return m_baselineFile; }
+    inline const char * GetCompareFile( void ) const { return m_compareFile; }
+    inline const char * GetExeName( void ) const { return m_exeName; }
+
+private:
+
+    BenchmarkArgs( void );
+    BenchmarkArgs( const BenchmarkArgs & );
+    BenchmarkArgs & operator = ( const BenchmarkArgs & );
+
+    bool m_valid;             ///< True if all parameters are valid.
+    bool m_doShowHelp;        ///< True if user asked for help.
+    bool m_readCounters;      ///< True if performance counters are read.
+    unsigned int m_outputs;   ///< Bitfield of s_use* values.
+    unsigned int m_count;     ///< # of DoTest calls per sample.
+    unsigned int m_samples;   ///< # of times each benchmark repeats.
+    const char * m_benchmark; ///< Name of benchmark, or NULL to run all.
+    const char * m_resultFile;
+    const char * m_baselineFile; ///< Results to compare with, or NULL.
+    const char * m_compareFile;  ///< HTML file made by comparison.
+    const char * m_exeName;
+};
+
+// ----------------------------------------------------------------------------
+
+BenchmarkArgs::BenchmarkArgs( unsigned int argc, const char * const argv[] ) :
+    m_valid( true ),
+    m_doShowHelp( false ),
+    m_readCounters( false ),
+    m_outputs( 0 ),
+    m_count( 100000 ),
+    m_samples( 5 ),
+    m_benchmark( NULL ),
+    m_resultFile( s_defaultResultFile ),
+    m_baselineFile( NULL ),
+    m_compareFile( s_defaultCompareFile ),
+    m_exeName( argv[0] )
+{
+    for ( unsigned int ii = 1; ( m_valid ) && ( ii < argc ); ++ii )
+    {
+        const char * ss = argv[ ii ];
+        if ( ( NULL == ss ) || ( '-' != ss[0] ) || ( '\0' == ss[1] ) )
+        {
+            m_valid = false;
+            break;
+        }
+        const bool hasValue = ( ':' == ss[2] ) && ( '\0' != ss[3] );
+        switch ( ss[1] )
+        {
+            case '?':
+                m_doShowHelp = true;
+                break;
+            case 'b':
+                m_valid = hasValue;
+                if ( m_valid )
+                    m_benchmark = ss + 3;
+                break;
+            case 'o':
+                m_valid = hasValue;
+                if ( m_valid )
+                    m_outputs = static_cast< unsigned int >(
+                        ::strtoul( ss + 3, NULL, 16 ) ) & s_useAll;
+                break;
+            case 'n':
+                m_valid = hasValue;
+                if ( m_valid )
+                    m_count = static_cast< unsigned int >(
+                        ::strtoul( ss + 3, NULL, 10 ) );
+                m_valid = hasValue && ( 0 < m_count );
+                break;
+            case 's':
+                m_valid = hasValue;
+                if ( m_valid )
+                    m_samples = static_cast< unsigned int >(
+                        ::strtoul( ss + 3, NULL, 10 ) );
+                m_valid = hasValue && ( 0 < m_samples );
+                break;
+            case 'p':
+                m_readCounters = true;
+                break;
+            case 'r':
+                m_valid = hasValue;
+                if ( m_valid )
+                    m_resultFile = ss + 3;
+                break;
+            case 'c':
+                m_valid = hasValue;
+                if ( m_valid )
+                    m_baselineFile = ss + 3;
+                break;
+            case 'h':
+                m_valid = hasValue;
+                if ( m_valid )
+                    m_compareFile = ss + 3;
+                break;
+            default:
+                m_valid = false;
+                break;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void BenchmarkArgs::ShowHelp( void ) const
+{
+    cout << "Usage: " << m_exeName << endl;
+    cout << " [-b:name] [-o:hex] [-n:count] [-s:samples] [-r:file] [-p] [-?]"
+         << endl;
+    cout << " [-c:baseline] [-h:file]" << endl;
+    cout << endl;
+    cout << "Parameters: (order of parameters does not matter)" << endl;
+    cout << "  -b  Run just one benchmark in this process.  Without this,"
+         << endl;
+    cout << "      the program runs every benchmark in a separate process."
+         << endl;
+    cout << "      DoTest       Calls to UnitTest::DoTest per second." << endl;
+    cout << "      AddUnitTest  Calls to UnitTestSet::AddUnitTest." << endl;
+    cout << "      AddManyUnitTests  Same, for 200000 UnitTests." << endl;
+    cout << "      OutputSummary  Summary tables for 10000 UnitTests." << endl;
+    cout << "      MainPage     Summaries added to a full main html page."
+         << endl;
+    cout << "  -o  Hexadecimal bitfield of output used by benchmark." << endl;
+    cout << "      01 Passes, 02 Warnings, 04 SendToCout," << endl;
+    cout << "      08 text file, 10 html file, 20 xml file." << endl;
+    cout << "  -n  Number of DoTest calls per sample.  Default is 100000."
+         << endl;
+    cout << "  -s  Number of samples per benchmark.  Default is 5." << endl;
+    cout << "  -r  Append results to this file.  Default is "
+         << s_defaultResultFile << "." << endl;
+    cout << "  -p  Read performance counters during each sample." << endl;
+    cout << "  -c  Compare results in this baseline file with results in"
+         << endl;
+    cout << "      the -r file instead of running benchmarks." << endl;
+    cout << "  -h  Write comparison to this HTML file.  Default is "
+         << s_defaultCompareFile << "." << endl;
+    cout << "  -?  Show this help information." << endl;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Reads performance counters and clock at start of a sample.
+inline clock_t StartSample( void )
+{
+    ut::UnitTestSet::GetIt().ReadCounters( s_startCounts );
+    return ::clock();
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns elapsed processor time in seconds since the given clock reading.
+inline double GetSecondsSince( clock_t start )
+{
+    const clock_t stop = ::clock();
+    return static_cast< double >( stop - start ) / CLOCKS_PER_SEC;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Appends one line of results to result file.
+void WriteResult( const BenchmarkArgs & args, unsigned int sample,
+    unsigned int count, double seconds )
+{
+    const ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    double counts[ ut::UnitTest::CounterCount ];
+    uts.ReadCounters( counts );
+    FILE * file = ::fopen( args.GetResultFile(), "a" );
+    if ( NULL == file )
+        return;
+    const unsigned int outputs = args.GetOutputs();
+    const double rate = ( 0.0 < seconds ) ? ( count / seconds ) : 0.0;
+    ::fprintf( file, "%s,%d,%d,%d,%d,%d,%d,%u,%u,%.6f,%.1f",
+        args.GetBenchmark(),
+        ( 0 != ( outputs & s_usePasses ) ),
+        ( 0 != ( outputs & s_useWarnings ) ),
+        ( 0 != ( outputs & s_useCout ) ),
+        ( 0 != ( outputs & s_useText ) ),
+        ( 0 != ( outputs & s_useHtml ) ),
+        ( 0 != ( outputs & s_useXml ) ),
+        sample, count, seconds, rate );
+    // Counter names share one column, split by slashes, so the columns after
+    // it mean the same thing on every line no matter which counters opened.
+    string names;
+    for ( unsigned int ii = 0; ii < ut::UnitTest::CounterCount; ++ii )
+    {
+        const char * name = uts.GetCounterName( ii );
+        if ( 0 != ii )
+            names += '/';
+        names += ( NULL != name ) ? name : "-";
+    }
+    ::fprintf( file, ",%s", names.c_str() );
+    for ( unsigned int ii = 0; ii < ut::UnitTest::CounterCount; ++ii )
+        ::fprintf( file, ",%.0f", counts[ ii ] - s_startCounts[ ii ] );
+    ::fprintf( file, "\n" );
+    ::fclose( file );
+}
+
+// ----------------------------------------------------------------------------
+
+/** Creates UnitTestSet singleton with output chosen by parameters.  The
+ summary table is always on since output files are closed only when the table
+ is done, and each sample ends with a summary.
+ */
+bool CreateUnitTestSet( const BenchmarkArgs & args )
+{
+    const unsigned int outputs = args.GetOutputs();
+    unsigned int options = ut::UnitTestSet::SummaryTable;
+    if ( 0 != ( outputs & s_usePasses ) )
+        options |= ut::UnitTestSet::Passes;
+    if ( 0 != ( outputs & s_useWarnings ) )
+        options |= ut::UnitTestSet::Warnings;
+    if ( 0 != ( outputs & s_useCout ) )
+        options |= ut::UnitTestSet::SendToCout;
+    if ( args.DoReadCounters() )
+        options |= ut::UnitTestSet::Counters;
+    const char * textFile = ( 0 != ( outputs & s_useText ) )
+        ? s_partialName : NULL;
+    const char * htmlFile = ( 0 != ( outputs & s_useHtml ) )
+        ? s_partialName : NULL;
+    const char * xmlFile = ( 0 != ( outputs & s_useXml ) )
+        ? s_partialName : NULL;
+
+    const ut::UnitTestSet::ErrorState status = ut::UnitTestSet::Create(
+        "Benchmark", textFile, htmlFile, xmlFile,
+        static_cast< ut::UnitTestSet::OutputOptions >( options ), false );
+    return ( ut::UnitTestSet::Success == status );
+}
+
+// ----------------------------------------------------------------------------
+
+/** Measures calls to UnitTest::DoTest.  Three of every four items pass, and
+ the fourth is a failed warning, so the Passes and Warnings options both matter.
+ */
+void BenchmarkDoTest( const BenchmarkArgs & args )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    const unsigned int count = args.GetCount();
+    for ( unsigned int sample = 1; sample <= args.GetSamples(); ++sample )
+    {
+        ut::UnitTest * u = uts.AddUnitTest( "DoTest Benchmark" );
+        const clock_t start = StartSample();
+        for ( unsigned int ii = 0; ii < count; ++ii )
+        {
+            if ( 3 == ( ii & 3 ) )
+            {
+                UNIT_TEST_WARN( u, ii == count );
+            }
+            else
+            {
+                UNIT_TEST( u, ii < count );
+            }
+        }
+        const double seconds = GetSecondsSince( start );
+        WriteResult( args, sample, count, seconds );
+        uts.OutputSummary();
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+/// Makes unique names for UnitTest's so names don't need allocation in loop.
+void MakeNames( string * names, unsigned int count )
+{
+    char buffer[ 32 ];
+    for ( unsigned int ii = 0; ii < count; ++ii )
+    {
+        ::sprintf( buffer, "Benchmark Test %u", ii );
+        names[ ii ] = buffer;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+/// Measures time needed to add count UnitTest's with different names.
+void BenchmarkAddUnitTest( const BenchmarkArgs & args, unsigned int count )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    string * names = new string[ count ];
+    MakeNames( names, count );
+    for ( unsigned int sample = 1; sample <= args.GetSamples(); ++sample )
+    {
+        const clock_t start = StartSample();
+        for ( unsigned int ii = 0; ii < count; ++ii )
+        {
+            uts.AddUnitTest( names[ ii ].c_str() );
+        }
+        const double seconds = GetSecondsSince( start );
+        WriteResult( args, sample, count, seconds );
+        uts.OutputSummary();
+    }
+    delete [] names;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Measures time needed to make a summary table for many UnitTest's.
+void BenchmarkOutputSummary( const BenchmarkArgs & args )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    string * names = new string[ s_unitTestCount ];
+    MakeNames( names, s_unitTestCount );
+    for ( unsigned int sample = 1; sample <= args.GetSamples(); ++sample )
+    {
+        for ( unsigned int ii = 0; ii < s_unitTestCount; ++ii )
+        {
+            ut::UnitTest * u = uts.AddUnitTest( names[ ii ].c_str() );
+            UNIT_TEST( u, ii < s_unitTestCount );
+        }
+        const clock_t start = StartSample();
+        uts.OutputSummary();
+        const double seconds = GetSecondsSince( start );
+        WriteResult( args, sample, s_unitTestCount, seconds );
+    }
+    delete [] names;
+}
+
+// ----------------------------------------------------------------------------
+
+/** Measures time needed to make a summary when the main html page already has
+ a long history of previous results.  Each summary adds another row to that
+ history, so the first summaries fill the history before timing starts.
+ */
+void BenchmarkMainPage( const BenchmarkArgs & args )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    for ( unsigned int ii = 0; ii < s_historyCount; ++ii )
+    {
+        ut::UnitTest * u = uts.AddUnitTest( "Main Page Benchmark" );
+        UNIT_TEST( u, ii < s_historyCount );
+        uts.OutputSummary();
+    }
+    for ( unsigned int sample = 1; sample <= args.GetSamples(); ++sample )
+    {
+        ut::UnitTest * u = uts.AddUnitTest( "Main Page Benchmark" );
+        UNIT_TEST( u, 0 < sample );
+        const clock_t start = StartSample();
+        uts.OutputSummary();
+        const double seconds = GetSecondsSince( start );
+        WriteResult( args, sample, 1, seconds );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+/// Runs this program again in another process for a single benchmark.
+bool RunChild( const BenchmarkArgs & args, const char * benchmark,
+    unsigned int outputs )
+{
+    char options[ 64 ];
+    ::sprintf( options, " -b:%s -o:%02X -n:%u -s:%u", benchmark, outputs,
+        args.GetCount(), args.GetSamples() );
+    string command( "\"" );
+    command += args.GetExeName();
+    command += "\"";
+    command += options;
+    command += " \"-r:";
+    command += args.GetResultFile();
+    command += "\"";
+    if ( args.DoReadCounters() )
+        command += " -p";
+    command += " > ";
+    command += s_childOutputFile;
+    cout << benchmark << " " << ( options + 1 ) << endl;
+    return ( 0 == ::system( command.c_str() ) );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Runs every benchmark with every combination of outputs.
+int RunAllBenchmarks( const BenchmarkArgs & args )
+{
+    FILE * file = ::fopen( args.GetResultFile(), "r" );
+    if ( NULL == file )
+    {
+        file = ::fopen( args.GetResultFile(), "w" );
+        if ( NULL == file )
+        {
+            cout << "Unable to open " << args.GetResultFile() << endl;
+            return 2;
+        }
+        ::fprintf( file, "%s\n", s_resultHeader );
+    }
+    ::fclose( file );
+
+    bool okay = true;
+    for ( unsigned int outputs = 0; outputs <= s_useAll; ++outputs )
+    {
+        okay &= RunChild( args, "DoTest", outputs );
+    }
+    okay &= RunChild( args, "AddUnitTest", 0 );
+    okay &= RunChild( args, "AddManyUnitTests", 0 );
+    okay &= RunChild( args, "OutputSummary", s_useText | s_useHtml | s_useXml );
+    okay &= RunChild( args, "MainPage", s_useHtml );
+    return okay ? 0 : 1;
+}
+
+// ----------------------------------------------------------------------------
+
+/** @struct BenchmarkSamples
+ @brief Samples of one benchmark with one set of output options, from both
+  result files being compared.
+ */
+struct BenchmarkSamples
+{
+    string m_name;                 ///< Name of benchmark.
+    string m_outputs;              ///< Output options, as in result file.
+    vector< double > m_baseline;   ///< Microseconds per operation.
+    vector< double > m_candidate;  ///< Microseconds per operation.
+};
+
+typedef vector< BenchmarkSamples > TBenchmarkSamples;
+
+// ----------------------------------------------------------------------------
+
+/** Adds samples from a result file to the list, keeping benchmarks in the order
+ they first appear.
+ @return False if file could not be read.
+ */
+bool ReadSamples( const char * filename, bool isBaseline,
+    TBenchmarkSamples & samples )
+{
+    FILE * file = ::fopen( filename, "r" );
+    if ( NULL == file )
+        return false;
+    char line[ 512 ];
+    while ( NULL != ::fgets( line, sizeof(line), file ) )
+    {
+        // Fields are benchmark, 6 output flags, sample, count, and seconds.
+        const char * fields[ 10 ];
+        unsigned int fieldCount = 0;
+        char * place = line;
+        while ( fieldCount < 10 )
+        {
+            fields[ fieldCount++ ] = place;
+            place = ::strchr( place, ',' );
+            if ( NULL == place )
+                break;
+            *place++ = '\0';
+        }
+        if ( fieldCount < 10 )
+            continue;
+        const double count = ::strtod( fields[ 8 ], NULL );
+        char * end = NULL;
+        const double seconds = ::strtod( fields[ 9 ], &end );
+        // This skips the header line along with any damaged lines.
+        if ( ( count <= 0.0 ) || ( end == fields[ 9 ] ) )
+            continue;
+        string outputs( fields[ 1 ] );
+        for ( unsigned int ii = 2; ii < 7; ++ii )
+        {
+            outputs += ',';
+            outputs += fields[ ii ];
+        }
+        TBenchmarkSamples::iterator it( samples.begin() );
+        for ( ; it != samples.end(); ++it )
+        {
+            if ( ( it->m_name == fields[ 0 ] ) && ( it->m_outputs == outputs ) )
+                break;
+        }
+        if ( it == samples.end() )
+        {
+            samples.push_back( BenchmarkSamples() );
+            it = samples.end() - 1;
+            it->m_name = fields[ 0 ];
+            it->m_outputs = outputs;
+        }
+        const double micro = seconds * 1000000.0 / count;
+        if ( isBaseline )
+            it->m_baseline.push_back( micro );
+        else
+            it->m_candidate.push_back( micro );
+    }
+    ::fclose( file );
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns a change in microseconds as a signed percent of baseline median.
+string MakePercent( double change, double baseline )
+{
+    char text[ 32 ];
+    if ( 0.0 < baseline )
+        ::sprintf( text, "%+.1f%%", change * 100.0 / baseline );
+    else
+        ::sprintf( text, "%+.3f us", change );
+    return string( text );
+}
+
+// ----------------------------------------------------------------------------
+
+/** Writes comparison of each benchmark to HTML file, in same colors and layout
+ as the summary tables made by the library.
+ @param[out] regressions # of benchmarks that regressed.
+ @param[out] improvements # of benchmarks that improved.
+ @return False if file could not be made.
+ */
+bool WriteComparison( const BenchmarkArgs & args,
+    const TBenchmarkSamples & samples, unsigned int & regressions,
+    unsigned int & improvements )
+{
+    FILE * file = ::fopen( args.GetCompareFile(), "w" );
+    if ( NULL == file )
+        return false;
+    ::fprintf( file, "<html><head><title>Benchmark Comparison</title></head>\n"
+        "<body bgcolor=black text=white>\n"
+        "<br><table border=1 cellspacing=0 cellpadding=3>\n"
+        "<caption><em>Benchmark Comparison of %s and %s</em></caption>\n"
+        "<tr><th>Result</th><th>Benchmark</th><th>Outputs</th>"
+        "<th>Baseline<br>Samples</th><th>Candidate<br>Samples</th>"
+        "<th>Baseline<br>Median us</th><th>Candidate<br>Median us</th>"
+        "<th>Change</th><th>%.0f%% Interval</th><th>p</th></tr>\n",
+        args.GetBaselineFile(), args.GetResultFile(), s_confidence * 100.0 );
+
+    for ( TBenchmarkSamples::const_iterator it( samples.begin() );
+        it != samples.end(); ++it )
+    {
+        const BenchmarkSamples & one = *it;
+        const ut::SampleComparison comparison(
+            one.m_baseline.empty() ? NULL : &one.m_baseline[ 0 ],
+            static_cast< unsigned int >( one.m_baseline.size() ),
+            one.m_candidate.empty() ? NULL : &one.m_candidate[ 0 ],
+            static_cast< unsigned int >( one.m_candidate.size() ),
+            s_confidence );
+        const ut::SampleComparison::Verdict verdict = comparison.GetVerdict();
+        const char * color = "white";
+        if ( ut::SampleComparison::Regressed == verdict )
+        {
+            color = "red";
+            ++regressions;
+        }
+        else if ( ut::SampleComparison::Improved == verdict )
+        {
+            color = "green";
+            ++improvements;
+        }
+        else if ( ut::SampleComparison::TooFewSamples == verdict )
+            color = "gray";
+        const double median = comparison.GetBaselineMedian();
+        ::fprintf( file, "<tr><td><span style=\"color: %s\">%s</span></td>"
+            "<td>%s</td><td>%s</td><th>%u</th><th>%u</th>"
+            "<th>%.4f</th><th>%.4f</th>",
+            color, ut::SampleComparison::GetVerdictName( verdict ),
+            one.m_name.c_str(), one.m_outputs.c_str(),
+            static_cast< unsigned int >( one.m_baseline.size() ),
+            static_cast< unsigned int >( one.m_candidate.size() ),
+            median, comparison.GetCandidateMedian() );
+        if ( ut::SampleComparison::TooFewSamples == verdict )
+        {
+            ::fprintf( file, "<th>-</th><th>-</th><th>-</th></tr>\n" );
+            continue;
+        }
+        ::fprintf( file, "<th><span style=\"color: %s\">%s</span></th>"
+            "<th>%s to %s</th><th>%.4f</th></tr>\n", color,
+            MakePercent( comparison.GetShift(), median ).c_str(),
+            MakePercent( comparison.GetLowerBound(), median ).c_str(),
+            MakePercent( comparison.GetUpperBound(), median ).c_str(),
+            comparison.GetProbability() );
+    }
+
+    ::fprintf( file, "</table><br>\n</body>\n</html>\n" );
+    ::fclose( file );
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Compares baseline result file with -r result file.
+int CompareResultFiles( const BenchmarkArgs & args )
+{
+    TBenchmarkSamples samples;
+    if ( !ReadSamples( args.GetBaselineFile(), true, samples ) )
+    {
+        cout << "Unable to read " << args.GetBaselineFile() << endl;
+        return 2;
+    }
+    if ( !ReadSamples( args.GetResultFile(), false, samples ) )
+    {
+        cout << "Unable to read " << args.GetResultFile() << endl;
+        return 2;
+    }
+    unsigned int regressions = 0;
+    unsigned int improvements = 0;
+    if ( !WriteComparison( args, samples, regressions, improvements ) )
+    {
+        cout << "Unable to write " << args.GetCompareFile() << endl;
+        return 2;
+    }
+    cout << samples.size() << " benchmarks compared: " << regressions
+         << " regressed, " << improvements << " improved.  See "
+         << args.GetCompareFile() << endl;
+    return ( 0 == regressions ) ? 0 : 1;
+}
+
+// ----------------------------------------------------------------------------
+
+} // end anonymous namespace
+
+// ----------------------------------------------------------------------------
+
+int main( int argc, const char * const argv[] )
+{
+
+    const BenchmarkArgs args( static_cast< unsigned int >( argc ), argv );
+    if ( !args.IsValid() )
+    {
+        cout << "Your command line arguements are invalid!" << endl;
+        args.ShowHelp();
+        return 1;
+    }
+    if ( args.DoShowHelp() )
+    {
+        args.ShowHelp();
+        return 0;
+    }
+
+    if ( NULL != args.GetBaselineFile() )
+    {
+        return CompareResultFiles( args );
+    }
+
+    const char * benchmark = args.GetBenchmark();
+    if ( NULL == benchmark )
+    {
+        return RunAllBenchmarks( args );
+    }
+
+    if ( !CreateUnitTestSet( args ) )
+    {
+        cout << "An error occurred when creating the UnitTestSet singleton!"
+             << endl;
+        return 2;
+    }
+
+    if ( ::strcmp( benchmark, "DoTest" ) == 0 )
+        BenchmarkDoTest( args );
+    else if ( ::strcmp( benchmark, "AddUnitTest" ) == 0 )
+        BenchmarkAddUnitTest( args, s_unitTestCount );
+    else if ( ::strcmp( benchmark, "AddManyUnitTests" ) == 0 )
+        BenchmarkAddUnitTest( args, s_manyUnitTestCount );
+    else if ( ::strcmp( benchmark, "OutputSummary" ) == 0 )
+        BenchmarkOutputSummary( args );
+    else if ( ::strcmp( benchmark, "MainPage" ) == 0 )
+        BenchmarkMainPage( args );
+    else
+    {
+        cout << "Unknown benchmark: " << benchmark << endl;
+        args.ShowHelp();
+        return 1;
+    }
+
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,162 @@
+// ----------------------------------------------------------------------------
+// The C++ Unit Test Library
+// Copyright (c) 2007 by Rich Sposato
+//
+// Permission to use, copy, modify, distribute and sell this software for any
+// purpose is hereby granted under the terms stated in the GNU Library Public
+// License, provided that the above copyright notice appear in all copies and
+// that both that copyright notice and this permission notice appear in
+// supporting documentation.
+//
+// ----------------------------------------------------------------------------
+
+/** @file embedded.cpp Checks the interrupt recording path of the embedded
+ version of the library.  Items recorded through an InterruptContext must not
+ reach the UnitTest or receiver until they are pumped, a full ring must drop
+ and count items instead of blocking, and pumped items must arrive in order.
+ This program returns zero if every check passed.
+ */
+
+// ----------------------------------------------------------------------------
+
+#include "UnitTest_E.hpp"
+
+#include <stdio.h>
+
+
+// ----------------------------------------------------------------------------
+
+/// Counts how many checks of this program failed.
+static unsigned int s_failures = 0;
+
+/// Notes a failed check of this program, since the library under test can't.
+#define EMBEDDED_CHECK( test ) \
+    if ( !( test ) ) \
+    { \
+        ++s_failures; \
+        ::printf( "%s(%d) : failed : %s\n", __FILE__, __LINE__, #test ); \
+    }
+
+// ----------------------------------------------------------------------------
+
+/** @class LineCounter
+ @brief Receiver which counts test lines it gets, and remembers the lines of
+  source code, so the order of pumped items can be checked.
+ */
+class LineCounter : public ut::UnitTestResultReceiver
+{
+public:
+
+    LineCounter( void ) : m_lineCount( 0 ), m_failCount( 0 ) {}
+
+    virtual ~LineCounter( void ) {}
+
+    virtual bool ShowTestLine( const ut::UnitTest * test,
+        ut::TestResult::EnumType result, const char * fileName,
+        unsigned int line, const char * expression, const char * message )
+    {
+        (void)test;
+        (void)fileName;
+        (void)expression;
+        (void)message;
+        if ( m_lineCount < static_cast< unsigned int >( MaxLines ) )
+            m_lines[ m_lineCount ] = line;
+        ++m_lineCount;
+        if ( ut::TestResult::Failed == result )
+            ++m_failCount;
+        return true;
+    }
+
+    enum { MaxLines = 16 };
+
+    unsigned int m_lineCount;
+    unsigned int m_failCount;
+    unsigned int m_lines[ MaxLines ];
+};
+
+// ----------------------------------------------------------------------------
+
+/// Stands in for an interrupt handler which checks what it was given.
+void FakeInterruptHandler( ut::InterruptContext * context, ut::UnitTest * u,
+    int value )
+{
+    UNIT_TEST_ISR( context, u, value < 10 );
+}
+
+// ----------------------------------------------------------------------------
+
+void InterruptTest( LineCounter & counter )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    ut::UnitTest * u = uts.AddUnitTest( "Interrupt Test" );
+    ut::InterruptContext * context = uts.AddInterruptContext( 4 );
+    EMBEDDED_CHECK( NULL != context );
+    EMBEDDED_CHECK( NULL == uts.AddInterruptContext( 0 ) );
+    EMBEDDED_CHECK( 4 == context->GetCapacity() );
+
+    // Nothing reaches the UnitTest or receiver until items are pumped.
+    FakeInterruptHandler( context, u, 1 );
+    FakeInterruptHandler( context, u, 20 );
+    FakeInterruptHandler( context, u, 3 );
+    EMBEDDED_CHECK( 3 == context->GetRecordCount() );
+    EMBEDDED_CHECK( 1 == context->GetFailCount() );
+    EMBEDDED_CHECK( 0 == u->GetItemCount() );
+    EMBEDDED_CHECK( 0 == counter.m_lineCount );
+
+    // Fifth item does not fit, so it is dropped rather than waiting.
+    FakeInterruptHandler( context, u, 4 );
+    FakeInterruptHandler( context, u, 50 );
+    EMBEDDED_CHECK( 4 == context->GetRecordCount() );
+    EMBEDDED_CHECK( 1 == context->GetDropCount() );
+
+    EMBEDDED_CHECK( 4 == uts.PumpInterruptEvents() );
+    EMBEDDED_CHECK( 0 == uts.PumpInterruptEvents() );
+    EMBEDDED_CHECK( 4 == u->GetItemCount() );
+    EMBEDDED_CHECK( 1 == u->GetFailCount() );
+    EMBEDDED_CHECK( 1 == counter.m_failCount );
+
+    // Ring wraps around, and items keep the order they were recorded in.
+    // Each item gets its own line # so the receiver can tell them apart.
+    const unsigned int first = counter.m_lineCount;
+    for ( unsigned int ii = 0; ii < 6; ++ii )
+    {
+        context->Record( u, __FILE__, 100 + ii, u->Checked, true,
+            "ordered", NULL );
+        if ( 1 == ii % 2 )
+            EMBEDDED_CHECK( 2 == uts.PumpInterruptEvents() );
+    }
+    EMBEDDED_CHECK( 10 == context->GetRecordCount() );
+    EMBEDDED_CHECK( 1 == context->GetDropCount() );
+    EMBEDDED_CHECK( 10 == u->GetItemCount() );
+    EMBEDDED_CHECK( first + 6 == counter.m_lineCount );
+    const unsigned int last = LineCounter::MaxLines;
+    for ( unsigned int ii = 0; ( ii < 6 ) && ( first + ii < last ); ++ii )
+        EMBEDDED_CHECK( 100 + ii == counter.m_lines[ first + ii ] );
+}
+
+// ----------------------------------------------------------------------------
+
+int main( void )
+{
+    static LineCounter counter;
+    const ut::UnitTestSet::ErrorState status = ut::UnitTestSet::Create(
+        "Embedded Tests", &counter, ut::UnitTestSet::Passes, false );
+    if ( ut::UnitTestSet::Success != status )
+    {
+        ::printf( "The UnitTestSet singleton could not be created.\n" );
+        return 2;
+    }
+
+    InterruptTest( counter );
+    ut::UnitTestSet::GetIt().OutputSummary();
+
+    if ( 0 != s_failures )
+    {
+        ::printf( "%u checks failed.\n", s_failures );
+        return 1;
+    }
+    ::printf( "All checks passed.\n" );
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
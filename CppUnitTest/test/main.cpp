@@ -18,6 +18,12 @@
 #include "UnitTest.hpp"
 
 #include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <fstream>
 #include <iostream>
 
 #include "Thingy.hpp"
@@ -242,15 +248,1007 @@ void EmptyThingyTest( void )
 
 // ----------------------------------------------------------------------------
 
-void FatalThingyTest( void )
+void DependentThingyBody( ut::UnitTest * u )
+{
+    Thingy justOne( 1 );
+    // This never runs since the prerequisite fails.
+    UNIT_TEST( u, !justOne.IsZero() );
+}
+
+// ----------------------------------------------------------------------------
+
+void BaseThingyBody( ut::UnitTest * u )
+{
+    Thingy base( 2 );
+    UNIT_TEST( u, 2 == base.GetSize() );
+}
+
+// ----------------------------------------------------------------------------
+
+void BuiltOnThingyBody( ut::UnitTest * u )
+{
+    // This runs since the prerequisite passes.
+    Thingy builtOn( 3 );
+    UNIT_TEST( u, !builtOn.IsZero() );
+}
+
+// ----------------------------------------------------------------------------
+
+void CycleThingyBody( ut::UnitTest * u )
+{
+    // This never runs since the two UnitTest's wait for each other.
+    UNIT_TEST( u, false );
+}
+
+// ----------------------------------------------------------------------------
+
+void DependencyTest( void )
 {
     ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
-    ut::UnitTest * u = uts.AddUnitTest ("Fatal Thingy Test");
+    ut::UnitTest * u = uts.AddUnitTest( "Dependency Checks" );
+    UNIT_TEST( u, uts.RegisterUnitTest( "Dependent Thingy Test",
+        DependentThingyBody ) );
+    UNIT_TEST( u, !uts.RegisterUnitTest( "Dependent Thingy Test",
+        DependentThingyBody ) );
+    uts.AddDependency( "Dependent Thingy Test", "Test 2 Thingys" );
+
+    // Registered after its dependent, but still runs first.
+    uts.RegisterUnitTest( "Built On Thingy Test", BuiltOnThingyBody );
+    uts.RegisterUnitTest( "Base Thingy Test", BaseThingyBody );
+    uts.AddDependency( "Built On Thingy Test", "Base Thingy Test" );
+
+    uts.RegisterUnitTest( "Cycle Thingy Test A", CycleThingyBody );
+    uts.RegisterUnitTest( "Cycle Thingy Test B", CycleThingyBody );
+    uts.AddDependency( "Cycle Thingy Test A", "Cycle Thingy Test B" );
+    uts.AddDependency( "Cycle Thingy Test B", "Cycle Thingy Test A" );
+    UNIT_TEST( u, !uts.RunUnitTests() );
+
+    const ut::UnitTest * builtOn = uts.GetUnitTest( "Built On Thingy Test" );
+    UNIT_TEST( u, NULL != builtOn );
+    if ( NULL != builtOn )
+    {
+        UNIT_TEST( u, 1 == builtOn->GetPassCount() );
+        UNIT_TEST( u, !builtOn->WasSkipped() );
+    }
+    const ut::UnitTest * dependent = uts.GetUnitTest( "Dependent Thingy Test" );
+    UNIT_TEST( u, ( NULL != dependent ) && dependent->WasSkipped() );
+    const char * const cycle[] =
+        { "Cycle Thingy Test A", "Cycle Thingy Test B" };
+    for ( unsigned int ii = 0; ii < 2; ++ii )
+    {
+        const ut::UnitTest * test = uts.GetUnitTest( cycle[ ii ] );
+        UNIT_TEST( u, NULL != test );
+        if ( NULL != test )
+        {
+            UNIT_TEST( u, 1 == test->GetSkipCount() );
+            UNIT_TEST( u, 0 == test->GetFailCount() );
+        }
+    }
+
+    // Registrations were used up, so the same names may be registered again.
+    UNIT_TEST( u, uts.RegisterUnitTest( "Base Thingy Test", BaseThingyBody ) );
+    UNIT_TEST( u, uts.RunUnitTests() );
+}
+
+// ----------------------------------------------------------------------------
+
+void LeaveWithMessage( void )
+{
+    cerr << "Thingy is leaving now." << endl;
+    ::exit( 3 );
+}
+
+// ----------------------------------------------------------------------------
+
+void AbortingThingyBody( ut::UnitTest * u )
+{
+    Thingy empty;
+    UNIT_TEST_DEATH( u, ::abort(), "" );
+    UNIT_TEST( u, empty.IsZero() );
+}
+
+// ----------------------------------------------------------------------------
+
+void ExitingThingyBody( ut::UnitTest * u )
+{
+    UNIT_TEST_EXIT( u, LeaveWithMessage(), 3, "leaving" );
+}
+
+// ----------------------------------------------------------------------------
+
+void WrongDeathThingyBody( ut::UnitTest * u )
+{
+    // Each of these is expected to fail.
+    Thingy living( 1 );
+    UNIT_TEST_DEATH( u, living.SetSize( 2 ), "" );
+    UNIT_TEST_EXIT( u, LeaveWithMessage(), 4, "leaving" );
+    UNIT_TEST_EXIT( u, LeaveWithMessage(), 3, "staying" );
+}
+
+// ----------------------------------------------------------------------------
+
+void DeathTest( void )
+{
+    // Neither depends on the other, so both children may run at once.
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    uts.RegisterUnitTest( "Aborting Thingy Test", AbortingThingyBody );
+    uts.RegisterUnitTest( "Exiting Thingy Test", ExitingThingyBody );
+    uts.RunUnitTests();
+
+    // A statement which returns, a wrong exit code, and output which does
+    // not match the pattern must each fail.
+    ut::UnitTest * u = uts.AddUnitTest( "Death Checks" );
+    UNIT_TEST( u, !uts.RunUnitTest( "Wrong Death Thingy Test",
+        WrongDeathThingyBody ) );
+    const ut::UnitTest * wrong = uts.GetUnitTest( "Wrong Death Thingy Test" );
+    UNIT_TEST( u, NULL != wrong );
+    if ( NULL != wrong )
+    {
+        UNIT_TEST( u, 3 == wrong->GetFailCount() );
+        UNIT_TEST( u, 0 == wrong->GetPassCount() );
+        UNIT_TEST( u, 0 == wrong->GetExceptionCount() );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+ut::AsyncWait AsyncThingyBody( ut::UnitTest * u, void * state, bool timedOut )
+{
+    // Each call does one step, and state remembers how many were done.
+    unsigned int & step = *static_cast< unsigned int * >( state );
+    Thingy counted( static_cast< int >( step ) );
+    UNIT_TEST( u, !timedOut );
+    UNIT_TEST( u, counted.IsZero() == ( 0 == step ) );
+    ++step;
+    return ( step < 3 ) ? ut::AsyncWait::After( 20 ) : ut::AsyncWait::Done();
+}
+
+// ----------------------------------------------------------------------------
+
+void AsyncTest( void )
+{
+    // Both bodies wait at the same time, so this takes about as long as one.
+    static unsigned int firstStep = 0;
+    static unsigned int secondStep = 0;
+    firstStep = 0;
+    secondStep = 0;
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    uts.RegisterAsyncUnitTest( "First Async Thingy Test", AsyncThingyBody,
+        &firstStep );
+    uts.RegisterAsyncUnitTest( "Second Async Thingy Test", AsyncThingyBody,
+        &secondStep );
+    uts.RunAsyncUnitTests();
+}
+
+// ----------------------------------------------------------------------------
+
+/// Waits longer after each failed try, as retry code often does.
+unsigned int GrowThingy( ut::Clock & clock, Thingy & thingy, int size )
+{
+    unsigned int tries = 0;
+    double delay = 1.0;
+    for ( int ii = 0; ii < size; ++ii )
+    {
+        ++tries;
+        clock.Sleep( delay );
+        delay *= 2.0;
+    }
+    thingy = Thingy( size );
+    return tries;
+}
+
+// ----------------------------------------------------------------------------
+
+void VirtualClockThingyBody( ut::UnitTest * u )
+{
+    ut::Clock & clock = ut::UnitTestSet::GetIt().GetClock();
+    const double start = clock.GetSeconds();
+    Thingy grown;
+    UNIT_TEST( u, 8 == GrowThingy( clock, grown, 8 ) );
+    UNIT_TEST( u, !grown.IsZero() );
+    // Waits of 1, 2, 4, ... 128 seconds take no real time.
+    UNIT_TEST( u, 255.0 == clock.GetSeconds() - start );
+}
+
+// ----------------------------------------------------------------------------
+
+void VirtualClockTest( void )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    uts.SetVirtualClock( true );
+    uts.RunUnitTest( "Virtual Clock Thingy Test", VirtualClockThingyBody );
+    // Time after the body ends does not belong to its UnitTest.
+    uts.GetClock().Sleep( 100.0 );
+    uts.SetVirtualClock( false );
+
+    ut::UnitTest * u = uts.AddUnitTest( "Virtual Clock Checks" );
+    const ut::UnitTest * test = uts.GetUnitTest( "Virtual Clock Thingy Test" );
+    UNIT_TEST( u, ( NULL != test ) && ( 255.0 == test->GetVirtualTime() ) );
+}
+
+// ----------------------------------------------------------------------------
+
+/** @class FailureKeeper
+ @brief Receiver which keeps the message of each failed item, so a test can
+  check what the library said about a failure.
+ */
+class FailureKeeper : public ::ut::UnitTestResultReceiver
+{
+public:
+
+    virtual bool ShowTestLine( const ut::UnitTest * test,
+        ::ut::TestResult::EnumType result, const char * fileName,
+        unsigned int line, const char * expression, const char * message )
+    {
+        (void)test;
+        (void)fileName;
+        (void)line;
+        (void)expression;
+        if ( ut::TestResult::Failed == result )
+            m_messages.push_back( ( NULL == message ) ? "" : message );
+        return true;
+    }
+
+    vector< string > m_messages;
+};
+
+// ----------------------------------------------------------------------------
+
+void MemoryThingyBody( ut::UnitTest * u )
+{
+    // Each page becomes resident only once something is written to it.
+    const unsigned int size = 4 * 1024 * 1024;
+    char * block = new char[ size ];
+    for ( unsigned int ii = 0; ii < size; ii += 1024 )
+        block[ ii ] = static_cast< char >( ii + 1 );
+    UNIT_TEST( u, 0 != block[ 1024 ] );
+    UNIT_TEST_MEMORY_BUDGET( u, 64 * 1024 );
+    delete [] block;
+}
+
+// ----------------------------------------------------------------------------
+
+void MemoryTest( void )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    uts.RunUnitTest( "Memory Thingy Test", MemoryThingyBody );
+
+#if defined( __linux__ )
+    // Growth before the first budget check of the program counts, even
+    // without the Memory option, so this budget is expected to fail.
+    FailureKeeper keeper;
+    uts.AddReceiver( &keeper );
+    ut::UnitTest * over = uts.AddUnitTest( "Over Budget Thingy" );
+    UNIT_TEST( over, NULL != over );
+    const unsigned int size = 16 * 1024 * 1024;
+    vector< char > block( size, 1 );
+    UNIT_TEST( over, 1 == block[ size / 2 ] );
+    UNIT_TEST_MEMORY_BUDGET( over, 1024 );
+    uts.RemoveReceiver( &keeper );
+
+    ut::UnitTest * u = uts.AddUnitTest( "Memory Checks" );
+    long growth = 0;
+    UNIT_TEST( u, 1 == keeper.m_messages.size() );
+    UNIT_TEST( u, ( !keeper.m_messages.empty() ) && ( 1 == ::sscanf(
+        keeper.m_messages[ 0 ].c_str(), "Resident memory grew by %ld KB",
+        &growth ) ) );
+    // Some pages may have been resident already, so allow for those.
+    UNIT_TEST( u, 8 * 1024 <= growth );
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+void LatencyThingyBody( ut::UnitTest * u )
+{
+    Thingy thingy( 3 );
+    ut::LatencyHistogram histogram;
+    UNIT_TEST_LATENCY_RUN( histogram, 10000,
+        thingy.SetSize( thingy.GetSize() + 1 ) );
+    UNIT_TEST( u, 10003 == thingy.GetSize() );
+    UNIT_TEST_PERCENTILE( u, histogram, 50.0, 2.0e-6 );
+    UNIT_TEST_PERCENTILE( u, histogram, 99.0, 50.0e-6 );
+    // This fails on purpose to show the histogram summary in its message.
+    UNIT_TEST_PERCENTILE( u, histogram, 99.99, 1.0e-9 );
+    UNIT_TEST_LATENCY( u, thingy.IsZero(), 1000, 99.0, 1.0e-3 );
+}
+
+// ----------------------------------------------------------------------------
+
+void LatencyTest( void )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    uts.RunUnitTest( "Latency Thingy Test", LatencyThingyBody );
+}
+
+// ----------------------------------------------------------------------------
+
+void ComparisonThingyBody( ut::UnitTest * u )
+{
+    // Every candidate costs more than every baseline, so U is 0, and the
+    // exact two-sided chance is 2 of the 252 ways to pick 5 of 10 ranks.
+    const double faster[] = { 1.0, 2.0, 3.0, 4.0, 5.0 };
+    const double slower[] = { 6.0, 7.0, 8.0, 9.0, 10.0 };
+    const ut::SampleComparison regressed( faster, 5, slower, 5, 0.95 );
+    UNIT_TEST( u, ut::SampleComparison::Regressed == regressed.GetVerdict() );
+    UNIT_TEST( u, 0.0 == regressed.GetU() );
+    UNIT_TEST( u, ::fabs( regressed.GetProbability() - 2.0 / 252.0 ) < 1.0e-9 );
+    UNIT_TEST( u, 5.0 == regressed.GetShift() );
+
+    const ut::SampleComparison improved( slower, 5, faster, 5, 0.95 );
+    UNIT_TEST( u, ut::SampleComparison::Improved == improved.GetVerdict() );
+    UNIT_TEST( u, -5.0 == improved.GetShift() );
+
+    const ut::SampleComparison same( faster, 5, faster, 5, 0.95 );
+    UNIT_TEST( u, ut::SampleComparison::Unchanged == same.GetVerdict() );
+    UNIT_TEST( u, 0.0 == same.GetShift() );
+
+    const double constant[] = { 3.0, 3.0, 3.0, 3.0, 3.0 };
+    const ut::SampleComparison tied( constant, 5, constant, 5, 0.95 );
+    UNIT_TEST( u, ut::SampleComparison::Unchanged == tied.GetVerdict() );
+
+    const ut::SampleComparison few( faster, 1, slower, 5, 0.95 );
+    UNIT_TEST( u, ut::SampleComparison::TooFewSamples == few.GetVerdict() );
+}
+
+// ----------------------------------------------------------------------------
+
+void ComparisonTest( void )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    uts.RunUnitTest( "Comparison Thingy Test", ComparisonThingyBody );
+}
+
+// ----------------------------------------------------------------------------
+
+void StressThingyBody( ut::UnitTest * u, void * state,
+    ut::StressThread & thread )
+{
+    // Each thread changes only its own Thingy, while all of them record into
+    // the same UnitTest at once.
+    Thingy * thingies = static_cast< Thingy * >( state );
+    Thingy & thingy = thingies[ thread.GetIndex() ];
+    const int size = static_cast< int >( thread.GetRandom() % 100 ) + 1;
+    thingy.SetSize( size );
+    thread.MaybeYield();
+    UNIT_TEST( u, size == thingy.GetSize() );
+    UNIT_TEST( u, !thingy.IsZero() );
+}
+
+// ----------------------------------------------------------------------------
+
+void StressTest( void )
+{
+    Thingy thingies[ 4 ];
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    uts.RunStressTest( "Stress Thingy Test", StressThingyBody, thingies, 4,
+        0.2, 0 );
+
+    // Each thread of the stress test counts its own events, and adds them in
+    // when done.  The first counter is cycles or task-clock nanoseconds, and
+    // the threads spend most of 0.2 seconds running rounds.
+    const ut::UnitTest * test = uts.GetUnitTest( "Stress Thingy Test" );
+    if ( ( NULL != uts.GetCounterName( 0 ) ) && ( NULL != test ) )
+    {
+        ut::UnitTest * u = uts.AddUnitTest( "Stress Checks" );
+        UNIT_TEST( u, 2.0e7 <= test->GetCounter( 0 ) );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+bool IsThingySizeKept( const int & size )
+{
+    Thingy thingy;
+    thingy.SetSize( size );
+    return ( size == thingy.GetSize() ) && ( thingy.IsZero() == ( 0 == size ) );
+}
+
+// ----------------------------------------------------------------------------
+
+bool IsThingyResizeKept( const ut::PropertyPair< unsigned int, int > & sizes )
+{
+    Thingy thingy( static_cast< int >( sizes.first ) );
+    thingy.SetSize( sizes.second );
+    return ( sizes.second == thingy.GetSize() );
+}
+
+// ----------------------------------------------------------------------------
+
+bool IsThingyShort( const string & name )
+{
+    const Thingy thingy( static_cast< int >( name.size() ) );
+    return ( thingy.GetSize() < 30 );
+}
+
+// ----------------------------------------------------------------------------
+
+void PropertyThingyBody( ut::UnitTest * u )
+{
+    UNIT_TEST_PROPERTY( u, ut::IntegerGenerator< int >( -100000, 100000 ),
+        IsThingySizeKept );
+    UNIT_TEST_PROPERTY( u, ut::MakePairGenerator(
+        ut::IntegerGenerator< unsigned int >( 0, 1000 ),
+        ut::IntegerGenerator< int >( -1000, 1000 ) ), IsThingyResizeKept );
+    // This fails on purpose to show a counterexample shrunk to 30 characters.
+    UNIT_TEST_PROPERTY( u, ut::StringGenerator< string >( 40 ),
+        IsThingyShort );
+}
+
+// ----------------------------------------------------------------------------
+
+void PropertyTest( void )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    uts.RunUnitTest( "Property Thingy Test", PropertyThingyBody );
+}
+
+// ----------------------------------------------------------------------------
+
+void CaseFileThingyBody( ut::UnitTest * u, void *, const ut::CaseRow & row )
+{
+    // Each row has a size, and whether a Thingy of that size is zero.
+    long size = 0;
+    UNIT_TEST( u, row.GetLong( 0, size ) );
+    const Thingy thingy( static_cast< int >( size ) );
+    UNIT_TEST( u, thingy.IsZero() == row.IsField( 1, "zero" ) );
+}
+
+// ----------------------------------------------------------------------------
+
+void CaseFileTest( void )
+{
+    const char * fileName = "ThingyCases.csv";
+    {
+        ofstream cases( fileName );
+        cases << "size,kind" << endl;
+        for ( int ii = -500; ii <= 500; ++ii )
+            cases << ii << ',' << ( ( 0 == ii ) ? "zero" : "nonzero" ) << endl;
+    }
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    uts.RunCaseFile( "Case File Thingy Test", fileName, CaseFileThingyBody,
+        0, ',', 1, 0 );
+    ::remove( fileName );
+}
+
+// ----------------------------------------------------------------------------
+
+void SnapshotThingyBody( ut::UnitTest * u )
+{
+    string sizes;
+    for ( int ii = 0; ii < 100; ++ii )
+    {
+        const Thingy thingy( ii );
+        sizes += thingy.IsZero() ? "zero\n" : "some\n";
+    }
+    // The first snapshot writes the golden file, and the second compares.
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    const bool update = uts.IsSnapshotUpdate();
+    uts.SetSnapshotUpdate( true );
+    UNIT_TEST_SNAPSHOT( u, "ThingySizes.txt", sizes );
+    uts.SetSnapshotUpdate( false );
+    UNIT_TEST_SNAPSHOT( u, "ThingySizes.txt", sizes );
+    uts.SetSnapshotUpdate( update );
+}
+
+// ----------------------------------------------------------------------------
+
+void WrongSnapshotThingyBody( ut::UnitTest * u )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    const bool update = uts.IsSnapshotUpdate();
+    uts.SetSnapshotUpdate( true );
+    UNIT_TEST_SNAPSHOT( u, "WrongSizes.txt", string( "zero\nsome\nsome\n" ) );
+    uts.SetSnapshotUpdate( false );
+    // Each of these is expected to fail.  The first differs on line 3, the
+    // second is shorter than the golden file, and the third has none.
+    UNIT_TEST_SNAPSHOT( u, "WrongSizes.txt", string( "zero\nsome\nsame\n" ) );
+    UNIT_TEST_SNAPSHOT( u, "WrongSizes.txt", string( "zero\nsome\n" ) );
+    UNIT_TEST_SNAPSHOT( u, "MissingSizes.txt", string( "zero\n" ) );
+    uts.SetSnapshotUpdate( update );
+}
+
+// ----------------------------------------------------------------------------
+
+bool HasText( const vector< string > & messages, size_t index,
+    const char * text )
+{
+    return ( index < messages.size() )
+        && ( string::npos != messages[ index ].find( text ) );
+}
+
+// ----------------------------------------------------------------------------
+
+void SnapshotTest( void )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    const string directory( uts.GetSnapshotDirectory() );
+    uts.SetSnapshotDirectory( "." );
+    uts.RunUnitTest( "Snapshot Thingy Test", SnapshotThingyBody );
+    ::remove( "./ThingySizes.txt" );
+
+    // Messages of failed snapshots must tell where and how they differ.
+    ut::UnitTest * u = uts.AddUnitTest( "Snapshot Checks" );
+    FailureKeeper keeper;
+    UNIT_TEST( u, uts.AddReceiver( &keeper ) );
+    UNIT_TEST( u, !uts.RunUnitTest( "Wrong Snapshot Thingy Test",
+        WrongSnapshotThingyBody ) );
+    UNIT_TEST( u, uts.RemoveReceiver( &keeper ) );
+    ::remove( "./WrongSizes.txt" );
+    const vector< string > & messages = keeper.m_messages;
+    UNIT_TEST( u, 3 == messages.size() );
+    UNIT_TEST( u, HasText( messages, 0, "at byte 11, line 3." ) );
+    UNIT_TEST( u, HasText( messages, 0,
+        "Made 15 bytes, and golden file has 15." ) );
+    UNIT_TEST( u, HasText( messages, 0, "Made: \"zero\\nsome\\nsame" ) );
+    UNIT_TEST( u, HasText( messages, 0, "Golden: \"zero\\nsome\\nsome" ) );
+    UNIT_TEST( u, HasText( messages, 1, "at byte 10, line 3." ) );
+    UNIT_TEST( u, HasText( messages, 1,
+        "Made 10 bytes, and golden file has 15." ) );
+    UNIT_TEST( u, HasText( messages, 2, "MissingSizes.txt is missing." ) );
+    uts.SetSnapshotDirectory( directory.c_str() );
+    UNIT_TEST( u, directory == uts.GetSnapshotDirectory() );
+}
+
+// ----------------------------------------------------------------------------
+
+UNIT_TEST_CASE( u, StaticZeroThingyTest )
+{
+    const Thingy zero( 0 );
+    UNIT_TEST( u, zero.IsZero() );
+}
+
+// ----------------------------------------------------------------------------
+
+UNIT_TEST_CASE( u, StaticOneThingyTest )
+{
+    const Thingy justOne( 1 );
+    UNIT_TEST( u, !justOne.IsZero() );
+}
+
+// ----------------------------------------------------------------------------
+
+void StaticTest( void )
+{
+    // Only UnitTest's whose names contain the filter are made and run.  When
+    // this is called again, the second run here already made StaticOne.
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    ut::UnitTest * u = uts.AddUnitTest( "Static Checks" );
+    const bool oneWasMade =
+        ( NULL != uts.GetUnitTest( "StaticOneThingyTest" ) );
+    UNIT_TEST( u, uts.RunStaticUnitTests( "StaticZero" ) );
+    UNIT_TEST( u, NULL != uts.GetUnitTest( "StaticZeroThingyTest" ) );
+    UNIT_TEST( u, oneWasMade
+        == ( NULL != uts.GetUnitTest( "StaticOneThingyTest" ) ) );
+    UNIT_TEST( u, uts.RunStaticUnitTests( "Static" ) );
+    UNIT_TEST( u, NULL != uts.GetUnitTest( "StaticOneThingyTest" ) );
+}
+
+// ----------------------------------------------------------------------------
+
+void * MakeThingyTable( void * state )
+{
+    (void)state;
+    Thingy * table = new Thingy[ 1000 ];
+    for ( int ii = 0; ii < 1000; ++ii )
+        table[ ii ].SetSize( ii );
+    return table;
+}
+
+// ----------------------------------------------------------------------------
+
+void FreeThingyTable( void * fixture, void * state )
+{
+    (void)state;
+    delete [] static_cast< Thingy * >( fixture );
+}
+
+// ----------------------------------------------------------------------------
+
+void * MakeScratchThingy( void * state )
+{
+    (void)state;
+    return new Thingy;
+}
+
+// ----------------------------------------------------------------------------
+
+/// True if the scratch tear-down got the table, which is torn down later.
+static bool s_tableAtTearDown = false;
+
+void FreeScratchThingy( void * fixture, void * state )
+{
+    (void)state;
+    // Tear-down functions may get fixtures declared before their own.
+    s_tableAtTearDown = ( NULL != ut::UnitTestSet::GetIt().GetFixture(
+        "Thingy Table" ) );
+    delete static_cast< Thingy * >( fixture );
+}
+
+// ----------------------------------------------------------------------------
+
+void FirstTableThingyBody( ut::UnitTest * u )
+{
+    const Thingy * table = static_cast< const Thingy * >(
+        ut::UnitTestSet::GetIt().GetFixture( "Thingy Table" ) );
+    UNIT_TEST( u, ( 0 != table ) && table[ 0 ].IsZero() );
+}
+
+// ----------------------------------------------------------------------------
+
+void LastTableThingyBody( ut::UnitTest * u )
+{
+    // Gets the same table the first UnitTest built.
+    const Thingy * table = static_cast< const Thingy * >(
+        ut::UnitTestSet::GetIt().GetFixture( "Thingy Table" ) );
+    UNIT_TEST( u, ( 0 != table ) && ( table[ 999 ] == Thingy( 999 ) ) );
+}
+
+// ----------------------------------------------------------------------------
+
+void ScratchThingyBody( ut::UnitTest * u, void * state,
+    ut::StressThread & thread )
+{
+    // Each thread gets its own scratch Thingy, so none of them share one.
+    (void)state;
+    Thingy * scratch = static_cast< Thingy * >(
+        ut::UnitTestSet::GetIt().GetFixture( "Scratch Thingy" ) );
+    UNIT_TEST_REQUIRE( u, 0 != scratch );
+    const int size = static_cast< int >( thread.GetIndex() ) + 1;
+    scratch->SetSize( size );
+    thread.MaybeYield();
+    UNIT_TEST( u, size == scratch->GetSize() );
+}
+
+// ----------------------------------------------------------------------------
+
+void FixtureTest( void )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    uts.AddFixture( "Thingy Table", ut::UnitTestSet::SuiteFixture,
+        MakeThingyTable, FreeThingyTable, 0 );
+    uts.AddFixture( "Scratch Thingy", ut::UnitTestSet::WorkerFixture,
+        MakeScratchThingy, FreeScratchThingy, 0 );
+    uts.RunUnitTest( "First Table Thingy Test", FirstTableThingyBody );
+    uts.RunUnitTest( "Last Table Thingy Test", LastTableThingyBody );
+    uts.RunStressTest( "Scratch Thingy Test", ScratchThingyBody, 0, 4,
+        0.1, 0 );
+
+    ut::UnitTest * u = uts.AddUnitTest( "Fixture Checks" );
+    s_tableAtTearDown = false;
+    uts.TearDownFixtures();
+    UNIT_TEST( u, s_tableAtTearDown );
+}
+
+// ----------------------------------------------------------------------------
+
+void SoakThingyBody( ut::UnitTest * u )
+{
+    Thingy thingy;
+
+    for ( int ii = 0; ii < 2000; ++ii )
+    {
+        thingy.SetSize( ii );
+        UNIT_TEST( u, thingy.GetSize() == ii );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void SoakTest( void )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    ut::UnitTest * u = uts.AddUnitTest( "Soak Checks" );
+    const ut::UnitTest * soak = uts.GetUnitTest( "Soak Thingy Test" );
+    const ut::ItemCount itemsBefore =
+        ( NULL == soak ) ? 0 : soak->GetItemCount();
+    const unsigned int snapshotsBefore = uts.GetSoakSnapshotCount();
+
+    // A real soak run would use minutes, and loop for hours.  Waiting past
+    // the interval before each run makes a snapshot due when the run ends.
+    ut::SystemClock clock;
+    UNIT_TEST( u, uts.SetSoakMode( 0.0005 ) );
+    for ( unsigned int ii = 0; ii < 3; ++ii )
+    {
+        clock.Sleep( 0.04 );
+        uts.RunUnitTest( "Soak Thingy Test", SoakThingyBody );
+    }
+    uts.OutputSoakSnapshot();
+    UNIT_TEST( u, uts.SetSoakMode( 0.0 ) );
+
+    // Snapshots change no counts.
+    UNIT_TEST( u, snapshotsBefore + 4 <= uts.GetSoakSnapshotCount() );
+    soak = uts.GetUnitTest( "Soak Thingy Test" );
+    UNIT_TEST( u, NULL != soak );
+    if ( NULL != soak )
+    {
+        UNIT_TEST( u, itemsBefore + 6000 == soak->GetItemCount() );
+        UNIT_TEST( u, soak->GetItemCount() == soak->GetPassCount() );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void SampledThingyBody( ut::UnitTest * u )
+{
+    Thingy thingy;
+
+    // Production code would keep items like these, checking only a few calls.
+    for ( int ii = 0; ii < 100000; ++ii )
+    {
+        thingy.SetSize( ii );
+        UNIT_TEST_SAMPLED( u, thingy.GetSize() == ii, 1000 );
+        UNIT_TEST_SAMPLED( u, !thingy.IsZero() || ( 0 == ii ), 100 );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void SampledTest( void )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    const ut::UnitTest * sampled = uts.GetUnitTest( "Sampled Thingy Test" );
+    const ut::ItemCount itemsBefore =
+        ( NULL == sampled ) ? 0 : sampled->GetItemCount();
+    uts.RunUnitTest( "Sampled Thingy Test", SampledThingyBody );
+
+    // About 100000 / 1000 + 100000 / 100 calls are checked.  Gaps are random,
+    // so this allows plenty either way.
+    ut::UnitTest * u = uts.AddUnitTest( "Sampled Checks" );
+    sampled = uts.GetUnitTest( "Sampled Thingy Test" );
+    UNIT_TEST( u, NULL != sampled );
+    if ( NULL != sampled )
+    {
+        const ut::ItemCount checked = sampled->GetItemCount() - itemsBefore;
+        UNIT_TEST( u, ( 900 <= checked ) && ( checked <= 1300 ) );
+        UNIT_TEST( u, sampled->GetItemCount() == sampled->GetPassCount() );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns # of invariant checks done while recording 100 items on u.
+ut::ItemCount CountChecksOfItems( ut::UnitTest * u )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    const ut::ItemCount before = uts.GetInvariantCheckCount();
+    for ( unsigned int ii = 0; ii < 100; ++ii )
+        UNIT_TEST( u, ii < 100 );
+    return uts.GetInvariantCheckCount() - before;
+}
+
+// ----------------------------------------------------------------------------
+
+void InvariantTest( unsigned int checkPeriod )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    ut::UnitTest * u = uts.AddUnitTest( "Invariant Checks" );
+    ut::UnitTest * items = uts.AddUnitTest( "Invariant Thingy Items" );
+    // First item of a test makes extra calls, so get it out of the way.
+    UNIT_TEST( items, NULL != items );
+
+    // Every call checks, so this is how many calls check invariants.
+    UNIT_TEST( u, uts.SetInvariantPolicy( ut::UnitTestSet::CheckAlways, 0 ) );
+    const ut::ItemCount calls = CountChecksOfItems( items );
+#if defined( DEBUG )
+    UNIT_TEST( u, 100 <= calls );
+#endif
+
+    // Countdown starts over, so the first call of every 10 checks.
+    UNIT_TEST( u, !uts.SetInvariantPolicy( ut::UnitTestSet::CheckEveryNth,
+        0 ) );
+    UNIT_TEST( u, uts.SetInvariantPolicy( ut::UnitTestSet::CheckEveryNth,
+        10 ) );
+    const ut::ItemCount nth = CountChecksOfItems( items );
+    UNIT_TEST( u, ( calls + 9 ) / 10 == nth );
+
+    UNIT_TEST( u, uts.SetInvariantPolicy( ut::UnitTestSet::CheckAtSummary,
+        0 ) );
+    UNIT_TEST( u, 0 == CountChecksOfItems( items ) );
+
+    if ( 0 < checkPeriod )
+        uts.SetInvariantPolicy( ut::UnitTestSet::CheckEveryNth, checkPeriod );
+    else
+        uts.SetInvariantPolicy( ut::UnitTestSet::CheckAlways, 0 );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Two UnitTests take turns failing, so JUnit output must merge their items.
+void InterleavedThingyTest( void )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    ut::UnitTest * first = uts.AddUnitTest( "Interleaved Thingy A" );
+    ut::UnitTest * second = uts.AddUnitTest( "Interleaved Thingy B" );
+    Thingy empty;
+    for ( unsigned int ii = 0; ii < 2; ++ii )
+    {
+        UNIT_TEST( first, empty.IsZero() );
+        UNIT_TEST_WITH_MSG( first, !empty.IsZero(), "Expected failure." );
+        UNIT_TEST_WITH_MSG( second, !empty.IsZero(), "Expected failure." );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns value of numeric attribute within text, or zero if not found.
+unsigned long GetAttribute( const string & text, const char * attribute )
+{
+    const string key = string( " " ) + attribute + "=\"";
+    const string::size_type place = text.find( key );
+    if ( string::npos == place )
+        return 0;
+    return ::strtoul( text.c_str() + place + key.size(), NULL, 10 );
+}
+
+// ----------------------------------------------------------------------------
+
+/** Checks JUnit file made by the last summary has one testcase for each
+ UnitTest, even those which took turns recording results, and that testsuite
+ totals match the testcases.  The summary closed the file, and no UnitTest can
+ show results after it, so this writes to cout instead.
+ @return True if file has what it should, or if there is no JUnit file.
+ */
+bool CheckJUnitFile( const string & fileName )
+{
+    if ( fileName.empty() )
+        return true;
+    ifstream file( fileName.c_str(), ios::in | ios::binary );
+    string text;
+    char buffer[ 4096 ];
+    while ( file.read( buffer, sizeof(buffer) ) || ( 0 < file.gcount() ) )
+        text.append( buffer, static_cast< size_t >( file.gcount() ) );
+
+    unsigned long testCases = 0;
+    unsigned long failures = 0;
+    unsigned long errors = 0;
+    unsigned long interleaved = 0;
+    string::size_type place = text.find( "<testcase " );
+    while ( string::npos != place )
+    {
+        const string::size_type end = text.find( "</testcase>", place );
+        const string testCase( text, place,
+            ( string::npos == end ) ? string::npos : end - place );
+        ++testCases;
+        if ( string::npos != testCase.find( "<error" ) )
+            ++errors;
+        else if ( string::npos != testCase.find( "<failure" ) )
+            ++failures;
+        if ( string::npos != testCase.find( "name=\"Interleaved Thingy" ) )
+            ++interleaved;
+        place = text.find( "<testcase ", place + 1 );
+    }
+
+    const bool okay = ( 2 == interleaved ) && ( 0 < testCases )
+        && ( testCases == GetAttribute( text, "tests" ) )
+        && ( failures == GetAttribute( text, "failures" ) )
+        && ( errors == GetAttribute( text, "errors" ) );
+    if ( !okay )
+    {
+        cout << fileName << " has " << testCases << " testcases, "
+             << interleaved << " of them interleaved, and totals do not match."
+             << endl;
+    }
+    return okay;
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns name of JUnit file, or empty string if there is none.
+string GetJUnitFileName( void )
+{
+    const char * name = ut::UnitTestSet::GetIt().GetJUnitFileName();
+    return ( NULL == name ) ? string() : string( name );
+}
+
+// ----------------------------------------------------------------------------
+
+/// Returns size of text output file, or zero if there is none.
+long GetTextFileSize( void )
+{
+    const char * name = ut::UnitTestSet::GetIt().GetTextFileName();
+    if ( NULL == name )
+        return 0;
+    ifstream file( name, ios::in | ios::binary );
+    file.seekg( 0, ios::end );
+    return static_cast< long >( file.tellg() );
+}
+
+/// Size of text output file before a line waits in the buffer.
+static long s_sizeBeforeFlush = 0;
+
+// ----------------------------------------------------------------------------
+
+void WaitingFlushThingyBody( ut::UnitTest * u )
+{
+    s_sizeBeforeFlush = GetTextFileSize();
+    Thingy empty;
+    UNIT_TEST_WITH_MSG( u, !empty.IsZero(),
+        "Expected failure, so a line waits in the text output buffer." );
+    UNIT_TEST( u, s_sizeBeforeFlush == GetTextFileSize() );
+    // No more lines come, so only a later check of the interval flushes.
+    ut::SystemClock clock;
+    clock.Sleep( 0.1 );
+}
+
+// ----------------------------------------------------------------------------
+
+void QuietFlushThingyBody( ut::UnitTest * u )
+{
+    Thingy empty;
+    // Switching to this UnitTest sends the waiting line.
+    UNIT_TEST( u, empty.IsZero() );
+    UNIT_TEST( u, s_sizeBeforeFlush < GetTextFileSize() );
+}
+
+// ----------------------------------------------------------------------------
+
+void FlushTest( void )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    if ( NULL == uts.GetTextFileName() )
+        return;
+    uts.SetTextFlushPolicy( ut::UnitTestSet::FlushInterval, 50 );
+    uts.RunUnitTest( "Waiting Flush Thingy Test", WaitingFlushThingyBody );
+    uts.RunUnitTest( "Quiet Flush Thingy Test", QuietFlushThingyBody );
+    uts.SetTextFlushPolicy( ut::UnitTestSet::FlushEveryLine, 0 );
+}
+
+// ----------------------------------------------------------------------------
+
+void HungThingyBody( ut::UnitTest * u )
+{
+    Thingy hung( 1 );
+    UNIT_TEST( u, !hung.IsZero() );
+    // Waits far longer than the time limit, so the child process is killed.
+    ut::SystemClock clock;
+    clock.Sleep( 30.0 );
+    UNIT_TEST( u, hung.IsZero() );
+}
+
+// ----------------------------------------------------------------------------
+
+void HungTest( void )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    if ( 0 == uts.GetIsolatedWorkers() )
+        return;
+    ut::UnitTest * u = uts.AddUnitTest( "Hung Checks" );
+    const double timeout = uts.GetIsolatedTimeout();
+    UNIT_TEST( u, !uts.SetIsolatedTimeout( -1.0 ) );
+    UNIT_TEST( u, uts.SetIsolatedTimeout( 0.5 ) );
+    UNIT_TEST( u, !uts.RunUnitTest( "Hung Thingy Test", HungThingyBody ) );
+    uts.SetIsolatedTimeout( timeout );
+
+    const ut::UnitTest * hung = uts.GetUnitTest( "Hung Thingy Test" );
+    UNIT_TEST( u, NULL != hung );
+    if ( NULL != hung )
+    {
+        // Item sent before the child hung still arrives.
+        UNIT_TEST( u, 1 == hung->GetPassCount() );
+        UNIT_TEST( u, 1 == hung->GetExceptionCount() );
+        UNIT_TEST( u, hung->GetElapsedTime() < 10.0 );
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void FatalThingyBody( ut::UnitTest * u )
+{
     Thingy empty;
 
     UNIT_TEST_REQUIRE( u, empty != empty );
-    // If this shows up in output, then program did not exit on previous line.
-    UNIT_TEST_WITH_MSG( u, false, "Why is this program still running?" );
+    // If this shows up in output, then the program or unit test did not end
+    // on previous line.
+    UNIT_TEST_WITH_MSG( u, false, "Why is this unit test still running?" );
+}
+
+// ----------------------------------------------------------------------------
+
+void FatalThingyTest( void )
+{
+    ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    uts.RunUnitTest( "Fatal Thingy Test", FatalThingyBody );
 }
 
 // ----------------------------------------------------------------------------
@@ -308,7 +1306,8 @@ class UnitTestAsserter : public ::ut::UnitTestResultReceiver
         (void)expression;
         (void)message;
         if ( ( result != ut::TestResult::Passed )
-          && ( result != ut::TestResult::Warning ) )
+          && ( result != ut::TestResult::Warning )
+          && ( result != ut::TestResult::Skipped ) )
         {
             assert( false );
         }
@@ -372,6 +1371,16 @@ public:
     inline const char * GetXmlFileName( void ) const
     { return m_xmlFileName; }
 
+    inline const char * GetJsonFileName( void ) const
+    { return m_jsonFileName; }
+
+    inline const char * GetJUnitFileName( void ) const
+    { return m_junitFileName; }
+
+    inline unsigned int GetWorkerCount( void ) const { return m_workerCount; }
+
+    inline unsigned int GetCheckPeriod( void ) const { return m_checkPeriod; }
+
     inline const char * GetExeName( void ) const { return m_exeName; }
 
 private:
@@ -392,8 +1401,12 @@ private:
     bool m_tableAtExitTime;
     bool m_deleteAtExitTime;
     unsigned int m_outputOptions;
+    unsigned int m_workerCount;
+    unsigned int m_checkPeriod;
     const char * m_exeName;
     const char * m_xmlFileName;
+    const char * m_jsonFileName;
+    const char * m_junitFileName;
     const char * m_htmlFileName;
     const char * m_textFileName;
 };
@@ -403,11 +1416,13 @@ private:
 void MainArgs::ShowHelp( void ) const
 {
     cout << "Usage: " << m_exeName << endl;
-    cout << " [-f] [-p] [-z] [-a] [-o:[ndhmptw]]" << endl;
-    cout << " [-s] [-t:file] [-h:file] [-x:file] [-?] [--help]" << endl;
+    cout << " [-f] [-p] [-z] [-a] [-o:[ndhmpcrstwF]]" << endl;
+    cout << " [-s] [-t:file] [-h:file] [-x:file] [-j:file]" << endl;
+    cout << " [-u:file] [-w:count] [-c:n] [-?] [--help]" << endl;
     cout << endl;
     cout << "Parameters: (order of parameters does not matter)" << endl;
     cout << "  -f  Do fatal tests.  Causes program to end abruptly." << endl;
+    cout << "      With -o:F, only the fatal unit test ends." << endl;
     cout << "      Incompatible with -p and -z." << endl;
     cout << "  -p  Do only passing tests." << endl;
     cout << "      Incompatible with -f and -z." << endl;
@@ -424,9 +1439,14 @@ void MainArgs::ShowHelp( void ) const
     cout << "      i  Show test index in each unit test output line." << endl;
     cout << "      m  Show messages even if no test with message." << endl;
     cout << "      p  Show contents of passing tests." << endl;
+    cout << "      s  Show real and virtual seconds in summary table." << endl;
+    cout << "      c  Show CPU event counts in summary table, Linux only."
+         << endl;
+    cout << "      r  Show resident memory use in summary table." << endl;
     cout << "      t  Show beginning and ending timestamps." << endl;
     cout << "      T  Show summary table once tests are done." << endl;
     cout << "      w  Show failing warnings." << endl;
+    cout << "      F  Fatal tests end only their own unit test." << endl;
     cout << "      d  Show divider lines in table and sections." << endl;
     cout << "      D  Show default output options." << endl;
     cout << "         You may combine this with other options." << endl;
@@ -440,6 +1460,14 @@ void MainArgs::ShowHelp( void ) const
          << endl;
     cout << "  -x  Send test results to xml file." << endl;
     cout << "        \"file\" is a partial file name." << endl;
+    cout << "  -j  Send test results to JSON Lines file." << endl;
+    cout << "        \"file\" is a partial file name." << endl;
+    cout << "  -u  Send test results to JUnit XML file." << endl;
+    cout << "        \"file\" is a partial file name." << endl;
+    cout << "  -w  Run dependent and fatal tests in child processes." << endl;
+    cout << "        \"count\" is the most child processes at once." << endl;
+    cout << "  -c  Check invariants at one call of every n in DEBUG builds."
+         << endl;
     cout << "  -e  Show summary table at program exit time." << endl;
     cout << "  -r  Show summary table and then repeat tests." << endl;
     cout << "      Incompatible with -z." << endl;
@@ -462,8 +1490,12 @@ MainArgs::MainArgs( unsigned int argc, const char * const argv[] ) :
     m_tableAtExitTime( false ),
     m_deleteAtExitTime( true ),
     m_outputOptions( ut::UnitTestSet::Nothing ),
+    m_workerCount( 0 ),
+    m_checkPeriod( 0 ),
     m_exeName( argv[0] ),
     m_xmlFileName( NULL ),
+    m_jsonFileName( NULL ),
+    m_junitFileName( NULL ),
     m_htmlFileName( NULL ),
     m_textFileName( NULL )
 {
@@ -532,6 +1564,42 @@ MainArgs::MainArgs( unsigned int argc, const char * const argv[] ) :
                 if ( okay )
                     m_htmlFileName = ss + 3;
                 break;
+            case 'j':
+                okay = ( 3 < length ) && ( ':' == ss[2] );
+                if ( okay )
+                    okay = ( NULL == m_jsonFileName );
+                if ( okay )
+                    m_jsonFileName = ss + 3;
+                break;
+            case 'u':
+                okay = ( 3 < length ) && ( ':' == ss[2] );
+                if ( okay )
+                    okay = ( NULL == m_junitFileName );
+                if ( okay )
+                    m_junitFileName = ss + 3;
+                break;
+            case 'w':
+                okay = ( 3 < length ) && ( ':' == ss[2] );
+                if ( okay )
+                    okay = ( 0 == m_workerCount );
+                if ( okay )
+                {
+                    m_workerCount = static_cast< unsigned int >(
+                        ::strtoul( ss + 3, NULL, 10 ) );
+                    okay = ( 0 < m_workerCount );
+                }
+                break;
+            case 'c':
+                okay = ( 3 < length ) && ( ':' == ss[2] );
+                if ( okay )
+                    okay = ( 0 == m_checkPeriod );
+                if ( okay )
+                {
+                    m_checkPeriod = static_cast< unsigned int >(
+                        ::strtoul( ss + 3, NULL, 10 ) );
+                    okay = ( 0 < m_checkPeriod );
+                }
+                break;
             case 'L':
                 okay = ( length == 2 );
                 if ( okay )
@@ -593,6 +1661,7 @@ MainArgs::MainArgs( unsigned int argc, const char * const argv[] ) :
     const bool standardOutput =
         ( 0 != ( m_outputOptions |= ut::UnitTestSet::SendToCout ) );
     const bool noOutput = ( !m_doFatalTest ) && ( NULL == m_xmlFileName )
+            && ( NULL == m_jsonFileName ) && ( NULL == m_junitFileName )
             && ( !standardError ) && ( !standardOutput )
             && ( NULL == m_textFileName ) && ( NULL == m_htmlFileName );
     if ( m_doShowHelp && okay )
@@ -634,6 +1703,10 @@ bool MainArgs::ParseOutputOptions( const char * ss )
     bool showSummaryTable = false;
     bool standardError = false;
     bool standardOutput = false;
+    bool fatalEndsTest = false;
+    bool showTimes = false;
+    bool showCounters = false;
+    bool showMemory = false;
 
     while ( okay && ( *ss != '\0' ) )
     {
@@ -718,6 +1791,30 @@ bool MainArgs::ParseOutputOptions( const char * ss )
                 else
                     showWarnings = true;
                 break;
+            case 'F':
+                if ( fatalEndsTest )
+                    okay = false;
+                else
+                    fatalEndsTest = true;
+                break;
+            case 's':
+                if ( showTimes )
+                    okay = false;
+                else
+                    showTimes = true;
+                break;
+            case 'c':
+                if ( showCounters )
+                    okay = false;
+                else
+                    showCounters = true;
+                break;
+            case 'r':
+                if ( showMemory )
+                    okay = false;
+                else
+                    showMemory = true;
+                break;
             default:
                 okay = false;
                 break;
@@ -757,6 +1854,14 @@ bool MainArgs::ParseOutputOptions( const char * ss )
         m_outputOptions |= ut::UnitTestSet::SendToCerr;
     if ( standardOutput )
         m_outputOptions |= ut::UnitTestSet::SendToCout;
+    if ( fatalEndsTest )
+        m_outputOptions |= ut::UnitTestSet::FatalEndsTest;
+    if ( showTimes )
+        m_outputOptions |= ut::UnitTestSet::Times;
+    if ( showCounters )
+        m_outputOptions |= ut::UnitTestSet::Counters;
+    if ( showMemory )
+        m_outputOptions |= ut::UnitTestSet::Memory;
 
     return okay;
 }
@@ -793,6 +1898,31 @@ int main( unsigned int argc, const char * const argv[] )
     }
 
     ut::UnitTestSet & uts = ut::UnitTestSet::GetIt();
+    if ( !uts.SetJsonFileName( args.GetJsonFileName() ) )
+    {
+        cout << "The UnitTestSet singleton could not set the JSON file name."
+             << endl;
+        return 2;
+    }
+    if ( !uts.SetJUnitFileName( args.GetJUnitFileName() ) )
+    {
+        cout << "The UnitTestSet singleton could not set the JUnit file name."
+             << endl;
+        return 2;
+    }
+    if ( !uts.SetIsolatedWorkers( args.GetWorkerCount() ) )
+    {
+        cout << "The UnitTestSet singleton could not run tests in child "
+             << "processes." << endl;
+        return 2;
+    }
+    if ( ( 0 < args.GetCheckPeriod() ) && !uts.SetInvariantPolicy(
+        ut::UnitTestSet::CheckEveryNth, args.GetCheckPeriod() ) )
+    {
+        cout << "The UnitTestSet singleton could not set the invariant policy."
+             << endl;
+        return 2;
+    }
     if ( !uts.DoesOutputOption( options ) )
     {
         cout << "The UnitTestSet singleton does not apply the same output "
@@ -837,13 +1967,35 @@ int main( unsigned int argc, const char * const argv[] )
         TestThingy2();
         EmptyThingyTest();
         ExceptionTest();
+        DependencyTest();
+        DeathTest();
+        AsyncTest();
+        VirtualClockTest();
+        MemoryTest();
+        LatencyTest();
+        ComparisonTest();
+        StressTest();
+        PropertyTest();
+        CaseFileTest();
+        SnapshotTest();
+        StaticTest();
+        FixtureTest();
+        SoakTest();
+        SampledTest();
+        InvariantTest( args.GetCheckPeriod() );
+        InterleavedThingyTest();
+        FlushTest();
+        HungTest();
         if ( args.DoFatalTest() )
             FatalThingyTest();
     }
 
+    bool junitOkay = true;
     if ( args.DoRepeatTests() )
     {
+        const string junitName = GetJUnitFileName();
         uts.OutputSummary();
+        junitOkay &= CheckJUnitFile( junitName );
         PassingThingyTest();
         PassWithWarningsThingyTest();
         if ( !args.DoOnlyPassingTest() )
@@ -852,6 +2004,25 @@ int main( unsigned int argc, const char * const argv[] )
             TestThingy2();
             EmptyThingyTest();
             ExceptionTest();
+            DependencyTest();
+            DeathTest();
+            AsyncTest();
+            VirtualClockTest();
+            MemoryTest();
+            LatencyTest();
+            ComparisonTest();
+            StressTest();
+            PropertyTest();
+            CaseFileTest();
+            SnapshotTest();
+            StaticTest();
+            FixtureTest();
+            SoakTest();
+            SampledTest();
+            InvariantTest( args.GetCheckPeriod() );
+            InterleavedThingyTest();
+            FlushTest();
+            HungTest();
             if ( args.DoFatalTest() )
                 FatalThingyTest();
         }
@@ -859,10 +2030,12 @@ int main( unsigned int argc, const char * const argv[] )
 
     if ( !args.DoMakeTableAtExitTime() )
     {
+        const string junitName = GetJUnitFileName();
         uts.OutputSummary();
+        junitOkay &= CheckJUnitFile( junitName );
     }
 
-    return 0;
+    return ( junitOkay ) ? 0 : 1;
 }
 
 // ----------------------------------------------------------------------------